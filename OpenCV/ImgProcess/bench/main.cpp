@@ -0,0 +1,642 @@
+/*
+ * @Description: 性能测试与逐字节校验
+ *
+ *     ImgBench [图片] [-s 5000x4000] [-c oil,dither,halftone,pipeline,tiled,color,geometry]
+ *
+ * 各项优化的结果与原实现 (或单线程 / 整图) 的结果逐字节比较, 有不一致时返回 1
+ */
+#include "ImgProcess.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace
+{
+    using namespace ImgSpace;
+
+    /**
+     * @description: 计时与比对, 记录不一致的项数
+     */
+    class BenchCheck
+    {
+    public:
+        /**
+         * @description: 执行 fn, 返回耗时 (ms)
+         */
+        static double timeMs(const std::function<void()> &fn)
+        {
+            const int64 nStart = getTickCount();
+            fn();
+            return (getTickCount() - nStart) * 1000.0 / getTickFrequency();
+        }
+
+        /**
+         * @description: 尺寸、类型与像素全部相同返回 true, 否则计入失败并输出最大差值
+         */
+        bool expectSame(const std::string &strName, const Mat &matExpect, const Mat &matActual)
+        {
+            if (matExpect.size() != matActual.size() || matExpect.type() != matActual.type())
+            {
+                fprintf(stderr, "不一致 %s: 尺寸或类型不同 (%dx%d / %dx%d)\n", strName.c_str(),
+                        matExpect.cols, matExpect.rows, matActual.cols, matActual.rows);
+                m_nFailed++;
+                return false;
+            }
+            const double dDiff = matExpect.empty() ? 0.0 : norm(matExpect, matActual, NORM_INF);
+            if (dDiff != 0.0)
+            {
+                fprintf(stderr, "不一致 %s: 最大差值 %.0f\n", strName.c_str(), dDiff);
+                m_nFailed++;
+                return false;
+            }
+            return true;
+        }
+
+        /**
+         * @description: 条件不成立时计入失败
+         */
+        bool expect(const std::string &strName, bool bOk)
+        {
+            if (!bOk)
+            {
+                fprintf(stderr, "失败 %s\n", strName.c_str());
+                m_nFailed++;
+            }
+            return bOk;
+        }
+
+        int getFailed() const { return m_nFailed; }
+
+    private:
+        int m_nFailed = 0;
+    };
+
+    const char *sameText(bool bSame) { return bSame ? "" : " (不一致)"; }
+
+    // 以下为颜色内核替换前的实现, 只用于对比耗时与结果
+
+    Mat legacyRedChannel(const Mat &mat)
+    {
+        vector<Mat> mv;
+        split(mat, mv);
+        mv[0] = Scalar(0);
+        mv[1] = Scalar(0);
+        Mat matRes;
+        merge(mv, matRes);
+        return matRes;
+    }
+
+    Mat legacyContrastAndBright(const Mat &mat, double dH, double dS, double dV)
+    {
+        Mat matHSV;
+        cvtColor(mat, matHSV, COLOR_BGR2HSV);
+        for (int y = 0; y < matHSV.rows; y++)
+        {
+            for (int x = 0; x < matHSV.cols; x++)
+            {
+                signed short h = matHSV.at<Vec3b>(y, x)[0];
+                signed short h_plus_shift = h;
+                h_plus_shift += dH;
+                if (h_plus_shift < 0)
+                    h = 180 + h_plus_shift;
+                else if (h_plus_shift > 180)
+                    h = h_plus_shift - 180;
+                else
+                    h = h_plus_shift;
+                matHSV.at<Vec3b>(y, x)[0] = static_cast<unsigned char>(h);
+
+                double v_plus_shift = matHSV.at<Vec3b>(y, x)[2] + dS;
+                matHSV.at<Vec3b>(y, x)[2] = static_cast<unsigned char>(std::min(std::max(v_plus_shift, 0.0), 255.0));
+
+                double s_plus_shift = matHSV.at<Vec3b>(y, x)[1] + dV;
+                matHSV.at<Vec3b>(y, x)[1] = static_cast<unsigned char>(std::min(std::max(s_plus_shift, 0.0), 255.0));
+            }
+        }
+        Mat matShow;
+        cvtColor(matHSV, matShow, COLOR_HSV2BGR);
+        return matShow;
+    }
+
+    Mat legacyRelief(const Mat &mat, int nBrushSize)
+    {
+        Mat matImgA = Mat::zeros(mat.size(), CV_8UC3);
+        for (int y = 1; y < mat.rows - 1; y++)
+        {
+            const uchar *p0 = mat.ptr<uchar>(y);
+            const uchar *p1 = mat.ptr<uchar>(y + 1);
+            uchar *q0 = matImgA.ptr<uchar>(y);
+            for (int x = 1; x < mat.cols - 1; x++)
+            {
+                for (int i = 0; i < 3; i++)
+                    q0[3 * x + i] = saturate_cast<uchar>(p1[3 * (x + 1) + i] - p0[3 * (x - 1) + i] + nBrushSize);
+            }
+        }
+        cvtColor(matImgA, matImgA, COLOR_BGR2GRAY);
+        return matImgA;
+    }
+
+    Mat legacyColorTemperature(const Mat &mat, int nPercent)
+    {
+        Mat matRes = mat.clone();
+        int level = nPercent * 0.1;
+        for (int i = 0; i < matRes.rows; ++i)
+        {
+            uchar *r = matRes.ptr<uchar>(i);
+            for (int j = 0; j < matRes.cols; ++j)
+            {
+                r[j * 3 + 2] = saturate_cast<uchar>(r[j * 3 + 2] + level);
+                r[j * 3 + 1] = saturate_cast<uchar>(r[j * 3 + 1] + level);
+                r[j * 3] = saturate_cast<uchar>(r[j * 3] - level);
+            }
+        }
+        return matRes;
+    }
+
+    Mat legacyWhiteBalance(const Mat &mat)
+    {
+        int nRow = mat.rows;
+        int nCol = mat.cols;
+        Mat dst(nRow, nCol, CV_8UC3);
+        int HistRGB[767] = { 0 };
+        int nMaxVal = 0;
+        for (int i = 0; i < nRow; i++)
+        {
+            for (int j = 0; j < nCol; j++)
+            {
+                nMaxVal = max(nMaxVal, (int)mat.at<Vec3b>(i, j)[0]);
+                nMaxVal = max(nMaxVal, (int)mat.at<Vec3b>(i, j)[1]);
+                nMaxVal = max(nMaxVal, (int)mat.at<Vec3b>(i, j)[2]);
+                HistRGB[mat.at<Vec3b>(i, j)[0] + mat.at<Vec3b>(i, j)[1] + mat.at<Vec3b>(i, j)[2]]++;
+            }
+        }
+
+        int Threshold = 0;
+        int sum = 0;
+        for (int i = 766; i >= 0; i--)
+        {
+            sum += HistRGB[i];
+            if (sum > nRow * nCol * 0.1)
+            {
+                Threshold = i;
+                break;
+            }
+        }
+
+        int64 AvgB = 0, AvgG = 0, AvgR = 0, cnt = 0;
+        for (int i = 0; i < nRow; i++)
+        {
+            for (int j = 0; j < nCol; j++)
+            {
+                if (mat.at<Vec3b>(i, j)[0] + mat.at<Vec3b>(i, j)[1] + mat.at<Vec3b>(i, j)[2] > Threshold)
+                {
+                    AvgB += mat.at<Vec3b>(i, j)[0];
+                    AvgG += mat.at<Vec3b>(i, j)[1];
+                    AvgR += mat.at<Vec3b>(i, j)[2];
+                    cnt++;
+                }
+            }
+        }
+        if (cnt == 0)
+            return mat.clone();
+
+        int nAvgB = std::max<int>(1, static_cast<int>(AvgB / cnt));
+        int nAvgG = std::max<int>(1, static_cast<int>(AvgG / cnt));
+        int nAvgR = std::max<int>(1, static_cast<int>(AvgR / cnt));
+        for (int i = 0; i < nRow; i++)
+        {
+            for (int j = 0; j < nCol; j++)
+            {
+                dst.at<Vec3b>(i, j)[0] = std::min(255, mat.at<Vec3b>(i, j)[0] * nMaxVal / nAvgB);
+                dst.at<Vec3b>(i, j)[1] = std::min(255, mat.at<Vec3b>(i, j)[1] * nMaxVal / nAvgG);
+                dst.at<Vec3b>(i, j)[2] = std::min(255, mat.at<Vec3b>(i, j)[2] * nMaxVal / nAvgR);
+            }
+        }
+        return dst;
+    }
+
+    // 以下为几何变换快速路径之前的实现, 只用于对比耗时与结果
+
+    Mat legacyRotate(const Mat &mat, double dAngle)
+    {
+        Mat matTemp = mat.clone();
+        Mat matRes = getRotationMatrix2D(Point(matTemp.cols / 2, matTemp.rows / 2), (dAngle - 180), 1.0);
+
+        Mat matOut;
+        warpAffine(matTemp, matOut, matRes, matTemp.size(), INTER_LINEAR, 0, Scalar());
+        return matOut;
+    }
+
+    Mat legacyMirror(const Mat &mat)
+    {
+        int col = mat.cols;
+        Mat matRes = mat.clone();
+        for (int i = 0; i < col; i++)
+            mat.col(col - 1 - i).copyTo(matRes.col(i));
+        return matRes;
+    }
+
+    // 油画: 滑动直方图实现随笔刷大小与线程数的耗时, 与原实现逐字节比对
+    void benchOilPaint(imgProcess &proc, const Mat &matSrc, BenchCheck &check)
+    {
+        const int nCoarseness = 20;
+        const int nMaxThreads = getNumberOfCPUs();
+        printf("油画: 粗糙度 %d\n", nCoarseness);
+
+        // 原实现太慢, 只在中心 512x512 区域上计时并比对
+        Rect rcCheck((matSrc.cols - std::min(512, matSrc.cols)) / 2, (matSrc.rows - std::min(512, matSrc.rows)) / 2,
+                     std::min(512, matSrc.cols), std::min(512, matSrc.rows));
+        Mat matCheck = matSrc(rcCheck).clone();
+        const double dCheckRatio = static_cast<double>(matSrc.total()) / matCheck.total();
+
+        for (int nBrush : { 1, 2, 4, 8 })
+        {
+            const std::string strName = "油画 笔刷 " + std::to_string(nBrush);
+
+            setNumThreads(1);
+            Mat matRef, matFast;
+            double dRefMs = BenchCheck::timeMs([&] { matRef = proc.setImgOilPaintRef(matCheck, nBrush, nCoarseness); });
+            matFast = proc.setImgOilPaint(matCheck, nBrush, nCoarseness);
+            bool bSame = check.expectSame(strName, matRef, matFast);
+            printf("  笔刷 %d: 原实现(估算整图) %.0f ms%s |", nBrush, dRefMs * dCheckRatio, sameText(bSame));
+
+            Mat matSingle;
+            for (int nThreads = 1; nThreads <= nMaxThreads; nThreads *= 2)
+            {
+                setNumThreads(nThreads);
+                Mat matRes;
+                double dMs = BenchCheck::timeMs([&] { matRes = proc.setImgOilPaint(matSrc, nBrush, nCoarseness); });
+                if (matSingle.empty())
+                    matSingle = matRes;
+                bSame = check.expectSame(strName + " " + std::to_string(nThreads) + " 线程", matSingle, matRes);
+                printf(" %d线程 %.0f ms%s", nThreads, dMs, sameText(bSame));
+            }
+            printf("\n");
+        }
+    }
+
+    // 误差扩散: 各扩散核在不同线程数下的耗时, 多线程结果与单线程逐字节比对
+    void benchDither(imgProcess &proc, const Mat &matSrc, BenchCheck &check)
+    {
+        static const char *arrNames[] = { "Floyd-Steinberg", "Jarvis", "Stucki", "Atkinson", "Sierra" };
+        const int nMaxThreads = getNumberOfCPUs();
+        printf("误差扩散:\n");
+
+        Mat matGray;
+        cvtColor(matSrc, matGray, COLOR_BGR2GRAY);
+
+        for (int k = 0; k < static_cast<int>(DitherKernel::Count); k++)
+        {
+            const DitherKernel eKernel = static_cast<DitherKernel>(k);
+            printf("  %s:", arrNames[k]);
+
+            Mat matSingle;
+            for (int nThreads = 1; nThreads <= nMaxThreads; nThreads *= 2)
+            {
+                setNumThreads(nThreads);
+                Mat matRes;
+                double dMs = BenchCheck::timeMs([&] { matRes = proc.setErrorDiffusion(matGray, eKernel); });
+                if (matSingle.empty())
+                    matSingle = matRes;
+                bool bSame = check.expectSame(std::string(arrNames[k]) + " " + std::to_string(nThreads) + " 线程", matSingle, matRes);
+                printf(" %d线程 %.0f ms%s", nThreads, dMs, sameText(bSame));
+            }
+
+            setNumThreads(1);
+            double dMs = BenchCheck::timeMs([&] { proc.setErrorDiffusion(matGray, eKernel, true); });
+            printf(" | 蛇形 %.0f ms\n", dMs);
+        }
+    }
+
+    // 挂网: 各阈值矩阵放大 2 倍, 网角 0 与 15 度的耗时; 上下两半分别挂网后与整图比对
+    void benchHalftone(imgProcess &proc, const Mat &matSrc, BenchCheck &check)
+    {
+        static const char *arrNames[] = { "Screw", "CoarseFatting", "Bayer", "Halftone", "12x12", "16x16", "9x9(8x8)" };
+        const double dScale = 2.0;
+        printf("挂网: x%.0f %s\n", dScale, HalftoneScreen::simdName());
+
+        Mat matGray;
+        cvtColor(matSrc, matGray, COLOR_BGR2GRAY);
+        const int nHalf = matGray.rows / 2;
+
+        for (int k = 0; k < HalftoneScreen::MASK_COUNT; k++)
+        {
+            HalftoneScreen screen(k);
+            printf("  %s:", arrNames[k]);
+            Mat matWhole;
+            for (int nAngle : { 0, 15 })
+            {
+                Mat matRes;
+                double dMs = BenchCheck::timeMs([&] { matRes = screen.apply(matGray, dScale, nAngle); });
+                if (nAngle == 0)
+                    matWhole = matRes;
+                printf(" %d度 %.0f ms", nAngle, dMs);
+            }
+
+            Mat matJoined;
+            vconcat(screen.apply(matGray.rowRange(0, nHalf), dScale),
+                    screen.apply(matGray.rowRange(nHalf, matGray.rows), dScale, 0.0, Point(0, cvRound(nHalf * dScale))), matJoined);
+            bool bSame = check.expectSame(std::string(arrNames[k]) + " 分块衔接", matWhole, matJoined);
+            printf("%s\n", sameText(bSame));
+        }
+
+        // setDither 的输出尺寸与原实现 (旋转 -> 放大 -> 转回) 相同
+        for (int nAngle : { 0, 15, 90 })
+        {
+            Mat matRotated = proc.setRotateImg(matGray, nAngle, true), matScaled;
+            resize(matRotated, matScaled, Size(matRotated.cols * dScale, matRotated.rows * dScale), 0, 0, INTER_NEAREST);
+            const Size sizeLegacy = proc.setRotateImg(matScaled, -nAngle, true).size();
+            const Size sizeDither = proc.setDither(matSrc, dScale, 0, 2, 0, nAngle).size();
+            bool bSame = check.expect("setDither " + std::to_string(nAngle) + " 度输出尺寸", sizeDither == sizeLegacy);
+            printf("  setDither %d度: %dx%d%s\n", nAngle, sizeDither.width, sizeDither.height, sameText(bSame));
+        }
+    }
+
+    // 效果流水线: 逐个调用 imgProcess 与流水线的耗时, 以及只改最后一步参数后重算的耗时
+    void benchPipeline(imgProcess &proc, const Mat &matSrc, BenchCheck &check)
+    {
+        // 伽马 -> 亮度对比度 -> 锐化 -> 反色 -> 二值化
+        Mat matReversal, matRef;
+        double dRefMs = BenchCheck::timeMs([&] {
+            matReversal = proc.setImgGamma(matSrc, 1.2);
+            matReversal = proc.setContrastAndBright(matReversal, 10, 20, 30);
+            matReversal = proc.setSharpening(matReversal, 3, 0, BORDER_DEFAULT);
+            matReversal = proc.setColorReversal(matReversal);
+            matRef = proc.setThreshold(matReversal, 100);
+        });
+
+        ImgPipeline pipeline;
+        pipeline.setSource(matSrc);
+        Mat matRes;
+        double dRunMs = BenchCheck::timeMs([&] {
+            matRes = pipeline.rewind().gamma(1.2).contrastAndBright(10, 20, 30).sharpen(3).reversal().threshold(100).run();
+        });
+        bool bSame = check.expectSame("流水线", matRef, matRes);
+
+        Mat matRerun;
+        double dRerunMs = BenchCheck::timeMs([&] { matRerun = pipeline.rewind(4).threshold(120).run(); });
+        bSame = check.expectSame("流水线 改阈值重算", proc.setThreshold(matReversal, 120), matRerun) && bSame;
+
+        printf("效果流水线: 逐个调用 %.0f ms | 流水线 %.0f ms | 改阈值重算 %.0f ms%s\n", dRefMs, dRunMs, dRerunMs, sameText(bSame));
+    }
+
+    // 分块处理: 图像写入临时分块文件, 在 32MB 缓存预算下分块执行流水线与误差扩散, 与整图结果比对
+    void benchTiled(imgProcess &, const Mat &matSrc, BenchCheck &check)
+    {
+        const std::string strDir = std::filesystem::temp_directory_path().string();
+        const std::string strSrc = strDir + "/ImgBenchSrc.tile";
+        const std::string strGray = strDir + "/ImgBenchGray.tile";
+        const std::string strDither = strDir + "/ImgBenchDither.tile";
+
+        {
+            TileCache cache(32 << 20);
+            TiledImage tiledSrc, tiledGray, tiledDither;
+            if (!tiledSrc.create(strSrc, matSrc.size(), matSrc.type()) ||
+                !tiledGray.create(strGray, matSrc.size(), CV_8UC1) ||
+                !tiledDither.create(strDither, matSrc.size(), CV_8UC1))
+            {
+                check.expect("分块处理: 无法在 " + strDir + " 创建临时文件", false);
+                return;
+            }
+            writeTiledRect(tiledSrc, matSrc, Point(), cache);
+
+            ImgPipeline pipeline;
+            pipeline.rewind().gray().gamma(1.2).sharpen(3);
+
+            double dPipelineMs = BenchCheck::timeMs([&] { processTiled(tiledSrc, tiledGray, pipeline, cache); });
+            double dDitherMs = BenchCheck::timeMs([&] {
+                errorDiffusionTiled(tiledGray, tiledDither, DitherKernel::FloydSteinberg, false, 128, cache);
+            });
+
+            const Rect rectAll(Point(), matSrc.size());
+            pipeline.setSource(matSrc);
+            Mat matGray = pipeline.run();
+            bool bSame = check.expectSame("分块流水线", matGray, readTiledRect(tiledGray, rectAll, cache));
+            bSame = check.expectSame("分块误差扩散", errorDiffusionDither(matGray, DitherKernel::FloydSteinberg),
+                                     readTiledRect(tiledDither, rectAll, cache)) && bSame;
+
+            printf("分块处理: 流水线 %.0f ms | 误差扩散 %.0f ms | 缓存峰值 %.1f MB / %.0f MB%s\n", dPipelineMs, dDitherMs,
+                   cache.getPeakBytes() / 1048576.0, cache.getBudget() / 1048576.0, sameText(bSame));
+        }
+
+        std::remove(strSrc.c_str());
+        std::remove(strGray.c_str());
+        std::remove(strDither.c_str());
+    }
+
+    // 颜色内核: 各效果替换前后的耗时与结果比对
+    void benchColor(imgProcess &proc, const Mat &matSrc, BenchCheck &check)
+    {
+        // 浮雕原实现不写四周一圈, 只比较内部
+        const Rect rectInner(1, 1, std::max(0, matSrc.cols - 2), std::max(0, matSrc.rows - 2));
+        struct Case
+        {
+            const char *szName;
+            std::function<Mat()> fnLegacy;
+            std::function<Mat()> fnKernel;
+            Rect rectCompare;
+        };
+        const Case arrCases[] = {
+            { "通道", [&] { return legacyRedChannel(matSrc); }, [&] { return proc.getRedChannel(matSrc); }, Rect() },
+            { "色相/饱和度/明度", [&] { return legacyContrastAndBright(matSrc, 10, 20, 30); }, [&] { return proc.setContrastAndBright(matSrc, 10, 20, 30); }, Rect() },
+            { "浮雕", [&] { return legacyRelief(matSrc, 150); }, [&] { return proc.setRelief(matSrc, 150, 0); }, rectInner },
+            { "色温", [&] { return legacyColorTemperature(matSrc, 300); }, [&] { return proc.setColorTemperature(matSrc, 300); }, Rect() },
+            { "白平衡", [&] { return legacyWhiteBalance(matSrc); }, [&] { return proc.setAutoWhithBalance(matSrc, 0, 0, 0); }, Rect() },
+        };
+
+        printf("颜色内核:\n");
+        for (const Case &c : arrCases)
+        {
+            Mat matLegacy, matKernel;
+            double dLegacyMs = BenchCheck::timeMs([&] { matLegacy = c.fnLegacy(); });
+            double dKernelMs = BenchCheck::timeMs([&] { matKernel = c.fnKernel(); });
+
+            bool bSame = c.rectCompare.area() > 0 ? check.expectSame(c.szName, matLegacy(c.rectCompare), matKernel(c.rectCompare))
+                                                  : check.expectSame(c.szName, matLegacy, matKernel);
+            printf("  %s: 原实现 %.1f ms | 内核 %.1f ms%s\n", c.szName, dLegacyMs, dKernelMs, sameText(bSame));
+        }
+    }
+
+    // 几何变换: 快速路径与原实现的耗时与结果比对, 输出缓冲区复用、原地翻转与复合变换
+    void benchGeometry(imgProcess &proc, const Mat &matSrc, BenchCheck &check)
+    {
+        struct Case
+        {
+            const char *szName;
+            std::function<Mat()> fnLegacy;
+            std::function<Mat()> fnFast;
+        };
+        const Case arrCases[] = {
+            { "顺时针 90 度", [&] { Mat matRes; rotate(matSrc, matRes, ROTATE_90_CLOCKWISE); return matRes; }, [&] { return proc.rotate90(matSrc, 0); } },
+            { "旋转 180 度", [&] { Mat matRes; rotate(matSrc, matRes, ROTATE_180); return matRes; }, [&] { return proc.rotate90(matSrc, 1); } },
+            { "setRotateImg 270", [&] { return legacyRotate(matSrc, 270); }, [&] { return proc.setRotateImg(matSrc, 270); } },
+            { "左右镜像", [&] { return legacyMirror(matSrc); }, [&] { return proc.setImgMirror(matSrc, 0); } },
+        };
+
+        printf("几何变换:\n");
+        for (const Case &c : arrCases)
+        {
+            Mat matLegacy, matFast;
+            double dLegacyMs = BenchCheck::timeMs([&] { matLegacy = c.fnLegacy(); });
+            double dFastMs = BenchCheck::timeMs([&] { matFast = c.fnFast(); });
+
+            bool bSame = check.expectSame(c.szName, matLegacy, matFast);
+            printf("  %s: 原实现 %.1f ms | 快速路径 %.1f ms%s\n", c.szName, dLegacyMs, dFastMs, sameText(bSame));
+        }
+
+        // 输出缓冲区复用
+        Mat matBuf;
+        GeoTransform transform;
+        transform.rotate90(1, matSrc.size());
+        transform.apply(matSrc, matBuf, Size(matSrc.rows, matSrc.cols));
+        const uchar *pBuf = matBuf.data;
+        double dReuseMs = BenchCheck::timeMs([&] { transform.apply(matSrc, matBuf, Size(matSrc.rows, matSrc.cols)); });
+        bool bReused = check.expect("复用输出缓冲区", matBuf.data == pBuf);
+
+        // 原地旋转 180 度
+        Mat matInPlace = matSrc.clone();
+        double dInPlaceMs = BenchCheck::timeMs([&] { GeoTransform().flip(-1, matInPlace.size()).apply(matInPlace, matInPlace, matInPlace.size()); });
+        Mat matFlip;
+        flip(matSrc, matFlip, -1);
+        bool bSame = check.expectSame("原地旋转 180 度", matFlip, matInPlace);
+
+        // 旋转后缩小: 两次插值与复合成一次 (插值次数不同, 结果不要求一致)
+        Mat matTwice, matOnce;
+        double dTwiceMs = BenchCheck::timeMs([&] { matTwice = proc.setScaleImg(legacyRotate(matSrc, 200), 0.5, 0.5); });
+        double dOnceMs = BenchCheck::timeMs([&] {
+            GeoTransform().rotate(20, Point(matSrc.cols / 2, matSrc.rows / 2)).resize(0.5, 0.5).apply(matSrc, matOnce, Size(matSrc.cols / 2, matSrc.rows / 2));
+        });
+
+        printf("  复用输出缓冲区 %.1f ms%s | 原地旋转 180 度 %.1f ms%s | 旋转+缩小: 两次插值 %.1f ms, 复合一次 %.1f ms\n",
+               dReuseMs, bReused ? "" : " (重新分配)", dInPlaceMs, sameText(bSame), dTwiceMs, dOnceMs);
+    }
+
+    struct BenchCase
+    {
+        const char *szName;
+        void (*fnRun)(imgProcess &, const Mat &, BenchCheck &);
+    };
+
+    const BenchCase g_arrCases[] = {
+        { "oil", benchOilPaint },
+        { "dither", benchDither },
+        { "halftone", benchHalftone },
+        { "pipeline", benchPipeline },
+        { "tiled", benchTiled },
+        { "color", benchColor },
+        { "geometry", benchGeometry },
+    };
+
+    void printUsage(const char *szApp)
+    {
+        printf("用法: %s [图片] [-s 宽x高] [-c 测试项[,测试项...]]\n", szApp);
+        printf("  不指定图片时用 -s 尺寸的随机图 (默认 5000x4000)\n");
+        printf("  测试项: oil dither halftone pipeline tiled color geometry, 默认全部\n");
+        printf("  全部一致时返回 0, 有不一致时返回 1\n");
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    std::string strImage;
+    std::string strCases;
+    Size sizeRandom(5000, 4000);
+
+    for (int i = 1; i < argc; i++)
+    {
+        const char *szArg = argv[i];
+        const bool bHasValue = i + 1 < argc;
+        if (!strcmp(szArg, "-s") && bHasValue)
+        {
+            if (sscanf(argv[++i], "%dx%d", &sizeRandom.width, &sizeRandom.height) != 2 || sizeRandom.width < 2 || sizeRandom.height < 2)
+            {
+                fprintf(stderr, "尺寸格式错误: %s\n", argv[i]);
+                return 2;
+            }
+        }
+        else if (!strcmp(szArg, "-c") && bHasValue)
+            strCases = argv[++i];
+        else if (!strcmp(szArg, "-h") || !strcmp(szArg, "--help"))
+        {
+            printUsage(argv[0]);
+            return 0;
+        }
+        else if (szArg[0] == '-' || !strImage.empty())
+        {
+            fprintf(stderr, "未知的参数: %s\n", szArg);
+            printUsage(argv[0]);
+            return 2;
+        }
+        else
+            strImage = szArg;
+    }
+
+    std::vector<const BenchCase *> vCases;
+    if (strCases.empty())
+    {
+        for (const BenchCase &c : g_arrCases)
+            vCases.push_back(&c);
+    }
+    else
+    {
+        size_t nPos = 0;
+        while (nPos <= strCases.size())
+        {
+            size_t nEnd = std::min(strCases.find(',', nPos), strCases.size());
+            const std::string strName = strCases.substr(nPos, nEnd - nPos);
+            nPos = nEnd + 1;
+            if (strName.empty())
+                continue;
+
+            const BenchCase *pCase = nullptr;
+            for (const BenchCase &c : g_arrCases)
+                if (strName == c.szName)
+                    pCase = &c;
+            if (!pCase)
+            {
+                fprintf(stderr, "未知的测试项: %s\n", strName.c_str());
+                printUsage(argv[0]);
+                return 2;
+            }
+            vCases.push_back(pCase);
+        }
+    }
+
+    Mat matSrc;
+    if (!strImage.empty())
+    {
+        matSrc = imread(strImage, IMREAD_COLOR);
+        if (matSrc.empty())
+        {
+            fprintf(stderr, "无法读取图像: %s\n", strImage.c_str());
+            return 2;
+        }
+    }
+    else
+    {
+        matSrc = Mat(sizeRandom, CV_8UC3);
+        randu(matSrc, Scalar::all(0), Scalar::all(256));
+    }
+    printf("图像 %dx%d, CPU %d\n", matSrc.cols, matSrc.rows, getNumberOfCPUs());
+
+    imgProcess proc;
+    BenchCheck check;
+    const int nPrevThreads = getNumThreads();
+    for (const BenchCase *pCase : vCases)
+    {
+        pCase->fnRun(proc, matSrc, check);
+        setNumThreads(nPrevThreads);
+    }
+
+    if (check.getFailed() > 0)
+    {
+        printf("%d 项不一致\n", check.getFailed());
+        return 1;
+    }
+    printf("全部一致\n");
+    return 0;
+}
@@ -0,0 +1,68 @@
+/*
+ * @Description: 逐像素颜色运算内核
+ */
+#ifndef IMG_COLOR_KERNELS_H
+#define IMG_COLOR_KERNELS_H
+
+#include <opencv2/opencv.hpp>
+
+namespace ImgSpace
+{
+    /*
+     * 各内核按行指针访问, 行内循环只有连续字节上的简单运算 (与按通道展开的整行模板逐字节运算), 编译器可自动向量化;
+     * 查表类的运算交给 cv::LUT. 行按条带由 cv::parallel_for_ 并行, 输入不会被修改.
+     */
+
+    /**
+     * @description: 只保留选中的通道, 其余置 0 (getRedChannel 等)
+     * @param {Mat} &mat CV_8UC3 或 CV_8UC4 (alpha 保留); 其他通道数原样复制
+     * @return 处理后的图像数据
+     */
+    cv::Mat keepChannels(const cv::Mat &mat, bool bBlue, bool bGreen, bool bRed);
+
+    /**
+     * @description: 各通道加上偏移并饱和到 0 ~ 255 (色温)
+     * @param {Mat} &matBgr CV_8UC3
+     * @return 处理后的图像数据
+     */
+    cv::Mat offsetChannels(const cv::Mat &matBgr, int nBlue, int nGreen, int nRed);
+
+    /**
+     * @description: setContrastAndBright 的 HSV 调节表: H 加 dH 后在 0 ~ 180 内回绕, S 加 dV、V 加 dS 后截断到 0 ~ 255
+     * @return 1x256 CV_8UC3, 用于 cv::LUT
+     */
+    cv::Mat makeHsvShiftLut(double dH, double dS, double dV);
+
+    /**
+     * @description: HSV 调节, 按条带转换到 HSV、查表、转回 BGR, 中间结果只有条带大小
+     * @param {Mat} &mat CV_8UC3 或 CV_8UC4
+     * @return CV_8UC3
+     */
+    cv::Mat shiftHsv(const cv::Mat &mat, double dH, double dS, double dV);
+
+    /**
+     * @description: 自动白平衡 (完美反射法)
+     * 一次遍历按像素的三通道和 (0 ~ 765) 统计个数与各通道之和, 同时求最大通道值; 由直方图找出最亮 10% 的阈值,
+     * 阈值以上各通道的均值直接由分组和相加得到, 不再重新遍历图像. 最后按 v * 最大值 / 均值 查表.
+     * @param {Mat} &matBgr CV_8UC3
+     * @return 处理后的图像数据
+     */
+    cv::Mat autoWhiteBalance(const cv::Mat &matBgr);
+
+    /**
+     * @description: 浮雕: 下一行右侧像素减本行左侧像素加偏移后转灰度, 四周一圈为 0
+     * @param {Mat} &matBgr CV_8UC3
+     * @param {int} nOffset 偏移
+     * @return CV_8UC1
+     */
+    cv::Mat reliefGray(const cv::Mat &matBgr, int nOffset);
+
+    /**
+     * @description: 颜色替换: 各通道与 colorFrom 相差都不超过 nTolerance 的像素换成 colorTo
+     * @param {Mat} &matBgr CV_8UC3
+     * @return 处理后的图像数据
+     */
+    cv::Mat replaceColor(const cv::Mat &matBgr, cv::Vec3b colorFrom, int nTolerance, cv::Vec3b colorTo);
+}
+
+#endif // IMG_COLOR_KERNELS_H
@@ -0,0 +1,79 @@
+/*
+ * @Description: 误差扩散抖动
+ */
+#ifndef IMG_ERROR_DIFFUSION_H
+#define IMG_ERROR_DIFFUSION_H
+
+#include <opencv2/opencv.hpp>
+#include <vector>
+
+namespace ImgSpace
+{
+    /**
+     * @description: 误差扩散核
+     */
+    enum class DitherKernel
+    {
+        FloydSteinberg = 0, // 2 行, /16
+        Jarvis,             // 3 行, /48 (Jarvis-Judice-Ninke)
+        Stucki,             // 3 行, /42
+        Atkinson,           // 3 行, 只扩散 6/8 的误差, 对比度更高
+        Sierra,             // 3 行, /32
+        Count
+    };
+
+    /**
+     * @description: 误差扩散抖动, 输出 0 / 255 的单通道图
+     * 按行指针访问像素, 误差以 float 累加在环形行缓冲中 (不截断、不饱和, 边缘列同样扩散).
+     * 光栅扫描时按对角波前并行: 各线程按顺序领取行, 每行落后上一行 2 * 核半宽 个像素以上,
+     * 保证读取的误差已经写完且两行不会同时写同一位置, 结果与单线程逐字节一致.
+     * 蛇形扫描时相邻两行方向相反, 下一行必须等上一行整行完成, 只能串行.
+     * @param {Mat} &matGray    CV_8UC1 灰度图
+     * @param {DitherKernel} eKernel 扩散核
+     * @param {bool} bSerpentine 蛇形扫描 (奇数行从右向左)
+     * @param {int} nThreshold  阈值, 累加误差后 >= 阈值输出 255
+     * @return 处理后的图像数据
+     */
+    cv::Mat errorDiffusionDither(const cv::Mat &matGray, DitherKernel eKernel, bool bSerpentine = false, int nThreshold = 128);
+
+    /**
+     * @description: 逐行误差扩散, 供分块 / 流式处理: 从第 0 行起按顺序逐行送入,
+     * 结果与 errorDiffusionDither 逐字节相同. 只保留 核行数 + 1 行误差, 内存与图像高度无关
+     */
+    class ErrorDiffusionRows
+    {
+    public:
+        ErrorDiffusionRows(int nWidth, DitherKernel eKernel, bool bSerpentine = false, int nThreshold = 128);
+
+        /**
+         * @description: 处理下一行
+         * @param {uchar} *pSrc 灰度行, nWidth 个像素
+         * @param {uchar} *pDst 输出行, 0 / 255
+         */
+        void ditherRow(const uchar *pSrc, uchar *pDst);
+
+        /**
+         * @description: 已处理的行数
+         */
+        int getRow() const { return m_nRow; }
+
+    private:
+        struct Tap
+        {
+            int nDx;
+            int nDy;
+            float fWeight;
+        };
+
+        std::vector<Tap> m_vTaps;
+        int m_nWidth = 0;
+        int m_nReach = 0;
+        int m_nRing = 1;        // 误差行数
+        int m_nRow = 0;
+        bool m_bSerpentine = false;
+        float m_fThreshold = 128.0f;
+        std::vector<float> m_vErr;
+    };
+}
+
+#endif // IMG_ERROR_DIFFUSION_H
@@ -0,0 +1,85 @@
+/*
+ * @Description: 几何变换 (仿射变换合并, 90 度旋转 / 镜像的整像素快速路径)
+ */
+#ifndef IMG_GEOMETRY_TRANSFORM_H
+#define IMG_GEOMETRY_TRANSFORM_H
+
+#include <opencv2/opencv.hpp>
+
+namespace ImgSpace
+{
+    /**
+     * @description: 仿射变换
+     * 保存源坐标到目标坐标的正向矩阵 (与 warpAffine 的 M 相同, 像素中心在整数坐标上), 连续的变换先复合成一个矩阵,
+     * apply 时只重采样一次. 复合结果是整像素搬移 (90 度倍数的旋转、镜像、整数平移及其组合) 时不插值,
+     * 按块直接搬移像素, 与 warpAffine 的结果逐位相同; 其余情况调用一次 warpAffine.
+     *
+     *     GeoTransform().rotate90(1, mat.size()).apply(mat, matDst, Size(mat.rows, mat.cols));  // 顺时针 90 度
+     *     GeoTransform().rotate(30, ptCenter).resize(0.5, 0.5).apply(mat, matDst, sizeHalf);    // 旋转加缩小, 一次插值
+     */
+    class GeoTransform
+    {
+    public:
+        GeoTransform() = default;
+        explicit GeoTransform(const cv::Matx23d &matM) : m_matM(matM) {}
+
+        /**
+         * @description: 在当前变换之后再做 other
+         */
+        GeoTransform &then(const GeoTransform &other);
+
+        /**
+         * @description: 绕 ptCenter 旋转, 与 getRotationMatrix2D 相同 (逆时针为正, 单位度)
+         */
+        GeoTransform &rotate(double dAngle, cv::Point2d ptCenter, double dScale = 1.0);
+
+        /**
+         * @description: 以原点为中心缩放
+         */
+        GeoTransform &scale(double dScaleX, double dScaleY);
+
+        /**
+         * @description: 与 cv::resize 相同的像素中心对齐的缩放, x' = (x + 0.5) * dScaleX - 0.5
+         */
+        GeoTransform &resize(double dScaleX, double dScaleY);
+
+        GeoTransform &translate(double dX, double dY);
+
+        /**
+         * @description: 镜像, 与 cv::flip 相同: 0 上下, 正数左右, 负数上下左右
+         * @param {Size} size 此时图像的尺寸
+         */
+        GeoTransform &flip(int nFlipCode, cv::Size size);
+
+        /**
+         * @description: 顺时针旋转 nTimes 个 90 度, 画布随之转置, 与 cv::rotate 相同
+         * @param {Size} size 此时图像的尺寸
+         */
+        GeoTransform &rotate90(int nTimes, cv::Size size);
+
+        const cv::Matx23d &matrix() const { return m_matM; }
+
+        /**
+         * @description: 是否为整像素搬移: 2x2 部分每行每列只有一个 ±1, 平移为整数 (允许 getRotationMatrix2D 等带来的舍入误差)
+         */
+        bool isExact() const;
+
+        /**
+         * @description: 执行变换
+         * @param {Mat} &mat 输入
+         * @param {Mat} &matDst 输出, 尺寸与类型已经符合时直接写入不重新分配 (可以是调用方的缓冲区或其中的 ROI);
+         *                      可以与 mat 是同一幅图 (原地), 镜像与 180 度旋转原地执行只需一行临时内存, 其余情况先复制输入
+         * @param {Size} size 输出尺寸
+         * @param {int} nInterp 非整像素搬移时的插值方式
+         * @param {int} nBorder 补边方式, 整像素搬移只支持 BORDER_CONSTANT 或不需要补边的情况, 否则改用 warpAffine
+         * @param {Scalar} border BORDER_CONSTANT 的颜色
+         */
+        void apply(const cv::Mat &mat, cv::Mat &matDst, cv::Size size, int nInterp = cv::INTER_LINEAR,
+                   int nBorder = cv::BORDER_CONSTANT, const cv::Scalar &border = cv::Scalar()) const;
+
+    private:
+        cv::Matx23d m_matM = cv::Matx23d(1, 0, 0, 0, 1, 0);
+    };
+}
+
+#endif // IMG_GEOMETRY_TRANSFORM_H
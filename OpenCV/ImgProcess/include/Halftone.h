@@ -0,0 +1,64 @@
+/*
+ * @Description: 有序抖动 / 挂网
+ */
+#ifndef IMG_HALFTONE_H
+#define IMG_HALFTONE_H
+
+#include <opencv2/opencv.hpp>
+#include <vector>
+
+namespace ImgSpace
+{
+    /**
+     * @description: 有序抖动挂网引擎
+     * 构造时把阈值矩阵与亮度微调换算成字节阈值图块: 灰度 g 输出 255 当且仅当 g >= 阈值
+     * (与原实现 g / 255.0 * N + 0.5 + nAdjust * 0.1 > Mask 的判断逐像素等价), 之后可重复用于多张图.
+     * apply 把最近邻放大与阈值比较合并在一起, 不生成放大后的中间图; 比较按 AVX2 / SSE2 / NEON
+     * 一次 32 / 16 / 16 个像素. 旋转网角时在旋转坐标中取阈值图块, 不旋转图像.
+     */
+    class HalftoneScreen
+    {
+    public:
+        static const int MASK_COUNT = 7;
+
+        /**
+         * @description:
+         * @param {int} nMask   阈值矩阵 0 Screw 1 CoarseFatting 2 Bayer 3 Halftone 4 12x12大颗粒 5 16x16 6 9x9螺旋表的前 64 项按 8x8 使用 (取模 7)
+         * @param {int} nAdjust 亮度微调, 每 10 相当于阈值偏移一级
+         */
+        HalftoneScreen(int nMask, int nAdjust = 0);
+
+        /**
+         * @description: 设置色调查找表 (对比度 / 亮度 / 伽马), 取样时先查表再比较
+         * @param {Mat} &matLut 1x256 CV_8U, 为空时取消
+         */
+        void setToneLut(const cv::Mat &matLut);
+
+        /**
+         * @description: 挂网
+         * @param {Mat} &matGray CV_8UC1 灰度图
+         * @param {double} dScale 放大倍数 1 ~ 8 (最近邻)
+         * @param {double} dAngle 网角(度), 方向与 setRotateImg 旋转图像后挂网再转回相同
+         * @param {Point} ptOrigin 结果左上角在整幅网屏中的坐标 (非负), 分块挂网时各块网点衔接
+         * @return 0 / 255 的单通道图, 尺寸为 (cols * dScale, rows * dScale)
+         */
+        cv::Mat apply(const cv::Mat &matGray, double dScale = 1.0, double dAngle = 0.0, cv::Point ptOrigin = cv::Point()) const;
+
+        int getTileWidth() const { return m_nTileW; }
+        int getTileHeight() const { return m_nTileH; }
+
+        /**
+         * @description: 编译时选用的指令集名称
+         */
+        static const char *simdName();
+
+    private:
+        int m_nTileW = 8;
+        int m_nTileH = 8;
+        std::vector<uchar> m_vThreshold;    // 图块阈值, 行优先
+        std::vector<uchar> m_vEnable;       // 0xFF 可点亮; 0 表示 255 也达不到阈值
+        std::vector<uchar> m_vLut;          // 色调查找表, 空表示不查表
+    };
+}
+
+#endif // IMG_HALFTONE_H
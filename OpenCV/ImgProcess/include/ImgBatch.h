@@ -0,0 +1,126 @@
+/*
+ * @Description: 批量图像处理 (无界面, 解码 / 处理 / 编码三级流水并行)
+ */
+#ifndef IMG_BATCH_H
+#define IMG_BATCH_H
+
+#include <opencv2/opencv.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace ImgSpace
+{
+    /**
+     * @description: 一个处理步骤, 如 "gamma:1.8" 解析为 { "gamma", { 1.8 } }; save 的第一个参数是扩展名, 放在 strExt
+     */
+    struct BatchStep
+    {
+        std::string strName;
+        std::vector<double> vArgs;
+        std::string strExt;
+    };
+
+    /**
+     * @description: 解析处理步骤, 步骤之间用 ',' 分隔, 参数用 ':' 分隔, 如 "gray,gamma:1.8,dither:2,save:png"
+     * 支持的步骤 (参数可省略, 取括号中的默认值):
+     *   gray                         灰度
+     *   channels:b:g:r (1:1:1)        只保留选中的通道
+     *   threshold:a:b:type (128:255:0)
+     *   contrast:h:s:v (0:0:0)        HSV 调节
+     *   gamma:g (1.0)
+     *   reversal                     反色
+     *   sharpen:sigma (5)
+     *   blur:w:h (7:7)
+     *   dither:type:scale:angle (0:1:0)          有序抖动挂网, 输出放大 scale 倍
+     *   diffusion:kernel:serpentine:threshold (0:0:128)  误差扩散
+     *   oil:brush:coarseness (3:5)   油画
+     *   mosaic:block:type (10:0)
+     *   rotate:angle:resize (0:0)
+     *   scale:sx:sy (1:sx)
+     *   save:ext:quality (png)       必须是最后一步; 省略时按 png 保存
+     * 相邻的 gray ~ blur 交给 ImgPipeline 合并执行, 相邻的 rotate (resize 为 0) / scale 复合成一次仿射变换只插值一次,
+     * 其余调用 imgProcess 的同名功能
+     * @param {string} &strSteps
+     * @param {vector} &vSteps 解析结果, 末尾总是 save
+     * @param {string} &strError 失败原因
+     * @return 是否成功
+     */
+    bool parseBatchSteps(const std::string &strSteps, std::vector<BatchStep> &vSteps, std::string &strError);
+
+    /**
+     * @description: 展开输入: 目录取其中的图像文件 (不递归), 文件名中含 '*' / '?' 时按通配符匹配同目录的文件, 其余原样返回
+     * @param {string} &strPattern
+     * @return 排序后的文件路径
+     */
+    std::vector<std::string> collectBatchInputs(const std::string &strPattern);
+
+    struct BatchOptions
+    {
+        std::vector<std::string> vInputs;
+        std::string strOutDir;
+        std::vector<BatchStep> vSteps;  // parseBatchSteps 的结果
+        int nWorkers = 0;               // 处理线程数, 0 取 CPU 核数
+        int nIoThreads = 2;             // 解码、编码各自的线程数
+        size_t nMemoryBytes = 1ull << 30; // 在途图像 (解码后到编码完成) 的内存上限, 单张超过上限时独占执行
+    };
+
+    struct BatchReport
+    {
+        size_t nImages = 0;     // 成功处理的张数
+        size_t nFailed = 0;
+        double dSeconds = 0.0;  // 总耗时
+        uint64_t nBytesIn = 0;  // 输入文件大小之和
+        uint64_t nBytesOut = 0; // 输出文件大小之和
+        uint64_t nPixels = 0;   // 输入像素数之和
+        double arrStageSeconds[3] = { 0.0, 0.0, 0.0 }; // 解码、处理、编码各自累计的线程时间
+        size_t nPeakBytes = 0;  // 在途图像的内存峰值
+    };
+
+    /**
+     * @description: 批量处理
+     * 解码线程按输入顺序读图, 放入有界队列交给处理线程, 处理结果再经有界队列交给编码线程写盘, 三级同时进行.
+     * 解码后按图像实际大小登记内存, 在途总量超过上限时解码线程拿着这张图等待编码完成释放 (每个解码线程最多多占一张);
+     * 队列长度也有上限, 处理跟不上时解码自然停下来. 每个处理线程持有自己的 imgProcess 与 ImgPipeline.
+     *
+     *     BatchOptions opt;
+     *     opt.vInputs = collectBatchInputs("scans");
+     *     parseBatchSteps("gray,gamma:1.8,dither:2,save:png", opt.vSteps, strError);
+     *     BatchReport report = BatchRunner(opt).run();
+     */
+    class BatchRunner
+    {
+    public:
+        explicit BatchRunner(const BatchOptions &opt);
+
+        /**
+         * @description: 执行, 阻塞到全部完成或被 cancel
+         * @param {function} onDone 每张完成 (或失败) 时回调: 输入路径, 输出路径 (失败时为错误信息), 是否成功; 在工作线程中串行调用
+         * @return 统计结果
+         */
+        BatchReport run(const std::function<void(const std::string &, const std::string &, bool)> &onDone = nullptr);
+
+        /**
+         * @description: 请求停止, 已开始的图像处理完, 其余跳过; 可在任意线程调用
+         */
+        void cancel() { m_bCancel = true; }
+
+        /**
+         * @description: 第 nIndex 个输入对应的输出路径: 输出目录 / 原文件名 . 扩展名 (未指定输出目录时为 原目录 / 原文件名_batch . 扩展名);
+         * 构造时统一分配, 主文件名相同的输入 (如 a.jpg 与 a.png) 保留原扩展名 (a_jpg.png、a_png.png), 仍然重名时加序号 (a_2.png)
+         */
+        const std::string &getOutputPath(size_t nIndex) const { return m_vOutputs[nIndex]; }
+
+    private:
+        void makeOutputPaths();
+
+        BatchOptions m_opt;
+        std::vector<std::string> m_vOutputs; // 与 m_opt.vInputs 一一对应, 互不重名
+        std::atomic<bool> m_bCancel{ false };
+    };
+}
+
+#endif // IMG_BATCH_H
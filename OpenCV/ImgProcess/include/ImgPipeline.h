@@ -0,0 +1,105 @@
+/*
+ * @Description: 图像效果流水线 (延迟执行, 逐点操作合并)
+ */
+#ifndef IMG_PIPELINE_H
+#define IMG_PIPELINE_H
+
+#include <opencv2/opencv.hpp>
+#include <functional>
+#include <vector>
+
+namespace ImgSpace
+{
+    /**
+     * @description: 图像效果流水线
+     * 各操作先记录下来, run 时才执行. 相邻的逐点操作 (通道、二值化、伽马、反色、HSV 调节、灰度)
+     * 合并成一次遍历, 连续的查找表在执行前复合成一张; 邻域操作 (锐化、模糊) 按行分块计算,
+     * 分块结果趁还在缓存中接着做后面的逐点操作, 各分块并行. 每个邻域操作的输入整图保留,
+     * 重新记录时只有参数变化的操作所在的分段及其之后的分段重新计算.
+     *
+     *     pipeline.setSource(mat);
+     *     pipeline.rewind().gray().gamma(1.2).sharpen(5).threshold(128);
+     *     Mat matRes = pipeline.run();
+     *     pipeline.rewind(3).threshold(100);  // 前三步的结果直接复用
+     *     matRes = pipeline.run();
+     *
+     * 各操作的结果与 imgProcess 中的同名函数相同. run 返回的图与缓存共用数据, 需要修改时先 clone.
+     */
+    class ImgPipeline
+    {
+    public:
+        /**
+         * @description: 设置输入图像, 清空所有缓存
+         * @param {Mat} &mat CV_8UC1 或 CV_8UC3
+         */
+        void setSource(const cv::Mat &mat);
+
+        /**
+         * @description: 从第 nStage 个操作开始重新记录. 与原来相同的操作保留缓存, 不同时其后的缓存作废;
+         *               run 时丢弃未重新记录的操作
+         */
+        ImgPipeline &rewind(size_t nStage = 0);
+
+        /**
+         * @description: 已记录的操作数
+         */
+        size_t size() const { return m_nCursor; }
+
+        ImgPipeline &gray();                                                   // getGray
+        ImgPipeline &channels(bool bBlue, bool bGreen, bool bRed);             // getRedChannel 等, 只保留选中的通道
+        ImgPipeline &threshold(int nValueA, int nValueB = 255, int nType = 0); // setThreshold
+        ImgPipeline &contrastAndBright(double dH, double dS, double dV);       // setContrastAndBright
+        ImgPipeline &gamma(double dGamma);                                     // setImgGamma
+        ImgPipeline &reversal();                                               // setColorReversal
+        ImgPipeline &sharpen(double dSigma);                                   // setSharpening
+        ImgPipeline &blur(int nW, int nH);                                     // setBlurImg
+
+        /**
+         * @description: 已记录操作的邻域半径之和, 输出中离边缘超过该距离的像素不受边界影响 (分块处理时的重叠宽度)
+         */
+        cv::Size getHalo() const;
+
+        /**
+         * @description: 输入为 nInChannels 通道时输出的通道数
+         */
+        int getOutChannels(int nInChannels) const;
+
+        /**
+         * @description: 执行, 从第一个缓存失效的分段开始
+         * @param {function} isStale 各分块开始前检查, 返回 true 时放弃计算 (已完成的分段仍然缓存), 可在多个线程中同时调用
+         * @return 处理后的图像数据, 放弃时为空
+         */
+        cv::Mat run(const std::function<bool()> &isStale = nullptr);
+
+    private:
+        enum class StageType
+        {
+            Gray,
+            Channels,
+            Threshold,
+            ContrastAndBright,
+            Gamma,
+            Reversal,
+            Sharpen,
+            Blur
+        };
+
+        struct Stage
+        {
+            StageType eType;
+            double arrParam[3];
+
+            bool operator==(const Stage &other) const;
+        };
+
+        ImgPipeline &record(StageType eType, double dA = 0.0, double dB = 0.0, double dC = 0.0);
+
+    private:
+        cv::Mat m_matSource;
+        std::vector<Stage> m_vStages;
+        std::vector<cv::Mat> m_vCache;  // m_vCache[i]: 第 i 个操作之后的整图, 只在分段末尾保存
+        size_t m_nCursor = 0;
+    };
+}
+
+#endif // IMG_PIPELINE_H
@@ -0,0 +1,100 @@
+/*
+ * @Description: 交互预览: 金字塔分级渲染
+ */
+#ifndef IMG_PREVIEW_H
+#define IMG_PREVIEW_H
+
+#include <opencv2/opencv.hpp>
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ImgSpace
+{
+    /**
+     * @description: 交互预览服务
+     * 对输入图像建立一次金字塔 (逐级 INTER_AREA 缩小一半), 参数变化时先在与显示尺寸相当的层上计算效果,
+     * 按各效果记录的每像素耗时选层, 保证在帧预算内返回; 然后在后台线程计算原图.
+     * 每次 render / cancel 作废之前的后台任务: 未开始的直接丢弃, 正在计算的由效果函数通过 isStale 提前结束,
+     * 结果不再回调.
+     */
+    class ImgPreview
+    {
+    public:
+        /**
+         * @description: 效果函数, dScale 为该层相对原图的比例, 半径等与尺寸相关的参数需乘上它.
+         * isStale 返回 true 时任务已被作废, 效果可以提前结束并返回空图 (如 ImgPipeline::run 在分块之间检查)
+         */
+        using Effect = std::function<cv::Mat(const cv::Mat &mat, double dScale, const std::function<bool()> &isStale)>;
+
+        /**
+         * @description: 原图计算完成的回调, 在后台线程中调用
+         * @param {uint64_t} nJob render 返回时 getJob() 的值
+         */
+        using Callback = std::function<void(uint64_t nJob, const cv::Mat &matRes)>;
+
+    public:
+        ImgPreview();
+        ~ImgPreview();
+        ImgPreview(const ImgPreview &) = delete;
+        ImgPreview &operator=(const ImgPreview &) = delete;
+
+        /**
+         * @description: 设置输入图像; 与上次是同一块数据时保留金字塔, 否则在下次 render 时重建
+         * @param {Mat} &mat
+         */
+        void setImage(const cv::Mat &mat);
+
+        /**
+         * @description: 计算预览
+         * @param {int} nKey 效果标识, 用于记录耗时
+         * @param {Effect} effect 效果函数, 会在后台线程中再次调用, 捕获的数据须按值保存
+         * @param {Size} sizeDisplay 显示区域大小
+         * @param {double} dBudgetMs 帧预算
+         * @param {Callback} onRefined 原图计算完成时的回调; 预览已经是原图时不会调用
+         * @param {int} *pLevel 返回预览所在的层, 0 为原图
+         * @return 预览结果
+         */
+        cv::Mat render(int nKey, const Effect &effect, cv::Size sizeDisplay, double dBudgetMs, Callback onRefined, int *pLevel = nullptr);
+
+        /**
+         * @description: 作废后台任务
+         */
+        void cancel();
+
+        /**
+         * @description: 当前任务号, 回调中的任务号与之不同时结果已过时
+         */
+        uint64_t getJob() const { return m_nJob.load(); }
+
+        int getLevelCount() const { return static_cast<int>(m_vLevels.size()); }
+
+    private:
+        void buildPyramid();
+        void run();
+
+        double estimateMs(int nKey, size_t nPixels);
+        void recordMs(int nKey, size_t nPixels, double dMs);
+
+    private:
+        cv::Mat m_matSource;
+        std::vector<cv::Mat> m_vLevels; // 0 为原图, 空表示需要重建
+
+        std::mutex m_mutexCost;
+        std::map<int, double> m_mapMsPerPixel; // 各效果的每像素耗时 (ms)
+
+        std::atomic<uint64_t> m_nJob{ 0 };
+        std::thread m_thread;
+        std::mutex m_mutex;                  // 保护下面的待办任务
+        std::condition_variable m_condition; // 有新任务或停止时通知
+        std::function<void()> m_task;        // 只保留最新的一个
+        bool m_bStop = false;
+    };
+}
+
+#endif // IMG_PREVIEW_H
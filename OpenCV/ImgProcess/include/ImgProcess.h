@@ -10,6 +10,15 @@
 #include <opencv2/opencv.hpp>
 #include <iostream>
 
+#include "ErrorDiffusion.h"
+#include "GeometryTransform.h"
+#include "Halftone.h"
+#include "ImgPipeline.h"
+#include "ImgPreview.h"
+#include "IntegralImage.h"
+#include "ColorKernels.h"
+#include "TiledImage.h"
+
 using namespace cv;
 using namespace std;
 
@@ -124,7 +133,7 @@ namespace ImgSpace
          * @description: 旋转图像
          * @param {Mat&} mat
          * @param {double} dAngle 旋转角度(度)
-         * @param {bool} bChangeSize 图像尺寸是否改变
+         * @param {bool} bChangeSize 图像尺寸是否改变 (逆时针旋转 dAngle 度, 90 度的倍数时宽高正好对调)
           @return 处理后的图像数据
          */
         Mat setRotateImg(const Mat &mat, double dAngle = 0.0, bool bChangeSize = false);
@@ -149,7 +158,7 @@ namespace ImgSpace
         /**
          * @description: 对图片进行90度顺时针旋转
          * @param {Mat&} mat
-         * @param {int} nIndex  旋转次数 1/90度 2/180度 3/270度
+         * @param {int} nIndex  0/90度 1/180度 2/270度 3/不旋转
          * @return {*}
          */
         Mat rotate90(const Mat &mat, int nIndex = 0);
@@ -240,20 +249,22 @@ namespace ImgSpace
         // 颜色样式
         Mat setColorStyle(const Mat &mat, int nA);
         /**
-         * @description:
+         * @description: 油画 (滑动直方图实现, 三通道图像按行条带并行; 其他图像走 setImgOilPaintRef)
          * @param {Mat} &mat
-         * @param {int} nBrushSize
-         * @param {int} nCoarseness
+         * @param {int} nBrushSize 笔刷半径 1 ~ 8
+         * @param {int} nCoarseness 粗糙度 1 ~ 255
           @return 处理后的图像数据
          */
+        Mat setImgOilPaint(const Mat &mat, int nBrushSize, int nCoarseness);
+
         /**
-         * @description:
+         * @description: 油画原始实现, 每个像素重新统计整个窗口 (用于校验与性能对比)
          * @param {Mat} &mat
          * @param {int} nBrushSize
          * @param {int} nCoarseness
           @return 处理后的图像数据
          */
-        Mat setImgOilPaint(const Mat &mat, int nBrushSize, int nCoarseness);
+        Mat setImgOilPaintRef(const Mat &mat, int nBrushSize, int nCoarseness);
 
         /**
          * @description:
@@ -265,23 +276,35 @@ namespace ImgSpace
         Mat setDotPaint(const Mat &mat, int nBrushSize, int nCoarseness);
 
         /**
-         * @description:
+         * @description: 散点图: Floyd-Steinberg 误差扩散, 误差按 8 位饱和累加, 首尾列与最后一行不扩散.
+         * 选择扩散核、蛇形扫描或多线程处理用 setErrorDiffusion
          * @param {Mat} &mat
-         * @param {int} nBrushSize
-         * @param {int} nCoarseness
-          @return 处理后的图像数据
+         * @param {int} nBrushSize 未使用
+         * @param {int} nCoarseness 未使用
+          @return 处理后的图像数据(0 / 255 灰度图)
          */
         Mat setDither(const Mat &mat, int nBrushSize, int nCoarseness);
 
         /**
-         * @description:
+         * @description: 误差扩散抖动, 光栅扫描时按对角波前多线程处理
          * @param {Mat} &mat
-         * @param {int} nRatio
-         * @param {int} nBright
-         * @param {int} nType
-         * @param {int} nAdjust
-         * @param {int} nE
-          @return 处理后的图像数据
+         * @param {DitherKernel} eKernel 扩散核
+         * @param {bool} bSerpentine 蛇形扫描 (串行)
+         * @param {int} nThreshold 阈值
+          @return 处理后的图像数据(0 / 255 灰度图)
+         */
+        Mat setErrorDiffusion(const Mat &mat, DitherKernel eKernel, bool bSerpentine = false, int nThreshold = 128);
+
+        /**
+         * @description: 有序抖动挂网 (见 HalftoneScreen)
+         * @param {Mat} &mat
+         * @param {double} dScale 放大倍数 1 ~ 8
+         * @param {int} nBright 未使用
+         * @param {int} nType 阈值矩阵 0 ~ 6
+         * @param {int} nAdjust 亮度微调
+         * @param {int} nE 网角(度)
+          @return 处理后的图像数据. 尺寸与原实现相同: nE 为 90 度的倍数时为原图放大 dScale 倍,
+                  否则为原图旋转 nE、放大、再转回后的外接画布, 图像位于其中, 四周为黑色
          */
         Mat setDither(const Mat &mat, double dScale, int nBright, int nType, int nAdjust, int nE);
 
@@ -329,12 +352,13 @@ namespace ImgSpace
         Mat setColorTemperature(const Mat &mat, int nPercent);
 
         /**
-         * @description:
-         * @param {Mat} processMat
-         * @param {int} nR
-         * @param {int} nG
-         * @param {int} nB
-          @return 处理后的图像数据
+         * @description: 颜色替换: 各通道都低于 150 的深色像素换成 (nR, nG, nB), 其余像素不变
+         * 灰度 / BGRA 图先转成 BGR. 早期版本返回膨胀后的单通道深色区域掩膜, 现在返回换色后的图像
+         * @param {Mat} &mat
+         * @param {int} nR 替换颜色的红色分量, 超出 0 ~ 255 时截断
+         * @param {int} nG 替换颜色的绿色分量
+         * @param {int} nB 替换颜色的蓝色分量
+          @return CV_8UC3 的 BGR 图像
          */
         Mat setColorReplace(const Mat &mat, int nR, int nG, int nB);
 
@@ -0,0 +1,80 @@
+/*
+ * @Description: 积分图与基于积分图的均值类滤镜 (盒式模糊, 马赛克)
+ */
+#ifndef IMG_INTEGRAL_IMAGE_H
+#define IMG_INTEGRAL_IMAGE_H
+
+#include <opencv2/opencv.hpp>
+
+#include <cstdint>
+#include <vector>
+
+namespace ImgSpace
+{
+    /**
+     * @description: 积分图 (summed-area table)
+     * 对图像中的一块区域 (可以超出图像, 超出部分按 BORDER_REFLECT_101 取像素, 与 OpenCV 滤波的默认补边相同)
+     * 建立各通道的前缀和, 之后任意矩形的和只需 4 次查表. 前缀和按 uint32 存放并允许回绕:
+     * 区域和按模 2^32 计算, 只要矩形的像素数不超过 2^32 / 255 (约 1680 万) 结果就是精确的, 与建表区域的大小无关.
+     * mat 是 ROI 时补边只发生在 ROI 所在整图的边缘之外, 与 OpenCV 滤波读取 ROI 外真实像素的行为一致.
+     */
+    class IntegralImage
+    {
+    public:
+        IntegralImage() = default;
+
+        /**
+         * @description: 建表
+         * @param {Mat} &mat CV_8U, 1 ~ 4 通道
+         * @param {Rect} rect 建表区域, mat 坐标
+         */
+        void compute(const cv::Mat &mat, cv::Rect rect);
+
+        /**
+         * @description: 矩形内 nChannel 通道的和, rect 须在建表区域内 (mat 坐标)
+         */
+        uint32_t sum(const cv::Rect &rect, int nChannel = 0) const
+        {
+            const int x0 = rect.x - m_rect.x, x1 = x0 + rect.width;
+            const uint32_t *pTop = m_vSum.data() + static_cast<size_t>(rect.y - m_rect.y) * m_nStride;
+            const uint32_t *pBottom = pTop + static_cast<size_t>(rect.height) * m_nStride;
+            return pBottom[x1 * m_nChannels + nChannel] - pBottom[x0 * m_nChannels + nChannel] -
+                   pTop[x1 * m_nChannels + nChannel] + pTop[x0 * m_nChannels + nChannel];
+        }
+
+        /**
+         * @description: 前缀和的第 y 行 (mat 坐标, y 取 rect.y ~ rect.y + rect.height), 第 x 列在 (x - rect.x) * 通道数 处
+         */
+        const uint32_t *row(int y) const { return m_vSum.data() + static_cast<size_t>(y - m_rect.y) * m_nStride; }
+
+        const cv::Rect &rect() const { return m_rect; }
+        int channels() const { return m_nChannels; }
+
+    private:
+        cv::Rect m_rect;
+        int m_nChannels = 1;
+        size_t m_nStride = 0;           // 每行 (rect.width + 1) * 通道数
+        std::vector<uint32_t> m_vSum;   // (rect.height + 1) 行, 首行首列为 0
+    };
+
+    /**
+     * @description: 盒式均值模糊, 与 cv::blur (锚点居中, BORDER_REFLECT_101) 相同的窗口与补边
+     * 按行条带并行, 每个条带建一张 (条带 + 核高) 行的积分图, 每像素 4 次查表, 耗时与核大小无关.
+     * @param {Mat} &mat CV_8U, 1 ~ 4 通道
+     * @param {Mat} &matDst 输出, 尺寸 rangeRows.size() x mat.cols; 不能与 mat 共用数据
+     * @param {Size} ksize 核大小
+     * @param {Range} rangeRows 只计算这些行, 上下邻域读取 mat 中的真实像素 (分块处理用)
+     */
+    void boxBlur(const cv::Mat &mat, cv::Mat &matDst, cv::Size ksize, cv::Range rangeRows = cv::Range::all());
+
+    /**
+     * @description: 马赛克, 不修改输入
+     * @param {Mat} &matBgr CV_8UC3
+     * @param {int} nBlock 块边长
+     * @param {bool} bAverage true 取块内均值 (积分图), false 取块左上角像素
+     * @return 处理后的图像数据
+     */
+    cv::Mat mosaicBlocks(const cv::Mat &matBgr, int nBlock, bool bAverage);
+}
+
+#endif // IMG_INTEGRAL_IMAGE_H
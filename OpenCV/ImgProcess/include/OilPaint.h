@@ -0,0 +1,26 @@
+/*
+ * @Description: 滑动直方图油画滤镜
+ */
+#ifndef IMG_OIL_PAINT_H
+#define IMG_OIL_PAINT_H
+
+#include <opencv2/opencv.hpp>
+
+namespace ImgSpace
+{
+    /**
+     * @description: 油画滤镜的滑动直方图实现, 结果与 imgProcess::setImgOilPaintRef 逐字节一致
+     * 每行先统计第一个窗口, 之后向右移动时只加入新进入的一列、减去移出的一列 (Huang 中值滤波的做法),
+     * 每像素的直方图更新量为 2 * (2 * nBrushSize + 1) 而不是整个窗口; 出现次数最多的灰度等级只在
+     * 原最大等级被减少时才重新扫描. 行按条带由 cv::parallel_for_ 并行处理.
+     * 窗口边界沿用原实现: 上下左右的结束位置为 min(中心 + nBrushSize + 1, 边长 - 1) (不含)
+     * @param {Mat} &mat        源图像, CV_8UC3, 宽高均不小于 2
+     * @param {Mat} &matGray    mat 的灰度图, CV_8UC1
+     * @param {int} nBrushSize  笔刷半径, 调用方负责限制范围
+     * @param {int} nCoarseness 粗糙度 (灰度等级数 - 1), 1 ~ 255
+     * @return 处理后的图像数据
+     */
+    cv::Mat oilPaintSliding(const cv::Mat &mat, const cv::Mat &matGray, int nBrushSize, int nCoarseness);
+}
+
+#endif // IMG_OIL_PAINT_H
@@ -0,0 +1,197 @@
+/*
+ * @Description: 分块存储的大图 (内存映射) 与分块流式处理
+ */
+#ifndef IMG_TILED_IMAGE_H
+#define IMG_TILED_IMAGE_H
+
+#include <opencv2/opencv.hpp>
+
+#include "ErrorDiffusion.h"
+#include "Halftone.h"
+#include "ImgPipeline.h"
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace ImgSpace
+{
+    /**
+     * @description: 分块存储的大图, 用于装不进内存的雕刻位图 (数亿到数十亿像素)
+     * 文件格式: 64KB 文件头 (魔数, 宽, 高, 类型, 块边长) 之后按块行优先依次存放各块,
+     * 每块 nTile x nTile 像素、块内逐行存放 (边缘块同样占整块), 每块的槽位按 64KB 对齐,
+     * 因此每块可以单独映射 (POSIX mmap / Windows MapViewOfFile 的偏移对齐要求).
+     * 块数据只通过 TileCache 访问, 由缓存控制同时映射的总量.
+     */
+    class TiledImage
+    {
+    public:
+        static const int DEFAULT_TILE = 256;
+
+        /**
+         * @description: 映射的一块, 最后一个引用释放时解除映射
+         */
+        struct TileView
+        {
+            cv::Mat mat;            // nTile x nTile, 指向映射内存
+            cv::Rect rect;          // 在图中的有效区域
+            std::shared_ptr<void> pFile;
+            void *pBase = nullptr;
+            size_t nBytes = 0;
+
+            ~TileView();
+        };
+
+    public:
+        TiledImage() = default;
+        ~TiledImage();
+        TiledImage(const TiledImage &) = delete;
+        TiledImage &operator=(const TiledImage &) = delete;
+
+        /**
+         * @description: 新建文件 (已存在时覆盖), 像素初始为 0
+         * @param {string} &strPath
+         * @param {Size} size 图像尺寸
+         * @param {int} nType CV_8UC1 或 CV_8UC3
+         * @param {int} nTile 块边长
+         * @return 成功返回 true
+         */
+        bool create(const std::string &strPath, cv::Size size, int nType, int nTile = DEFAULT_TILE);
+
+        /**
+         * @description: 打开已有文件
+         * @param {bool} bWrite 是否可写
+         * @return 成功返回 true
+         */
+        bool open(const std::string &strPath, bool bWrite = false);
+
+        /**
+         * @description: 关闭文件. 缓存中的块仍然有效, 随缓存淘汰解除映射
+         */
+        void close();
+
+        bool isOpen() const { return m_pFile != nullptr; }
+        bool isWritable() const { return m_bWrite; }
+        uint64_t getId() const { return m_nId; }
+        cv::Size size() const { return m_size; }
+        int type() const { return m_nType; }
+        int getTileSize() const { return m_nTile; }
+        int getTilesX() const { return (m_size.width + m_nTile - 1) / m_nTile; }
+        int getTilesY() const { return (m_size.height + m_nTile - 1) / m_nTile; }
+
+        /**
+         * @description: 第 (nTx, nTy) 块在图中的有效区域
+         */
+        cv::Rect tileRect(int nTx, int nTy) const;
+
+        /**
+         * @description: 映射一块, 一般通过 TileCache::acquire 调用
+         */
+        std::shared_ptr<TileView> mapTile(int nTx, int nTy) const;
+
+        /**
+         * @description: 块在内存中占用的字节数
+         */
+        size_t getTileBytes() const { return m_nSlotBytes; }
+
+    private:
+        std::shared_ptr<void> m_pFile;  // 平台相关的文件句柄
+        cv::Size m_size;
+        int m_nType = CV_8UC1;
+        int m_nTile = DEFAULT_TILE;
+        size_t m_nSlotBytes = 0;
+        bool m_bWrite = false;
+        uint64_t m_nId = 0;             // 每次打开分配新的编号, 作为缓存键
+    };
+
+    /**
+     * @description: 块缓存
+     * 映射的块按最近使用排序, 总字节数超过预算时从最久未用的块开始淘汰, 正被使用 (外部持有引用) 的块跳过.
+     * 淘汰只是从缓存中移除, 外部引用全部释放后才解除映射; 同时在用的块数由调用方控制 (如分块并行的线程数),
+     * 峰值内存约为 预算 + 在用块. 可在多个线程中同时调用.
+     */
+    class TileCache
+    {
+    public:
+        explicit TileCache(size_t nBudgetBytes);
+
+        /**
+         * @description: 取一块, 不在缓存中时映射
+         */
+        std::shared_ptr<TiledImage::TileView> acquire(const TiledImage &image, int nTx, int nTy);
+
+        /**
+         * @description: 移除 image 的所有块 (关闭或覆盖文件前调用)
+         */
+        void drop(const TiledImage &image);
+
+        void clear();
+
+        size_t getBudget() const { return m_nBudget; }
+        size_t getBytes() const;
+        size_t getPeakBytes() const;
+        size_t getMisses() const;
+
+    private:
+        using Key = std::pair<uint64_t, int64_t>;
+        struct KeyHash
+        {
+            size_t operator()(const Key &key) const { return std::hash<uint64_t>()(key.first * 0x9E3779B97F4A7C15ull ^ static_cast<uint64_t>(key.second)); }
+        };
+        using Entry = std::pair<Key, std::shared_ptr<TiledImage::TileView>>;
+
+        void evict();
+
+    private:
+        mutable std::mutex m_mutex;
+        size_t m_nBudget;
+        size_t m_nBytes = 0;
+        size_t m_nPeak = 0;
+        size_t m_nMisses = 0;
+        std::list<Entry> m_listLru;     // 头部最近使用
+        std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> m_mapEntry;
+    };
+
+    /**
+     * @description: 读取图中一块区域 (跨越多块时拼接)
+     * @return 连续存储的图像数据
+     */
+    cv::Mat readTiledRect(const TiledImage &image, cv::Rect rect, TileCache &cache);
+
+    /**
+     * @description: 把 mat 写到图中 ptOrigin 处
+     */
+    void writeTiledRect(TiledImage &image, const cv::Mat &mat, cv::Point ptOrigin, TileCache &cache);
+
+    /**
+     * @description: 分块执行流水线
+     * 每个输出块读取 块 + 流水线邻域半径 的区域 (在图像边缘处截断), 执行后裁掉外圈写回. 只有真正的图像边缘
+     * 才做边界延拓, 结果与整图执行逐字节相同. 各块并行, 每块的流水线相互独立.
+     * @param {TiledImage} &src 输入
+     * @param {TiledImage} &dst 输出, 尺寸与块边长同 src, 通道数为 pipeline.getOutChannels
+     * @param {ImgPipeline} &pipeline 已记录操作的流水线 (不需要 setSource)
+     * @param {TileCache} &cache
+     */
+    void processTiled(const TiledImage &src, TiledImage &dst, const ImgPipeline &pipeline, TileCache &cache);
+
+    /**
+     * @description: 分块挂网, 各块按自己在图中的位置取网点, 块与块之间衔接
+     * @param {TiledImage} &srcGray CV_8UC1
+     * @param {TiledImage} &dst CV_8UC1, 尺寸同 srcGray (不放大)
+     * @param {double} dAngle 网角(度)
+     */
+    void halftoneTiled(const TiledImage &srcGray, TiledImage &dst, const HalftoneScreen &screen, double dAngle, TileCache &cache);
+
+    /**
+     * @description: 分块误差扩散, 按块行读入, 每行用 ErrorDiffusionRows 顺序处理, 结果与整图 errorDiffusionDither 相同.
+     * 一个块行在用, 缓存预算至少要容纳输入与输出各一个块行
+     * @param {TiledImage} &srcGray CV_8UC1
+     * @param {TiledImage} &dst CV_8UC1, 尺寸同 srcGray
+     */
+    void errorDiffusionTiled(const TiledImage &srcGray, TiledImage &dst, DitherKernel eKernel, bool bSerpentine, int nThreshold, TileCache &cache);
+}
+
+#endif // IMG_TILED_IMAGE_H
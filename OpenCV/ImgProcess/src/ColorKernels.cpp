@@ -0,0 +1,288 @@
+#include "ColorKernels.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+namespace ImgSpace
+{
+    namespace
+    {
+        const int BAND_BYTES = 64 * 1024; // 每个条带的大致字节数
+
+        /**
+         * @description: 按行条带并行, fnBand(nY0, nY1)
+         */
+        void forEachBand(const cv::Mat &mat, const std::function<void(int, int)> &fnBand)
+        {
+            const size_t nRowBytes = std::max<size_t>(1, static_cast<size_t>(mat.cols) * mat.elemSize());
+            const int nBandRows = static_cast<int>(std::max<size_t>(1, BAND_BYTES / nRowBytes));
+            const int nBands = (mat.rows + nBandRows - 1) / nBandRows;
+            cv::parallel_for_(cv::Range(0, nBands), [&](const cv::Range &range) {
+                for (int b = range.start; b < range.end; b++)
+                    fnBand(b * nBandRows, std::min(mat.rows, (b + 1) * nBandRows));
+            });
+        }
+    }
+
+    cv::Mat keepChannels(const cv::Mat &mat, bool bBlue, bool bGreen, bool bRed)
+    {
+        const int nCh = mat.channels();
+        if (mat.depth() != CV_8U || nCh < 3)
+            return mat.clone();
+
+        // 按通道展开成整行的掩码, 行内逐字节相与
+        const uchar arrKeep[4] = { uchar(bBlue ? 0xFF : 0), uchar(bGreen ? 0xFF : 0), uchar(bRed ? 0xFF : 0), 0xFF };
+        const int nLen = mat.cols * nCh;
+        std::vector<uchar> vMask(nLen);
+        for (int i = 0; i < nLen; i++)
+            vMask[i] = arrKeep[i % nCh];
+
+        cv::Mat matRes(mat.size(), mat.type());
+        const uchar *pMask = vMask.data();
+        forEachBand(mat, [&](int nY0, int nY1) {
+            for (int y = nY0; y < nY1; y++)
+            {
+                const uchar *pSrc = mat.ptr<uchar>(y);
+                uchar *pDst = matRes.ptr<uchar>(y);
+                for (int i = 0; i < nLen; i++)
+                    pDst[i] = pSrc[i] & pMask[i];
+            }
+        });
+        return matRes;
+    }
+
+    cv::Mat offsetChannels(const cv::Mat &matBgr, int nBlue, int nGreen, int nRed)
+    {
+        CV_Assert(matBgr.type() == CV_8UC3);
+
+        const int nLen = matBgr.cols * 3;
+        std::vector<int16_t> vOffset(nLen);
+        for (int i = 0; i < nLen; i += 3)
+        {
+            vOffset[i] = static_cast<int16_t>(std::min(std::max(nBlue, -255), 255));
+            vOffset[i + 1] = static_cast<int16_t>(std::min(std::max(nGreen, -255), 255));
+            vOffset[i + 2] = static_cast<int16_t>(std::min(std::max(nRed, -255), 255));
+        }
+
+        cv::Mat matRes(matBgr.size(), CV_8UC3);
+        const int16_t *pOffset = vOffset.data();
+        forEachBand(matBgr, [&](int nY0, int nY1) {
+            for (int y = nY0; y < nY1; y++)
+            {
+                const uchar *pSrc = matBgr.ptr<uchar>(y);
+                uchar *pDst = matRes.ptr<uchar>(y);
+                for (int i = 0; i < nLen; i++)
+                {
+                    const int16_t nValue = static_cast<int16_t>(pSrc[i] + pOffset[i]);
+                    pDst[i] = static_cast<uchar>(nValue < 0 ? 0 : (nValue > 255 ? 255 : nValue));
+                }
+            }
+        });
+        return matRes;
+    }
+
+    cv::Mat makeHsvShiftLut(double dH, double dS, double dV)
+    {
+        cv::Mat matLut(1, 256, CV_8UC3);
+        uchar *p = matLut.ptr<uchar>(0);
+        for (int v = 0; v < 256; v++)
+        {
+            // 色相, 与原实现相同先转成 short 再回绕
+            signed short h = v;
+            signed short h_plus_shift = h;
+            h_plus_shift += dH;
+
+            if (h_plus_shift < 0)
+                h = 180 + h_plus_shift;
+            else if (h_plus_shift > 180)
+                h = h_plus_shift - 180;
+            else
+                h = h_plus_shift;
+            p[v * 3] = static_cast<unsigned char>(h);
+
+            // 通道 1 加 dV, 通道 2 加 dS
+            for (int c = 1; c < 3; c++)
+            {
+                double dShift = v + (c == 1 ? dV : dS);
+                if (dShift < 0)
+                    dShift = 0;
+                else if (dShift > 255)
+                    dShift = 255;
+                p[v * 3 + c] = static_cast<unsigned char>(dShift);
+            }
+        }
+        return matLut;
+    }
+
+    cv::Mat shiftHsv(const cv::Mat &mat, double dH, double dS, double dV)
+    {
+        CV_Assert(mat.type() == CV_8UC3 || mat.type() == CV_8UC4);
+
+        const cv::Mat matLut = makeHsvShiftLut(dH, dS, dV);
+        cv::Mat matRes(mat.size(), CV_8UC3);
+        forEachBand(mat, [&](int nY0, int nY1) {
+            cv::Mat matHsv;
+            cv::cvtColor(mat.rowRange(nY0, nY1), matHsv, cv::COLOR_BGR2HSV);
+            cv::LUT(matHsv, matLut, matHsv);
+            cv::Mat matDst = matRes.rowRange(nY0, nY1);
+            cv::cvtColor(matHsv, matDst, cv::COLOR_HSV2BGR);
+        });
+        return matRes;
+    }
+
+    cv::Mat autoWhiteBalance(const cv::Mat &matBgr)
+    {
+        CV_Assert(matBgr.type() == CV_8UC3);
+
+        // 按三通道和分组的像素数与各通道之和
+        struct Histogram
+        {
+            int64_t arrCount[766] = {};
+            int64_t arrSum[766][3] = {};
+            int nMax = 0;
+        };
+
+        Histogram hist;
+        std::mutex mutex;
+        forEachBand(matBgr, [&](int nY0, int nY1) {
+            Histogram local;
+            for (int y = nY0; y < nY1; y++)
+            {
+                const uchar *p = matBgr.ptr<uchar>(y);
+                for (int x = 0; x < matBgr.cols; x++, p += 3)
+                {
+                    const int nSum = p[0] + p[1] + p[2];
+                    local.arrCount[nSum]++;
+                    local.arrSum[nSum][0] += p[0];
+                    local.arrSum[nSum][1] += p[1];
+                    local.arrSum[nSum][2] += p[2];
+                    local.nMax = std::max(local.nMax, static_cast<int>(std::max(p[0], std::max(p[1], p[2]))));
+                }
+            }
+
+            std::lock_guard<std::mutex> lock(mutex);
+            for (int i = 0; i < 766; i++)
+            {
+                hist.arrCount[i] += local.arrCount[i];
+                for (int c = 0; c < 3; c++)
+                    hist.arrSum[i][c] += local.arrSum[i][c];
+            }
+            hist.nMax = std::max(hist.nMax, local.nMax);
+        });
+
+        // 最亮 10% 的阈值, 与原实现相同: 从高往低累加到超过 10% 的那一组, 取严格大于它的像素
+        const double dTotal = static_cast<double>(matBgr.total());
+        int64_t nAcc = 0;
+        int nThreshold = 0;
+        for (int i = 765; i >= 0; i--)
+        {
+            nAcc += hist.arrCount[i];
+            if (nAcc > dTotal * 0.1)
+            {
+                nThreshold = i;
+                break;
+            }
+        }
+
+        int64_t nCount = 0;
+        int64_t arrSum[3] = { 0, 0, 0 };
+        for (int i = nThreshold + 1; i < 766; i++)
+        {
+            nCount += hist.arrCount[i];
+            for (int c = 0; c < 3; c++)
+                arrSum[c] += hist.arrSum[i][c];
+        }
+
+        // 所有像素一样亮时没有阈值以上的像素, 原样返回
+        if (nCount == 0)
+            return matBgr.clone();
+
+        cv::Mat matLut(1, 256, CV_8UC3);
+        uchar *pLut = matLut.ptr<uchar>(0);
+        for (int c = 0; c < 3; c++)
+        {
+            const int nAvg = std::max(1, static_cast<int>(arrSum[c] / nCount));
+            for (int v = 0; v < 256; v++)
+                pLut[v * 3 + c] = static_cast<uchar>(std::min(255, v * hist.nMax / nAvg));
+        }
+
+        cv::Mat matRes;
+        cv::LUT(matBgr, matLut, matRes);
+        return matRes;
+    }
+
+    cv::Mat reliefGray(const cv::Mat &matBgr, int nOffset)
+    {
+        CV_Assert(matBgr.type() == CV_8UC3);
+
+        const int nW = matBgr.cols;
+        const int nH = matBgr.rows;
+        const int nLen = nW * 3;
+        cv::Mat matRes(matBgr.size(), CV_8UC1);
+
+        // 每个条带先算出 BGR 浮雕, 趁还在缓存中转灰度
+        forEachBand(matBgr, [&](int nY0, int nY1) {
+            cv::Mat matBand(nY1 - nY0, nW, CV_8UC3);
+            for (int y = nY0; y < nY1; y++)
+            {
+                uchar *q = matBand.ptr<uchar>(y - nY0);
+                memset(q, 0, nLen);
+                if (y == 0 || y == nH - 1 || nW < 3)
+                    continue;
+
+                // 下一行 x + 1 列减本行 x - 1 列, 展开后是相距 ±3 个字节的逐字节运算
+                const uchar *p0 = matBgr.ptr<uchar>(y);
+                const uchar *p1 = matBgr.ptr<uchar>(y + 1);
+                for (int i = 3; i < nLen - 3; i++)
+                {
+                    const int nValue = p1[i + 3] - p0[i - 3] + nOffset;
+                    q[i] = static_cast<uchar>(nValue < 0 ? 0 : (nValue > 255 ? 255 : nValue));
+                }
+            }
+
+            cv::Mat matDst = matRes.rowRange(nY0, nY1);
+            cv::cvtColor(matBand, matDst, cv::COLOR_BGR2GRAY);
+        });
+        return matRes;
+    }
+
+    cv::Mat replaceColor(const cv::Mat &matBgr, cv::Vec3b colorFrom, int nTolerance, cv::Vec3b colorTo)
+    {
+        CV_Assert(matBgr.type() == CV_8UC3);
+
+        const int nW = matBgr.cols;
+        const int nLen = nW * 3;
+        std::vector<uchar> vFrom(nLen);
+        for (int i = 0; i < nLen; i++)
+            vFrom[i] = colorFrom[i % 3];
+
+        cv::Mat matRes(matBgr.size(), CV_8UC3);
+        forEachBand(matBgr, [&](int nY0, int nY1) {
+            std::vector<uchar> vNear(nLen);
+            for (int y = nY0; y < nY1; y++)
+            {
+                const uchar *pSrc = matBgr.ptr<uchar>(y);
+                uchar *pDst = matRes.ptr<uchar>(y);
+
+                // 先逐字节比较 (可向量化), 再按像素合并三个通道的结果
+                for (int i = 0; i < nLen; i++)
+                {
+                    const int nDiff = pSrc[i] - vFrom[i];
+                    vNear[i] = (nDiff <= nTolerance && -nDiff <= nTolerance) ? 1 : 0;
+                }
+                for (int x = 0, i = 0; x < nW; x++, i += 3)
+                {
+                    const bool bReplace = vNear[i] & vNear[i + 1] & vNear[i + 2];
+                    pDst[i] = bReplace ? colorTo[0] : pSrc[i];
+                    pDst[i + 1] = bReplace ? colorTo[1] : pSrc[i + 1];
+                    pDst[i + 2] = bReplace ? colorTo[2] : pSrc[i + 2];
+                }
+            }
+        });
+        return matRes;
+    }
+}
@@ -0,0 +1,208 @@
+#include "ErrorDiffusion.h"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace ImgSpace
+{
+    namespace
+    {
+        /**
+         * @description: 扩散核中的一项: 相对当前像素的偏移与权重 (dx 为扫描方向上的偏移)
+         */
+        struct DiffusionTap
+        {
+            int nDx;
+            int nDy;
+            float fWeight;
+        };
+
+        struct DiffusionKernel
+        {
+            std::vector<DiffusionTap> vTaps;
+            int nReach;     // 左右最大偏移
+            int nRows;      // 向下扩散的最大行数
+        };
+
+        DiffusionKernel makeKernel(DitherKernel eKernel)
+        {
+            struct RawTap
+            {
+                int nDx, nDy, nWeight;
+            };
+            std::vector<RawTap> vRaw;
+            float fDivisor = 1.0f;
+
+            switch (eKernel)
+            {
+            case DitherKernel::Jarvis:
+                vRaw = { { 1, 0, 7 }, { 2, 0, 5 },
+                         { -2, 1, 3 }, { -1, 1, 5 }, { 0, 1, 7 }, { 1, 1, 5 }, { 2, 1, 3 },
+                         { -2, 2, 1 }, { -1, 2, 3 }, { 0, 2, 5 }, { 1, 2, 3 }, { 2, 2, 1 } };
+                fDivisor = 48.0f;
+                break;
+            case DitherKernel::Stucki:
+                vRaw = { { 1, 0, 8 }, { 2, 0, 4 },
+                         { -2, 1, 2 }, { -1, 1, 4 }, { 0, 1, 8 }, { 1, 1, 4 }, { 2, 1, 2 },
+                         { -2, 2, 1 }, { -1, 2, 2 }, { 0, 2, 4 }, { 1, 2, 2 }, { 2, 2, 1 } };
+                fDivisor = 42.0f;
+                break;
+            case DitherKernel::Atkinson:
+                vRaw = { { 1, 0, 1 }, { 2, 0, 1 },
+                         { -1, 1, 1 }, { 0, 1, 1 }, { 1, 1, 1 },
+                         { 0, 2, 1 } };
+                fDivisor = 8.0f;
+                break;
+            case DitherKernel::Sierra:
+                vRaw = { { 1, 0, 5 }, { 2, 0, 3 },
+                         { -2, 1, 2 }, { -1, 1, 4 }, { 0, 1, 5 }, { 1, 1, 4 }, { 2, 1, 2 },
+                         { -1, 2, 2 }, { 0, 2, 3 }, { 1, 2, 2 } };
+                fDivisor = 32.0f;
+                break;
+            case DitherKernel::FloydSteinberg:
+            default:
+                vRaw = { { 1, 0, 7 },
+                         { -1, 1, 3 }, { 0, 1, 5 }, { 1, 1, 1 } };
+                fDivisor = 16.0f;
+                break;
+            }
+
+            DiffusionKernel kernel{ {}, 0, 0 };
+            for (const RawTap &raw : vRaw)
+            {
+                kernel.vTaps.push_back({ raw.nDx, raw.nDy, raw.nWeight / fDivisor });
+                kernel.nReach = std::max(kernel.nReach, std::abs(raw.nDx));
+                kernel.nRows = std::max(kernel.nRows, raw.nDy);
+            }
+            return kernel;
+        }
+    }
+
+    cv::Mat errorDiffusionDither(const cv::Mat &matGray, DitherKernel eKernel, bool bSerpentine, int nThreshold)
+    {
+        CV_Assert(matGray.type() == CV_8UC1);
+
+        const int nW = matGray.cols;
+        const int nH = matGray.rows;
+        cv::Mat matRes(matGray.size(), CV_8UC1);
+        if (nW == 0 || nH == 0)
+            return matRes;
+
+        const DiffusionKernel kernel = makeKernel(eKernel);
+        const int nReach = kernel.nReach;
+        const float fThreshold = static_cast<float>(nThreshold);
+
+        // 光栅扫描可并行; 蛇形扫描相邻行互相阻塞, 只用一个线程
+        const int nThreads = bSerpentine ? 1 : std::max(1, std::min(cv::getNumThreads(), nH));
+
+        // 误差行: 左右各留 nReach 个像素的边, 扩散到图外的误差直接落在边上丢弃.
+        // 同时在处理的行不超过线程数, 每行还会向下写 nRows 行, 环形缓冲 nThreads + nRows + 1 行足够
+        const int nStride = nW + 2 * nReach;
+        const int nRing = nThreads + kernel.nRows + 1;
+        std::vector<float> vErr(static_cast<size_t>(nRing) * nStride, 0.0f);
+        auto errRow = [&](int nY) { return vErr.data() + static_cast<size_t>(nY % nRing) * nStride + nReach; };
+
+        // 每行已完成的像素数 (光栅顺序), 后一行据此等待
+        std::unique_ptr<std::atomic<int>[]> pProgress(new std::atomic<int>[nH]);
+        for (int i = 0; i < nH; i++)
+            pProgress[i].store(0, std::memory_order_relaxed);
+        std::atomic<int> nNextRow{ 0 };
+
+        const int CHUNK = 64;       // 每处理这么多像素发布一次进度
+        const int nLag = 2 * nReach; // 上一行需领先的像素数: 误差已写完, 且两行向下写的位置不重叠
+
+        auto waitFor = [&](int nY, int nCount) {
+            if (nY < 0)
+                return;
+            nCount = std::min(nCount, nW);
+            while (pProgress[nY].load(std::memory_order_acquire) < nCount)
+                std::this_thread::yield();
+        };
+
+        auto ditherRow = [&](int nY) {
+            // 复用的环形槽位原属 nY + nRows - nRing 行, 等它整行完成后清零给 nY + nRows 行使用;
+            // 更早的行最多只写到 nY + nRows - 1 行, 此时不会有其他线程写这个槽位
+            const int nReuse = nY + kernel.nRows - nRing;
+            if (nReuse >= 0)
+                waitFor(nReuse, nW);
+            if (nReuse >= 0 && nY + kernel.nRows < nH)
+                std::fill_n(errRow(nY + kernel.nRows) - nReach, nStride, 0.0f);
+
+            float *arrErr[3] = { errRow(nY), errRow(nY + 1), errRow(nY + 2) };
+            const uchar *pSrc = matGray.ptr<uchar>(nY);
+            uchar *pDst = matRes.ptr<uchar>(nY);
+
+            const bool bReverse = bSerpentine && (nY & 1);
+            const int nDir = bReverse ? -1 : 1;
+
+            for (int nDone = 0; nDone < nW;)
+            {
+                const int nChunkEnd = std::min(nW, nDone + CHUNK);
+                waitFor(nY - 1, bSerpentine ? nW : nChunkEnd + nLag);
+
+                for (int i = nDone; i < nChunkEnd; i++)
+                {
+                    const int nX = bReverse ? nW - 1 - i : i;
+                    const float fValue = pSrc[nX] + arrErr[0][nX];
+                    const uchar nOut = fValue >= fThreshold ? 255 : 0;
+                    pDst[nX] = nOut;
+
+                    const float fError = fValue - nOut;
+                    for (const DiffusionTap &tap : kernel.vTaps)
+                        arrErr[tap.nDy][nX + tap.nDx * nDir] += fError * tap.fWeight;
+                }
+
+                nDone = nChunkEnd;
+                pProgress[nY].store(nDone, std::memory_order_release);
+            }
+        };
+
+        cv::parallel_for_(cv::Range(0, nThreads), [&](const cv::Range &range) {
+            for (int nY = nNextRow++; nY < nH; nY = nNextRow++)
+                ditherRow(nY);
+        }, nThreads);
+
+        return matRes;
+    }
+
+    ErrorDiffusionRows::ErrorDiffusionRows(int nWidth, DitherKernel eKernel, bool bSerpentine, int nThreshold)
+        : m_nWidth(nWidth), m_bSerpentine(bSerpentine), m_fThreshold(static_cast<float>(nThreshold))
+    {
+        const DiffusionKernel kernel = makeKernel(eKernel);
+        for (const DiffusionTap &tap : kernel.vTaps)
+            m_vTaps.push_back({ tap.nDx, tap.nDy, tap.fWeight });
+        m_nReach = kernel.nReach;
+        m_nRing = kernel.nRows + 1;
+        m_vErr.assign(static_cast<size_t>(m_nRing) * (m_nWidth + 2 * m_nReach), 0.0f);
+    }
+
+    void ErrorDiffusionRows::ditherRow(const uchar *pSrc, uchar *pDst)
+    {
+        // 与 errorDiffusionDither 单线程时的运算顺序相同
+        const int nStride = m_nWidth + 2 * m_nReach;
+        float *arrErr[3];
+        for (int i = 0; i < 3; i++)
+            arrErr[i] = m_vErr.data() + static_cast<size_t>((m_nRow + i) % m_nRing) * nStride + m_nReach;
+
+        const bool bReverse = m_bSerpentine && (m_nRow & 1);
+        const int nDir = bReverse ? -1 : 1;
+        for (int i = 0; i < m_nWidth; i++)
+        {
+            const int nX = bReverse ? m_nWidth - 1 - i : i;
+            const float fValue = pSrc[nX] + arrErr[0][nX];
+            const uchar nOut = fValue >= m_fThreshold ? 255 : 0;
+            pDst[nX] = nOut;
+
+            const float fError = fValue - nOut;
+            for (const Tap &tap : m_vTaps)
+                arrErr[tap.nDy][nX + tap.nDx * nDir] += fError * tap.fWeight;
+        }
+
+        // 本行的槽位清零, 留给 m_nRow + m_nRing 行
+        std::fill_n(arrErr[0] - m_nReach, nStride, 0.0f);
+        m_nRow++;
+    }
+}
@@ -0,0 +1,320 @@
+#include "GeometryTransform.h"
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+namespace ImgSpace
+{
+    namespace
+    {
+        const int TILE = 64; // 转置时的块边长 (像素)
+
+        template <size_t N>
+        struct PixelBytes
+        {
+            uchar arr[N];
+        };
+
+        /**
+         * @description: 整像素搬移的逆映射 (目标 -> 源), 源 x = a * x + b * y + tx, 源 y = c * x + d * y + ty
+         */
+        struct ExactMap
+        {
+            int a, b, tx, c, d, ty;
+            cv::Rect rectValid; // 源坐标落在图内的目标区域
+        };
+
+        bool nearInt(double dValue, double dEps, int &nValue)
+        {
+            const double dRound = std::floor(dValue + 0.5);
+            if (std::fabs(dValue - dRound) > dEps || std::fabs(dRound) > INT_MAX / 2)
+                return false;
+            nValue = static_cast<int>(dRound);
+            return true;
+        }
+
+        // 0 <= s * t + o < nLen 且 0 <= t < nLimit 的 t 范围 (s 为 ±1)
+        cv::Range validRange(int s, int o, int nLen, int nLimit)
+        {
+            int nStart = s > 0 ? -o : o - nLen + 1;
+            int nEnd = s > 0 ? nLen - o : o + 1;
+            nStart = std::max(nStart, 0);
+            nEnd = std::min(nEnd, nLimit);
+            return nStart < nEnd ? cv::Range(nStart, nEnd) : cv::Range(0, 0);
+        }
+
+        bool getExactMap(const cv::Matx23d &matM, cv::Size sizeSrc, cv::Size sizeDst, ExactMap &map)
+        {
+            // 系数的误差乘上坐标后仍远小于 warpAffine 定点化的精度 (1/1024), 结果逐位相同
+            const double dEpsCoef = 1e-9;
+            const double dEpsShift = 1e-6;
+            int a, b, c, d, tx, ty;
+            if (!nearInt(matM(0, 0), dEpsCoef, a) || !nearInt(matM(0, 1), dEpsCoef, b) || !nearInt(matM(1, 0), dEpsCoef, c) ||
+                !nearInt(matM(1, 1), dEpsCoef, d) || !nearInt(matM(0, 2), dEpsShift, tx) || !nearInt(matM(1, 2), dEpsShift, ty))
+                return false;
+
+            const bool bStraight = b == 0 && c == 0 && std::abs(a) == 1 && std::abs(d) == 1;
+            const bool bTransposed = a == 0 && d == 0 && std::abs(b) == 1 && std::abs(c) == 1;
+            if (!bStraight && !bTransposed)
+                return false;
+
+            // 带符号置换矩阵的逆是其转置
+            map.a = a;
+            map.b = c;
+            map.tx = -(a * tx + c * ty);
+            map.c = b;
+            map.d = d;
+            map.ty = -(b * tx + d * ty);
+
+            cv::Range rangeX, rangeY;
+            if (bStraight)
+            {
+                rangeX = validRange(map.a, map.tx, sizeSrc.width, sizeDst.width);
+                rangeY = validRange(map.d, map.ty, sizeSrc.height, sizeDst.height);
+            }
+            else
+            {
+                rangeY = validRange(map.b, map.tx, sizeSrc.width, sizeDst.height);
+                rangeX = validRange(map.c, map.ty, sizeSrc.height, sizeDst.width);
+            }
+            map.rectValid = cv::Rect(rangeX.start, rangeY.start, rangeX.size(), rangeY.size());
+            if (map.rectValid.empty())
+                map.rectValid = cv::Rect();
+            return true;
+        }
+
+        template <typename T>
+        void moveExact(const cv::Mat &mat, cv::Mat &matDst, const ExactMap &map)
+        {
+            const cv::Rect &rect = map.rectValid;
+            const int nBands = (rect.height + TILE - 1) / TILE;
+
+            cv::parallel_for_(cv::Range(0, nBands), [&](const cv::Range &range) {
+                for (int nBand = range.start; nBand < range.end; nBand++)
+                {
+                    const int nY0 = rect.y + nBand * TILE;
+                    const int nY1 = std::min(rect.y + rect.height, nY0 + TILE);
+
+                    if (map.b == 0)
+                    {
+                        // 不转置: 每个目标行对应一个源行, 正向时整段复制, 反向时倒序复制
+                        for (int y = nY0; y < nY1; y++)
+                        {
+                            const T *pSrc = mat.ptr<T>(map.d * y + map.ty);
+                            T *pDst = matDst.ptr<T>(y);
+                            if (map.a > 0)
+                            {
+                                memcpy(pDst + rect.x, pSrc + rect.x + map.tx, rect.width * sizeof(T));
+                            }
+                            else
+                            {
+                                const T *p = pSrc + (map.tx - rect.x);
+                                for (int x = rect.x; x < rect.x + rect.width; x++)
+                                    pDst[x] = *p--;
+                            }
+                        }
+                        continue;
+                    }
+
+                    // 转置: 目标的一行对应源的一列, 按 TILE x TILE 的块搬移, 块内读写都留在缓存中
+                    const ptrdiff_t nSrcStep = static_cast<ptrdiff_t>(mat.step) * map.c;
+                    for (int nX0 = rect.x; nX0 < rect.x + rect.width; nX0 += TILE)
+                    {
+                        const int nX1 = std::min(rect.x + rect.width, nX0 + TILE);
+                        const uchar *pCol = mat.data + static_cast<ptrdiff_t>(map.c * nX0 + map.ty) * static_cast<ptrdiff_t>(mat.step);
+                        for (int y = nY0; y < nY1; y++)
+                        {
+                            const uchar *p = pCol + static_cast<ptrdiff_t>(map.b * y + map.tx) * static_cast<ptrdiff_t>(sizeof(T));
+                            T *pDst = matDst.ptr<T>(y);
+                            for (int x = nX0; x < nX1; x++, p += nSrcStep)
+                                pDst[x] = *reinterpret_cast<const T *>(p);
+                        }
+                    }
+                }
+            });
+        }
+
+        // 镜像 / 180 度旋转原地执行: 上下对称的两行互换, 需要时再各自倒序
+        template <typename T>
+        void flipInPlace(cv::Mat &mat, const ExactMap &map)
+        {
+            const int nW = mat.cols;
+            const int nH = mat.rows;
+            const int nPairs = map.d > 0 ? nH : (nH + 1) / 2;
+
+            cv::parallel_for_(cv::Range(0, nPairs), [&](const cv::Range &range) {
+                for (int y = range.start; y < range.end; y++)
+                {
+                    T *pA = mat.ptr<T>(y);
+                    T *pB = mat.ptr<T>(map.d * y + map.ty);
+                    if (pA != pB)
+                        std::swap_ranges(pA, pA + nW, pB);
+                    if (map.a < 0)
+                    {
+                        std::reverse(pA, pA + nW);
+                        if (pA != pB)
+                            std::reverse(pB, pB + nW);
+                    }
+                }
+            });
+        }
+
+        template <typename T>
+        void dispatchExact(const cv::Mat &mat, cv::Mat &matDst, const ExactMap &map, bool bInPlace)
+        {
+            if (bInPlace)
+                flipInPlace<T>(matDst, map);
+            else
+                moveExact<T>(mat, matDst, map);
+        }
+
+        // 按像素字节数选择搬移的类型, 不支持时返回 false
+        bool runExact(const cv::Mat &mat, cv::Mat &matDst, const ExactMap &map, bool bInPlace)
+        {
+            switch (mat.elemSize())
+            {
+            case 1: dispatchExact<uint8_t>(mat, matDst, map, bInPlace); return true;
+            case 2: dispatchExact<uint16_t>(mat, matDst, map, bInPlace); return true;
+            case 3: dispatchExact<PixelBytes<3>>(mat, matDst, map, bInPlace); return true;
+            case 4: dispatchExact<uint32_t>(mat, matDst, map, bInPlace); return true;
+            case 6: dispatchExact<PixelBytes<6>>(mat, matDst, map, bInPlace); return true;
+            case 8: dispatchExact<uint64_t>(mat, matDst, map, bInPlace); return true;
+            case 12: dispatchExact<PixelBytes<12>>(mat, matDst, map, bInPlace); return true;
+            case 16: dispatchExact<PixelBytes<16>>(mat, matDst, map, bInPlace); return true;
+            case 24: dispatchExact<PixelBytes<24>>(mat, matDst, map, bInPlace); return true;
+            case 32: dispatchExact<PixelBytes<32>>(mat, matDst, map, bInPlace); return true;
+            default: return false;
+            }
+        }
+
+        bool isSupportedElemSize(size_t nSize)
+        {
+            return nSize == 1 || nSize == 2 || nSize == 3 || nSize == 4 || nSize == 6 || nSize == 8 || nSize == 12 || nSize == 16 ||
+                   nSize == 24 || nSize == 32;
+        }
+
+        bool isOverlapped(const cv::Mat &matA, const cv::Mat &matB)
+        {
+            return matA.data && matB.data && matA.datastart < matB.dataend && matB.datastart < matA.dataend;
+        }
+
+        // 目标中 rectValid 以外的部分填充补边颜色
+        void fillOutside(cv::Mat &matDst, const cv::Rect &rectValid, const cv::Scalar &border)
+        {
+            if (rectValid.empty())
+            {
+                matDst.setTo(border);
+                return;
+            }
+            if (rectValid.y > 0)
+                matDst.rowRange(0, rectValid.y).setTo(border);
+            if (rectValid.y + rectValid.height < matDst.rows)
+                matDst.rowRange(rectValid.y + rectValid.height, matDst.rows).setTo(border);
+
+            cv::Mat matRows = matDst.rowRange(rectValid.y, rectValid.y + rectValid.height);
+            if (rectValid.x > 0)
+                matRows.colRange(0, rectValid.x).setTo(border);
+            if (rectValid.x + rectValid.width < matDst.cols)
+                matRows.colRange(rectValid.x + rectValid.width, matDst.cols).setTo(border);
+        }
+    }
+
+    GeoTransform &GeoTransform::then(const GeoTransform &other)
+    {
+        const cv::Matx23d &o = other.m_matM;
+        const cv::Matx23d m = m_matM;
+        m_matM = cv::Matx23d(o(0, 0) * m(0, 0) + o(0, 1) * m(1, 0), o(0, 0) * m(0, 1) + o(0, 1) * m(1, 1),
+                             o(0, 0) * m(0, 2) + o(0, 1) * m(1, 2) + o(0, 2), o(1, 0) * m(0, 0) + o(1, 1) * m(1, 0),
+                             o(1, 0) * m(0, 1) + o(1, 1) * m(1, 1), o(1, 0) * m(0, 2) + o(1, 1) * m(1, 2) + o(1, 2));
+        return *this;
+    }
+
+    GeoTransform &GeoTransform::rotate(double dAngle, cv::Point2d ptCenter, double dScale)
+    {
+        // 直接取 getRotationMatrix2D 的结果, 单独使用时与原来调用 warpAffine 的矩阵完全相同
+        const cv::Mat matR = cv::getRotationMatrix2D(cv::Point2f(ptCenter), dAngle, dScale);
+        return then(GeoTransform(cv::Matx23d(matR.ptr<double>(0)[0], matR.ptr<double>(0)[1], matR.ptr<double>(0)[2],
+                                             matR.ptr<double>(1)[0], matR.ptr<double>(1)[1], matR.ptr<double>(1)[2])));
+    }
+
+    GeoTransform &GeoTransform::scale(double dScaleX, double dScaleY)
+    {
+        return then(GeoTransform(cv::Matx23d(dScaleX, 0, 0, 0, dScaleY, 0)));
+    }
+
+    GeoTransform &GeoTransform::resize(double dScaleX, double dScaleY)
+    {
+        return then(GeoTransform(cv::Matx23d(dScaleX, 0, 0.5 * dScaleX - 0.5, 0, dScaleY, 0.5 * dScaleY - 0.5)));
+    }
+
+    GeoTransform &GeoTransform::translate(double dX, double dY)
+    {
+        return then(GeoTransform(cv::Matx23d(1, 0, dX, 0, 1, dY)));
+    }
+
+    GeoTransform &GeoTransform::flip(int nFlipCode, cv::Size size)
+    {
+        const bool bX = nFlipCode != 0; // 左右
+        const bool bY = nFlipCode <= 0; // 上下
+        return then(GeoTransform(cv::Matx23d(bX ? -1 : 1, 0, bX ? size.width - 1 : 0, 0, bY ? -1 : 1, bY ? size.height - 1 : 0)));
+    }
+
+    GeoTransform &GeoTransform::rotate90(int nTimes, cv::Size size)
+    {
+        switch (((nTimes % 4) + 4) % 4)
+        {
+        case 1: // (x, y) -> (H - 1 - y, x)
+            return then(GeoTransform(cv::Matx23d(0, -1, size.height - 1, 1, 0, 0)));
+        case 2:
+            return flip(-1, size);
+        case 3: // (x, y) -> (y, W - 1 - x)
+            return then(GeoTransform(cv::Matx23d(0, 1, 0, -1, 0, size.width - 1)));
+        default:
+            return *this;
+        }
+    }
+
+    bool GeoTransform::isExact() const
+    {
+        ExactMap map;
+        return getExactMap(m_matM, cv::Size(1, 1), cv::Size(1, 1), map);
+    }
+
+    void GeoTransform::apply(const cv::Mat &mat, cv::Mat &matDst, cv::Size size, int nInterp, int nBorder, const cv::Scalar &border) const
+    {
+        CV_Assert(!mat.empty() && size.width > 0 && size.height > 0);
+
+        // matDst 与 mat 是同一个对象时 create 可能换掉 mat 的数据, 先留住输入
+        cv::Mat matSrc = mat;
+        matDst.create(size, matSrc.type());
+
+        ExactMap map;
+        const bool bExact = getExactMap(m_matM, matSrc.size(), size, map) && isSupportedElemSize(matSrc.elemSize()) &&
+                            (nBorder == cv::BORDER_CONSTANT || map.rectValid == cv::Rect(cv::Point(), size));
+
+        if (isOverlapped(matSrc, matDst))
+        {
+            const bool bFlipInPlace = bExact && map.b == 0 && matSrc.data == matDst.data && matSrc.step == matDst.step &&
+                                      matSrc.size() == size && map.rectValid == cv::Rect(cv::Point(), size);
+            if (bFlipInPlace)
+            {
+                runExact(matSrc, matDst, map, true);
+                return;
+            }
+            matSrc = matSrc.clone();
+        }
+
+        if (!bExact)
+        {
+            cv::warpAffine(matSrc, matDst, m_matM, size, nInterp, nBorder, border);
+            return;
+        }
+
+        fillOutside(matDst, map.rectValid, border);
+        if (!map.rectValid.empty())
+            runExact(matSrc, matDst, map, false);
+    }
+}
@@ -0,0 +1,331 @@
+#include "Halftone.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define IMG_HALFTONE_SSE2
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#endif
+
+namespace ImgSpace
+{
+    namespace
+    {
+        // Screw Ordered Dithering
+        const int Mask0[] = { 64, 53, 42, 26, 27, 43, 54, 61,
+                              60, 41, 25, 14, 15, 28, 44, 55,
+                              52, 40, 13, 5, 6, 16, 29, 45,
+                              39, 24, 12, 1, 2, 7, 17, 30,
+                              38, 23, 11, 4, 3, 8, 18, 31,
+                              51, 37, 22, 10, 9, 19, 32, 41,
+                              59, 50, 36, 21, 20, 33, 47, 56,
+                              63, 58, 49, 35, 34, 48, 57, 62 };
+
+        // CoarseFatting Ordered Dithering
+        const int Mask1[] = { 4, 14, 52, 58, 56, 45, 20, 6,
+                              16, 26, 38, 50, 48, 36, 28, 18,
+                              43, 35, 31, 9, 11, 25, 33, 41,
+                              61, 46, 23, 1, 3, 13, 55, 60,
+                              57, 47, 21, 7, 5, 15, 53, 59,
+                              49, 37, 29, 19, 17, 27, 39, 51,
+                              10, 24, 32, 40, 42, 34, 30, 8,
+                              2, 12, 54, 60, 51, 44, 22, 0 };
+
+        // 有序抖动算法 Bayer Ordered Dithering
+        const int Mask2[] = { 0, 32, 8, 40, 2, 34, 10, 42,
+                              48, 16, 56, 42, 50, 18, 58, 26,
+                              12, 44, 4, 36, 14, 46, 6, 38,
+                              60, 28, 52, 20, 62, 30, 54, 22,
+                              3, 35, 11, 43, 1, 33, 9, 41,
+                              51, 19, 59, 27, 49, 17, 57, 25,
+                              15, 47, 7, 39, 13, 45, 5, 37,
+                              63, 31, 55, 23, 61, 29, 53, 21 };
+
+        // Halftone Ordered Dithering
+        const int Mask3[] = { 28, 10, 18, 26, 36, 44, 52, 34,
+                              22, 2, 4, 12, 48, 58, 60, 42,
+                              14, 6, 0, 20, 40, 56, 62, 50,
+                              24, 16, 8, 30, 32, 54, 46, 38,
+                              37, 45, 53, 35, 29, 11, 19, 27,
+                              49, 59, 61, 43, 23, 3, 5, 13,
+                              41, 57, 63, 51, 15, 7, 1, 21,
+                              33, 55, 47, 39, 25, 17, 9, 31 };
+
+        // 12 * 12  大颗粒
+        const int Mask4[] = { 144, 140, 132, 122, 107, 63, 54, 93, 106, 123, 133, 142,
+                              143, 137, 128, 104, 94, 41, 31, 65, 98, 116, 120, 139,
+                              135, 131, 114, 97, 61, 35, 24, 55, 80, 103, 113, 125,
+                              126, 117, 88, 83, 56, 29, 15, 51, 68, 90, 99, 111,
+                              109, 100, 81, 77, 48, 22, 8, 28, 47, 76, 85, 96,
+                              91, 44, 16, 12, 9, 3, 5, 21, 25, 33, 37, 73,
+                              59, 58, 30, 18, 10, 1, 2, 4, 11, 19, 34, 42,
+                              92, 64, 57, 52, 26, 6, 7, 14, 32, 46, 53, 74,
+                              101, 95, 70, 67, 38, 13, 20, 36, 50, 75, 82, 108,
+                              121, 110, 86, 78, 45, 17, 27, 39, 69, 79, 102, 119,
+                              134, 129, 112, 89, 49, 23, 43, 60, 71, 87, 115, 127,
+                              141, 138, 124, 118, 66, 40, 62, 72, 84, 105, 130, 136 };
+
+        // 16 * 16
+        const int Mask5[] = { 0, 191, 48, 239, 12, 203, 60, 251, 3, 194, 51, 242, 15, 206, 63, 254,
+                              127, 64, 175, 112, 139, 76, 187, 124, 130, 67, 178, 115, 142, 79, 190, 127,
+                              32, 223, 16, 207, 44, 235, 28, 219, 35, 226, 19, 210, 47, 238, 31, 222,
+                              159, 96, 143, 80, 171, 108, 155, 92, 162, 99, 146, 83, 174, 111, 158, 95,
+                              8, 199, 56, 247, 4, 195, 52, 243, 11, 202, 59, 250, 7, 198, 55, 246,
+                              135, 72, 183, 120, 131, 68, 179, 116, 138, 75, 186, 123, 134, 71, 182, 119,
+                              40, 231, 24, 215, 36, 227, 20, 211, 43, 234, 27, 218, 39, 230, 23, 214,
+                              167, 104, 151, 88, 163, 100, 147, 84, 170, 107, 154, 91, 166, 103, 150, 87,
+                              2, 193, 50, 241, 14, 205, 62, 253, 1, 192, 49, 240, 13, 204, 61, 252,
+                              129, 66, 177, 114, 141, 78, 189, 126, 128, 65, 176, 113, 140, 77, 188, 125,
+                              34, 225, 18, 209, 46, 237, 30, 221, 33, 224, 17, 208, 45, 236, 29, 220,
+                              161, 98, 145, 82, 173, 110, 157, 94, 160, 97, 144, 81, 172, 109, 156, 93,
+                              10, 201, 58, 249, 6, 197, 54, 245, 9, 200, 57, 248, 5, 196, 53, 244,
+                              137, 74, 185, 122, 133, 70, 181, 118, 136, 73, 184, 121, 132, 69, 180, 117,
+                              42, 233, 26, 217, 38, 229, 22, 213, 41, 232, 25, 216, 37, 228, 21, 212,
+                              169, 106, 153, 90, 165, 102, 149, 86, 168, 105, 152, 89, 164, 101, 148, 85 };
+
+        // 9 * 9
+        const int Mask6[] = { 53, 53, 54, 55, 56, 57, 58, 59, 60,
+                              51, 27, 28, 29, 30, 31, 32, 33, 61,
+                              50, 26, 10, 11, 12, 13, 14, 34, 62,
+                              49, 25, 9, 1, 2, 3, 15, 35, 63,
+                              80, 48, 24, 8, 0, 4, 16, 36, 64,
+                              79, 47, 23, 7, 6, 5, 17, 37, 65,
+                              78, 46, 22, 21, 20, 19, 18, 38, 66,
+                              77, 45, 44, 43, 42, 41, 40, 39, 67,
+                              76, 75, 74, 73, 72, 71, 70, 69, 68 };
+
+        /**
+         * @description: 阈值矩阵: 边长与灰度映射的最大级数 N
+         */
+        struct MaskInfo
+        {
+            const int *pData;
+            int nSize;
+            int nLevels;
+        };
+
+        const MaskInfo arrMasks[HalftoneScreen::MASK_COUNT] = {
+            { Mask0, 8, 63 },
+            { Mask1, 8, 63 },
+            { Mask2, 8, 63 },
+            { Mask3, 8, 63 },
+            { Mask4, 12, 123 },
+            { Mask5, 16, 255 },
+            { Mask6, 8, 63 }, // 与原实现相同: 只取 9x9 表的前 64 项按 8x8 使用
+        };
+
+        /**
+         * @description: pDst[i] = (pGray[i] >= pThreshold[i]) & pEnable[i] ? 255 : 0
+         */
+        void compareRow(const uchar *pGray, const uchar *pThreshold, const uchar *pEnable, uchar *pDst, int nCount)
+        {
+            int i = 0;
+#if defined(__AVX2__)
+            for (; i + 32 <= nCount; i += 32)
+            {
+                __m256i g = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(pGray + i));
+                __m256i t = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(pThreshold + i));
+                __m256i e = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(pEnable + i));
+                __m256i ge = _mm256_cmpeq_epi8(_mm256_max_epu8(g, t), g);
+                _mm256_storeu_si256(reinterpret_cast<__m256i *>(pDst + i), _mm256_and_si256(ge, e));
+            }
+#elif defined(IMG_HALFTONE_SSE2)
+            for (; i + 16 <= nCount; i += 16)
+            {
+                __m128i g = _mm_loadu_si128(reinterpret_cast<const __m128i *>(pGray + i));
+                __m128i t = _mm_loadu_si128(reinterpret_cast<const __m128i *>(pThreshold + i));
+                __m128i e = _mm_loadu_si128(reinterpret_cast<const __m128i *>(pEnable + i));
+                __m128i ge = _mm_cmpeq_epi8(_mm_max_epu8(g, t), g);
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(pDst + i), _mm_and_si128(ge, e));
+            }
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+            for (; i + 16 <= nCount; i += 16)
+            {
+                uint8x16_t ge = vcgeq_u8(vld1q_u8(pGray + i), vld1q_u8(pThreshold + i));
+                vst1q_u8(pDst + i, vandq_u8(ge, vld1q_u8(pEnable + i)));
+            }
+#endif
+            for (; i < nCount; i++)
+                pDst[i] = (pGray[i] >= pThreshold[i]) ? pEnable[i] : 0;
+        }
+    }
+
+    HalftoneScreen::HalftoneScreen(int nMask, int nAdjust)
+    {
+        if (nMask < 0)
+            nMask = -nMask;
+        const MaskInfo &mask = arrMasks[nMask % MASK_COUNT];
+
+        m_nTileW = mask.nSize;
+        m_nTileH = mask.nSize;
+        m_vThreshold.resize(m_nTileW * m_nTileH);
+        m_vEnable.resize(m_nTileW * m_nTileH);
+
+        // 每格的最小点亮灰度, 判断式与原实现完全相同
+        for (int i = 0; i < m_nTileW * m_nTileH; i++)
+        {
+            m_vThreshold[i] = 255;
+            m_vEnable[i] = 0;
+            for (int g = 0; g < 256; g++)
+            {
+                double dPix = g / 255.0 * mask.nLevels + 0.5 + nAdjust * 0.1;
+                if (dPix > mask.pData[i])
+                {
+                    m_vThreshold[i] = static_cast<uchar>(g);
+                    m_vEnable[i] = 255;
+                    break;
+                }
+            }
+        }
+    }
+
+    void HalftoneScreen::setToneLut(const cv::Mat &matLut)
+    {
+        if (matLut.empty())
+        {
+            m_vLut.clear();
+            return;
+        }
+
+        CV_Assert(matLut.type() == CV_8UC1 && matLut.total() == 256 && matLut.isContinuous());
+        m_vLut.assign(matLut.ptr<uchar>(0), matLut.ptr<uchar>(0) + 256);
+    }
+
+    cv::Mat HalftoneScreen::apply(const cv::Mat &matGray, double dScale, double dAngle, cv::Point ptOrigin) const
+    {
+        CV_Assert(matGray.type() == CV_8UC1 && ptOrigin.x >= 0 && ptOrigin.y >= 0);
+
+        dScale = std::min(std::max(dScale, 1.0), 8.0);
+
+        const int nSrcW = matGray.cols;
+        const int nSrcH = matGray.rows;
+        const int nW = static_cast<int>(nSrcW * dScale);
+        const int nH = static_cast<int>(nSrcH * dScale);
+        cv::Mat matRes(nH, nW, CV_8UC1);
+        if (nW == 0 || nH == 0)
+            return matRes;
+
+        // 最近邻放大的列映射
+        std::vector<int> vSrcX(nW);
+        for (int x = 0; x < nW; x++)
+            vSrcX[x] = std::min(static_cast<int>(x / dScale), nSrcW - 1);
+
+        // 不旋转时每个图块行展开成整行阈值, 各行直接取用
+        const bool bRotate = std::fmod(dAngle, 360.0) != 0.0;
+        std::vector<uchar> vRowThreshold;
+        std::vector<uchar> vRowEnable;
+        if (!bRotate)
+        {
+            vRowThreshold.resize(static_cast<size_t>(m_nTileH) * nW);
+            vRowEnable.resize(static_cast<size_t>(m_nTileH) * nW);
+            for (int k = 0; k < m_nTileH; k++)
+            {
+                for (int x = 0; x < nW; x++)
+                {
+                    vRowThreshold[static_cast<size_t>(k) * nW + x] = m_vThreshold[k * m_nTileW + (x + ptOrigin.x) % m_nTileW];
+                    vRowEnable[static_cast<size_t>(k) * nW + x] = m_vEnable[k * m_nTileW + (x + ptOrigin.x) % m_nTileW];
+                }
+            }
+        }
+
+        // 旋转图像 dAngle 度后挂网, 等价于在 (u, v) = R(dAngle) * (x, y) 处取图块 (与 getRotationMatrix2D 同向)
+        const double dRad = dAngle * CV_PI / 180.0;
+        const double dCos = std::cos(dRad);
+        const double dSin = std::sin(dRad);
+        const int64_t nStepU = std::llround(dCos * 4294967296.0);
+        const int64_t nStepV = std::llround(-dSin * 4294967296.0);
+
+        cv::parallel_for_(cv::Range(0, nH), [&](const cv::Range &range) {
+            std::vector<uchar> vGray(nW);
+            std::vector<uchar> vThreshold(bRotate ? nW : 0);
+            std::vector<uchar> vEnable(bRotate ? nW : 0);
+            int nLastSrcY = -1;
+
+            for (int y = range.start; y < range.end; y++)
+            {
+                // 同一源行放大出的多行共用取样结果
+                const int nSrcY = std::min(static_cast<int>(y / dScale), nSrcH - 1);
+                if (nSrcY != nLastSrcY)
+                {
+                    const uchar *pSrc = matGray.ptr<uchar>(nSrcY);
+                    if (m_vLut.empty())
+                    {
+                        for (int x = 0; x < nW; x++)
+                            vGray[x] = pSrc[vSrcX[x]];
+                    }
+                    else
+                    {
+                        for (int x = 0; x < nW; x++)
+                            vGray[x] = m_vLut[pSrc[vSrcX[x]]];
+                    }
+                    nLastSrcY = nSrcY;
+                }
+
+                const uchar *pThreshold = nullptr;
+                const uchar *pEnable = nullptr;
+                if (!bRotate)
+                {
+                    const size_t nRow = static_cast<size_t>((y + ptOrigin.y) % m_nTileH);
+                    pThreshold = vRowThreshold.data() + nRow * nW;
+                    pEnable = vRowEnable.data() + nRow * nW;
+                }
+                else
+                {
+                    // 32 位小数定点数沿行递推, 每步至多跨一个图块周期, 用一次加减回绕代替取模
+                    const int64_t nPeriodU = static_cast<int64_t>(m_nTileW) << 32;
+                    const int64_t nPeriodV = static_cast<int64_t>(m_nTileH) << 32;
+                    const double dY = static_cast<double>(y) + ptOrigin.y;
+                    int64_t nU = std::llround(std::fmod(dCos * ptOrigin.x + dSin * dY, m_nTileW) * 4294967296.0) % nPeriodU;
+                    int64_t nV = std::llround(std::fmod(-dSin * ptOrigin.x + dCos * dY, m_nTileH) * 4294967296.0) % nPeriodV;
+                    if (nU < 0)
+                        nU += nPeriodU;
+                    if (nV < 0)
+                        nV += nPeriodV;
+
+                    for (int x = 0; x < nW; x++)
+                    {
+                        const int nIdx = static_cast<int>(nV >> 32) * m_nTileW + static_cast<int>(nU >> 32);
+                        vThreshold[x] = m_vThreshold[nIdx];
+                        vEnable[x] = m_vEnable[nIdx];
+
+                        nU += nStepU;
+                        if (nU >= nPeriodU)
+                            nU -= nPeriodU;
+                        else if (nU < 0)
+                            nU += nPeriodU;
+                        nV += nStepV;
+                        if (nV >= nPeriodV)
+                            nV -= nPeriodV;
+                        else if (nV < 0)
+                            nV += nPeriodV;
+                    }
+                    pThreshold = vThreshold.data();
+                    pEnable = vEnable.data();
+                }
+
+                compareRow(vGray.data(), pThreshold, pEnable, matRes.ptr<uchar>(y), nW);
+            }
+        });
+
+        return matRes;
+    }
+
+    const char *HalftoneScreen::simdName()
+    {
+#if defined(__AVX2__)
+        return "AVX2";
+#elif defined(IMG_HALFTONE_SSE2)
+        return "SSE2";
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+        return "NEON";
+#else
+        return "Scalar";
+#endif
+    }
+}
@@ -0,0 +1,664 @@
+#include "ImgBatch.h"
+#include "ImgProcess.h"
+#include "ImgPipeline.h"
+#include "GeometryTransform.h"
+
+#include <algorithm>
+#include <cctype>
+#include <condition_variable>
+#include <cstdlib>
+#include <deque>
+#include <filesystem>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <unordered_map>
+
+namespace fs = std::filesystem;
+
+namespace ImgSpace
+{
+    namespace
+    {
+        struct StepSpec
+        {
+            const char *szName;
+            size_t nMaxArgs;
+            bool bPipeline;  // 可交给 ImgPipeline
+        };
+
+        const StepSpec STEP_SPECS[] = {
+            { "gray", 0, true },      { "channels", 3, true }, { "threshold", 3, true }, { "contrast", 3, true },
+            { "gamma", 1, true },     { "reversal", 0, true }, { "sharpen", 1, true },   { "blur", 2, true },
+            { "dither", 3, false },   { "diffusion", 3, false }, { "oil", 2, false },    { "mosaic", 2, false },
+            { "rotate", 2, false },   { "scale", 2, false },   { "save", 2, false },
+        };
+
+        const StepSpec *findStep(const std::string &strName)
+        {
+            for (const StepSpec &spec : STEP_SPECS)
+                if (strName == spec.szName)
+                    return &spec;
+            return nullptr;
+        }
+
+        std::string trim(const std::string &str)
+        {
+            size_t nBegin = str.find_first_not_of(" \t");
+            if (nBegin == std::string::npos)
+                return std::string();
+            size_t nEnd = str.find_last_not_of(" \t");
+            return str.substr(nBegin, nEnd - nBegin + 1);
+        }
+
+        std::vector<std::string> split(const std::string &str, char ch)
+        {
+            std::vector<std::string> vParts;
+            size_t nStart = 0;
+            while (true)
+            {
+                size_t nPos = str.find(ch, nStart);
+                vParts.push_back(trim(str.substr(nStart, nPos - nStart)));
+                if (nPos == std::string::npos)
+                    break;
+                nStart = nPos + 1;
+            }
+            return vParts;
+        }
+
+        std::string toLower(std::string str)
+        {
+            std::transform(str.begin(), str.end(), str.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+            return str;
+        }
+
+        double getArg(const BatchStep &step, size_t nIndex, double dDefault)
+        {
+            return nIndex < step.vArgs.size() ? step.vArgs[nIndex] : dDefault;
+        }
+
+        bool isImageFile(const fs::path &path)
+        {
+            static const char *arrExt[] = { ".bmp", ".jpg", ".jpeg", ".png", ".tif", ".tiff", ".webp", ".pbm", ".pgm", ".ppm" };
+            const std::string strExt = toLower(path.extension().string());
+            return std::find_if(std::begin(arrExt), std::end(arrExt), [&](const char *sz) { return strExt == sz; }) != std::end(arrExt);
+        }
+
+        // 遍历目录下的普通文件; 用 error_code 版本的 increment, 中途出错 (无权限、文件被删等) 时停止而不抛异常
+        template <typename Fn>
+        void forEachFile(const fs::path &dir, Fn fn)
+        {
+            std::error_code ec;
+            for (fs::directory_iterator it(dir, ec), end; !ec && it != end; it.increment(ec))
+            {
+                std::error_code ecEntry;
+                if (it->is_regular_file(ecEntry))
+                    fn(it->path());
+            }
+        }
+
+        // '*' 匹配任意个字符, '?' 匹配一个字符
+        bool matchWildcard(const char *szPattern, const char *szName)
+        {
+            const char *pStar = nullptr;
+            const char *pResume = nullptr;
+            while (*szName)
+            {
+                if (*szPattern == '?' || *szPattern == *szName)
+                {
+                    szPattern++;
+                    szName++;
+                }
+                else if (*szPattern == '*')
+                {
+                    pStar = szPattern++;
+                    pResume = szName;
+                }
+                else if (pStar)
+                {
+                    szPattern = pStar + 1;
+                    szName = ++pResume;
+                }
+                else
+                {
+                    return false;
+                }
+            }
+            while (*szPattern == '*')
+                szPattern++;
+            return *szPattern == '\0';
+        }
+
+        /**
+         * @description: 有界阻塞队列, close 之后 push 失败, pop 取完剩余元素后返回 false
+         */
+        template <typename T>
+        class BoundedQueue
+        {
+        public:
+            explicit BoundedQueue(size_t nCapacity) : m_nCapacity(std::max<size_t>(1, nCapacity)) {}
+
+            bool push(T &&item)
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_cvNotFull.wait(lock, [&] { return m_bClosed || m_queue.size() < m_nCapacity; });
+                if (m_bClosed)
+                    return false;
+                m_queue.push_back(std::move(item));
+                m_cvNotEmpty.notify_one();
+                return true;
+            }
+
+            bool pop(T &item)
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_cvNotEmpty.wait(lock, [&] { return m_bClosed || !m_queue.empty(); });
+                if (m_queue.empty())
+                    return false;
+                item = std::move(m_queue.front());
+                m_queue.pop_front();
+                m_cvNotFull.notify_one();
+                return true;
+            }
+
+            void close()
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_bClosed = true;
+                m_cvNotEmpty.notify_all();
+                m_cvNotFull.notify_all();
+            }
+
+        private:
+            std::mutex m_mutex;
+            std::condition_variable m_cvNotEmpty;
+            std::condition_variable m_cvNotFull;
+            std::deque<T> m_queue;
+            size_t m_nCapacity;
+            bool m_bClosed = false;
+        };
+
+        /**
+         * @description: 在途图像的内存额度. 没有在途图像时总是放行, 单张超过上限的图也能处理
+         */
+        class MemoryBudget
+        {
+        public:
+            explicit MemoryBudget(size_t nLimit) : m_nLimit(nLimit) {}
+
+            void acquire(size_t nBytes)
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_cv.wait(lock, [&] { return m_nUsed == 0 || m_nUsed + nBytes <= m_nLimit; });
+                m_nUsed += nBytes;
+                m_nPeak = std::max(m_nPeak, m_nUsed);
+            }
+
+            // 处理后图像变大 (如挂网放大) 时追加登记, 不等待: 处理线程在这里等待可能与解码线程互相卡住
+            void grow(size_t nBytes)
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_nUsed += nBytes;
+                m_nPeak = std::max(m_nPeak, m_nUsed);
+            }
+
+            void release(size_t nBytes)
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_nUsed -= std::min(m_nUsed, nBytes);
+                m_cv.notify_all();
+            }
+
+            size_t getPeak()
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                return m_nPeak;
+            }
+
+        private:
+            std::mutex m_mutex;
+            std::condition_variable m_cv;
+            size_t m_nLimit;
+            size_t m_nUsed = 0;
+            size_t m_nPeak = 0;
+        };
+
+        struct BatchJob
+        {
+            size_t nIndex = 0;
+            cv::Mat mat;
+            size_t nReserved = 0;  // 在 MemoryBudget 中登记的字节数
+            uint64_t nFileBytes = 0;
+        };
+
+        size_t matBytes(const cv::Mat &mat)
+        {
+            return mat.total() * mat.elemSize();
+        }
+
+        double ticksToSeconds(int64 nTicks)
+        {
+            return static_cast<double>(nTicks) / cv::getTickFrequency();
+        }
+
+        // 不改变尺寸的 rotate 与 scale 都是仿射变换, 相邻时可以复合
+        bool isWarpStep(const BatchStep &step)
+        {
+            return step.strName == "scale" || (step.strName == "rotate" && getArg(step, 1, 0) == 0);
+        }
+
+        /**
+         * @description: 连续的 rotate / scale 复合成一个矩阵, 只插值一次; 各步的矩阵与输出尺寸与 setRotateImg / setScaleImg 相同
+         */
+        cv::Mat applyWarpSteps(const std::vector<BatchStep> &vSteps, size_t &i, const cv::Mat &mat)
+        {
+            GeoTransform transform;
+            cv::Size size = mat.size();
+            bool bRotated = false;
+            for (; i < vSteps.size() && isWarpStep(vSteps[i]); i++)
+            {
+                const BatchStep &step = vSteps[i];
+                if (step.strName == "rotate")
+                {
+                    transform.rotate(getArg(step, 0, 0) - 180, cv::Point(size.width / 2, size.height / 2));
+                    bRotated = true;
+                    continue;
+                }
+
+                const double dScaleX = std::max(getArg(step, 0, 1.0), 0.000001);
+                const double dScaleY = std::max(getArg(step, 1, getArg(step, 0, 1.0)), 0.000001);
+                const cv::Size sizeNext(static_cast<int>(size.width * dScaleX), static_cast<int>(size.height * dScaleY));
+                CV_Assert(sizeNext.width > 0 && sizeNext.height > 0);
+                transform.resize(static_cast<double>(sizeNext.width) / size.width, static_cast<double>(sizeNext.height) / size.height);
+                size = sizeNext;
+            }
+
+            // 只有缩放时与 cv::resize 一样按边缘像素补边
+            cv::Mat matOut;
+            transform.apply(mat, matOut, size, cv::INTER_LINEAR, bRotated ? cv::BORDER_CONSTANT : cv::BORDER_REPLICATE);
+            return matOut;
+        }
+
+        /**
+         * @description: 按步骤处理一张图. 相邻的逐点 / 邻域操作合并成一次 ImgPipeline 执行, 相邻的 rotate / scale 合并成一次变换
+         */
+        cv::Mat applySteps(const std::vector<BatchStep> &vSteps, cv::Mat mat, imgProcess &process, ImgPipeline &pipeline)
+        {
+            size_t i = 0;
+            while (i < vSteps.size())
+            {
+                const BatchStep &step = vSteps[i];
+                if (step.strName == "save")
+                    break;
+
+                if (findStep(step.strName)->bPipeline)
+                {
+                    if (mat.channels() == 4)
+                        cv::cvtColor(mat, mat, cv::COLOR_BGRA2BGR);
+
+                    pipeline.setSource(mat);
+                    pipeline.rewind();
+                    for (; i < vSteps.size() && findStep(vSteps[i].strName)->bPipeline; i++)
+                    {
+                        const BatchStep &s = vSteps[i];
+                        if (s.strName == "gray")
+                            pipeline.gray();
+                        else if (s.strName == "channels")
+                            pipeline.channels(getArg(s, 0, 1) != 0, getArg(s, 1, 1) != 0, getArg(s, 2, 1) != 0);
+                        else if (s.strName == "threshold")
+                            pipeline.threshold(cvRound(getArg(s, 0, 128)), cvRound(getArg(s, 1, 255)), cvRound(getArg(s, 2, 0)));
+                        else if (s.strName == "contrast")
+                            pipeline.contrastAndBright(getArg(s, 0, 0), getArg(s, 1, 0), getArg(s, 2, 0));
+                        else if (s.strName == "gamma")
+                            pipeline.gamma(getArg(s, 0, 1.0));
+                        else if (s.strName == "reversal")
+                            pipeline.reversal();
+                        else if (s.strName == "sharpen")
+                            pipeline.sharpen(getArg(s, 0, 5));
+                        else if (s.strName == "blur")
+                            pipeline.blur(cvRound(getArg(s, 0, 7)), cvRound(getArg(s, 1, 7)));
+                    }
+                    mat = pipeline.run();
+                    continue;
+                }
+
+                if (isWarpStep(step) && i + 1 < vSteps.size() && isWarpStep(vSteps[i + 1]))
+                {
+                    mat = applyWarpSteps(vSteps, i, mat);
+                    continue;
+                }
+
+                if (step.strName == "dither")
+                    mat = process.setDither(mat, getArg(step, 1, 1.0), 0, cvRound(getArg(step, 0, 0)), 0, cvRound(getArg(step, 2, 0)));
+                else if (step.strName == "diffusion")
+                    mat = process.setErrorDiffusion(mat, static_cast<DitherKernel>(cvRound(getArg(step, 0, 0))), getArg(step, 1, 0) != 0,
+                                                    cvRound(getArg(step, 2, 128)));
+                else if (step.strName == "oil")
+                    mat = process.setImgOilPaint(mat, cvRound(getArg(step, 0, 3)), cvRound(getArg(step, 1, 5)));
+                else if (step.strName == "mosaic")
+                    mat = process.setMosaic(mat, cvRound(getArg(step, 0, 10)), cvRound(getArg(step, 1, 0)));
+                else if (step.strName == "rotate")
+                    mat = process.setRotateImg(mat, getArg(step, 0, 0), getArg(step, 1, 0) != 0);
+                else if (step.strName == "scale")
+                    mat = process.setScaleImg(mat, getArg(step, 0, 1.0), getArg(step, 1, getArg(step, 0, 1.0)));
+                i++;
+            }
+            return mat;
+        }
+
+        std::vector<int> getWriteParams(const BatchStep &save)
+        {
+            std::vector<int> vParams;
+            if (save.vArgs.empty())
+                return vParams;
+
+            const int nQuality = cvRound(save.vArgs[0]);
+            if (save.strExt == "jpg" || save.strExt == "jpeg")
+                vParams = { cv::IMWRITE_JPEG_QUALITY, nQuality };
+            else if (save.strExt == "png")
+                vParams = { cv::IMWRITE_PNG_COMPRESSION, nQuality };
+            else if (save.strExt == "webp")
+                vParams = { cv::IMWRITE_WEBP_QUALITY, nQuality };
+            return vParams;
+        }
+    }
+
+    bool parseBatchSteps(const std::string &strSteps, std::vector<BatchStep> &vSteps, std::string &strError)
+    {
+        vSteps.clear();
+        for (const std::string &strItem : split(strSteps, ','))
+        {
+            if (strItem.empty())
+                continue;
+
+            std::vector<std::string> vParts = split(strItem, ':');
+            BatchStep step;
+            step.strName = toLower(vParts[0]);
+
+            const StepSpec *pSpec = findStep(step.strName);
+            if (!pSpec)
+            {
+                strError = "未知的步骤: " + vParts[0];
+                return false;
+            }
+            if (!vSteps.empty() && vSteps.back().strName == "save")
+            {
+                strError = "save 必须是最后一步";
+                return false;
+            }
+
+            size_t nFirst = 1;
+            if (step.strName == "save")
+            {
+                step.strExt = vParts.size() > 1 && !vParts[1].empty() ? toLower(vParts[1]) : "png";
+                if (step.strExt[0] == '.')
+                    step.strExt.erase(0, 1);
+                nFirst = 2;
+            }
+
+            for (size_t i = nFirst; i < vParts.size(); i++)
+            {
+                char *pEnd = nullptr;
+                const double dValue = strtod(vParts[i].c_str(), &pEnd);
+                if (vParts[i].empty() || *pEnd != '\0')
+                {
+                    strError = "参数不是数字: " + strItem;
+                    return false;
+                }
+                step.vArgs.push_back(dValue);
+            }
+            if (step.vArgs.size() + nFirst - 1 > pSpec->nMaxArgs)
+            {
+                strError = "参数过多: " + strItem;
+                return false;
+            }
+            if (step.strName == "diffusion" && (getArg(step, 0, 0) < 0 || getArg(step, 0, 0) > static_cast<int>(DitherKernel::Sierra)))
+            {
+                strError = "误差扩散核取 0 ~ 4: " + strItem;
+                return false;
+            }
+            vSteps.push_back(step);
+        }
+
+        if (vSteps.empty() || vSteps.back().strName != "save")
+        {
+            BatchStep save;
+            save.strName = "save";
+            save.strExt = "png";
+            vSteps.push_back(save);
+        }
+        return true;
+    }
+
+    std::vector<std::string> collectBatchInputs(const std::string &strPattern)
+    {
+        std::vector<std::string> vFiles;
+        std::error_code ec;
+        const fs::path path(strPattern);
+
+        if (fs::is_directory(path, ec))
+        {
+            forEachFile(path, [&](const fs::path &file) {
+                if (isImageFile(file))
+                    vFiles.push_back(file.string());
+            });
+        }
+        else if (path.filename().string().find_first_of("*?") != std::string::npos)
+        {
+            const std::string strName = path.filename().string();
+            const fs::path dir = path.has_parent_path() ? path.parent_path() : fs::path(".");
+            forEachFile(dir, [&](const fs::path &file) {
+                if (matchWildcard(strName.c_str(), file.filename().string().c_str()))
+                    vFiles.push_back(file.string());
+            });
+        }
+        else
+        {
+            vFiles.push_back(strPattern);
+        }
+
+        std::sort(vFiles.begin(), vFiles.end());
+        return vFiles;
+    }
+
+    BatchRunner::BatchRunner(const BatchOptions &opt) : m_opt(opt)
+    {
+        if (m_opt.vSteps.empty() || m_opt.vSteps.back().strName != "save")
+        {
+            std::string strError;
+            parseBatchSteps("", m_opt.vSteps, strError);
+        }
+        makeOutputPaths();
+    }
+
+    void BatchRunner::makeOutputPaths()
+    {
+        const std::string strExt = "." + m_opt.vSteps.back().strExt;
+        const std::string strSuffix = m_opt.strOutDir.empty() ? "_batch" : "";
+        auto getDir = [&](const fs::path &input) { return m_opt.strOutDir.empty() ? input.parent_path() : fs::path(m_opt.strOutDir); };
+        // 按不区分大小写比较, 与 Windows / macOS 的文件系统一致
+        auto getKey = [&](const fs::path &input) { return toLower((getDir(input) / input.stem()).string()); };
+
+        // 输出到同一目录且主文件名相同 (如 a.jpg 与 a.png) 的输入, 文件名中都保留原扩展名, 结果与输入顺序无关
+        std::unordered_map<std::string, size_t> mapStems;
+        for (const std::string &strInput : m_opt.vInputs)
+            mapStems[getKey(strInput)]++;
+
+        // 仍然重名 (不同输入目录下的同名文件、重复的输入) 时按输入顺序加序号
+        std::set<std::string> setUsed;
+        m_vOutputs.clear();
+        m_vOutputs.reserve(m_opt.vInputs.size());
+        for (const std::string &strInput : m_opt.vInputs)
+        {
+            const fs::path input(strInput);
+            std::string strStem = input.stem().string();
+            if (mapStems[getKey(input)] > 1 && input.has_extension())
+                strStem += "_" + input.extension().string().substr(1);
+
+            fs::path output = getDir(input) / (strStem + strSuffix + strExt);
+            for (int n = 2; !setUsed.insert(toLower(output.string())).second; n++)
+                output = getDir(input) / (strStem + "_" + std::to_string(n) + strSuffix + strExt);
+            m_vOutputs.push_back(output.string());
+        }
+    }
+
+    BatchReport BatchRunner::run(const std::function<void(const std::string &, const std::string &, bool)> &onDone)
+    {
+        BatchReport report;
+        const int64 nStart = cv::getTickCount();
+
+        if (!m_opt.strOutDir.empty())
+        {
+            std::error_code ec;
+            fs::create_directories(m_opt.strOutDir, ec);
+        }
+
+        const int nWorkers = m_opt.nWorkers > 0 ? m_opt.nWorkers : std::max(1, cv::getNumberOfCPUs());
+        const int nIoThreads = std::max(1, m_opt.nIoThreads);
+        const std::vector<int> vWriteParams = getWriteParams(m_opt.vSteps.back());
+
+        // 队列只需盖住各级速度的抖动, 内存上限由 MemoryBudget 保证
+        BoundedQueue<BatchJob> queueDecoded(nWorkers * 2);
+        BoundedQueue<BatchJob> queueProcessed(nIoThreads * 2);
+        MemoryBudget budget(m_opt.nMemoryBytes);
+
+        std::mutex mutexReport;
+        auto finish = [&](size_t nIndex, const std::string &strResult, bool bOk, uint64_t nBytesOut, int nStage, int64 nTicks) {
+            std::lock_guard<std::mutex> lock(mutexReport);
+            (bOk ? report.nImages : report.nFailed)++;
+            report.nBytesOut += nBytesOut;
+            report.arrStageSeconds[nStage] += ticksToSeconds(nTicks);
+            if (onDone)
+                onDone(m_opt.vInputs[nIndex], strResult, bOk);
+        };
+        auto addStage = [&](int nStage, int64 nTicks) {
+            std::lock_guard<std::mutex> lock(mutexReport);
+            report.arrStageSeconds[nStage] += ticksToSeconds(nTicks);
+        };
+
+        // 解码
+        std::atomic<size_t> nNext{ 0 };
+        std::atomic<int> nDecoders{ nIoThreads };
+        auto decode = [&] {
+            size_t nIndex;
+            while (!m_bCancel && (nIndex = nNext++) < m_opt.vInputs.size())
+            {
+                const int64 nT0 = cv::getTickCount();
+                const std::string &strPath = m_opt.vInputs[nIndex];
+
+                BatchJob job;
+                job.nIndex = nIndex;
+                try
+                {
+                    job.mat = cv::imread(strPath);
+                }
+                catch (const std::exception &)
+                {
+                    job.mat.release();
+                }
+                if (job.mat.empty())
+                {
+                    finish(nIndex, "无法读取图像", false, 0, 0, cv::getTickCount() - nT0);
+                    continue;
+                }
+
+                std::error_code ec;
+                job.nFileBytes = fs::file_size(strPath, ec);
+                job.nReserved = matBytes(job.mat);
+                {
+                    std::lock_guard<std::mutex> lock(mutexReport);
+                    report.nBytesIn += ec ? 0 : job.nFileBytes;
+                    report.nPixels += job.mat.total();
+                    report.arrStageSeconds[0] += ticksToSeconds(cv::getTickCount() - nT0);
+                }
+
+                budget.acquire(job.nReserved);
+                queueDecoded.push(std::move(job));
+            }
+            if (--nDecoders == 0)
+                queueDecoded.close();
+        };
+
+        // 处理
+        std::atomic<int> nProcessors{ nWorkers };
+        auto process = [&] {
+            imgProcess processor;
+            ImgPipeline pipeline;
+            BatchJob job;
+            while (queueDecoded.pop(job))
+            {
+                const int64 nT0 = cv::getTickCount();
+                std::string strError;
+                try
+                {
+                    job.mat = applySteps(m_opt.vSteps, job.mat, processor, pipeline);
+                    if (job.mat.empty())
+                        strError = "处理结果为空";
+                }
+                catch (const std::exception &e)
+                {
+                    // cv::Exception 以外还可能是 bad_alloc 等, 只让这一张失败
+                    strError = e.what();
+                }
+
+                if (!strError.empty())
+                {
+                    budget.release(job.nReserved);
+                    finish(job.nIndex, strError, false, 0, 1, cv::getTickCount() - nT0);
+                    continue;
+                }
+
+                const size_t nBytes = matBytes(job.mat);
+                if (nBytes > job.nReserved)
+                {
+                    budget.grow(nBytes - job.nReserved);
+                    job.nReserved = nBytes;
+                }
+                addStage(1, cv::getTickCount() - nT0);
+                queueProcessed.push(std::move(job));
+            }
+            pipeline.setSource(cv::Mat()); // 不再持有最后一张的缓存
+            if (--nProcessors == 0)
+                queueProcessed.close();
+        };
+
+        // 编码
+        auto encode = [&] {
+            BatchJob job;
+            while (queueProcessed.pop(job))
+            {
+                const int64 nT0 = cv::getTickCount();
+                const std::string &strOut = m_vOutputs[job.nIndex];
+                bool bOk = false;
+                try
+                {
+                    bOk = cv::imwrite(strOut, job.mat, vWriteParams);
+                }
+                catch (const std::exception &)
+                {
+                    bOk = false;
+                }
+
+                std::error_code ec;
+                const uint64_t nBytesOut = bOk ? fs::file_size(strOut, ec) : 0;
+                job.mat.release();
+                budget.release(job.nReserved);
+                finish(job.nIndex, bOk ? strOut : "无法写入 " + strOut, bOk, ec ? 0 : nBytesOut, 2, cv::getTickCount() - nT0);
+            }
+        };
+
+        std::vector<std::thread> vThreads;
+        for (int i = 0; i < nIoThreads; i++)
+            vThreads.emplace_back(decode);
+        for (int i = 0; i < nWorkers; i++)
+            vThreads.emplace_back(process);
+        for (int i = 0; i < nIoThreads; i++)
+            vThreads.emplace_back(encode);
+        for (std::thread &thread : vThreads)
+            thread.join();
+
+        report.dSeconds = ticksToSeconds(cv::getTickCount() - nStart);
+        report.nPeakBytes = budget.getPeak();
+        return report;
+    }
+}
@@ -0,0 +1,400 @@
+#include "ImgPipeline.h"
+#include "ColorKernels.h"
+#include "IntegralImage.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+
+namespace ImgSpace
+{
+    namespace
+    {
+        const int TILE_BYTES = 128 * 1024; // 每个分块的大致字节数, 保证中间结果留在缓存中
+
+        /**
+         * @description: 合并后的逐点操作
+         */
+        struct PointOp
+        {
+            enum class Kind
+            {
+                Lut,  // 查找表, 通道数与图像相同
+                Gray, // BGR -> 灰度
+                Hsv   // BGR -> HSV, 查表, HSV -> BGR
+            };
+
+            Kind eKind;
+            cv::Mat matLut;
+        };
+
+        /**
+         * @description: 一次整图遍历: 可选的一个邻域操作, 后接若干逐点操作
+         */
+        struct Segment
+        {
+            int nNeighbour = -1;    // 邻域操作的序号, -1 表示没有
+            size_t nLast = 0;       // 分段中最后一个操作的序号, 结果缓存在这里
+            int nOutChannels = 3;
+            std::vector<PointOp> vOps;
+        };
+
+        /**
+         * @description: 生成 1x256 的查找表
+         * @param {int} nChannels 通道数
+         * @param {Fn} fn uchar fn(int nValue, int nChannel)
+         */
+        template <class Fn>
+        cv::Mat makeLut(int nChannels, Fn fn)
+        {
+            cv::Mat matLut(1, 256, CV_8UC(nChannels));
+            uchar *p = matLut.ptr<uchar>(0);
+            for (int i = 0; i < 256; i++)
+            {
+                for (int c = 0; c < nChannels; c++)
+                    p[i * nChannels + c] = fn(i, c);
+            }
+            return matLut;
+        }
+
+        /**
+         * @description: 追加查找表; 前一个操作也是查找表时复合成一张
+         */
+        void appendLut(std::vector<PointOp> &vOps, const cv::Mat &matLut)
+        {
+            if (!vOps.empty() && vOps.back().eKind == PointOp::Kind::Lut)
+            {
+                cv::Mat &matPrev = vOps.back().matLut;
+                const int nChannels = matPrev.channels();
+                uchar *pPrev = matPrev.ptr<uchar>(0);
+                const uchar *pNext = matLut.ptr<uchar>(0);
+                for (int i = 0; i < 256 * nChannels; i++)
+                    pPrev[i] = pNext[pPrev[i] * nChannels + i % nChannels];
+                return;
+            }
+            vOps.push_back({ PointOp::Kind::Lut, matLut });
+        }
+
+        /**
+         * @description: 与 cv::threshold 对 CV_8U 的结果相同 (包括阈值超出 0 ~ 255 的情况)
+         */
+        uchar thresholdValue(int nValue, int nThresh, int nMax, int nType)
+        {
+            const bool bAbove = nValue > nThresh;
+            switch (nType)
+            {
+            case cv::THRESH_BINARY:
+                return bAbove ? cv::saturate_cast<uchar>(nMax) : 0;
+            case cv::THRESH_BINARY_INV:
+                return bAbove ? 0 : cv::saturate_cast<uchar>(nMax);
+            case cv::THRESH_TRUNC:
+                return bAbove ? cv::saturate_cast<uchar>(nThresh) : static_cast<uchar>(nValue);
+            case cv::THRESH_TOZERO:
+                return bAbove ? static_cast<uchar>(nValue) : 0;
+            case cv::THRESH_TOZERO_INV:
+            default:
+                return bAbove ? 0 : static_cast<uchar>(nValue);
+            }
+        }
+    }
+
+    bool ImgPipeline::Stage::operator==(const Stage &other) const
+    {
+        return eType == other.eType && arrParam[0] == other.arrParam[0] && arrParam[1] == other.arrParam[1] && arrParam[2] == other.arrParam[2];
+    }
+
+    void ImgPipeline::setSource(const cv::Mat &mat)
+    {
+        CV_Assert(mat.type() == CV_8UC1 || mat.type() == CV_8UC3);
+
+        m_matSource = mat;
+        for (cv::Mat &matCache : m_vCache)
+            matCache.release();
+    }
+
+    ImgPipeline &ImgPipeline::rewind(size_t nStage)
+    {
+        m_nCursor = std::min(nStage, m_vStages.size());
+        return *this;
+    }
+
+    ImgPipeline &ImgPipeline::record(StageType eType, double dA, double dB, double dC)
+    {
+        const Stage stage{ eType, { dA, dB, dC } };
+
+        if (m_nCursor < m_vStages.size())
+        {
+            if (!(m_vStages[m_nCursor] == stage))
+            {
+                // 参数变了: 这一步及之后的结果都要重算
+                m_vStages[m_nCursor] = stage;
+                for (size_t i = m_nCursor; i < m_vCache.size(); i++)
+                    m_vCache[i].release();
+            }
+        }
+        else
+        {
+            m_vStages.push_back(stage);
+            m_vCache.emplace_back();
+        }
+
+        m_nCursor++;
+        return *this;
+    }
+
+    ImgPipeline &ImgPipeline::gray()
+    {
+        return record(StageType::Gray);
+    }
+
+    ImgPipeline &ImgPipeline::channels(bool bBlue, bool bGreen, bool bRed)
+    {
+        return record(StageType::Channels, bBlue, bGreen, bRed);
+    }
+
+    ImgPipeline &ImgPipeline::threshold(int nValueA, int nValueB, int nType)
+    {
+        nType %= 5;
+        if (nType < 0)
+            nType += 5;
+        return record(StageType::Threshold, nValueA, nValueB, nType);
+    }
+
+    ImgPipeline &ImgPipeline::contrastAndBright(double dH, double dS, double dV)
+    {
+        return record(StageType::ContrastAndBright, dH, dS, dV);
+    }
+
+    ImgPipeline &ImgPipeline::gamma(double dGamma)
+    {
+        return record(StageType::Gamma, dGamma);
+    }
+
+    ImgPipeline &ImgPipeline::reversal()
+    {
+        return record(StageType::Reversal);
+    }
+
+    ImgPipeline &ImgPipeline::sharpen(double dSigma)
+    {
+        return record(StageType::Sharpen, dSigma);
+    }
+
+    ImgPipeline &ImgPipeline::blur(int nW, int nH)
+    {
+        return record(StageType::Blur, nW, nH);
+    }
+
+    cv::Size ImgPipeline::getHalo() const
+    {
+        cv::Size sizeHalo;
+        for (size_t i = 0; i < m_nCursor; i++)
+        {
+            const double *p = m_vStages[i].arrParam;
+            if (m_vStages[i].eType == StageType::Sharpen && p[0] >= 1)
+            {
+                // 与 GaussianBlur 对 CV_8U 由 sigma 推算的核大小相同
+                const int nRadius = (cvRound(p[0] * 3 * 2 + 1) | 1) / 2;
+                sizeHalo.width += nRadius;
+                sizeHalo.height += nRadius;
+            }
+            else if (m_vStages[i].eType == StageType::Blur && p[0] >= 1 && p[1] >= 1)
+            {
+                sizeHalo.width += static_cast<int>(p[0]) / 2;
+                sizeHalo.height += static_cast<int>(p[1]) / 2;
+            }
+        }
+        return sizeHalo;
+    }
+
+    int ImgPipeline::getOutChannels(int nInChannels) const
+    {
+        for (size_t i = 0; i < m_nCursor; i++)
+        {
+            if (m_vStages[i].eType == StageType::Gray || m_vStages[i].eType == StageType::Threshold)
+                nInChannels = 1;
+        }
+        return nInChannels;
+    }
+
+    cv::Mat ImgPipeline::run(const std::function<bool()> &isStale)
+    {
+        CV_Assert(!m_matSource.empty());
+
+        // 丢弃没有重新记录的操作
+        m_vStages.resize(m_nCursor);
+        m_vCache.resize(m_nCursor);
+
+        // 从最后一个有效缓存继续
+        int nDone = static_cast<int>(m_nCursor) - 1;
+        while (nDone >= 0 && m_vCache[nDone].empty())
+            nDone--;
+
+        cv::Mat matCur = nDone >= 0 ? m_vCache[nDone] : m_matSource;
+        if (nDone + 1 == static_cast<int>(m_nCursor))
+            return matCur;
+
+        // 划分分段: 每个邻域操作开始一个新分段, 逐点操作并入当前分段
+        std::vector<Segment> vSegments(1);
+        int nChannels = matCur.channels();
+        for (size_t i = nDone + 1; i < m_nCursor; i++)
+        {
+            const Stage &stage = m_vStages[i];
+            const double *p = stage.arrParam;
+            std::vector<PointOp> *pOps = &vSegments.back().vOps;
+
+            switch (stage.eType)
+            {
+            case StageType::Gray:
+                if (nChannels == 3)
+                {
+                    pOps->push_back({ PointOp::Kind::Gray, cv::Mat() });
+                    nChannels = 1;
+                }
+                break;
+            case StageType::Channels:
+                if (nChannels == 3)
+                    appendLut(*pOps, makeLut(3, [p](int v, int c) { return p[c] != 0.0 ? static_cast<uchar>(v) : uchar(0); }));
+                break;
+            case StageType::Threshold:
+                if (nChannels == 3)
+                {
+                    pOps->push_back({ PointOp::Kind::Gray, cv::Mat() });
+                    nChannels = 1;
+                }
+                appendLut(*pOps, makeLut(1, [p](int v, int) {
+                    return thresholdValue(v, static_cast<int>(p[0]), static_cast<int>(p[1]), static_cast<int>(p[2]));
+                }));
+                break;
+            case StageType::ContrastAndBright:
+                if (nChannels == 3)
+                    pOps->push_back({ PointOp::Kind::Hsv, makeHsvShiftLut(p[0], p[1], p[2]) });
+                break;
+            case StageType::Gamma:
+            {
+                // 与 setImgGamma 的表相同
+                double dInvGamma = 1 / p[0];
+                appendLut(*pOps, makeLut(nChannels, [dInvGamma](int v, int) { return (uchar)(std::pow(v / 255.0, dInvGamma) * 255); }));
+                break;
+            }
+            case StageType::Reversal:
+                appendLut(*pOps, makeLut(nChannels, [](int v, int) { return static_cast<uchar>(255 - v); }));
+                break;
+            case StageType::Sharpen:
+            case StageType::Blur:
+            {
+                const bool bIdentity = stage.eType == StageType::Sharpen ? p[0] < 1 : (p[0] < 1 || p[1] < 1);
+                if (bIdentity)
+                    break;
+                if (vSegments.back().nNeighbour >= 0 || !vSegments.back().vOps.empty())
+                    vSegments.emplace_back();
+                vSegments.back().nNeighbour = static_cast<int>(i);
+                break;
+            }
+            }
+
+            vSegments.back().nLast = i;
+            vSegments.back().nOutChannels = nChannels;
+        }
+
+        for (const Segment &seg : vSegments)
+        {
+            const size_t nSteps = (seg.nNeighbour >= 0 ? 1 : 0) + seg.vOps.size();
+            if (nSteps == 0)
+            {
+                // 全是不起作用的操作
+                m_vCache[seg.nLast] = matCur;
+                continue;
+            }
+
+            const cv::Mat matIn = matCur;
+            cv::Mat matOut(matIn.size(), CV_8UC(seg.nOutChannels));
+
+            const Stage *pNeighbour = seg.nNeighbour >= 0 ? &m_vStages[seg.nNeighbour] : nullptr;
+            int nTileRows = std::max(8, TILE_BYTES / std::max(1, matIn.cols * 3));
+            if (pNeighbour)
+            {
+                // 邻域操作在分块上下多读的行数 (锐化的核大小与 GaussianBlur 对 CV_8U 由 sigma 推算的相同);
+                // 分块太矮时多读的行占比过大
+                const double *p = pNeighbour->arrParam;
+                const int nHalo = pNeighbour->eType == StageType::Sharpen ? (cvRound(p[0] * 3 * 2 + 1) | 1) / 2 : static_cast<int>(p[1]) / 2;
+                nTileRows = std::max(nTileRows, 2 * nHalo);
+            }
+            const int nTiles = (matIn.rows + nTileRows - 1) / nTileRows;
+
+            std::atomic<bool> bStale{ false };
+            cv::parallel_for_(cv::Range(0, nTiles), [&](const cv::Range &range) {
+                cv::Mat arrTemp[2];
+                cv::Mat matBlur, matHsv;
+
+                for (int t = range.start; t < range.end; t++)
+                {
+                    if (bStale.load(std::memory_order_relaxed) || (isStale && isStale()))
+                    {
+                        bStale = true;
+                        return;
+                    }
+
+                    const int nY0 = t * nTileRows;
+                    const int nY1 = std::min(matIn.rows, nY0 + nTileRows);
+
+                    // 分块是整图的 ROI, 邻域操作会读取分块上下的真实像素, 只在整图边缘处补边, 结果与整图处理相同
+                    const cv::Mat matSrc = matIn.rowRange(nY0, nY1);
+                    cv::Mat matDst = matOut.rowRange(nY0, nY1);
+
+                    // 最后一步直接写入输出, 其余在两个临时分块间交替
+                    size_t nStep = 0;
+                    int nBuf = 0;
+                    auto target = [&]() -> cv::Mat & { return ++nStep == nSteps ? matDst : arrTemp[nBuf ^= 1]; };
+
+                    cv::Mat matTile = matSrc;
+                    if (pNeighbour)
+                    {
+                        const double *p = pNeighbour->arrParam;
+                        cv::Mat &matNext = target();
+                        if (pNeighbour->eType == StageType::Sharpen)
+                        {
+                            // USM 锐化, 与 setSharpening 相同
+                            cv::GaussianBlur(matSrc, matBlur, cv::Size(0, 0), p[0]);
+                            cv::addWeighted(matSrc, 1.5, matBlur, -0.5, 0, matNext);
+                        }
+                        else
+                        {
+                            // 读取整图中分块上下的真实像素, 与 setBlurImg 相同
+                            boxBlur(matIn, matNext, cv::Size(static_cast<int>(p[0]), static_cast<int>(p[1])), cv::Range(nY0, nY1));
+                        }
+                        matTile = matNext;
+                    }
+
+                    for (const PointOp &op : seg.vOps)
+                    {
+                        cv::Mat &matNext = target();
+                        switch (op.eKind)
+                        {
+                        case PointOp::Kind::Lut:
+                            cv::LUT(matTile, op.matLut, matNext);
+                            break;
+                        case PointOp::Kind::Gray:
+                            cv::cvtColor(matTile, matNext, cv::COLOR_BGR2GRAY);
+                            break;
+                        case PointOp::Kind::Hsv:
+                            cv::cvtColor(matTile, matHsv, cv::COLOR_BGR2HSV);
+                            cv::LUT(matHsv, op.matLut, matHsv);
+                            cv::cvtColor(matHsv, matNext, cv::COLOR_HSV2BGR);
+                            break;
+                        }
+                        matTile = matNext;
+                    }
+                }
+            });
+
+            if (bStale)
+                return cv::Mat();
+
+            matCur = matOut;
+            m_vCache[seg.nLast] = matCur;
+        }
+
+        return matCur;
+    }
+}
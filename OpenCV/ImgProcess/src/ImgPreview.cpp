@@ -0,0 +1,168 @@
+#include "ImgPreview.h"
+
+#include <algorithm>
+
+namespace ImgSpace
+{
+    namespace
+    {
+        const int PYRAMID_MIN_SIDE = 256; // 金字塔最小一层的长边
+    }
+
+    ImgPreview::ImgPreview()
+    {
+        m_thread = std::thread([this]() { run(); });
+    }
+
+    ImgPreview::~ImgPreview()
+    {
+        cancel();
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_bStop = true;
+        }
+        m_condition.notify_all();
+        m_thread.join();
+    }
+
+    void ImgPreview::setImage(const cv::Mat &mat)
+    {
+        if (mat.data == m_matSource.data && mat.size() == m_matSource.size() && mat.type() == m_matSource.type())
+            return;
+
+        cancel();
+        m_matSource = mat;
+        m_vLevels.clear();
+    }
+
+    void ImgPreview::buildPyramid()
+    {
+        m_vLevels.assign(1, m_matSource);
+        while (std::max(m_vLevels.back().cols, m_vLevels.back().rows) > PYRAMID_MIN_SIDE)
+        {
+            const cv::Mat &matPrev = m_vLevels.back();
+            cv::Mat matNext;
+            cv::resize(matPrev, matNext, cv::Size((matPrev.cols + 1) / 2, (matPrev.rows + 1) / 2), 0, 0, cv::INTER_AREA);
+            m_vLevels.push_back(matNext);
+        }
+    }
+
+    double ImgPreview::estimateMs(int nKey, size_t nPixels)
+    {
+        std::unique_lock<std::mutex> lock(m_mutexCost);
+        auto it = m_mapMsPerPixel.find(nKey);
+        return it == m_mapMsPerPixel.end() ? 0.0 : it->second * nPixels;
+    }
+
+    void ImgPreview::recordMs(int nKey, size_t nPixels, double dMs)
+    {
+        if (nPixels == 0)
+            return;
+
+        const double dPerPixel = dMs / nPixels;
+        std::unique_lock<std::mutex> lock(m_mutexCost);
+        auto it = m_mapMsPerPixel.find(nKey);
+        if (it == m_mapMsPerPixel.end())
+            m_mapMsPerPixel[nKey] = dPerPixel;
+        else
+            it->second = 0.5 * (it->second + dPerPixel);
+    }
+
+    cv::Mat ImgPreview::render(int nKey, const Effect &effect, cv::Size sizeDisplay, double dBudgetMs, Callback onRefined, int *pLevel)
+    {
+        CV_Assert(!m_matSource.empty());
+
+        if (m_vLevels.empty())
+            buildPyramid();
+
+        const uint64_t nJob = ++m_nJob;
+        const int nCount = static_cast<int>(m_vLevels.size());
+
+        // 仍能铺满显示区域的最小一层
+        int nLevel = 0;
+        for (int i = nCount - 1; i >= 0; i--)
+        {
+            if (m_vLevels[i].cols >= sizeDisplay.width && m_vLevels[i].rows >= sizeDisplay.height)
+            {
+                nLevel = i;
+                break;
+            }
+        }
+
+        // 第一次用到的效果没有耗时记录, 先在最小一层上试算一次
+        if (estimateMs(nKey, 1) <= 0.0)
+        {
+            const cv::Mat &matSmall = m_vLevels.back();
+            int64 nStart = cv::getTickCount();
+            effect(matSmall, static_cast<double>(matSmall.cols) / m_matSource.cols, []() { return false; });
+            recordMs(nKey, matSmall.total(), (cv::getTickCount() - nStart) * 1000.0 / cv::getTickFrequency());
+        }
+
+        // 按记录的耗时估计, 超出帧预算时改用更小的层
+        while (nLevel + 1 < nCount && estimateMs(nKey, m_vLevels[nLevel].total()) > dBudgetMs)
+            nLevel++;
+
+        const cv::Mat &matLevel = m_vLevels[nLevel];
+        const double dScale = static_cast<double>(matLevel.cols) / m_matSource.cols;
+
+        int64 nStart = cv::getTickCount();
+        cv::Mat matRes = effect(matLevel, dScale, []() { return false; });
+        recordMs(nKey, matLevel.total(), (cv::getTickCount() - nStart) * 1000.0 / cv::getTickFrequency());
+
+        if (pLevel)
+            *pLevel = nLevel;
+
+        std::function<void()> task;
+        if (nLevel > 0)
+        {
+            const cv::Mat matFull = m_matSource;
+            task = [this, nJob, nKey, effect, onRefined, matFull]() {
+                auto isStale = [this, nJob]() { return nJob != m_nJob.load(std::memory_order_relaxed); };
+                if (isStale())
+                    return;
+
+                int64 nStart = cv::getTickCount();
+                cv::Mat matRes = effect(matFull, 1.0, isStale);
+                if (isStale() || matRes.empty())
+                    return;
+
+                recordMs(nKey, matFull.total(), (cv::getTickCount() - nStart) * 1000.0 / cv::getTickFrequency());
+                if (onRefined)
+                    onRefined(nJob, matRes);
+            };
+        }
+
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_task = std::move(task);
+        }
+        m_condition.notify_one();
+
+        return matRes;
+    }
+
+    void ImgPreview::cancel()
+    {
+        ++m_nJob;
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_task = nullptr;
+    }
+
+    void ImgPreview::run()
+    {
+        for (;;)
+        {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_condition.wait(lock, [this] { return m_bStop || m_task; });
+                if (m_bStop)
+                    break;
+
+                task = std::move(m_task);
+                m_task = nullptr;
+            }
+            task();
+        }
+    }
+}
@@ -1,8 +1,85 @@
 #include "ImgProcess.h"
+#include "OilPaint.h"
+#include "ErrorDiffusion.h"
+#include "Halftone.h"
+#include "IntegralImage.h"
+#include "ColorKernels.h"
+#include "GeometryTransform.h"
 // #include <opencv2/freetype.hpp>
 
 using namespace ImgSpace;
 
+namespace
+{
+    /**
+     * @description: setRotateImg(bChangeSize) 的画布: 逆时针旋转 theta 弧度后的外接尺寸
+     * @param {Point} &ptMin 画布左上角在旋转后坐标中的位置
+     */
+    Size rotatedCanvas(Size sizeSrc, float theta, Point& ptMin)
+    {
+        // 逆时针旋转矩阵
+        float matRotate[2][2]{
+            {std::cos(theta), -std::sin(theta)},
+            {std::sin(theta), std::cos(theta)} };
+
+        float pt[3][2]{
+            {0, (float)sizeSrc.height},
+            {(float)sizeSrc.width, (float)sizeSrc.height},
+            {(float)sizeSrc.width, 0} };
+
+        for (int i = 0; i < 3; i++)
+        {
+            float x = pt[i][0] * matRotate[0][0] + pt[i][1] * matRotate[1][0];
+            float y = pt[i][0] * matRotate[0][1] + pt[i][1] * matRotate[1][1];
+            pt[i][0] = x;
+            pt[i][1] = y;
+        }
+
+        // 计算出旋转后图像的极值点和尺寸
+        float fMin_x = min(min(min(pt[0][0], pt[1][0]), pt[2][0]), (float)0.0);
+        float fMin_y = min(min(min(pt[0][1], pt[1][1]), pt[2][1]), (float)0.0);
+        float fMax_x = max(max(max(pt[0][0], pt[1][0]), pt[2][0]), (float)0.0);
+        float fMax_y = max(max(max(pt[0][1], pt[1][1]), pt[2][1]), (float)0.0);
+
+        ptMin = Point(cvRound(fMin_x + 0.5), cvRound(fMin_y + 0.5));
+        return Size(cvRound(fMax_x - fMin_x + 0.5) + 1, cvRound(fMax_y - fMin_y + 0.5) + 1);
+    }
+
+    /**
+     * @description: 挂网, 输出尺寸与原实现相同.
+     * 原实现把图像逆时针旋转 dAngle (画布扩大) 后放大挂网, 再转回 (画布再次扩大); 现在旋转的是阈值图块,
+     * 图像不旋转, 挂网结果按两次旋转后的位置放进同样大小的黑色画布. 网角为 90 度的倍数时画布与放大后的图像相同
+     */
+    Mat screenOnRotatedCanvas(const HalftoneScreen& screen, const Mat& matGray, double dScale, double dAngle)
+    {
+        Mat matScreen = screen.apply(matGray, dScale, dAngle);
+
+        const double dQuarter = dAngle / 90.0;
+        if (fabs(dQuarter - cvRound(dQuarter)) < 1e-9)
+            return matScreen;
+
+        // 两次旋转合起来是平移: 放大后的图像左上角落在 -(ptMin2 + dScale * R(theta) * ptMin1),
+        // 再加上两次旋转与放大各自按像素左上角取样带来的半像素偏移 (dScale + 1) / 2 * R(theta) * (1, 1)
+        dScale = std::min(std::max(dScale, 1.0), 8.0);
+        const float theta = dAngle * CV_PI / 180.0;
+        Point ptMin1, ptMin2;
+        const Size sizeRotated = rotatedCanvas(matGray.size(), theta, ptMin1);
+        const Size sizeCanvas = rotatedCanvas(Size(sizeRotated.width * dScale, sizeRotated.height * dScale), -theta, ptMin2);
+
+        const double dCos = std::cos(theta);
+        const double dSin = std::sin(theta);
+        const double dHalf = (dScale + 1.0) * 0.5;
+        const Point ptOffset(-cvRound(ptMin2.x + dScale * (dCos * ptMin1.x - dSin * ptMin1.y) - dHalf * (dCos - dSin)),
+                             -cvRound(ptMin2.y + dScale * (dSin * ptMin1.x + dCos * ptMin1.y) - dHalf * (dSin + dCos)));
+
+        Mat matCanvas = Mat::zeros(sizeCanvas, CV_8UC1);
+        const Rect rectDst = Rect(ptOffset, matScreen.size()) & Rect(Point(), sizeCanvas);
+        if (!rectDst.empty())
+            matScreen(rectDst - ptOffset).copyTo(matCanvas(rectDst));
+        return matCanvas;
+    }
+}
+
 imgProcess::imgProcess()
 {
 }
@@ -143,83 +220,49 @@ Mat imgProcess::setThreshold(const Mat& mat, int nValueA, int nValueB /*= 255*/,
 
 Mat imgProcess::getRedChannel(const Mat& mat)
 {
-    vector<Mat> mv;
-
-    split(mat, mv);
-    mv[0] = Scalar(0);
-    mv[1] = Scalar(0);
-    Mat matRes;
-    merge(mv, matRes);
-
-    return matRes;
+    return keepChannels(mat, false, false, true);
 }
 
 Mat imgProcess::getGreeChannel(const Mat& mat)
 {
-    vector<Mat> mv;
-
-    split(mat, mv);
-    mv[0] = Scalar(0);
-    mv[2] = Scalar(0);
-    Mat matRes;
-    merge(mv, matRes);
-
-    return matRes;
+    return keepChannels(mat, false, true, false);
 }
 
 Mat imgProcess::getBlueChannel(const Mat& mat)
 {
-    vector<Mat> mv;
-
-    split(mat, mv);
-    mv[1] = Scalar(0);
-    mv[2] = Scalar(0);
-    Mat matRes;
-    merge(mv, matRes);
-
-    return matRes;
+    return keepChannels(mat, true, false, false);
 }
 
 Mat imgProcess::getRGChannel(const Mat& mat)
 {
-    vector<Mat> mv;
-
-    split(mat, mv);
-    mv[0] = Scalar(0);
-    Mat matRes;
-    merge(mv, matRes);
-
-    return matRes;
+    return keepChannels(mat, false, true, true);
 }
 
 Mat imgProcess::getRBChannel(const Mat& mat)
 {
-    vector<Mat> mv;
-
-    split(mat, mv);
-    mv[1] = Scalar(0);
-    Mat matRes;
-    merge(mv, matRes);
-
-    return matRes;
+    return keepChannels(mat, true, false, true);
 }
 
 // 绿蓝
 Mat imgProcess::getGBChannel(const Mat& mat)
 {
-    vector<Mat> mv;
-
-    split(mat, mv);
-    mv[2] = Scalar(0);
-    Mat matRes;
-    merge(mv, matRes);
-    return matRes;
+    return keepChannels(mat, true, true, false);
 }
 
 Mat imgProcess::setRotateImg(const Mat& mat, double dAngle /*=0.0*/, bool bChangeSize /*= false*/)
 {
     if (bChangeSize)
     {
+        // 90 度的倍数 (逆时针为正) 直接分块搬移, 尺寸正好对调
+        const double dQuarter = dAngle / 90.0;
+        if (fabs(dQuarter - cvRound(dQuarter)) < 1e-9)
+        {
+            const int nTimes = -cvRound(dQuarter); // rotate90 按顺时针计
+            Mat matRet;
+            GeoTransform().rotate90(nTimes, mat.size()).apply(mat, matRet, nTimes % 2 != 0 ? Size(mat.rows, mat.cols) : mat.size());
+            return matRet;
+        }
+
         // https://www.cnblogs.com/konglongdanfo/p/9135501.html
         float theta = dAngle * CV_PI / 180.0;
         int nRowsSrc = mat.rows;
@@ -232,34 +275,16 @@ Mat imgProcess::setRotateImg(const Mat& mat, double dAngle /*=0.0*/, bool bChang
 
         // 全部以逆时针旋转来计算
         // 逆时针旋转矩阵
-        float matRotate[3][3]{
-            {std::cos(theta), -std::sin(theta), 0},
-            {std::sin(theta), std::cos(theta), 0},
-            {0, 0, 1} };
+        float matRotate[2][2]{
+            {std::cos(theta), -std::sin(theta)},
+            {std::sin(theta), std::cos(theta)} };
 
-        float pt[3][2]{
-            {0, (float)nRowsSrc},
-            {(float)nColsSrc, (float)nRowsSrc},
-            {(float)nColsSrc, 0} };
-
-        for (int i = 0; i < 3; i++)
-        {
-            float x = pt[i][0] * matRotate[0][0] + pt[i][1] * matRotate[1][0];
-            float y = pt[i][0] * matRotate[0][1] + pt[i][1] * matRotate[1][1];
-            pt[i][0] = x;
-            pt[i][1] = y;
-        }
-
-        // 计算出旋转后图像的极值点和尺寸
-        float fMin_x = min(min(min(pt[0][0], pt[1][0]), pt[2][0]), (float)0.0);
-        float fMin_y = min(min(min(pt[0][1], pt[1][1]), pt[2][1]), (float)0.0);
-        float fMax_x = max(max(max(pt[0][0], pt[1][0]), pt[2][0]), (float)0.0);
-        float fMax_y = max(max(max(pt[0][1], pt[1][1]), pt[2][1]), (float)0.0);
-
-        int nRows = cvRound(fMax_y - fMin_y + 0.5) + 1;
-        int nCols = cvRound(fMax_x - fMin_x + 0.5) + 1;
-        int nMin_x = cvRound(fMin_x + 0.5);
-        int nMin_y = cvRound(fMin_y + 0.5);
+        Point ptMin;
+        const Size sizeRet = rotatedCanvas(mat.size(), theta, ptMin);
+        int nRows = sizeRet.height;
+        int nCols = sizeRet.width;
+        int nMin_x = ptMin.x;
+        int nMin_y = ptMin.y;
 
         bool bOneCh = false;
         if (1 == mat.channels())
@@ -292,14 +317,12 @@ Mat imgProcess::setRotateImg(const Mat& mat, double dAngle /*=0.0*/, bool bChang
 
     else
     {
-        Mat matTemp = mat.clone();
-        int nCenterX = matTemp.cols / 2;
-        int nCenterY = matTemp.rows / 2;
-
-        Mat matRes = getRotationMatrix2D(Point(nCenterX, nCenterY), (dAngle - 180), 1.0);
+        int nCenterX = mat.cols / 2;
+        int nCenterY = mat.rows / 2;
 
+        // 与原来的 warpAffine 相同的矩阵; 90 度的倍数时按整像素搬移, 结果与 warpAffine 相同
         Mat matOut;
-        warpAffine(matTemp, matOut, matRes, matTemp.size(), INTER_LINEAR, 0, Scalar());
+        GeoTransform().rotate(dAngle - 180, Point(nCenterX, nCenterY)).apply(mat, matOut, mat.size());
 
         return matOut;
     }
@@ -314,9 +337,9 @@ Mat imgProcess::setScaleImg(const Mat& mat, double dScale /*= 1.0*/)
     int nCenterY = mat.cols / 2;
 
     // Mat matRotation = getRotationMatrix2D(Point(nCenterX, nCenterY), (nAngle - 180), iScale / 50.0);
-    Mat matRes = getRotationMatrix2D(Point(nCenterX, nCenterY), 0.0, dScale);
-
-    warpAffine(mat, matRes, matRes, mat.size(), INTER_LINEAR, 0, Scalar());
+    // dScale 为 1 时是整像素复制, 不插值
+    Mat matRes;
+    GeoTransform().rotate(0.0, Point(nCenterX, nCenterY), dScale).apply(mat, matRes, mat.size());
 
     return matRes;
 }
@@ -342,11 +365,12 @@ Mat imgProcess::rotate90(const Mat& mat, int nIndex /*= 0*/)
 {
     Mat matRes;
 
-    nIndex %= 4;
+    nIndex = (nIndex % 4 + 4) % 4;
     if (nIndex == 3)
         return mat;
 
-    rotate(mat, matRes, nIndex); // 0 1 2 顺时针旋转 90 180 270 度
+    // 0 1 2 顺时针旋转 90 180 270 度, 一遍分块搬移 (cv::rotate 的 90 度是转置后再镜像)
+    GeoTransform().rotate90(nIndex + 1, mat.size()).apply(mat, matRes, nIndex == 1 ? mat.size() : Size(mat.rows, mat.cols));
 
     return matRes;
 }
@@ -379,7 +403,7 @@ Mat imgProcess::setBlurImg(const Mat& mat, int w /*= 7*/, int h /*= 7*/) // 模
         return mat;
 
     Mat matRes;
-    blur(mat, matRes, Size(w, h)); // 模糊
+    boxBlur(mat, matRes, Size(w, h)); // 模糊 (积分图, 耗时与核大小无关)
     return matRes;
 }
 
@@ -460,7 +484,7 @@ Mat imgProcess::setCannyImg(const Mat& mat, int a, int b, int c, int w /*= 13*/,
     cvtColor(mat, matGray, COLOR_BGR2GRAY);
 
     /// 使用 3x3内核降噪
-    blur(matGray, detected, Size(w, h));
+    boxBlur(matGray, detected, Size(w, h));
 
     /// 运行Canny算子
     Canny(detected, detected, a, b, c);
@@ -497,95 +521,11 @@ Mat imgProcess::setContrastAndBright(const Mat& mat, double dH, double dS, doubl
     // // H指hue(色相)、S指saturation(饱和度)、L指lightness(亮度)、V指value(色调)、B指brightness(明度)
     // // HSL是色相(Hue)、饱和度(Saturation)和亮度(Lightness)
 
-    // 色相调节
-    Mat matHSV;
-
-    int nCh = mat.channels();
-
-    if (nCh < 3)
+    // 色相调节: 各通道的调节只与通道值有关, 转到 HSV 后查表
+    if (mat.channels() < 3)
         return mat;
 
-    if (nCh == 4)
-        cvtColor(mat, matHSV, COLOR_RGBA2BGR);
-
-    cvtColor(mat, matHSV, COLOR_BGR2HSV);
-    std::vector<Mat> vecPlanes;
-    split(matHSV, vecPlanes);
-
-    const Mat& matTemp = vecPlanes[0];
-    int nW = matTemp.cols;
-    int nH = matTemp.rows;
-
-    for (int y = 0; y < nH; y++)
-    {
-        for (int x = 0; x < nW; x++)
-        {
-            // uchar h = matHSV.at<Vec3b>(y, x)[0];
-            // if (h + dH > 180)
-            //     h = (h + dH) - 180;
-            // else
-            //     h = h + dH;
-
-            // matHSV.at<Vec3b>(y, x)[0] = h;      // 色相调节
-
-            // uchar s = matHSV.at<Vec3b>(y, x)[1];
-            // if (s + dS > 100)
-            //     s = (s + dS) - 100;
-            // else
-            //     s = s + dS;
-            // matHSV.at<Vec3b>(y, x)[1] = s;
-
-            // uchar l = matHSV.at<Vec3b>(y, x)[2];
-            // if (l + dV > 100)
-            //     l = (l + dV) - 100;
-            // else
-            //     l = s + dV;
-            // matHSV.at<Vec3b>(y, x)[2] = l;
-
-            // 色相
-            signed short h = matHSV.at<Vec3b>(y, x)[0];
-            signed short h_plus_shift = h;
-            h_plus_shift += dH;
-
-            if (h_plus_shift < 0)
-                h = 180 + h_plus_shift;
-            else if (h_plus_shift > 180)
-                h = h_plus_shift - 180;
-            else
-                h = h_plus_shift;
-
-            matHSV.at<Vec3b>(y, x)[0] = static_cast<unsigned char>(h);
-
-            // 饱和度
-            double v = matHSV.at<Vec3b>(y, x)[2];
-            // double v_shift = (dV - 100) / 100.0;
-
-            double v_plus_shift = v + dS;
-
-            if (v_plus_shift < 0)
-                v_plus_shift = 0;
-            else if (v_plus_shift > 255)
-                v_plus_shift = 255;
-
-            matHSV.at<Vec3b>(y, x)[2] = static_cast<unsigned char>(v_plus_shift);
-
-            // 明度
-            double s = matHSV.at<Vec3b>(y, x)[1];
-            // double s_shift = (dS - 100) / 100.0
-            double s_plus_shift = s + dV;
-
-            if (s_plus_shift < 0)
-                s_plus_shift = 0;
-            else if (s_plus_shift > 255)
-                s_plus_shift = 255;
-
-            matHSV.at<Vec3b>(y, x)[1] = static_cast<unsigned char>(s_plus_shift);
-        }
-    }
-
-    Mat matShow;
-    cvtColor(matHSV, matShow, COLOR_HSV2BGR);
-    return matShow;
+    return shiftHsv(mat, dH, dS, dV);
 
     // // 所以我们需要一个新的Mat对象,以存储变换后的图像.我们希望这个Mat对象拥有下面的性质:
     // // 像素值初始化为0 与原图像有相同的大小和类型
@@ -652,9 +592,8 @@ Mat imgProcess::setSharpening(const Mat& mat, double sigmaX /*= 100.0*/, double
 Mat imgProcess::setImgContours(const Mat& mat, int nBrushSize)
 {
     /// 转成灰度并模糊化降噪
-    Mat matGray = getGray(mat);
-
-    blur(matGray, matGray, Size(3, 3));
+    Mat matGray;
+    boxBlur(getGray(mat), matGray, Size(3, 3));
 
     Mat canny_output;
     vector<vector<Point>> contours;
@@ -685,7 +624,7 @@ Mat imgProcess::setImgBlur(const Mat& mat, int nBrushSize, int nType)
     if (nBrushSize % 2 == 0)
         nBrushSize += 1;
 
-    Mat matCpy = mat.clone();
+    Mat matCpy;
 
     // 归一化块滤波器(Normalized Box Filter)  就是 均值平滑
     // 最简单的滤波器, 输出像素值是核窗口内像素值的 均值(所有像素加权系数相等)
@@ -703,7 +642,7 @@ Mat imgProcess::setImgBlur(const Mat& mat, int nBrushSize, int nType)
         // matCpy : 输出图像
         // Size(w, h) : 定义内核大小(w 像素宽度, h 像素高度)
         // Point(-1, -1) : 指定锚点位置(被平滑点), 如果是负值,取核的中心为锚点.
-        blur(mat, matCpy, Size(nBrushSize, nBrushSize), Point(-1, -1)); // 归一化块滤波器  均值平滑
+        boxBlur(mat, matCpy, Size(nBrushSize, nBrushSize)); // 归一化块滤波器  均值平滑 (积分图, 锚点居中)
     }
     break;
     case 1:
@@ -750,75 +689,32 @@ Mat imgProcess::setMosaic(const Mat& mat, int nBrushSize, int nType)
     if (nBrushSize < 3)
         nBrushSize = 3;
 
-    Mat matRes;
+    // 结果总是新图, 不修改调用方的 mat
+    Mat matBgr;
     if (mat.channels() < 3)
-        cvtColor(mat, matRes, COLOR_GRAY2BGR);
+        cvtColor(mat, matBgr, COLOR_GRAY2BGR);
+    else if (mat.channels() == 4)
+        cvtColor(mat, matBgr, COLOR_BGRA2BGR);
     else
-        matRes = mat;
-
-    Mat matMosaic;
+        matBgr = mat;
 
-    int nW = matRes.cols; // 宽
-    int nH = matRes.rows; // 高
-
-    // Mat matRes(mat.size(), CV_8UC3);
-    for (int i = 0; i < nH; i += nBrushSize)
-    {
-        for (int j = 0; j < nW; j += nBrushSize)
-        {
-            // 获取像素点
-            Scalar scalar = Scalar(mat.at<Vec3b>(i, j));
-
-            // 将像素点赋给Mat
-
-            for (int m = i; m < i + nBrushSize && m < nH; m++)
-            {
-                for (int n = j; n < j + nBrushSize && n < nW; n++)
-                {
-                    // 将Mat移至原图覆盖
-                    // Mat matM(nBrushSize, nBrushSize, CV_8UC3, scalar);
-                    matRes.at<Vec3b>(m, n)[0] = scalar[0];
-                    matRes.at<Vec3b>(m, n)[1] = scalar[1];
-                    matRes.at<Vec3b>(m, n)[2] = scalar[2];
-                }
-            }
-        }
-    }
-
-    return matRes;
+    // nType 为奇数时取块内均值, 否则取块左上角像素
+    return mosaicBlocks(matBgr, nBrushSize, nType % 2 != 0);
 }
 
 // 浮雕
 Mat imgProcess::setRelief(const Mat& mat, int nBrushSize, int nType)
 {
-    Mat matImgA(mat.size(), CV_8UC3);
-
-    for (int y = 1; y < mat.rows - 1; y++)
-    {
-        const uchar* p0 = mat.ptr<uchar>(y);
-        const uchar* p1 = mat.ptr<uchar>(y + 1);
-
-        uchar* q0 = matImgA.ptr<uchar>(y);
-
-        for (int x = 1; x < mat.cols - 1; x++)
-        {
-            for (int i = 0; i < 3; i++)
-            {
-                // 当前点和右边一个点相减,再加150
-                int tmp0 = p1[3 * (x + 1) + i] - p0[3 * (x - 1) + i] + nBrushSize; //浮雕
-
-                if (tmp0 < 0)
-                    q0[3 * x + i] = 0;
-                else if (tmp0 > 255)
-                    q0[3 * x + i] = 255;
-                else
-                    q0[3 * x + i] = tmp0;
-            }
-        }
-    }
+    Mat matBgr;
+    if (mat.channels() < 3)
+        cvtColor(mat, matBgr, COLOR_GRAY2BGR);
+    else if (mat.channels() == 4)
+        cvtColor(mat, matBgr, COLOR_BGRA2BGR);
+    else
+        matBgr = mat;
 
-    cvtColor(matImgA, matImgA, COLOR_BGR2GRAY);
-    return matImgA;
+    // 当前点和右边一个点相减, 再加 nBrushSize
+    return reliefGray(matBgr, nBrushSize);
 
     // Mat matImgA(mat.size(), CV_8UC3);
     // Mat matImgB(mat.size(), CV_8UC3);
@@ -928,6 +824,28 @@ Mat imgProcess::setColorStyle(const Mat& mat, int nA)
 }
 
 Mat imgProcess::setImgOilPaint(const Mat& mat, int nBrushSize, int nCoarseness)
+{
+    assert(!mat.empty());
+
+    // 滑动直方图只处理三通道图像; 单行/单列图像的窗口为空, 沿用原实现
+    if (mat.type() != CV_8UC3 || mat.cols < 2 || mat.rows < 2)
+        return setImgOilPaintRef(mat, nBrushSize, nCoarseness);
+
+    if (nBrushSize < 1)
+        nBrushSize = 1;
+    if (nBrushSize > 8)
+        nBrushSize = 8;
+
+    if (nCoarseness < 1)
+        nCoarseness = 1;
+    if (nCoarseness > 255)
+        nCoarseness = 255;
+
+    Mat matGray = getGray(mat);
+    return oilPaintSliding(mat, matGray, nBrushSize, nCoarseness);
+}
+
+Mat imgProcess::setImgOilPaintRef(const Mat& mat, int nBrushSize, int nCoarseness)
 {
     // 1.把(0~255)灰度值均分成n个区间
     // 2.遍历图像的每个像素点 将模板范围内的所有像素值进一步离散化,根据像素的灰度落入不同的区间,
@@ -1209,327 +1127,64 @@ Mat imgProcess::setDotPaint(const Mat& mat, int nBrushSize, int nCoarseness)
 // 散点图
 Mat imgProcess::setDither(const Mat& mat, int nBrushSize, int nCoarseness)
 {
+    // 灰度图输入时 getGray 不复制, 原地扩散前先复制一份, 不改动调用方的图像
     Mat matDith = getGray(mat);
+    if (matDith.data == mat.data)
+        matDith = mat.clone();
 
-    int nW = matDith.cols;
-    int nH = matDith.rows;
+    const int nW = matDith.cols;
+    const int nH = matDith.rows;
 
     /* Run the 'Floyd-Steinberg' dithering algorithm ... */
-    int err;
-    int8_t a, b, c, d;
-
-    auto saturated_add = [](uint8_t val1, int8_t val2) -> uint8_t {
-        int16_t val1_int = val1;
-        int16_t val2_int = val2;
-        int16_t tmp = val1_int + val2_int;
-
-        if (tmp > 255)
-            return 255;
-        else if (tmp < 0)
-            return 0;
-        else
-            return tmp;
-        };
-
+    // 误差直接饱和累加到 8 位图上, 首尾列与最后一行的误差不扩散
     for (int i = 0; i < nH; i++)
     {
+        uchar* p = matDith.ptr<uchar>(i);
+        uchar* q = (i != nH - 1) ? matDith.ptr<uchar>(i + 1) : nullptr;
         for (int j = 0; j < nW; j++)
         {
-            if (matDith.at<uint8_t>(i, j) > 127)
-            {
-                err = matDith.at<uint8_t>(i, j) - 255;
-                matDith.at<uint8_t>(i, j) = 255;
-            }
-            else
-            {
-                err = matDith.at<uint8_t>(i, j) - 0;
-                matDith.at<uint8_t>(i, j) = 0;
-            }
-
-            a = (err * 7) / 16;
-            b = (err * 1) / 16;
-            c = (err * 5) / 16;
-            d = (err * 3) / 16;
+            int err = p[j] > 127 ? p[j] - 255 : p[j];
+            p[j] = p[j] > 127 ? 255 : 0;
 
-            if ((i != (nH - 1)) && (j != 0) && (j != (nW - 1)))
+            if (q && (j != 0) && (j != (nW - 1)))
             {
-                matDith.at<uint8_t>(i + 0, j + 1) = saturated_add(matDith.at<uint8_t>(i + 0, j + 1), a);
-                matDith.at<uint8_t>(i + 1, j + 1) = saturated_add(matDith.at<uint8_t>(i + 1, j + 1), b);
-                matDith.at<uint8_t>(i + 1, j + 0) = saturated_add(matDith.at<uint8_t>(i + 1, j + 0), c);
-                matDith.at<uint8_t>(i + 1, j - 1) = saturated_add(matDith.at<uint8_t>(i + 1, j - 1), d);
+                p[j + 1] = saturate_cast<uchar>(p[j + 1] + (err * 7) / 16);
+                q[j + 1] = saturate_cast<uchar>(q[j + 1] + (err * 1) / 16);
+                q[j + 0] = saturate_cast<uchar>(q[j + 0] + (err * 5) / 16);
+                q[j - 1] = saturate_cast<uchar>(q[j - 1] + (err * 3) / 16);
             }
         }
     }
 
-    // imshow("Raw Image", mat);
-    // imshow("Dithered Image", matDith);
-    // imwrite("F:/img/sdt.png", matDith);
-
     return matDith;
 }
 
-Mat imgProcess::setDither(const Mat& mat, double dScale, int nBright, int nType, int nAdjust, int nE)
+Mat imgProcess::setErrorDiffusion(const Mat& mat, DitherKernel eKernel, bool bSerpentine, int nThreshold)
 {
-    // Screw Ordered Dithering
-    int Mask0[] = { 64, 53, 42, 26, 27, 43, 54, 61,
-                   60, 41, 25, 14, 15, 28, 44, 55,
-                   52, 40, 13, 5, 6, 16, 29, 45,
-                   39, 24, 12, 1, 2, 7, 17, 30,
-                   38, 23, 11, 4, 3, 8, 18, 31,
-                   51, 37, 22, 10, 9, 19, 32, 41,
-                   59, 50, 36, 21, 20, 33, 47, 56,
-                   63, 58, 49, 35, 34, 48, 57, 62 };
-
-    // CoarseFatting Ordered Dithering
-    int Mask1[] = { 4, 14, 52, 58, 56, 45, 20, 6,
-                   16, 26, 38, 50, 48, 36, 28, 18,
-                   43, 35, 31, 9, 11, 25, 33, 41,
-                   61, 46, 23, 1, 3, 13, 55, 60,
-                   57, 47, 21, 7, 5, 15, 53, 59,
-                   49, 37, 29, 19, 17, 27, 39, 51,
-                   10, 24, 32, 40, 42, 34, 30, 8,
-                   2, 12, 54, 60, 51, 44, 22, 0 };
-
-    // 有序抖动算法 Bayer Ordered Dithering
-    int Mask2[] = { 0, 32, 8, 40, 2, 34, 10, 42,
-                   48, 16, 56, 42, 50, 18, 58, 26,
-                   12, 44, 4, 36, 14, 46, 6, 38,
-                   60, 28, 52, 20, 62, 30, 54, 22,
-                   3, 35, 11, 43, 1, 33, 9, 41,
-                   51, 19, 59, 27, 49, 17, 57, 25,
-                   15, 47, 7, 39, 13, 45, 5, 37,
-                   63, 31, 55, 23, 61, 29, 53, 21 };
-
-    // Halftone Ordered Dithering
-    int Mask3[] = { 28, 10, 18, 26, 36, 44, 52, 34,
-                   22, 2, 4, 12, 48, 58, 60, 42,
-                   14, 6, 0, 20, 40, 56, 62, 50,
-                   24, 16, 8, 30, 32, 54, 46, 38,
-                   37, 45, 53, 35, 29, 11, 19, 27,
-                   49, 59, 61, 43, 23, 3, 5, 13,
-                   41, 57, 63, 51, 15, 7, 1, 21,
-                   33, 55, 47, 39, 25, 17, 9, 31 };
-
-    // 12 * 12  大颗粒
-    int Mask4[] = { 144, 140, 132, 122, 107, 63, 54, 93, 106, 123, 133, 142,
-                   143, 137, 128, 104, 94, 41, 31, 65, 98, 116, 120, 139,
-                   135, 131, 114, 97, 61, 35, 24, 55, 80, 103, 113, 125,
-                   126, 117, 88, 83, 56, 29, 15, 51, 68, 90, 99, 111,
-                   109, 100, 81, 77, 48, 22, 8, 28, 47, 76, 85, 96,
-                   91, 44, 16, 12, 9, 3, 5, 21, 25, 33, 37, 73,
-                   59, 58, 30, 18, 10, 1, 2, 4, 11, 19, 34, 42,
-                   92, 64, 57, 52, 26, 6, 7, 14, 32, 46, 53, 74,
-                   101, 95, 70, 67, 38, 13, 20, 36, 50, 75, 82, 108,
-                   121, 110, 86, 78, 45, 17, 27, 39, 69, 79, 102, 119,
-                   134, 129, 112, 89, 49, 23, 43, 60, 71, 87, 115, 127,
-                   141, 138, 124, 118, 66, 40, 62, 72, 84, 105, 130, 136 };
-
-    // 16 * 16
-    int Mask5[] = { 0, 191, 48, 239, 12, 203, 60, 251, 3, 194, 51, 242, 15, 206, 63, 254,
-                   127, 64, 175, 112, 139, 76, 187, 124, 130, 67, 178, 115, 142, 79, 190, 127,
-                   32, 223, 16, 207, 44, 235, 28, 219, 35, 226, 19, 210, 47, 238, 31, 222,
-                   159, 96, 143, 80, 171, 108, 155, 92, 162, 99, 146, 83, 174, 111, 158, 95,
-                   8, 199, 56, 247, 4, 195, 52, 243, 11, 202, 59, 250, 7, 198, 55, 246,
-                   135, 72, 183, 120, 131, 68, 179, 116, 138, 75, 186, 123, 134, 71, 182, 119,
-                   40, 231, 24, 215, 36, 227, 20, 211, 43, 234, 27, 218, 39, 230, 23, 214,
-                   167, 104, 151, 88, 163, 100, 147, 84, 170, 107, 154, 91, 166, 103, 150, 87,
-                   2, 193, 50, 241, 14, 205, 62, 253, 1, 192, 49, 240, 13, 204, 61, 252,
-                   129, 66, 177, 114, 141, 78, 189, 126, 128, 65, 176, 113, 140, 77, 188, 125,
-                   34, 225, 18, 209, 46, 237, 30, 221, 33, 224, 17, 208, 45, 236, 29, 220,
-                   161, 98, 145, 82, 173, 110, 157, 94, 160, 97, 144, 81, 172, 109, 156, 93,
-                   10, 201, 58, 249, 6, 197, 54, 245, 9, 200, 57, 248, 5, 196, 53, 244,
-                   137, 74, 185, 122, 133, 70, 181, 118, 136, 73, 184, 121, 132, 69, 180, 117,
-                   42, 233, 26, 217, 38, 229, 22, 213, 41, 232, 25, 216, 37, 228, 21, 212,
-                   169, 106, 153, 90, 165, 102, 149, 86, 168, 105, 152, 89, 164, 101, 148, 85 };
-
-    // 9 * 9
-    int Mask6[] = {
-        53, 53, 54, 55, 56, 57, 58, 59, 60,
-        51, 27, 28, 29, 30, 31, 32, 33, 61,
-        50, 26, 10, 11, 12, 13, 14, 34, 62,
-        49, 25, 9, 1, 2, 3, 15, 35, 63,
-        80, 48, 24, 8, 0, 4, 16, 36, 64,
-        79, 47, 23, 7, 6, 5, 17, 37, 65,
-        78, 46, 22, 21, 20, 19, 18, 38, 66,
-        77, 45, 44, 43, 42, 41, 40, 39, 67,
-        76, 75, 74, 73, 72, 71, 70, 69, 68 };
-
-    Mat matOri = mat.clone();
-    Mat matTemp = setRotateImg(matOri, nE, true);
-
-    // -------------------------------------------------
-    Mat matTempx = matTemp.clone();
-    // 对原图像使用 GaussianBlur 降噪(内核大小 = 3)
-    GaussianBlur(matTempx, matTempx, Size(3, 3), 0, 0, BORDER_DEFAULT); // 高斯平滑
-
-    // ------------------------------------------------
-    // 锐化測試
-    GaussianBlur(matTemp, matTempx, Size(49, 49), 26);
-    addWeighted(matTempx, 1.0 + 3.0, matTempx, -3.0, 0, matTempx);
-
-    // imshow("Test", matTempx);
-    //  ------------------------------------------------
-
-    Mat src_gray;
-    /// 转换为灰度图
-    cvtColor(matTempx, src_gray, COLOR_RGB2GRAY);
-
-    /// 创建 grad_x 和 grad_y 矩阵
-    Mat grad_x, grad_y;
-    Mat abs_grad_x, abs_grad_y;
-
-    int scalex = 1;
-    int delta = 0;
-    int ddepth = CV_16S;
-
-    /// 求 X方向梯度
-    // Scharr( src_gray, grad_x, ddepth, 1, 0, scalex, delta, BORDER_DEFAULT );
-    Sobel(src_gray, grad_x, ddepth, 1, 0, 3, scalex, delta, BORDER_DEFAULT);
-    convertScaleAbs(grad_x, abs_grad_x);
-
-    /// 求Y方向梯度
-    // Scharr( src_gray, grad_y, ddepth, 0, 1, scalex, delta, BORDER_DEFAULT );
-    Sobel(src_gray, grad_y, ddepth, 0, 1, 3, scalex, delta, BORDER_DEFAULT);
-    convertScaleAbs(grad_y, abs_grad_y);
-
-    Mat gradEdge;
-    /// 合并梯度(近似) // addWeighted使用OpenCV对两幅图像求和(求混合(blending))
-    addWeighted(abs_grad_x, 0.5, abs_grad_y, 0.5, 0, gradEdge);
-
-    // imshow("Grad", grad);
-
-    // -------------------------------------------------
-
-    // mask
-
-    if (nType < 0)
-        nType *= -1;
-
-    if (mat.channels() < 3)
-        cvtColor(mat, matOri, COLOR_GRAY2BGR);
-
-    // Mat matTemp = matOri;
-    // matTemp = setRotateImg(matOri, nE, true);
-
-    Mat matGray = getGray(matTemp);
-
-    // Mat matSmooth;
-    // cvSmooth( matGray, matSmooth, CV_BLUR_NO_SCALE, 3, 0, 0, 0);
-
-    // for (int y = 0; y < matGray.rows; y++)
-    // {
-    //     for (int x = 0; x < matGray.cols; x++)
-    //     {
-    //     }
-    // }
-
-    // 混合
-    Mat matMix;
-    addWeighted(gradEdge, 0.5, matGray, 0.5, 0, matMix);
-    // imshow("matMix", matMix);
-
-    // matGray = setRotateImg(matMix, nE, true);
-
-    std::vector<int*> vecArr;
-    vecArr.emplace_back(Mask0);
-    vecArr.emplace_back(Mask1);
-    vecArr.emplace_back(Mask2);
-    vecArr.emplace_back(Mask3);
-    vecArr.emplace_back(Mask4);
-    vecArr.emplace_back(Mask5);
-    vecArr.emplace_back(Mask6);
-
-    if (dScale < 1)
-        dScale = 1;
-
-    if (dScale > 8)
-        dScale = 8;
-
-    int K = 8;
-    int L = 8;
-    int N = 63;
-
-    if (nType % 7 == 4)
-    {
-        K = 12;
-        L = 12;
-        N = 123;
-    }
-    else if (nType % 7 == 5)
-    {
-        K = 16;
-        L = 16;
-        N = 255;
-    }
-    else if (nType % 7 == 5)
-    {
-        K = 16;
-        L = 16;
-        N = 255;
-    }
-
-    Size dsize = Size(matGray.cols * dScale, matGray.rows * dScale);
-    Mat matGrayResize;
-    resize(matGray, matGrayResize, dsize);
-
-    uchar* p = nullptr;
-
-    int nW = matGrayResize.cols;
-    int nH = matGrayResize.rows;
-
-    for (int y = 0; y < nH; y++)
-    {
-        // p = matGray.ptr(y);//获取每行首地址
-
-        int k = y % K;
-
-        for (int x = 0; x < nW; x++)
-        {
-            int l = x % L;
+    assert(!mat.empty());
+    Mat matGray = getGray(mat);
+    return errorDiffusionDither(matGray, eKernel, bSerpentine, nThreshold);
+}
 
-            // float nPix = matGray.at<uint8_t>(Point(x / scale, y / scale)) / 255.0 * N + 0.5 + nAdjust * 0.1;
-            double dPix = matGray.at<uint8_t>(Point(x / dScale, y / dScale)) / 255.0 * N + 0.5 + nAdjust * 0.1;
-            // auto color = matGray.at<Vec3b>(Point(x,y));
-            // if(nPix > Mask[(k * L + l) % 64])
-            if (dPix > vecArr[nType % 7][(k * L + l)])
+Mat imgProcess::setDither(const Mat& mat, double dScale, int nBright, int nType, int nAdjust, int nE)
+{
+    assert(!mat.empty());
 
-                // if (nPix > Mask0[(k * L + l)])
-            {
-                matGrayResize.at<uint8_t>(Point(x, y)) = 255;
-                // p[x] = 255; //对灰度图像素操作赋值
-            }
-            else
-            {
-                matGrayResize.at<uint8_t>(Point(x, y)) = 0;
-                // p[x] = 0; //对灰度图像素操作赋值
-            }
-        }
-    }
+    // 阈值图块按 nType 选择, 放大与比较在 HalftoneScreen 中一次完成; 网角 nE 旋转的是阈值图块而不是图像
+    Mat matGray = getGray(mat);
+    Mat matScreen = screenOnRotatedCanvas(HalftoneScreen(nType, nAdjust), matGray, dScale, nE);
 
     Mat matOut;
-    cvtColor(matGrayResize, matOut, COLOR_GRAY2BGR);
-    Mat matOutX;
-    matOutX = setRotateImg(matOut, -1 * nE, true);
-
-    return matOutX;
+    cvtColor(matScreen, matOut, COLOR_GRAY2BGR);
+    return matOut;
 }
 
 // 镜像
 Mat imgProcess::setImgMirror(const Mat& mat, int type /*= 0*/)
 {
-    int row = mat.rows;
-    int col = mat.cols;
-    Mat matRes = mat.clone();
-    if (type % 2 == 0)
-    {
-        for (int i = 0; i < col; i++)
-            mat.col(col - 1 - i).copyTo(matRes.col(i));
-    }
-    else
-    {
-        for (int i = 0; i < row; i++)
-            mat.row(row - 1 - i).copyTo(matRes.row(i));
-    }
+    // 偶数左右镜像, 奇数上下镜像; 按行整段搬移, 不再逐列复制
+    Mat matRes;
+    GeoTransform().flip(type % 2 == 0 ? 1 : 0, mat.size()).apply(mat, matRes, mat.size());
 
     return matRes;
 }
@@ -1553,55 +1208,12 @@ Mat imgProcess::setColorReversal(const Mat& mat, int type /*= 0*/)
 
 Mat imgProcess::setColorTemperature(const Mat& mat, int nPercent)
 {
-    Mat matRes = mat.clone();
-    int row = matRes.rows;
-    int col = matRes.cols;
-    int level = nPercent * 0.1;
+    if (mat.type() != CV_8UC3)
+        return mat.clone();
 
-    for (int i = 0; i < row; ++i)
-    {
-        uchar* a = matRes.ptr<uchar>(i);
-        uchar* r = matRes.ptr<uchar>(i);
-
-        for (int j = 0; j < col; ++j)
-        {
-            int R, G, B;
-
-            // R通道
-            R = a[j * 3 + 2];
-            R = R + level;
-
-            if (R > 255)
-                r[j * 3 + 2] = 255;
-            else if (R < 0)
-                r[j * 3 + 2] = 0;
-            else
-                r[j * 3 + 2] = R;
-
-            // G通道
-            G = a[j * 3 + 1];
-            G = G + level;
-            if (G > 255)
-                r[j * 3 + 1] = 255;
-            else if (G < 0)
-                r[j * 3 + 1] = 0;
-            else
-                r[j * 3 + 1] = G;
-
-            // B通道
-            B = a[j * 3];
-            B = B - level;
-
-            if (B > 255)
-                r[j * 3] = 255;
-            else if (B < 0)
-                r[j * 3] = 0;
-            else
-                r[j * 3] = B;
-        }
-    }
-
-    return matRes;
+    // 红绿通道加 level, 蓝通道减 level
+    int level = nPercent * 0.1;
+    return offsetChannels(mat, -level, level, level);
 }
 
 // 美颜
@@ -1609,21 +1221,17 @@ Mat imgProcess::setBeautify(const Mat& mat, int nA, int nB)
 {
     int bilateralFilterVal = 30; // 双边模糊系数
 
-    Mat srcMat = mat.clone();
     double dA = nA * 0.1;
     // dA = 1.1;
     // nB = 68;
 
-    for (int y = 0; y < srcMat.rows; y++)
-    {
-        for (int x = 0; x < srcMat.cols; x++)
-        {
-            for (int c = 0; c < 3; c++)
-            {
-                srcMat.at<Vec3b>(y, x)[c] = saturate_cast<uchar>(dA * (srcMat.at<Vec3b>(y, x)[c]) + nB);
-            }
-        }
-    }
+    // 线性调节只与通道值有关, 查表
+    Mat matLut(1, 256, CV_8U);
+    for (int i = 0; i < 256; i++)
+        matLut.at<uchar>(i) = saturate_cast<uchar>(dA * i + nB);
+
+    Mat srcMat;
+    LUT(mat, matLut, srcMat);
 
     Mat matResult;
     GaussianBlur(srcMat, srcMat, Size(9, 9), 0, 0);        // 高斯模糊,消除椒盐噪声
@@ -1641,115 +1249,24 @@ Mat imgProcess::setBeautify(const Mat& mat, int nA, int nB)
 // 自动白平衡
 Mat imgProcess::setAutoWhithBalance(const Mat& mat, double dA, double dB, double dC)
 {
-    int nRow = mat.rows;
-    int nCol = mat.cols;
-    Mat dst(nRow, nCol, CV_8UC3);
-    int HistRGB[767] = { 0 };
-    int nMaxVal = 0;
+    if (mat.type() != CV_8UC3)
+        return mat.clone();
 
-    for (int i = 0; i < nRow; i++)
-    {
-        for (int j = 0; j < nCol; j++)
-        {
-            nMaxVal = max(nMaxVal, (int)mat.at<Vec3b>(i, j)[0]);
-            nMaxVal = max(nMaxVal, (int)mat.at<Vec3b>(i, j)[1]);
-            nMaxVal = max(nMaxVal, (int)mat.at<Vec3b>(i, j)[2]);
-            int sum = mat.at<Vec3b>(i, j)[0] + mat.at<Vec3b>(i, j)[1] + mat.at<Vec3b>(i, j)[2];
-            HistRGB[sum]++;
-        }
-    }
-
-    int Threshold = 0;
-    int sum = 0;
-    for (int i = 766; i >= 0; i--)
-    {
-        sum += HistRGB[i];
-        if (sum > nRow * nCol * 0.1)
-        {
-            Threshold = i;
-            break;
-        }
-    }
-
-    int AvgB = 0;
-    int AvgG = 0;
-    int AvgR = 0;
-    int cnt = 0;
-    for (int i = 0; i < nRow; i++)
-    {
-        for (int j = 0; j < nCol; j++)
-        {
-            int sumP = mat.at<Vec3b>(i, j)[0] + mat.at<Vec3b>(i, j)[1] + mat.at<Vec3b>(i, j)[2];
-            if (sumP > Threshold)
-            {
-                AvgB += mat.at<Vec3b>(i, j)[0];
-                AvgG += mat.at<Vec3b>(i, j)[1];
-                AvgR += mat.at<Vec3b>(i, j)[2];
-                cnt++;
-            }
-        }
-    }
-
-    AvgB /= cnt;
-    AvgG /= cnt;
-    AvgR /= cnt;
-    for (int i = 0; i < nRow; i++)
-    {
-        for (int j = 0; j < nCol; j++)
-        {
-            int Blue = mat.at<Vec3b>(i, j)[0] * nMaxVal / AvgB;
-            int Green = mat.at<Vec3b>(i, j)[1] * nMaxVal / AvgG;
-            int Red = mat.at<Vec3b>(i, j)[2] * nMaxVal / AvgR;
-            if (Red > 255)
-                Red = 255;
-            else if (Red < 0)
-                Red = 0;
-
-            if (Green > 255)
-                Green = 255;
-            else if (Green < 0)
-                Green = 0;
-
-            if (Blue > 255)
-                Blue = 255;
-            else if (Blue < 0)
-                Blue = 0;
-
-            dst.at<Vec3b>(i, j)[0] = Blue;
-            dst.at<Vec3b>(i, j)[1] = Green;
-            dst.at<Vec3b>(i, j)[2] = Red;
-        }
-    }
-
-    return dst;
+    return autoWhiteBalance(mat);
 }
 
 Mat imgProcess::setColorReplace(const Mat& mat, int nR, int nG, int nB)
 {
-    int iterations = 5;
-    Point anchor;
-    Mat grayImage;
-    Mat threshImage;
-    Mat dilatedImage;
-    vector<vector<Point>> contours;
-    vector<Vec4i> hierarchy;
-
-    cvtColor(mat, grayImage, COLOR_RGB2GRAY);
-    threshold(grayImage, threshImage, 150, 255, THRESH_BINARY_INV);
-    Mat element = getStructuringElement(MORPH_CROSS, Size(3, 3));
-    dilate(threshImage, dilatedImage, element, anchor = Point(-1, -1), iterations);
-    findContours(dilatedImage, contours, hierarchy, RETR_EXTERNAL, CHAIN_APPROX_NONE, Point(0, 0));
-
-    vector<Rect> boundRect(contours.size());
-
-    for (int contour = 0; contour < contours.size(); contour++)
-    {
-        boundRect[contour] = boundingRect(contours[contour]);
-        rectangle(dilatedImage, boundRect[contour].tl(), boundRect[contour].br(), (255, 0, 255), 2);
-    }
+    Mat matBgr;
+    if (mat.channels() < 3)
+        cvtColor(mat, matBgr, COLOR_GRAY2BGR);
+    else if (mat.channels() == 4)
+        cvtColor(mat, matBgr, COLOR_BGRA2BGR);
+    else
+        matBgr = mat;
 
-    // imshow("Contours", dilatedImage);
-    return dilatedImage;
+    // 深色内容 (各通道都低于 150) 换成指定颜色
+    return replaceColor(matBgr, Vec3b(0, 0, 0), 149, Vec3b(saturate_cast<uchar>(nB), saturate_cast<uchar>(nG), saturate_cast<uchar>(nR)));
 }
 
 Mat imgProcess::drawLaserLine(const Mat& mat, double dA, double dB, double dC)
@@ -2137,236 +1654,9 @@ Mat imgProcess::setImgEdgePaperEffect(const Mat& mat, double dLineInterval, doub
 
     imshow("Edge Strong", matRes);
 
-    Mat matOri = matRes.clone();
-
-    // Screw Ordered Dithering
-    int Mask0[] = { 64, 53, 42, 26, 27, 43, 54, 61,
-                   60, 41, 25, 14, 15, 28, 44, 55,
-                   52, 40, 13, 5, 6, 16, 29, 45,
-                   39, 24, 12, 1, 2, 7, 17, 30,
-                   38, 23, 11, 4, 3, 8, 18, 31,
-                   51, 37, 22, 10, 9, 19, 32, 41,
-                   59, 50, 36, 21, 20, 33, 47, 56,
-                   63, 58, 49, 35, 34, 48, 57, 62 };
-
-    // CoarseFatting Ordered Dithering
-    int Mask1[] = { 4, 14, 52, 58, 56, 45, 20, 6,
-                   16, 26, 38, 50, 48, 36, 28, 18,
-                   43, 35, 31, 9, 11, 25, 33, 41,
-                   61, 46, 23, 1, 3, 13, 55, 60,
-                   57, 47, 21, 7, 5, 15, 53, 59,
-                   49, 37, 29, 19, 17, 27, 39, 51,
-                   10, 24, 32, 40, 42, 34, 30, 8,
-                   2, 12, 54, 60, 51, 44, 22, 0 };
-
-    // 有序抖动算法 Bayer Ordered Dithering
-    int Mask2[] = { 0, 32, 8, 40, 2, 34, 10, 42,
-                   48, 16, 56, 42, 50, 18, 58, 26,
-                   12, 44, 4, 36, 14, 46, 6, 38,
-                   60, 28, 52, 20, 62, 30, 54, 22,
-                   3, 35, 11, 43, 1, 33, 9, 41,
-                   51, 19, 59, 27, 49, 17, 57, 25,
-                   15, 47, 7, 39, 13, 45, 5, 37,
-                   63, 31, 55, 23, 61, 29, 53, 21 };
-
-    // Halftone Ordered Dithering
-    int Mask3[] = { 28, 10, 18, 26, 36, 44, 52, 34,
-                   22, 2, 4, 12, 48, 58, 60, 42,
-                   14, 6, 0, 20, 40, 56, 62, 50,
-                   24, 16, 8, 30, 32, 54, 46, 38,
-                   37, 45, 53, 35, 29, 11, 19, 27,
-                   49, 59, 61, 43, 23, 3, 5, 13,
-                   41, 57, 63, 51, 15, 7, 1, 21,
-                   33, 55, 47, 39, 25, 17, 9, 31 };
-
-    // 12 * 12  大颗粒
-    int Mask4[] = { 144, 140, 132, 122, 107, 63, 54, 93, 106, 123, 133, 142,
-                   143, 137, 128, 104, 94, 41, 31, 65, 98, 116, 120, 139,
-                   135, 131, 114, 97, 61, 35, 24, 55, 80, 103, 113, 125,
-                   126, 117, 88, 83, 56, 29, 15, 51, 68, 90, 99, 111,
-                   109, 100, 81, 77, 48, 22, 8, 28, 47, 76, 85, 96,
-                   91, 44, 16, 12, 9, 3, 5, 21, 25, 33, 37, 73,
-                   59, 58, 30, 18, 10, 1, 2, 4, 11, 19, 34, 42,
-                   92, 64, 57, 52, 26, 6, 7, 14, 32, 46, 53, 74,
-                   101, 95, 70, 67, 38, 13, 20, 36, 50, 75, 82, 108,
-                   121, 110, 86, 78, 45, 17, 27, 39, 69, 79, 102, 119,
-                   134, 129, 112, 89, 49, 23, 43, 60, 71, 87, 115, 127,
-                   141, 138, 124, 118, 66, 40, 62, 72, 84, 105, 130, 136 };
-
-    // 16 * 16
-    int Mask5[] = { 0, 191, 48, 239, 12, 203, 60, 251, 3, 194, 51, 242, 15, 206, 63, 254,
-                   127, 64, 175, 112, 139, 76, 187, 124, 130, 67, 178, 115, 142, 79, 190, 127,
-                   32, 223, 16, 207, 44, 235, 28, 219, 35, 226, 19, 210, 47, 238, 31, 222,
-                   159, 96, 143, 80, 171, 108, 155, 92, 162, 99, 146, 83, 174, 111, 158, 95,
-                   8, 199, 56, 247, 4, 195, 52, 243, 11, 202, 59, 250, 7, 198, 55, 246,
-                   135, 72, 183, 120, 131, 68, 179, 116, 138, 75, 186, 123, 134, 71, 182, 119,
-                   40, 231, 24, 215, 36, 227, 20, 211, 43, 234, 27, 218, 39, 230, 23, 214,
-                   167, 104, 151, 88, 163, 100, 147, 84, 170, 107, 154, 91, 166, 103, 150, 87,
-                   2, 193, 50, 241, 14, 205, 62, 253, 1, 192, 49, 240, 13, 204, 61, 252,
-                   129, 66, 177, 114, 141, 78, 189, 126, 128, 65, 176, 113, 140, 77, 188, 125,
-                   34, 225, 18, 209, 46, 237, 30, 221, 33, 224, 17, 208, 45, 236, 29, 220,
-                   161, 98, 145, 82, 173, 110, 157, 94, 160, 97, 144, 81, 172, 109, 156, 93,
-                   10, 201, 58, 249, 6, 197, 54, 245, 9, 200, 57, 248, 5, 196, 53, 244,
-                   137, 74, 185, 122, 133, 70, 181, 118, 136, 73, 184, 121, 132, 69, 180, 117,
-                   42, 233, 26, 217, 38, 229, 22, 213, 41, 232, 25, 216, 37, 228, 21, 212,
-                   169, 106, 153, 90, 165, 102, 149, 86, 168, 105, 152, 89, 164, 101, 148, 85 };
-
-    // 9 * 9
-    int Mask6[] = {
-        53, 53, 54, 55, 56, 57, 58, 59, 60,
-        51, 27, 28, 29, 30, 31, 32, 33, 61,
-        50, 26, 10, 11, 12, 13, 14, 34, 62,
-        49, 25, 9, 1, 2, 3, 15, 35, 63,
-        80, 48, 24, 8, 0, 4, 16, 36, 64,
-        79, 47, 23, 7, 6, 5, 17, 37, 65,
-        78, 46, 22, 21, 20, 19, 18, 38, 66,
-        77, 45, 44, 43, 42, 41, 40, 39, 67,
-        76, 75, 74, 73, 72, 71, 70, 69, 68 };
-
-    Mat matTemp = setRotateImg(matOri, dAngle, true);
-
-    // -------------------------------------------------
-    Mat matTempx = matTemp.clone();
-    // 对原图像使用 GaussianBlur 降噪(内核大小 = 3)
-    GaussianBlur(matTempx, matTempx, Size(3, 3), 0, 0, BORDER_DEFAULT); // 高斯平滑
-
-    // ------------------------------------------------
-    // 锐化測試
-    GaussianBlur(matTemp, matTempx, Size(49, 49), 26);
-    addWeighted(matTempx, 1.0 + 3.0, matTempx, -3.0, 0, matTempx);
-
-    // imshow("Test", matTempx);
-    //  ------------------------------------------------
-
-    Mat src_gray;
-    /// 转换为灰度图
-    cvtColor(matTempx, src_gray, COLOR_RGB2GRAY);
-
-    /// 创建 grad_x 和 grad_y 矩阵
-    Mat grad_x, grad_y;
-    Mat abs_grad_x, abs_grad_y;
-
-    int scalex = 1;
-    int delta = 0;
-    int ddepth = CV_16S;
-
-    // 求 X方向梯度
-    // Scharr( src_gray, grad_x, ddepth, 1, 0, scalex, delta, BORDER_DEFAULT );
-    Sobel(src_gray, grad_x, ddepth, 1, 0, 3, scalex, delta, BORDER_DEFAULT);
-    convertScaleAbs(grad_x, abs_grad_x);
-
-    // 求Y方向梯度
-    // Scharr( src_gray, grad_y, ddepth, 0, 1, scalex, delta, BORDER_DEFAULT );
-    Sobel(src_gray, grad_y, ddepth, 0, 1, 3, scalex, delta, BORDER_DEFAULT);
-    convertScaleAbs(grad_y, abs_grad_y);
-
-    Mat gradEdge;
-    // 合并梯度(近似) // addWeighted使用OpenCV对两幅图像求和(求混合(blending))
-    addWeighted(abs_grad_x, 0.5, abs_grad_y, 0.5, 0, gradEdge);
-
-    // imshow("Grad", grad);
-
-    // -------------------------------------------------
-
-    // mask
-
-    if (nType < 0)
-        nType *= -1;
-
-    if (mat.channels() < 3)
-        cvtColor(mat, matOri, COLOR_GRAY2BGR);
-
-    // Mat matTemp = matOri;
-    // matTemp = setRotateImg(matOri, nE, true);
-
-    Mat matGray = getGray(matTemp);
-
-    // Mat matSmooth;
-    // cvSmooth( matGray, matSmooth, CV_BLUR_NO_SCALE, 3, 0, 0, 0);
-
-    // for (int y = 0; y < matGray.rows; y++)
-    // {
-    //     for (int x = 0; x < matGray.cols; x++)
-    //     {
-    //     }
-    // }
-
-    // 混合
-    Mat matMix;
-    addWeighted(gradEdge, 0.5, matGray, 0.5, 0, matMix);
-    // imshow("matMix", matMix);
-    // matGray = setRotateImg(matMix, nE, true);
-
-    std::vector<int*> vecArr;
-    vecArr.emplace_back(Mask0);
-    vecArr.emplace_back(Mask1);
-    vecArr.emplace_back(Mask2);
-    vecArr.emplace_back(Mask3);
-    vecArr.emplace_back(Mask4);
-    vecArr.emplace_back(Mask5);
-    vecArr.emplace_back(Mask6);
-
-    if (dDPI < 1)
-        dDPI = 1;
-
-    if (dDPI > 8)
-        dDPI = 8;
-
-    int K = 8;
-    int L = 8;
-    int N = 63;
-
-    if (nType % 7 == 4)
-    {
-        K = 12;
-        L = 12;
-        N = 123;
-    }
-    else if (nType % 7 == 5)
-    {
-        K = 16;
-        L = 16;
-        N = 255;
-    }
-    else if (nType % 7 == 5)
-    {
-        K = 16;
-        L = 16;
-        N = 255;
-    }
-
-    Size dsize = Size(matGray.cols * dDPI, matGray.rows * dDPI);
-    Mat matGrayResize;
-    resize(matGray, matGrayResize, dsize);
-
-    int nW = matGrayResize.cols;
-    int nH = matGrayResize.rows;
-
-    for (int y = 0; y < nH; y++)
-    {
-        int k = y % K;
-
-        for (int x = 0; x < nW; x++)
-        {
-            int l = x % L;
-
-            double dPix = matGray.at<uint8_t>(Point(x / dDPI, y / dDPI)) / 255.0 * N + 0.5 + nAdjust * 0.1;
-
-            if (dPix > vecArr[nType % 7][(k * L + l)])
-            {
-                matGrayResize.at<uint8_t>(Point(x, y)) = 255;
-            }
-            else
-            {
-                matGrayResize.at<uint8_t>(Point(x, y)) = 0;
-            }
-        }
-    }
+    Mat matScreen = screenOnRotatedCanvas(HalftoneScreen(nType, nAdjust), getGray(matRes), dDPI, dAngle);
 
     Mat matOut;
-    cvtColor(matGrayResize, matOut, COLOR_GRAY2BGR);
-    Mat matOutX;
-    matOutX = setRotateImg(matOut, -1.0 * dAngle, true);
-
-    return matOutX;
+    cvtColor(matScreen, matOut, COLOR_GRAY2BGR);
+    return matOut;
 }
\ No newline at end of file
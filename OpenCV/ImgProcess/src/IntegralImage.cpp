@@ -0,0 +1,185 @@
+#include "IntegralImage.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace ImgSpace
+{
+    namespace
+    {
+        // BORDER_REFLECT_101 (与 cv::borderInterpolate 相同)
+        int reflect101(int p, int nLen)
+        {
+            if (nLen == 1)
+                return 0;
+            while (p < 0 || p >= nLen)
+                p = p < 0 ? -p : 2 * nLen - 2 - p;
+            return p;
+        }
+    }
+
+    void IntegralImage::compute(const cv::Mat &mat, cv::Rect rect)
+    {
+        CV_Assert(mat.depth() == CV_8U && mat.channels() <= 4 && !mat.empty() && rect.width > 0 && rect.height > 0);
+
+        m_rect = rect;
+        m_nChannels = mat.channels();
+        m_nStride = static_cast<size_t>(rect.width + 1) * m_nChannels;
+        m_vSum.resize((rect.height + 1) * m_nStride); // 重复建表时复用内存
+        std::fill_n(m_vSum.begin(), m_nStride, 0u);
+
+        // 坐标换算到 ROI 所在整图后补边, 再换回相对 mat 的偏移
+        cv::Size sizeWhole;
+        cv::Point ptOfs;
+        mat.locateROI(sizeWhole, ptOfs);
+
+        std::vector<int> vCol(rect.width);
+        for (int i = 0; i < rect.width; i++)
+            vCol[i] = (reflect101(rect.x + i + ptOfs.x, sizeWhole.width) - ptOfs.x) * m_nChannels;
+
+        for (int r = 0; r < rect.height; r++)
+        {
+            const int y = reflect101(rect.y + r + ptOfs.y, sizeWhole.height) - ptOfs.y;
+            const uchar *pSrc = mat.data + static_cast<ptrdiff_t>(y) * static_cast<ptrdiff_t>(mat.step);
+            const uint32_t *pAbove = m_vSum.data() + r * m_nStride;
+            uint32_t *pCur = m_vSum.data() + (r + 1) * m_nStride;
+
+            if (m_nChannels == 1)
+            {
+                uint32_t nRun = 0;
+                pCur[0] = 0;
+                for (int i = 0; i < rect.width; i++)
+                {
+                    nRun += pSrc[vCol[i]];
+                    pCur[i + 1] = pAbove[i + 1] + nRun;
+                }
+            }
+            else if (m_nChannels == 3)
+            {
+                uint32_t nRun0 = 0, nRun1 = 0, nRun2 = 0;
+                pCur[0] = pCur[1] = pCur[2] = 0;
+                for (int i = 0; i < rect.width; i++)
+                {
+                    const uchar *p = pSrc + vCol[i];
+                    const int k = (i + 1) * 3;
+                    nRun0 += p[0];
+                    nRun1 += p[1];
+                    nRun2 += p[2];
+                    pCur[k] = pAbove[k] + nRun0;
+                    pCur[k + 1] = pAbove[k + 1] + nRun1;
+                    pCur[k + 2] = pAbove[k + 2] + nRun2;
+                }
+            }
+            else
+            {
+                uint32_t arrRun[4] = { 0, 0, 0, 0 };
+                std::fill_n(pCur, m_nChannels, 0u);
+                for (int i = 0; i < rect.width; i++)
+                {
+                    const uchar *p = pSrc + vCol[i];
+                    const int k = (i + 1) * m_nChannels;
+                    for (int c = 0; c < m_nChannels; c++)
+                    {
+                        arrRun[c] += p[c];
+                        pCur[k + c] = pAbove[k + c] + arrRun[c];
+                    }
+                }
+            }
+        }
+    }
+
+    void boxBlur(const cv::Mat &mat, cv::Mat &matDst, cv::Size ksize, cv::Range rangeRows)
+    {
+        CV_Assert(mat.depth() == CV_8U && mat.channels() <= 4 && ksize.width > 0 && ksize.height > 0);
+        CV_Assert(static_cast<double>(ksize.width) * ksize.height * 255 < 4294967296.0);
+
+        if (rangeRows == cv::Range::all())
+            rangeRows = cv::Range(0, mat.rows);
+        matDst.create(rangeRows.size(), mat.cols, mat.type());
+        if (matDst.empty())
+            return;
+
+        const int nAnchorX = ksize.width / 2;
+        const int nAnchorY = ksize.height / 2;
+        const int nLen = mat.cols * mat.channels();
+        const int nSpan = ksize.width * mat.channels();
+        const double dScale = 1.0 / (static_cast<double>(ksize.width) * ksize.height);
+
+        // 条带至少与核一样高, 多建的 核高 - 1 行积分图占比不超过一半
+        const int nStrip = std::max(32, ksize.height);
+        const int nStrips = (rangeRows.size() + nStrip - 1) / nStrip;
+
+        cv::parallel_for_(cv::Range(0, nStrips), [&](const cv::Range &range) {
+            IntegralImage sat;
+            for (int s = range.start; s < range.end; s++)
+            {
+                const int nY0 = rangeRows.start + s * nStrip;
+                const int nY1 = std::min(rangeRows.end, nY0 + nStrip);
+                sat.compute(mat, cv::Rect(-nAnchorX, nY0 - nAnchorY, mat.cols + ksize.width - 1, nY1 - nY0 + ksize.height - 1));
+
+                for (int y = nY0; y < nY1; y++)
+                {
+                    // 积分图从 x = -nAnchorX 开始, 第 x 列窗口的左边界正好是积分图的第 x 列, 各通道交错存放, 按字节下标直接对应
+                    const uint32_t *pTop = sat.row(y - nAnchorY);
+                    const uint32_t *pBottom = sat.row(y - nAnchorY + ksize.height);
+                    uchar *pDst = matDst.ptr<uchar>(y - rangeRows.start);
+                    for (int i = 0; i < nLen; i++)
+                    {
+                        const uint32_t nSum = pBottom[i + nSpan] - pBottom[i] - pTop[i + nSpan] + pTop[i];
+                        pDst[i] = cv::saturate_cast<uchar>(nSum * dScale);
+                    }
+                }
+            }
+        });
+    }
+
+    cv::Mat mosaicBlocks(const cv::Mat &matBgr, int nBlock, bool bAverage)
+    {
+        CV_Assert(matBgr.type() == CV_8UC3 && nBlock > 0);
+
+        const int nW = matBgr.cols;
+        const int nH = matBgr.rows;
+        cv::Mat matRes(matBgr.size(), CV_8UC3);
+        if (matRes.empty())
+            return matRes;
+
+        // 每个块行先拼出一行颜色, 再整行复制到块行内的各行
+        cv::parallel_for_(cv::Range(0, (nH + nBlock - 1) / nBlock), [&](const cv::Range &range) {
+            IntegralImage sat;
+            std::vector<uchar> vRow(static_cast<size_t>(nW) * 3);
+
+            for (int b = range.start; b < range.end; b++)
+            {
+                const int nY0 = b * nBlock;
+                const int nRows = std::min(nBlock, nH - nY0);
+                if (bAverage)
+                    sat.compute(matBgr, cv::Rect(0, nY0, nW, nRows));
+
+                for (int nX0 = 0; nX0 < nW; nX0 += nBlock)
+                {
+                    const int nCols = std::min(nBlock, nW - nX0);
+                    uchar arrColor[3];
+                    if (bAverage)
+                    {
+                        const cv::Rect rect(nX0, nY0, nCols, nRows);
+                        const double dScale = 1.0 / rect.area();
+                        for (int c = 0; c < 3; c++)
+                            arrColor[c] = cv::saturate_cast<uchar>(sat.sum(rect, c) * dScale);
+                    }
+                    else
+                    {
+                        memcpy(arrColor, matBgr.ptr<uchar>(nY0) + nX0 * 3, 3);
+                    }
+
+                    for (int x = nX0; x < nX0 + nCols; x++)
+                        memcpy(&vRow[x * 3], arrColor, 3);
+                }
+
+                for (int y = nY0; y < nY0 + nRows; y++)
+                    memcpy(matRes.ptr<uchar>(y), vRow.data(), vRow.size());
+            }
+        });
+
+        return matRes;
+    }
+}
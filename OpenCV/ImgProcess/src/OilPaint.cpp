@@ -0,0 +1,160 @@
+#include "OilPaint.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace ImgSpace
+{
+    namespace
+    {
+        /**
+         * @description: 窗口内各灰度等级的像素数与 BGR 累加和
+         */
+        struct OilPaintHist
+        {
+            // 计数与三个通道的累加和放在一起, 一次更新只触及一条缓存行
+            struct Bin
+            {
+                int nCount;
+                uint nBlue;
+                uint nGreen;
+                uint nRed;
+            };
+            std::vector<Bin> vBins;
+
+            int nMaxIdx = 0;        // 像素最多的等级 (并列时取最小等级, 与原实现相同)
+            bool bMaxDirty = true;  // 最大等级被减少后需重新扫描
+
+            explicit OilPaintHist(int nLen)
+                : vBins(nLen)
+            {
+            }
+
+            void reset()
+            {
+                std::fill(vBins.begin(), vBins.end(), Bin{ 0, 0u, 0u, 0u });
+                nMaxIdx = 0;
+                bMaxDirty = true;
+            }
+
+            void add(int nLevel, const uchar *pBgr)
+            {
+                Bin &bin = vBins[nLevel];
+                int nCount = ++bin.nCount;
+                bin.nBlue += pBgr[0];
+                bin.nGreen += pBgr[1];
+                bin.nRed += pBgr[2];
+
+                if (!bMaxDirty && (nCount > vBins[nMaxIdx].nCount || (nCount == vBins[nMaxIdx].nCount && nLevel < nMaxIdx)))
+                    nMaxIdx = nLevel;
+            }
+
+            void remove(int nLevel, const uchar *pBgr)
+            {
+                Bin &bin = vBins[nLevel];
+                --bin.nCount;
+                bin.nBlue -= pBgr[0];
+                bin.nGreen -= pBgr[1];
+                bin.nRed -= pBgr[2];
+
+                if (nLevel == nMaxIdx)
+                    bMaxDirty = true;
+            }
+
+            const Bin &maxBin()
+            {
+                if (bMaxDirty)
+                {
+                    nMaxIdx = 0;
+                    int nMax = vBins[0].nCount;
+                    for (int i = 1; i < static_cast<int>(vBins.size()); i++)
+                    {
+                        if (vBins[i].nCount > nMax)
+                        {
+                            nMaxIdx = i;
+                            nMax = vBins[i].nCount;
+                        }
+                    }
+                    bMaxDirty = false;
+                }
+                return vBins[nMaxIdx];
+            }
+        };
+    }
+
+    cv::Mat oilPaintSliding(const cv::Mat &mat, const cv::Mat &matGray, int nBrushSize, int nCoarseness)
+    {
+        CV_Assert(mat.type() == CV_8UC3 && matGray.type() == CV_8UC1 && mat.size() == matGray.size());
+        CV_Assert(mat.cols >= 2 && mat.rows >= 2);
+
+        const int nW = mat.cols;
+        const int nH = mat.rows;
+        const int nLenArray = nCoarseness + 1;
+
+        // 灰度 -> 等级, 与原实现的逐像素计算相同
+        uchar arrLevel[256];
+        for (int i = 0; i < 256; i++)
+            arrLevel[i] = static_cast<uchar>(nCoarseness * i / 255.0);
+
+        cv::Mat matLevel(nH, nW, CV_8UC1);
+        for (int nY = 0; nY < nH; nY++)
+        {
+            const uchar *pGray = matGray.ptr<uchar>(nY);
+            uchar *pLevel = matLevel.ptr<uchar>(nY);
+            for (int nX = 0; nX < nW; nX++)
+                pLevel[nX] = arrLevel[pGray[nX]];
+        }
+
+        cv::Mat matRes(mat.size(), mat.type());
+
+        // 窗口结束位置 (不含): 超出或触及边界时为 边长 - 1
+        auto windowEnd = [nBrushSize](int n, int nLen) {
+            int nEnd = n + nBrushSize + 1;
+            return nEnd >= nLen ? nLen - 1 : nEnd;
+        };
+
+        cv::parallel_for_(cv::Range(0, nH), [&](const cv::Range &range) {
+            OilPaintHist hist(nLenArray);
+
+            for (int nY = range.start; nY < range.end; nY++)
+            {
+                const int nTop = std::max(0, nY - nBrushSize);
+                const int nBottom = windowEnd(nY, nH);
+
+                // 加入 / 移出第 nX 列在 [nTop, nBottom) 内的像素
+                auto addColumn = [&](int nX) {
+                    for (int j = nTop; j < nBottom; j++)
+                        hist.add(matLevel.ptr<uchar>(j)[nX], mat.ptr<uchar>(j) + nX * 3);
+                };
+                auto removeColumn = [&](int nX) {
+                    for (int j = nTop; j < nBottom; j++)
+                        hist.remove(matLevel.ptr<uchar>(j)[nX], mat.ptr<uchar>(j) + nX * 3);
+                };
+
+                hist.reset();
+                int nCurLeft = 0;
+                int nCurRight = 0;
+
+                uchar *pRes = matRes.ptr<uchar>(nY);
+                for (int nX = 0; nX < nW; nX++)
+                {
+                    const int nLeft = std::max(0, nX - nBrushSize);
+                    const int nRight = windowEnd(nX, nW);
+
+                    for (; nCurRight < nRight; nCurRight++)
+                        addColumn(nCurRight);
+                    for (; nCurLeft < nLeft; nCurLeft++)
+                        removeColumn(nCurLeft);
+
+                    const OilPaintHist::Bin &bin = hist.maxBin();
+                    const float fCount = static_cast<float>(bin.nCount);
+                    pRes[nX * 3 + 2] = static_cast<uchar>(bin.nRed / fCount);
+                    pRes[nX * 3 + 1] = static_cast<uchar>(bin.nGreen / fCount);
+                    pRes[nX * 3 + 0] = static_cast<uchar>(bin.nBlue / fCount);
+                }
+            }
+        });
+
+        return matRes;
+    }
+}
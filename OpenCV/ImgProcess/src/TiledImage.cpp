@@ -0,0 +1,443 @@
+#include "TiledImage.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace ImgSpace
+{
+    namespace
+    {
+        const char FILE_MAGIC[8] = { 'I', 'M', 'G', 'T', 'I', 'L', 'E', '1' };
+        const size_t HEADER_BYTES = 65536;  // 文件头占一个对齐单位, 块从对齐位置开始
+        const size_t ALIGN_BYTES = 65536;   // Windows 映射偏移须是分配粒度 (64KB) 的整数倍, 同时满足 POSIX 页对齐
+
+        struct FileHeader
+        {
+            char arrMagic[8];
+            int32_t nWidth;
+            int32_t nHeight;
+            int32_t nType;
+            int32_t nTile;
+        };
+
+#ifdef _WIN32
+        struct FileHandle
+        {
+            HANDLE hFile = INVALID_HANDLE_VALUE;
+            HANDLE hMap = nullptr;
+
+            ~FileHandle()
+            {
+                if (hMap)
+                    CloseHandle(hMap);
+                if (hFile != INVALID_HANDLE_VALUE)
+                    CloseHandle(hFile);
+            }
+        };
+#else
+        struct FileHandle
+        {
+            int nFd = -1;
+
+            ~FileHandle()
+            {
+                if (nFd >= 0)
+                    ::close(nFd);
+            }
+        };
+#endif
+
+        std::atomic<uint64_t> g_nNextId{ 1 };
+
+        size_t slotBytes(int nTile, int nType)
+        {
+            const size_t nBytes = static_cast<size_t>(nTile) * nTile * CV_ELEM_SIZE(nType);
+            return (nBytes + ALIGN_BYTES - 1) / ALIGN_BYTES * ALIGN_BYTES;
+        }
+
+        // 打开文件并建立映射对象 (Windows), bCreate 时按 nFileBytes 建立新文件并写入 header
+        std::shared_ptr<FileHandle> openFile(const std::string &strPath, bool bWrite, bool bCreate, FileHeader &header, uint64_t nFileBytes)
+        {
+            auto pFile = std::make_shared<FileHandle>();
+#ifdef _WIN32
+            pFile->hFile = CreateFileA(strPath.c_str(), bWrite ? (GENERIC_READ | GENERIC_WRITE) : GENERIC_READ, FILE_SHARE_READ,
+                                       nullptr, bCreate ? CREATE_ALWAYS : OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+            if (pFile->hFile == INVALID_HANDLE_VALUE)
+                return nullptr;
+
+            DWORD nDone = 0;
+            if (bCreate)
+            {
+                std::vector<char> vHeader(HEADER_BYTES, 0);
+                memcpy(vHeader.data(), &header, sizeof(header));
+                if (!WriteFile(pFile->hFile, vHeader.data(), static_cast<DWORD>(vHeader.size()), &nDone, nullptr) || nDone != vHeader.size())
+                    return nullptr;
+            }
+            else if (!ReadFile(pFile->hFile, &header, sizeof(header), &nDone, nullptr) || nDone != sizeof(header))
+            {
+                return nullptr;
+            }
+
+            // 建立新文件时映射对象的大小即文件大小, 未写过的部分为 0
+            pFile->hMap = CreateFileMappingA(pFile->hFile, nullptr, bWrite ? PAGE_READWRITE : PAGE_READONLY,
+                                             bCreate ? static_cast<DWORD>(nFileBytes >> 32) : 0,
+                                             bCreate ? static_cast<DWORD>(nFileBytes & 0xFFFFFFFFu) : 0, nullptr);
+            if (!pFile->hMap)
+                return nullptr;
+#else
+            pFile->nFd = ::open(strPath.c_str(), bCreate ? (O_RDWR | O_CREAT | O_TRUNC) : (bWrite ? O_RDWR : O_RDONLY), 0644);
+            if (pFile->nFd < 0)
+                return nullptr;
+
+            if (bCreate)
+            {
+                // 稀疏文件, 未写过的块读出为 0
+                if (ftruncate(pFile->nFd, static_cast<off_t>(nFileBytes)) != 0 ||
+                    pwrite(pFile->nFd, &header, sizeof(header), 0) != static_cast<ssize_t>(sizeof(header)))
+                    return nullptr;
+            }
+            else if (pread(pFile->nFd, &header, sizeof(header), 0) != static_cast<ssize_t>(sizeof(header)))
+            {
+                return nullptr;
+            }
+#endif
+            return pFile;
+        }
+    }
+
+    TiledImage::TileView::~TileView()
+    {
+        if (!pBase)
+            return;
+#ifdef _WIN32
+        UnmapViewOfFile(pBase);
+#else
+        munmap(pBase, nBytes);
+#endif
+    }
+
+    TiledImage::~TiledImage()
+    {
+        close();
+    }
+
+    bool TiledImage::create(const std::string &strPath, cv::Size size, int nType, int nTile)
+    {
+        CV_Assert((nType == CV_8UC1 || nType == CV_8UC3) && size.width > 0 && size.height > 0 && nTile > 0);
+        close();
+
+        FileHeader header;
+        memcpy(header.arrMagic, FILE_MAGIC, sizeof(FILE_MAGIC));
+        header.nWidth = size.width;
+        header.nHeight = size.height;
+        header.nType = nType;
+        header.nTile = nTile;
+
+        const uint64_t nTiles = static_cast<uint64_t>((size.width + nTile - 1) / nTile) * ((size.height + nTile - 1) / nTile);
+        const uint64_t nFileBytes = HEADER_BYTES + nTiles * slotBytes(nTile, nType);
+
+        std::shared_ptr<FileHandle> pFile = openFile(strPath, true, true, header, nFileBytes);
+        if (!pFile)
+            return false;
+
+        m_pFile = pFile;
+        m_size = size;
+        m_nType = nType;
+        m_nTile = nTile;
+        m_nSlotBytes = slotBytes(nTile, nType);
+        m_bWrite = true;
+        m_nId = g_nNextId++;
+        return true;
+    }
+
+    bool TiledImage::open(const std::string &strPath, bool bWrite)
+    {
+        close();
+
+        FileHeader header;
+        std::shared_ptr<FileHandle> pFile = openFile(strPath, bWrite, false, header, 0);
+        if (!pFile || memcmp(header.arrMagic, FILE_MAGIC, sizeof(FILE_MAGIC)) != 0)
+            return false;
+        if ((header.nType != CV_8UC1 && header.nType != CV_8UC3) || header.nWidth <= 0 || header.nHeight <= 0 || header.nTile <= 0)
+            return false;
+
+        m_pFile = pFile;
+        m_size = cv::Size(header.nWidth, header.nHeight);
+        m_nType = header.nType;
+        m_nTile = header.nTile;
+        m_nSlotBytes = slotBytes(m_nTile, m_nType);
+        m_bWrite = bWrite;
+        m_nId = g_nNextId++;
+        return true;
+    }
+
+    void TiledImage::close()
+    {
+        m_pFile.reset();
+        m_size = cv::Size();
+        m_bWrite = false;
+        m_nId = 0;
+    }
+
+    cv::Rect TiledImage::tileRect(int nTx, int nTy) const
+    {
+        return cv::Rect(nTx * m_nTile, nTy * m_nTile, m_nTile, m_nTile) & cv::Rect(cv::Point(), m_size);
+    }
+
+    std::shared_ptr<TiledImage::TileView> TiledImage::mapTile(int nTx, int nTy) const
+    {
+        CV_Assert(isOpen() && nTx >= 0 && nTx < getTilesX() && nTy >= 0 && nTy < getTilesY());
+
+        const uint64_t nOffset = HEADER_BYTES + (static_cast<uint64_t>(nTy) * getTilesX() + nTx) * m_nSlotBytes;
+        FileHandle *pFile = static_cast<FileHandle *>(m_pFile.get());
+
+#ifdef _WIN32
+        void *pBase = MapViewOfFile(pFile->hMap, m_bWrite ? FILE_MAP_WRITE : FILE_MAP_READ,
+                                    static_cast<DWORD>(nOffset >> 32), static_cast<DWORD>(nOffset & 0xFFFFFFFFu), m_nSlotBytes);
+        if (!pBase)
+            CV_Error(cv::Error::StsError, "MapViewOfFile failed");
+#else
+        void *pBase = mmap(nullptr, m_nSlotBytes, m_bWrite ? (PROT_READ | PROT_WRITE) : PROT_READ, MAP_SHARED,
+                           pFile->nFd, static_cast<off_t>(nOffset));
+        if (pBase == MAP_FAILED)
+            CV_Error(cv::Error::StsError, "mmap failed");
+#endif
+
+        auto pView = std::make_shared<TileView>();
+        pView->pBase = pBase;
+        pView->nBytes = m_nSlotBytes;
+        pView->pFile = m_pFile;
+        pView->rect = tileRect(nTx, nTy);
+        pView->mat = cv::Mat(m_nTile, m_nTile, m_nType, pBase);
+        return pView;
+    }
+
+    TileCache::TileCache(size_t nBudgetBytes)
+        : m_nBudget(nBudgetBytes)
+    {
+    }
+
+    std::shared_ptr<TiledImage::TileView> TileCache::acquire(const TiledImage &image, int nTx, int nTy)
+    {
+        const Key key(image.getId(), static_cast<int64_t>(nTy) * image.getTilesX() + nTx);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_mapEntry.find(key);
+        if (it != m_mapEntry.end())
+        {
+            m_listLru.splice(m_listLru.begin(), m_listLru, it->second);
+            return it->second->second;
+        }
+
+        // 只建立映射, 缺页在锁外访问时才发生
+        std::shared_ptr<TiledImage::TileView> pView = image.mapTile(nTx, nTy);
+        m_listLru.emplace_front(key, pView);
+        m_mapEntry[key] = m_listLru.begin();
+        m_nBytes += pView->nBytes;
+        m_nPeak = std::max(m_nPeak, m_nBytes);
+        m_nMisses++;
+        evict();
+        return pView;
+    }
+
+    void TileCache::evict()
+    {
+        auto it = m_listLru.end();
+        while (m_nBytes > m_nBudget && it != m_listLru.begin())
+        {
+            --it;
+            if (it->second.use_count() > 1)
+                continue;
+
+            m_nBytes -= it->second->nBytes;
+            m_mapEntry.erase(it->first);
+            it = m_listLru.erase(it);
+        }
+    }
+
+    void TileCache::drop(const TiledImage &image)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (auto it = m_listLru.begin(); it != m_listLru.end();)
+        {
+            if (it->first.first != image.getId())
+            {
+                ++it;
+                continue;
+            }
+            m_nBytes -= it->second->nBytes;
+            m_mapEntry.erase(it->first);
+            it = m_listLru.erase(it);
+        }
+    }
+
+    void TileCache::clear()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_mapEntry.clear();
+        m_listLru.clear();
+        m_nBytes = 0;
+    }
+
+    size_t TileCache::getBytes() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_nBytes;
+    }
+
+    size_t TileCache::getPeakBytes() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_nPeak;
+    }
+
+    size_t TileCache::getMisses() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_nMisses;
+    }
+
+    cv::Mat readTiledRect(const TiledImage &image, cv::Rect rect, TileCache &cache)
+    {
+        CV_Assert((rect & cv::Rect(cv::Point(), image.size())) == rect);
+
+        cv::Mat matRes(rect.size(), image.type());
+        const int nTile = image.getTileSize();
+        for (int nTy = rect.y / nTile; nTy * nTile < rect.br().y; nTy++)
+        {
+            for (int nTx = rect.x / nTile; nTx * nTile < rect.br().x; nTx++)
+            {
+                auto pView = cache.acquire(image, nTx, nTy);
+                const cv::Rect rectPart = rect & pView->rect;
+                pView->mat(rectPart - pView->rect.tl()).copyTo(matRes(rectPart - rect.tl()));
+            }
+        }
+        return matRes;
+    }
+
+    void writeTiledRect(TiledImage &image, const cv::Mat &mat, cv::Point ptOrigin, TileCache &cache)
+    {
+        const cv::Rect rect(ptOrigin, mat.size());
+        CV_Assert(image.isWritable() && mat.type() == image.type() && (rect & cv::Rect(cv::Point(), image.size())) == rect);
+
+        const int nTile = image.getTileSize();
+        for (int nTy = rect.y / nTile; nTy * nTile < rect.br().y; nTy++)
+        {
+            for (int nTx = rect.x / nTile; nTx * nTile < rect.br().x; nTx++)
+            {
+                auto pView = cache.acquire(image, nTx, nTy);
+                const cv::Rect rectPart = rect & pView->rect;
+                cv::Mat matDst = pView->mat(rectPart - pView->rect.tl());
+                mat(rectPart - rect.tl()).copyTo(matDst);
+            }
+        }
+    }
+
+    void processTiled(const TiledImage &src, TiledImage &dst, const ImgPipeline &pipeline, TileCache &cache)
+    {
+        CV_Assert(src.isOpen() && dst.isWritable() && dst.size() == src.size());
+        CV_Assert(dst.type() == CV_8UC(pipeline.getOutChannels(CV_MAT_CN(src.type()))));
+
+        const cv::Size sizeHalo = pipeline.getHalo();
+        const cv::Rect rectImage(cv::Point(), src.size());
+        const int nTilesX = dst.getTilesX();
+
+        cv::parallel_for_(cv::Range(0, nTilesX * dst.getTilesY()), [&](const cv::Range &range) {
+            for (int i = range.start; i < range.end; i++)
+            {
+                const int nTx = i % nTilesX;
+                const int nTy = i / nTilesX;
+                const cv::Rect rectOut = dst.tileRect(nTx, nTy);
+                const cv::Rect rectIn = cv::Rect(rectOut.x - sizeHalo.width, rectOut.y - sizeHalo.height,
+                                                 rectOut.width + 2 * sizeHalo.width, rectOut.height + 2 * sizeHalo.height) & rectImage;
+
+                ImgPipeline tilePipeline = pipeline;
+                tilePipeline.setSource(readTiledRect(src, rectIn, cache));
+                const cv::Mat matRes = tilePipeline.run();
+
+                auto pView = cache.acquire(dst, nTx, nTy);
+                cv::Mat matDst = pView->mat(cv::Rect(cv::Point(), rectOut.size()));
+                matRes(rectOut - rectIn.tl()).copyTo(matDst);
+            }
+        });
+    }
+
+    void halftoneTiled(const TiledImage &srcGray, TiledImage &dst, const HalftoneScreen &screen, double dAngle, TileCache &cache)
+    {
+        CV_Assert(srcGray.type() == CV_8UC1 && dst.type() == CV_8UC1 && dst.isWritable() && dst.size() == srcGray.size());
+
+        const int nTilesX = dst.getTilesX();
+        cv::parallel_for_(cv::Range(0, nTilesX * dst.getTilesY()), [&](const cv::Range &range) {
+            for (int i = range.start; i < range.end; i++)
+            {
+                const int nTx = i % nTilesX;
+                const int nTy = i / nTilesX;
+                const cv::Rect rect = dst.tileRect(nTx, nTy);
+                const cv::Mat matRes = screen.apply(readTiledRect(srcGray, rect, cache), 1.0, dAngle, rect.tl());
+
+                auto pView = cache.acquire(dst, nTx, nTy);
+                cv::Mat matDst = pView->mat(cv::Rect(cv::Point(), rect.size()));
+                matRes.copyTo(matDst);
+            }
+        });
+    }
+
+    void errorDiffusionTiled(const TiledImage &srcGray, TiledImage &dst, DitherKernel eKernel, bool bSerpentine, int nThreshold, TileCache &cache)
+    {
+        CV_Assert(srcGray.type() == CV_8UC1 && dst.type() == CV_8UC1 && dst.isWritable() && dst.size() == srcGray.size());
+
+        // 误差沿行传递, 只能按光栅顺序处理; 每个块行的输入输出块整行持有, 逐行拼接后送入
+        const int nW = srcGray.size().width;
+        const int nH = srcGray.size().height;
+        ErrorDiffusionRows rows(nW, eKernel, bSerpentine, nThreshold);
+        std::vector<uchar> vSrc(nW);
+        std::vector<uchar> vDst(nW);
+
+        const int nSrcTile = srcGray.getTileSize();
+        const int nDstTile = dst.getTileSize();
+        std::vector<std::shared_ptr<TiledImage::TileView>> vSrcViews;
+        std::vector<std::shared_ptr<TiledImage::TileView>> vDstViews;
+        int nSrcTy = -1;
+        int nDstTy = -1;
+
+        for (int y = 0; y < nH; y++)
+        {
+            if (y / nSrcTile != nSrcTy)
+            {
+                nSrcTy = y / nSrcTile;
+                vSrcViews.clear();
+                for (int nTx = 0; nTx < srcGray.getTilesX(); nTx++)
+                    vSrcViews.push_back(cache.acquire(srcGray, nTx, nSrcTy));
+            }
+            if (y / nDstTile != nDstTy)
+            {
+                nDstTy = y / nDstTile;
+                vDstViews.clear();
+                for (int nTx = 0; nTx < dst.getTilesX(); nTx++)
+                    vDstViews.push_back(cache.acquire(dst, nTx, nDstTy));
+            }
+
+            for (const auto &pView : vSrcViews)
+                memcpy(vSrc.data() + pView->rect.x, pView->mat.ptr<uchar>(y - pView->rect.y), pView->rect.width);
+
+            rows.ditherRow(vSrc.data(), vDst.data());
+
+            for (const auto &pView : vDstViews)
+                memcpy(pView->mat.ptr<uchar>(y - pView->rect.y), vDst.data() + pView->rect.x, pView->rect.width);
+        }
+    }
+}
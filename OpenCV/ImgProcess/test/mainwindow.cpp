@@ -11,14 +11,108 @@
 
 using namespace ImgSpace;
 
+namespace
+{
+    // 可以放进效果流水线的效果: 逐点效果与锐化 / 模糊
+    bool isPipelineType(int nType)
+    {
+        switch (nType)
+        {
+        case 2: case 3: case 4: case 5: case 6: case 7: case 8: // 灰度 / 通道
+        case 13: // 模糊
+        case 15: // 二值化
+        case 16: // 亮度对比度
+        case 17: // 锐化
+        case 29: // 反色
+        case 41: // Gamma
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    /**
+     * @description: 把流水线效果记录到 pipeline 上
+     * @param {double} dScale 图像相对原图的比例 (预览时小于 1), 模糊 / 锐化的半径按比例缩小
+     * @return 滑块名称
+     */
+    QStringList recordPipelineStage(ImgPipeline& pipeline, int nType, int nA, int nB, int nC, double dScale)
+    {
+        auto scaled = [dScale](int n) { return n < 1 ? n : std::max(1, cvRound(n * dScale)); };
+
+        QStringList listName;
+        switch (nType)
+        {
+        case 2: // 灰度
+            pipeline.gray();
+            break;
+        case 3: // 红
+            pipeline.channels(false, false, true);
+            break;
+        case 4: // 绿
+            pipeline.channels(false, true, false);
+            break;
+        case 5: // 蓝
+            pipeline.channels(true, false, false);
+            break;
+        case 6: // 红+绿
+            pipeline.channels(false, true, true);
+            break;
+        case 7: // 红+蓝
+            pipeline.channels(true, false, true);
+            break;
+        case 8: // 绿+蓝
+            pipeline.channels(true, true, false);
+            break;
+        case 13: // 模糊
+            listName << "A"
+                << "B";
+            pipeline.blur(scaled(nA), scaled(nB));
+            break;
+        case 15: // 二值化
+            listName << "A"
+                << "B"
+                << "C";
+            pipeline.threshold(nA, nB, nC);
+            break;
+        case 16: // 亮度对比度
+            listName << "A"
+                << "B"
+                << "C";
+            pipeline.contrastAndBright(nA, nB, nC);
+            break;
+        case 17: //图像锐化(image sharpening)
+            listName << "A"
+                << "B"
+                << "C";
+            pipeline.sharpen(nA * dScale);
+            break;
+        case 29: // 反色
+            pipeline.reversal();
+            break;
+        case 41: // Gamma
+            listName << "Gamma";
+            listName << "A * 0.01";
+            pipeline.gamma(nA * 0.01);
+            break;
+        }
+        return listName;
+    }
+
+    const double PREVIEW_BUDGET_MS = 40.0; // 拖动滑块时预览的帧预算
+}
+
 #define CONNECT_BTN(N)                                                                        \
     {                                                                                         \
         connect(ui->pushBtnTest_##N, &QPushButton::clicked, this, &MainWindow::slotImageSet); \
         ui->pushBtnTest_##N->setProperty("Index", #N);                                        \
     }
 
-#define CONNECT_SLIDER(N) connect(ui->hSlider##N, &QSlider::sliderReleased, \
-                                  this, &MainWindow::slotImageSet);
+#define CONNECT_SLIDER(N)                                                                    \
+    {                                                                                        \
+        connect(ui->hSlider##N, &QSlider::sliderReleased, this, &MainWindow::slotImageSet);  \
+        connect(ui->hSlider##N, &QSlider::sliderMoved, this, &MainWindow::slotImagePreview); \
+    }
 
 MainWindow::MainWindow(QWidget* parent)
     : QMainWindow(parent), ui(new Ui::MainWindow)
@@ -100,6 +194,7 @@ MainWindow::MainWindow(QWidget* parent)
     CONNECT_SLIDER(F);
     CONNECT_SLIDER(G);
     CONNECT_SLIDER(H);
+
 }
 
 MainWindow::~MainWindow()
@@ -137,6 +232,7 @@ void MainWindow::initData()
     m_nTypePrev = -1;
     m_matRes = Mat();
     m_matResPrev = Mat();
+    m_bPipelineLive = false;
     this->slotValueReset();
 
     initSlider();
@@ -274,6 +370,7 @@ void MainWindow::slotOpenImage()
         m_pImgProcess = new imgProcess();
     m_matRes = m_pImgProcess->readImg(filePath);
     m_matResPrev = m_matRes;
+    m_bPipelineLive = false;
     /////////////////////////////////////////////
 
     QImage qImg = QImage((const unsigned char*)(m_matRes.data),
@@ -305,6 +402,68 @@ void MainWindow::slotImageSave()
     m_pImgProcess->saveImg(m_matResPrev, strPath.toStdString());
 }
 
+void MainWindow::showImage(const Mat& mat)
+{
+    QImage::Format f = QImage::Format_BGR888;
+    if (mat.channels() < 3)
+        f = QImage::Format_Grayscale8;
+
+    QImage qImg = QImage((const unsigned char*)(mat.data),
+        mat.cols, mat.rows, mat.cols * mat.channels(),
+        f);
+
+    ui->labelImg->clear();
+    ui->labelImg->setPixmap(QPixmap::fromImage(qImg));
+    ui->labelImg->resize(ui->labelImg->pixmap(Qt::ReturnByValue).size());
+}
+
+// 拖动滑块时预览: 流水线效果先在金字塔中与显示区域相当的一层上计算并缩放到显示区域,
+// 原图在后台计算, 算完且参数没有再变时替换显示. 松开滑块后仍由 slotImageSet 计算并保存结果
+void MainWindow::slotImagePreview()
+{
+    slotSlideValue();
+
+    if (m_nType != m_nTypePrev || !isPipelineType(m_nType) || !m_matRes.data || (m_matRes.type() != CV_8UC1 && m_matRes.type() != CV_8UC3))
+        return;
+
+    QTime startTime = QTime::currentTime();
+
+    const int nType = m_nType;
+    const int nA = ui->hSliderA->value();
+    const int nB = ui->hSliderB->value();
+    const int nC = ui->hSliderC->value();
+    auto effect = [nType, nA, nB, nC](const Mat& mat, double dScale, const std::function<bool()>& isStale) {
+        ImgPipeline pipeline;
+        pipeline.setSource(mat);
+        recordPipelineStage(pipeline, nType, nA, nB, nC, dScale);
+        return pipeline.run(isStale);
+    };
+
+    // 回调在后台线程, 转到界面线程显示
+    auto onRefined = [this](uint64_t nJob, const Mat& matRes) {
+        QMetaObject::invokeMethod(this, [this, nJob, matRes]() {
+            if (nJob != m_preview.getJob())
+                return;
+            showImage(matRes);
+            ui->labelProcessTip->setText("Preview refined");
+        }, Qt::QueuedConnection);
+    };
+
+    QSize sizeView = ui->scrollArea->viewport()->size();
+    int nLevel = 0;
+    m_preview.setImage(m_matRes);
+    Mat matPreview = m_preview.render(nType, effect, Size(sizeView.width(), sizeView.height()), PREVIEW_BUDGET_MS, onRefined, &nLevel);
+
+    // 缩放到显示区域内
+    double dRatio = std::min(1.0, std::min(sizeView.width() / (double)matPreview.cols, sizeView.height() / (double)matPreview.rows));
+    if (dRatio < 1.0)
+        cv::resize(matPreview, matPreview, Size(), dRatio, dRatio, INTER_AREA);
+    showImage(matPreview);
+
+    int elapsed = startTime.msecsTo(QTime::currentTime());
+    ui->labelProcessTip->setText(QString("Preview L%1 Elapsed: %2").arg(nLevel).arg(elapsed));
+}
+
 // 复原
 void MainWindow::slotValueReset()
 {
@@ -330,6 +489,7 @@ void MainWindow::slotValueReset()
     ui->labelImg->resize(ui->labelImg->pixmap(Qt::ReturnByValue).size());
 
     m_matResPrev = m_pImgProcess->getOriginImg();
+    m_bPipelineLive = false;
 }
 
 void MainWindow::slotZeroSlide()
@@ -369,6 +529,9 @@ void MainWindow::slotImageSet()
 {
     QTime startTime = QTime::currentTime();
 
+    // 后台的预览任务作废, 下面直接计算原图
+    m_preview.cancel();
+
     ui->labelProcessTip->setText("Start...");
     this->update();
 
@@ -378,6 +541,7 @@ void MainWindow::slotImageSet()
     else // 滑动块
         slotSlideValue();
 
+    bool bNewType = false;
     if (m_nType != m_nTypePrev) // 切换按钮,在上次的效果上进行处理
     {
         if (!m_matResPrev.data)
@@ -385,6 +549,28 @@ void MainWindow::slotImageSet()
 
         m_matRes = m_matResPrev;
         m_nTypePrev = m_nType;
+        bNewType = true;
+    }
+
+    // 连续叠加的流水线效果记录在同一条流水线上, 拖动滑块时只重算当前效果及之后的部分
+    const bool bPipeline = isPipelineType(m_nType) && m_matRes.data && (m_matRes.type() == CV_8UC1 || m_matRes.type() == CV_8UC3);
+    if (bPipeline)
+    {
+        if (!m_bPipelineLive)
+        {
+            m_pipeline.setSource(m_matRes);
+            m_nPipelineBase = 0;
+            m_bPipelineLive = true;
+        }
+        else if (bNewType)
+        {
+            m_nPipelineBase = m_pipeline.size();
+        }
+        m_pipeline.rewind(m_nPipelineBase);
+    }
+    else
+    {
+        m_bPipelineLive = false;
     }
 
     int nA = ui->hSliderA->value();
@@ -411,6 +597,12 @@ void MainWindow::slotImageSet()
 
     Mat matRes;
     ////////////////////////////////////////////////////
+    if (bPipeline)
+    {
+        listName = recordPipelineStage(m_pipeline, m_nType, nA, nB, nC, 1.0);
+        matRes = m_pipeline.run();
+    }
+    else
     {
         switch (m_nType)
         {
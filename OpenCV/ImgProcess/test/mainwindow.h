@@ -14,6 +14,9 @@
 #include <opencv2/opencv.hpp>
 using namespace cv;
 
+#include "ImgPipeline.h"
+#include "ImgPreview.h"
+
 QT_BEGIN_NAMESPACE
 namespace Ui
 {
@@ -41,6 +44,7 @@ protected:
     void initData();
 
     void setSliderTip(QStringList listTip);
+    void showImage(const Mat& mat);
 
 protected slots:
     // void slotImageParamSet(bool bClicked);
@@ -54,6 +58,7 @@ protected slots:
     void slotSlideValue();
     void slotImageResize();
     void slotImageSet();
+    void slotImagePreview();
 
 private:
     ImgSpace::imgProcess* m_pImgProcess = nullptr;
@@ -65,6 +70,12 @@ private:
     int m_nType = -1;
     int m_nTypePrev = -1;
 
+    ImgSpace::ImgPipeline m_pipeline;   // 连续叠加的逐点 / 锐化 / 模糊效果
+    size_t m_nPipelineBase = 0;         // 当前效果在流水线中的序号
+    bool m_bPipelineLive = false;       // 当前结果是否来自流水线
+
+    ImgSpace::ImgPreview m_preview;     // 拖动滑块时的分级预览
+
     QVector<QLabel*> m_vecLabelName;
 };
 #endif // MAINWINDOW_H
@@ -23,37 +23,37 @@ namespace GLRhi
 
         void setRgb(float red, float green, float blue);
 
-        void getRgb(float& red, float& green, float& blue) const;
+        void getRgb(float& red, float& green, float& blue) const { m_color.getRgb(red, green, blue); }
 
-        void getRgba(float& red, float& green, float& blue, float& alpha) const;
+        void getRgba(float& red, float& green, float& blue, float& alpha) const { m_color.getRgba(red, green, blue, alpha); }
 
-        float getRed() const;
-        float r() const;
-        float getGreen() const;
-        float g() const;
-        float getBlue() const;
-        float b() const;
-        float getAlpha() const;
-        float a() const;
-        const Color& getColor() const;
+        float getRed() const { return m_color.getRed(); }
+        float r() const { return m_color.r(); }
+        float getGreen() const { return m_color.getGreen(); }
+        float g() const { return m_color.g(); }
+        float getBlue() const { return m_color.getBlue(); }
+        float b() const { return m_color.b(); }
+        float getAlpha() const { return m_color.getAlpha(); }
+        float a() const { return m_color.a(); }
+        const Color& getColor() const { return m_color; }
 
-        Color& getColor();
+        Color& getColor() { return m_color; }
 
-        float getDepth() const;
-        float d() const;
-        int getType() const;
-        int t() const;
+        float getDepth() const { return m_depth; }
+        float d() const { return m_depth; }
+        int getType() const { return m_type; }
+        int t() const { return m_type; }
 
-        void setRed(float red);
-        void setGreen(float green);
-        void setBlue(float blue);
-        void setAlpha(float alpha);
-        void setColor(const Color& color);
+        void setRed(float red) { m_color.setRed(red); }
+        void setGreen(float green) { m_color.setGreen(green); }
+        void setBlue(float blue) { m_color.setBlue(blue); }
+        void setAlpha(float alpha) { m_color.setAlpha(alpha); }
+        void setColor(const Color& color) { m_color = color; }
 
-        void setDepth(float depth);
-        void setType(int type);
+        void setDepth(float depth) { m_depth = depth; }
+        void setType(int type) { m_type = type; }
 
-        void clampValues();
+        void clampValues() { m_color.clampValues(); }
 
         Brush blend(const Brush& other, float factor) const;
 
@@ -1,6 +1,7 @@
 #ifndef COLOR_H
 #define COLOR_H
 
+#include <algorithm>
 #include <cstdint>
 
 namespace GLRhi
@@ -9,6 +10,8 @@ namespace GLRhi
      * @brief 颜色类，用于表示RGBA颜色值
      *
      * 封装了RGBA颜色的存储和操作，提供颜色创建、修改、混合等功能。
+     * 访问、设置与打包都在头文件内联（constexpr），在逐图元的热路径上没有函数调用开销；
+     * 大批量颜色运算使用 ColorBuffer。
      */
     class Color
     {
@@ -29,38 +32,80 @@ namespace GLRhi
          * @param blue 蓝色 (0.0-1.0)
          * @param alpha 透明度 (0.0-1.0)
          */
-        Color(float red = 1.0f, float green = 1.0f, float blue = 1.0f, float alpha = 1.0f);
-        Color(const Color& other);
+        constexpr Color(float red = 1.0f, float green = 1.0f, float blue = 1.0f, float alpha = 1.0f)
+            : m_arrColor{ red, green, blue, alpha }
+        {
+            clampValues();
+        }
+
+        // 所有修改接口都会限制范围，拷贝时无需再次 clamp
+        constexpr Color(const Color& other) = default;
+        constexpr Color& operator=(const Color& other) = default;
 
-        Color& operator=(const Color& other);
-        bool operator==(const Color& other) const;
-        bool operator!=(const Color& other) const;
+        bool operator==(const Color& other) const
+        {
+            constexpr float epsilon = 1e-6f;
+            for (int i = 0; i < COLOR_COUNT; ++i)
+            {
+                float fDiff = m_arrColor[i] - other.m_arrColor[i];
+                if (fDiff >= epsilon || fDiff <= -epsilon)
+                    return false;
+            }
+            return true;
+        }
+        bool operator!=(const Color& other) const { return !(*this == other); }
         bool operator<(const Color& other) const;
 
         /**
          * @brief 设置RGBA颜色值
          */
-        void set(float red, float green, float blue, float alpha = 1.0f);
+        constexpr void set(float red, float green, float blue, float alpha = 1.0f)
+        {
+            m_arrColor[RED] = red;
+            m_arrColor[GREEN] = green;
+            m_arrColor[BLUE] = blue;
+            m_arrColor[ALPHA] = alpha;
+            clampValues();
+        }
 
         /**
          * @brief 设置RGB颜色值（保持当前透明度）
          */
-        void setRgb(float red, float green, float blue);
+        constexpr void setRgb(float red, float green, float blue)
+        {
+            m_arrColor[RED] = red;
+            m_arrColor[GREEN] = green;
+            m_arrColor[BLUE] = blue;
+            clampValues();
+        }
 
         /**
          * @brief 获取RGB颜色值
          */
-        void getRgb(float& red, float& green, float& blue) const;
+        constexpr void getRgb(float& red, float& green, float& blue) const
+        {
+            red = m_arrColor[RED];
+            green = m_arrColor[GREEN];
+            blue = m_arrColor[BLUE];
+        }
 
         /**
          * @brief 获取RGBA颜色值
          */
-        void getRgba(float& red, float& green, float& blue, float& alpha) const;
+        constexpr void getRgba(float& red, float& green, float& blue, float& alpha) const
+        {
+            getRgb(red, green, blue);
+            alpha = m_arrColor[ALPHA];
+        }
 
         /**
          * @brief 将颜色值限制在有效范围内 (0.0-1.0)
          */
-        void clampValues();
+        constexpr void clampValues()
+        {
+            for (int i = 0; i < COLOR_COUNT; ++i)
+                m_arrColor[i] = std::clamp(m_arrColor[i], 0.0f, 1.0f);
+        }
 
         /**
          * @brief 混合两个颜色
@@ -68,27 +113,51 @@ namespace GLRhi
          * @param factor 混合因子 (0.0-1.0)，0表示完全使用当前颜色，1表示完全使用other颜色
          * @return 混合后的新颜色
          */
-        Color blend(const Color& other, float factor) const;
-
-        float getRed() const;
-        float r() const;
-        float getGreen() const;
-        float g() const;
-        float getBlue() const;
-        float b() const;
-        float getAlpha() const;
-        float a() const;
-
-        void setRed(float red);
-        void setGreen(float green);
-        void setBlue(float blue);
-        void setAlpha(float alpha);
-
-        uint32_t toUInt32() const;
-        
+        constexpr Color blend(const Color& other, float factor) const
+        {
+            factor = std::clamp(factor, 0.0f, 1.0f);
+            float invFactor = 1.0f - factor;
+            return Color(m_arrColor[RED] * invFactor + other.m_arrColor[RED] * factor,
+                m_arrColor[GREEN] * invFactor + other.m_arrColor[GREEN] * factor,
+                m_arrColor[BLUE] * invFactor + other.m_arrColor[BLUE] * factor,
+                m_arrColor[ALPHA] * invFactor + other.m_arrColor[ALPHA] * factor);
+        }
+
+        constexpr float getRed() const { return m_arrColor[RED]; }
+        constexpr float r() const { return m_arrColor[RED]; }
+        constexpr float getGreen() const { return m_arrColor[GREEN]; }
+        constexpr float g() const { return m_arrColor[GREEN]; }
+        constexpr float getBlue() const { return m_arrColor[BLUE]; }
+        constexpr float b() const { return m_arrColor[BLUE]; }
+        constexpr float getAlpha() const { return m_arrColor[ALPHA]; }
+        constexpr float a() const { return m_arrColor[ALPHA]; }
+
+        constexpr void setRed(float red) { m_arrColor[RED] = std::clamp(red, 0.0f, 1.0f); }
+        constexpr void setGreen(float green) { m_arrColor[GREEN] = std::clamp(green, 0.0f, 1.0f); }
+        constexpr void setBlue(float blue) { m_arrColor[BLUE] = std::clamp(blue, 0.0f, 1.0f); }
+        constexpr void setAlpha(float alpha) { m_arrColor[ALPHA] = std::clamp(alpha, 0.0f, 1.0f); }
+
+        /**
+         * @brief 转换为 32 位整数（内存顺序 RGBA，即 0xAABBGGRR）
+         * 分量已在 [0, 1] 内，+0.5 截断即四舍五入；与 ColorBuffer::packUInt32 结果一致
+         */
+        constexpr uint32_t toUInt32() const
+        {
+            return (toByte(m_arrColor[ALPHA]) << 24) |
+                (toByte(m_arrColor[BLUE]) << 16) |
+                (toByte(m_arrColor[GREEN]) << 8) |
+                toByte(m_arrColor[RED]);
+        }
+
+    private:
+        static constexpr uint32_t toByte(float f)
+        {
+            return static_cast<uint32_t>(f * 255.0f + 0.5f);
+        }
+
     private:
         float m_arrColor[COLOR_COUNT] = { 1.0f, 1.0f, 1.0f, 1.0f }; // RGBA颜色数组
     };
 }
 
-#endif // COLOR_H
\ No newline at end of file
+#endif // COLOR_H
@@ -0,0 +1,104 @@
+#ifndef COLOR_BUFFER_H
+#define COLOR_BUFFER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Color.h"
+
+namespace GLRhi
+{
+    /**
+     * @class ColorBuffer
+     * @brief 按分量分开存储（SoA）的颜色数组，批量运算走 SIMD
+     *
+     * R/G/B/A 各一个 float 数组，批量混合、限制范围、预乘、打包与 sRGB 转换一次处理
+     * 8（AVX2）或 4（SSE2 / NEON）个颜色，余下部分用同一公式的标量代码，结果与 SIMD 一致。
+     * 指令集在编译期选择：定义了 __AVX2__ 用 AVX2，x86 默认 SSE2，AArch64 用 NEON，其它平台为标量。
+     *
+     * 单个颜色的操作仍使用 Color（已内联）；只有成批（导入、换色、生成测试数据）时才值得先转成 SoA。
+     */
+    class ColorBuffer
+    {
+    public:
+        ColorBuffer() = default;
+        explicit ColorBuffer(size_t nCount, const Color& fill = Color());
+
+        size_t size() const { return m_vR.size(); }
+        bool empty() const { return m_vR.empty(); }
+        void reserve(size_t nCount);
+        void resize(size_t nCount, const Color& fill = Color());
+        void clear();
+
+        void push_back(const Color& color);
+        void set(size_t i, const Color& color);
+        Color get(size_t i) const { return Color(m_vR[i], m_vG[i], m_vB[i], m_vA[i]); }
+
+        /**
+         * @brief 从 Color 数组转换（AoS -> SoA）
+         */
+        void assign(const Color* pColors, size_t nCount);
+
+        /**
+         * @brief 从 RGBA8 打包值转换（与 packUInt32 互逆）
+         */
+        void unpackUInt32(const uint32_t* pPacked, size_t nCount);
+
+        float* r() { return m_vR.data(); }
+        float* g() { return m_vG.data(); }
+        float* b() { return m_vB.data(); }
+        float* a() { return m_vA.data(); }
+        const float* r() const { return m_vR.data(); }
+        const float* g() const { return m_vG.data(); }
+        const float* b() const { return m_vB.data(); }
+        const float* a() const { return m_vA.data(); }
+
+        /**
+         * @brief 各分量限制到 [0, 1]（直接写入 r()/g()/b()/a() 后调用）
+         */
+        void clamp();
+
+        /**
+         * @brief 与另一组颜色逐个混合：this = this * (1 - factor) + other * factor
+         * @note 两者长度需相同，factor 限制到 [0, 1]；结果与 Color::blend 一致
+         */
+        void blend(const ColorBuffer& other, float factor);
+
+        /**
+         * @brief 全部颜色向同一颜色混合（例如高亮、淡出）
+         */
+        void blend(const Color& target, float factor);
+
+        /**
+         * @brief RGB 乘以 Alpha（预乘透明度）
+         */
+        void premultiply();
+
+        /**
+         * @brief 线性空间 -> sRGB / sRGB -> 线性空间
+         * 使用多项式近似（无 pow），8 位精度下误差不超过 1
+         */
+        void linearToSrgb();
+        void srgbToLinear();
+
+        /**
+         * @brief 打包为 RGBA8（0xAABBGGRR），与 Color::toUInt32 逐位相同
+         * @param pOut 输出数组，长度至少 size()
+         */
+        void packUInt32(uint32_t* pOut) const;
+
+        /**
+         * @brief 当前编译使用的指令集名称
+         */
+        static const char* simdName();
+
+    private:
+        std::vector<float> m_vR;
+        std::vector<float> m_vG;
+        std::vector<float> m_vB;
+        std::vector<float> m_vA;
+    };
+}
+
+#endif // COLOR_BUFFER_H
@@ -2,6 +2,8 @@
 #define FAKE_DATA_PROVIDER_H
 
 #include <vector>
+#include <random>
+#include <cstdint>
 #include <QOpenGLFunctions_3_3_Core>
 
 #include "PolylinesVboManager.h"
@@ -29,6 +31,9 @@ namespace GLRhi
         std::vector<PolylineData> genLineData(
             size_t group =20, size_t nLineSz =100, size_t minPts = 2, size_t maxPts = 10);
 
+        // 固定扰乱数据使用的随机种子（默认取 random_device），便于复现
+        void setSeed(uint64_t nSeed) { m_rng.seed(static_cast<std::mt19937::result_type>(nSeed)); }
+
         // 扰乱线段数据
         void disturbLineData(std::vector<PolylineData>& vPolylineDatas);
         void disturbLineDataVBO();
@@ -45,6 +50,7 @@ namespace GLRhi
 
     private:
         PrimitiveIDGenerator m_idGenerator;
+        std::mt19937 m_rng{ std::random_device{}() };
 
         PolylinesVboManager m_plVboManager;
 
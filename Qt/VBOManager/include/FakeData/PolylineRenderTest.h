@@ -23,11 +23,15 @@ namespace GLRhi
     layout(location = 0) in vec3 aPos;
 
     // uniform mat4 uMVP; // 模型视图投影矩阵
+    uniform vec2 uBlockOrigin;  // 块原点（压缩顶点格式）
+    uniform float uBlockScale;  // 量化步长（Float3 块为 1）
+    uniform float uBlockZ;      // 块统一 z 值
 
     void main()
     {
-        // gl_Position = uMVP * vec4(aPos, 1.0);
-        gl_Position = vec4(aPos, 1.0);
+        vec3 pos = vec3(uBlockOrigin + aPos.xy * uBlockScale, aPos.z + uBlockZ);
+        // gl_Position = uMVP * vec4(pos, 1.0);
+        gl_Position = vec4(pos, 1.0);
     }
     )";
 
@@ -0,0 +1,107 @@
+#ifndef VBO_BENCHMARK_H
+#define VBO_BENCHMARK_H
+
+#include <vector>
+#include <QOpenGLFunctions_3_3_Core>
+
+#include "RenderCommon.h"
+#include "VertexFormat.h"
+
+namespace GLRhi
+{
+    /**
+     * @brief 顶点格式精度校验结果
+     */
+    struct VertexFormatAccuracy
+    {
+        VertexFormat eFormat{ VertexFormat::Float3 };
+        size_t nLineCount{ 0 };         // 参与校验的折线数
+        size_t nVertCount{ 0 };         // 参与校验的顶点数
+        size_t nFailedCount{ 0 };       // 读回失败的折线数
+        double dMaxError{ 0.0 };        // 最大绝对误差（世界坐标）
+        double dRmsError{ 0.0 };        // 均方根误差
+    };
+
+    /**
+     * @brief 顶点格式性能测试结果
+     */
+    struct VertexFormatBench
+    {
+        VertexFormat eFormat{ VertexFormat::Float3 };
+        size_t nLineCount{ 0 };         // 添加成功的折线数
+        size_t nVertexBytes{ 0 };       // 顶点数据占用显存（字节）
+        double dUploadMs{ 0.0 };        // 批量添加 + 上传耗时
+        double dRenderMs{ 0.0 };        // 平均每帧绘制耗时（glFinish 同步）
+    };
+
+    /**
+     * @brief 折线 VBO 顶点格式测试
+     * 对同一份数据分别以 Float3 / Quantized16 / HalfFloat 建立管理器，
+     * 读回显存与原始 float 数据比对，并统计显存占用、上传与绘制耗时。
+     * 需在 OpenGL 上下文中调用，且已绑定带 uBlockOrigin/uBlockScale/uBlockZ 的着色器。
+     */
+    class VboBenchmark
+    {
+    public:
+        /**
+         * @brief 校验指定格式相对 float 数据的精度
+         * @param vPlDatas 测试数据
+         * @param eFormat 顶点格式
+         * @param fQuantizeStep 量化步长
+         */
+        static VertexFormatAccuracy checkAccuracy(const std::vector<PolylineData>& vPlDatas,
+            VertexFormat eFormat, float fQuantizeStep);
+
+        /**
+         * @brief 测试指定格式的显存占用、上传和绘制耗时
+         * @param gl OpenGL 函数表（glFinish 同步用）
+         * @param vPlDatas 测试数据
+         * @param eFormat 顶点格式
+         * @param fQuantizeStep 量化步长
+         * @param nRenderFrames 绘制帧数
+         */
+        static VertexFormatBench benchFormat(QOpenGLFunctions_3_3_Core* gl,
+            const std::vector<PolylineData>& vPlDatas, VertexFormat eFormat,
+            float fQuantizeStep, int nRenderFrames = 20);
+
+        /**
+         * @brief 依次测试全部格式并输出对比
+         */
+        static void runVertexFormatBenchmark(QOpenGLFunctions_3_3_Core* gl,
+            const std::vector<PolylineData>& vPlDatas, float fQuantizeStep = 1.0f / 8192.0f);
+
+        /**
+         * @brief 对比逐条添加、tuple 批量添加与 loadPolylines 零拷贝加载的耗时
+         * @param gl OpenGL 函数表
+         * @param nLineCount 折线数量
+         * @param nMinPts 每条折线最少点数
+         * @param nMaxPts 每条折线最多点数
+         */
+        static void runBulkLoadBenchmark(QOpenGLFunctions_3_3_Core* gl,
+            size_t nLineCount = 1'000'000, size_t nMinPts = 2, size_t nMaxPts = 8);
+
+        /**
+         * @brief 异步加载重复 ID 后合并块的校验
+         * 异步加载一批含已存在 ID 的折线，接入后在显存预算下触发块合并，
+         * 读回确认已存在的折线仍是原数据（作废的重复图元不参与合并）。
+         * @return 校验是否通过
+         */
+        static bool checkAsyncDuplicateMerge(QOpenGLFunctions_3_3_Core* gl);
+
+        /**
+         * @brief 多线程并发取 ID 测试（1~64 线程）
+         * 对比逐个访问共享计数器、genID 线程本地块、reserve 批量预留与可回收生成器的吞吐，
+         * 不需要 OpenGL 上下文
+         * @param nIdsPerThread 每个线程取 ID 的数量
+         */
+        static void runIdGeneratorBenchmark(size_t nIdsPerThread = 1'000'000);
+
+        /**
+         * @brief 颜色批量运算测试：逐个 Color 与 ColorBuffer（SIMD）的混合、打包、sRGB 转换耗时对比
+         * @param nCount 颜色数量
+         */
+        static void runColorKernelBenchmark(size_t nCount = 4'000'000);
+    };
+}
+
+#endif // VBO_BENCHMARK_H
@@ -0,0 +1,140 @@
+#ifndef WORKLOAD_TRACE_H
+#define WORKLOAD_TRACE_H
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <QOpenGLFunctions_3_3_Core>
+
+#include "VertexFormat.h"
+
+namespace GLRhi
+{
+    /**
+     * @brief 负载场景
+     */
+    enum class WorkloadProfile : uint32_t
+    {
+        BulkLoad,       // 一帧加载全部折线，随后只绘制
+        EditStorm,      // 每帧修改 1%（点数变化）、增删各 0.2%
+        MassDelete,     // 每帧删除剩余折线的 10%，触发整理
+        ColorChurn,     // 每帧 1% 的折线换色（删除后以新颜色重新添加）
+        ZoomPan         // 视口缩放平移，按包围盒切换可见性
+    };
+
+    const char* workloadProfileName(WorkloadProfile eProfile);
+
+    /**
+     * @brief 轨迹中的一次操作（定长，直接按字节写入文件）
+     */
+    struct WorkloadOp
+    {
+        enum Type : uint8_t
+        {
+            Add,        // 添加折线（顶点取自顶点池）
+            Remove,     // 删除折线
+            Update,     // 更新顶点
+            SetVisible, // 设置可见性
+            EndFrame    // 帧结束：提交本帧操作并绘制
+        };
+
+        uint8_t  eType{ EndFrame };
+        uint8_t  bVisible{ 1 };         // SetVisible 的可见性
+        uint8_t  arrColor[4]{};         // Add 的颜色 RGBA8
+        uint16_t nReserved{ 0 };
+        int64_t  id{ -1 };
+        uint64_t nVertOffset{ 0 };      // 顶点池中的起始顶点
+        uint64_t nVertCount{ 0 };       // 顶点数
+    };
+    static_assert(sizeof(WorkloadOp) == 32, "WorkloadOp 需保持定长文件布局");
+
+    /**
+     * @brief 操作轨迹
+     * 所有顶点存放在一个池中（xyz 连续），操作按帧排列，以 EndFrame 分隔。
+     */
+    struct WorkloadTrace
+    {
+        WorkloadProfile eProfile{ WorkloadProfile::BulkLoad };
+        uint64_t nSeed{ 0 };
+        uint32_t nWarmupFrames{ 0 };    // 前若干帧为场景准备，不计入帧时间分位数
+        uint32_t nFrameCount{ 0 };
+        std::vector<WorkloadOp> vOps;
+        std::vector<float> vVertPool;
+
+        /**
+         * @brief 写入 / 读取二进制轨迹文件
+         * @return 文件无法打开或格式不符时返回 false
+         */
+        bool save(const std::string& strPath) const;
+        bool load(const std::string& strPath);
+    };
+
+    /**
+     * @brief 可复现的负载生成器
+     *
+     * 同一 (场景, 种子, 规模) 生成的轨迹逐字节相同，与线程数无关：
+     * 折线几何按固定大小分片，每片用种子与片序号派生独立的随机数流，分片在多线程上并行生成后按序拼接；
+     * 选取哪些 ID 增删改由主线程上的单一随机数流决定。
+     */
+    class WorkloadGenerator
+    {
+    public:
+        /**
+         * @param eProfile 场景
+         * @param nSeed 随机种子
+         * @param nLineCount 初始折线数量
+         * @param nThreads 生成线程数，0 表示使用硬件线程数
+         */
+        static WorkloadTrace generate(WorkloadProfile eProfile, uint64_t nSeed,
+            size_t nLineCount = 100'000, unsigned int nThreads = 0);
+    };
+
+    /**
+     * @brief 回放的代码路径
+     */
+    enum class ReplayPath
+    {
+        Draw,           // 立即模式 + renderVisiblePrimitives（逐图元 glDrawElementsBaseVertex）
+        MultiDraw,      // 立即模式 + renderVisiblePrimitivesEx（glMultiDrawElementsBaseVertex）
+        Deferred        // 延迟模式命令队列 + renderVisiblePrimitivesEx
+    };
+
+    const char* replayPathName(ReplayPath ePath);
+
+    /**
+     * @brief 回放结果
+     */
+    struct WorkloadReplayResult
+    {
+        ReplayPath ePath{ ReplayPath::MultiDraw };
+        size_t nFrames{ 0 };            // 计入统计的帧数
+        double dWarmupMs{ 0.0 };        // 准备帧总耗时
+        double dP50Ms{ 0.0 };           // 帧时间中位数
+        double dP99Ms{ 0.0 };           // 帧时间 99 分位
+        double dMaxMs{ 0.0 };
+        size_t nUploadBytes{ 0 };       // 计入统计的帧的上传总字节数
+        size_t nCompacts{ 0 };          // 整理次数
+        double dCompactMs{ 0.0 };       // 整理总耗时
+    };
+
+    /**
+     * @brief 轨迹回放
+     * 每帧提交操作、绘制并 glFinish，帧时间为 CPU 提交到 GPU 完成的总耗时。
+     * 需在 OpenGL 上下文中调用，且已绑定带 uBlockOrigin/uBlockScale/uBlockZ 的着色器。
+     */
+    class WorkloadReplay
+    {
+    public:
+        static WorkloadReplayResult replay(QOpenGLFunctions_3_3_Core* gl, const WorkloadTrace& trace,
+            ReplayPath ePath, VertexFormat eFormat = VertexFormat::Float3);
+
+        /**
+         * @brief 生成全部场景，写入轨迹文件后读回，再按每条代码路径回放并输出对比
+         * @param strDir 轨迹文件目录，为空时不落盘
+         */
+        static void runAll(QOpenGLFunctions_3_3_Core* gl, uint64_t nSeed,
+            size_t nLineCount = 100'000, const std::string& strDir = std::string());
+    };
+}
+
+#endif // WORKLOAD_TRACE_H
@@ -0,0 +1,153 @@
+#ifndef FRAME_PROFILER_H
+#define FRAME_PROFILER_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <string>
+#include <QOpenGLFunctions_3_3_Core>
+
+namespace GLRhi
+{
+    /**
+     * @class FrameProfiler
+     * @brief 帧耗时分析器
+     *
+     * - CPU：各管理器用 ScopedStage 把分阶段耗时累加到当前帧（原子累加，后台整理线程也可写入）
+     * - GPU：每帧一个 GL_TIME_ELAPSED 查询，查询对象轮流使用，结果可用时才读取，
+     *   读回滞后若干帧但从不等待 GPU；环中查询都未完成时该帧不计 GPU 时间
+     * - 计数：绘制调用次数、上传字节数
+     *
+     * 帧的边界是上一次 endFrame 到本次 endFrame，两帧之间事件处理中的编辑也计入下一帧。
+     * beginFrame / endFrame 需在同一 OpenGL 上下文中调用。
+     */
+    class FrameProfiler
+    {
+    public:
+        /**
+         * @brief CPU 分阶段
+         */
+        enum class Stage
+        {
+            Rebuild,    // 重建绘制命令
+            Compact,    // 块整理
+            Upload,     // 顶点 / 索引上传
+            Draw,       // 绑定与绘制调用
+            Count
+        };
+        static constexpr size_t STAGE_COUNT = static_cast<size_t>(Stage::Count);
+
+        static constexpr size_t HISTORY_FRAMES = 240;   // 保留的帧数
+        static constexpr size_t QUERY_RING = 3;         // GPU 查询对象数（至少双缓冲）
+
+        /**
+         * @brief 一帧的统计
+         */
+        struct FrameSample
+        {
+            unsigned long long nFrame{ 0 };
+            double dFrameMs{ 0.0 };         // 与上一帧 endFrame 的间隔
+            double dPaintMs{ 0.0 };         // beginFrame 到 endFrame 的 CPU 耗时
+            std::array<double, STAGE_COUNT> arrStageMs{};
+            double dGpuMs{ -1.0 };          // GPU 耗时，-1 表示尚未读回或未测量
+            size_t nDrawCalls{ 0 };
+            size_t nUploadBytes{ 0 };
+        };
+
+        /**
+         * @brief 作用域计时，析构时累加到对应阶段；分析器为空时不计时
+         */
+        class ScopedStage
+        {
+        public:
+            ScopedStage(FrameProfiler* pProfiler, Stage eStage)
+                : m_pProfiler(pProfiler), m_eStage(eStage)
+            {
+                if (m_pProfiler)
+                    m_start = std::chrono::steady_clock::now();
+            }
+            ~ScopedStage()
+            {
+                if (m_pProfiler)
+                    m_pProfiler->addStageTime(m_eStage, std::chrono::steady_clock::now() - m_start);
+            }
+            ScopedStage(const ScopedStage&) = delete;
+            ScopedStage& operator=(const ScopedStage&) = delete;
+
+        private:
+            FrameProfiler* m_pProfiler;
+            Stage m_eStage;
+            std::chrono::steady_clock::time_point m_start;
+        };
+
+    public:
+        FrameProfiler() = default;
+        ~FrameProfiler() = default;
+        FrameProfiler(const FrameProfiler&) = delete;
+        FrameProfiler& operator=(const FrameProfiler&) = delete;
+
+        /**
+         * @brief 创建 / 释放 GPU 查询对象（在 OpenGL 上下文中调用）
+         */
+        void initGL(QOpenGLFunctions_3_3_Core* gl);
+        void releaseGL();
+
+        /**
+         * @brief 帧开始：读取已完成的 GPU 查询并开始本帧查询
+         */
+        void beginFrame();
+
+        /**
+         * @brief 帧结束：结束 GPU 查询，把本帧统计写入历史
+         * @param nUploadBytes 本帧上传字节数（通常取自 GpuMemoryBudget）
+         */
+        void endFrame(size_t nUploadBytes);
+
+        void addStageTime(Stage eStage, std::chrono::steady_clock::duration duration);
+        void addDrawCalls(size_t nCount) { m_nDrawCalls.fetch_add(nCount, std::memory_order_relaxed); }
+
+        const std::deque<FrameSample>& getHistory() const { return m_history; }
+
+        /**
+         * @brief 最近 nFrames 帧的平均值（GPU 只统计已读回的帧）
+         */
+        FrameSample getAverage(size_t nFrames = HISTORY_FRAMES) const;
+
+        /**
+         * @brief 导出历史为 CSV
+         * @return 文件无法写入时返回 false
+         */
+        bool exportCsv(const std::string& strPath) const;
+
+        static const char* stageName(Stage eStage);
+
+    private:
+        void collectGpuResults();
+
+    private:
+        /**
+         * @brief GPU 查询槽位
+         */
+        struct QuerySlot
+        {
+            GLuint query{ 0 };
+            unsigned long long nFrame{ 0 };
+            bool bPending{ false };     // 已结束查询但结果尚未读回
+        };
+
+        QOpenGLFunctions_3_3_Core* m_gl{ nullptr };
+        std::array<QuerySlot, QUERY_RING> m_arrQueries{};
+        QuerySlot* m_pActiveQuery{ nullptr };       // 本帧正在计时的查询
+
+        std::array<std::atomic<long long>, STAGE_COUNT> m_arrStageNs{};
+        std::atomic<size_t> m_nDrawCalls{ 0 };
+
+        unsigned long long m_nFrame{ 0 };
+        std::chrono::steady_clock::time_point m_lastEnd{};
+        std::chrono::steady_clock::time_point m_paintStart{};
+        std::deque<FrameSample> m_history;
+    };
+}
+
+#endif // FRAME_PROFILER_H
@@ -6,13 +6,20 @@
 #include <QOpenGLShaderProgram>
 #include <QTimer>
 #include <QKeyEvent>
+#include <QMouseEvent>
 
 #include <vector>
+#include <thread>
 #include "RenderCommon.h"
+#include "VertexFormat.h"
 
 namespace GLRhi
 {
     class PolylinesVboManager;
+    class TrianglesVboManager;
+    class TexturesVboManager;
+    class InstancedLinesManager;
+    class FrameProfiler;
     class FakeDataProvider;
 }
 
@@ -29,6 +36,7 @@ protected:
     void resizeGL(int w, int h) override;
     void paintGL() override;
     void keyPressEvent(QKeyEvent* event) override;
+    void mousePressEvent(QMouseEvent* event) override;
 
 private:
     void createShader();
@@ -41,10 +49,27 @@ private:
     void delFakeDatas();                    // 删除测试
     void modifyFakeData();                  // 修改测试线数据
     void showHideLines(bool bAll = false);  // 显示隐藏测试线
+    void startEditThread();                 // 延迟模式下从工作线程编辑折线
+    void drawStatsOverlay();                // 绘制显存统计面板
+    void initPrimitiveDemo();               // 创建三角形 / 纹理管理器及其着色器、纹理数组
+    void drawPrimitiveDemo();               // 绘制三角形与纹理图元
+    void toggleInstancedLines();            // 创建 / 显示 / 隐藏实例化宽线段
+    void streamInstancedLines();            // 每帧随机修改部分宽线段（演示增量上传）
 
 
     QOpenGLShaderProgram* m_program{ nullptr };
     GLRhi::PolylinesVboManager* m_linesMgr{ nullptr };
+    QOpenGLShaderProgram* m_triProgram{ nullptr };
+    QOpenGLShaderProgram* m_texProgram{ nullptr };
+    GLRhi::TrianglesVboManager* m_trisMgr{ nullptr };
+    GLRhi::TexturesVboManager* m_texsMgr{ nullptr };
+    GLuint m_texArray{ 0 };                 // 演示用 2D 纹理数组（4 层棋盘格）
+    bool m_bShowPrimitives{ false };        // 是否绘制三角形 / 纹理图元
+    GLRhi::InstancedLinesManager* m_instLinesMgr{ nullptr };
+    std::vector<long long> m_vInstLineIds;  // 实例化宽线段 ID
+    bool m_bShowInstLines{ false };         // 是否绘制实例化宽线段
+    bool m_bPickPending{ false };           // 已发起 GPU 拾取，等待读回
+    qint64 m_nPickStartUs{ 0 };             // 发起拾取的时间（微秒）
 
     GLRhi::FakeDataProvider* m_dataProvider{ nullptr };
     std::vector<GLRhi::PolylineData> m_polylineData;
@@ -54,6 +79,12 @@ private:
     QMatrix4x4  m_model;
 
     bool m_bUseDrawEx{ true };              // 是否使用高性能绘制
+    GLRhi::VertexFormat m_eVertexFormat{ GLRhi::VertexFormat::Float3 }; // 折线顶点格式
+    std::thread m_editThread;               // 延迟模式编辑线程（不持有 GL 上下文）
+    bool m_bShowStats{ false };             // 是否显示显存统计面板
+    GLRhi::FrameProfiler* m_pProfiler{ nullptr };   // 帧耗时分析器
+    size_t m_nGpuBudgetMB{ 0 };             // 显存预算（MB），0 表示不限制
+    uint64_t m_nWorkloadSeed{ 1 };          // 负载回放测试的随机种子
     QTimer      m_timer;
     int         m_frame{ 0 };
 
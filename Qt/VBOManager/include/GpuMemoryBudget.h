@@ -0,0 +1,151 @@
+#ifndef GPU_MEMORY_BUDGET_H
+#define GPU_MEMORY_BUDGET_H
+
+#include <cstddef>
+#include <mutex>
+#include <unordered_map>
+
+namespace GLRhi
+{
+    /**
+     * @brief 显存统计（供性能面板显示）
+     */
+    struct GpuMemoryStats
+    {
+        size_t nBlockCount{ 0 };            // 登记的块数（含已驱逐）
+        size_t nEvictedBlockCount{ 0 };     // 已驱逐到 CPU 的块数
+        size_t nAllocatedBytes{ 0 };        // 已分配显存（VBO + EBO 容量）
+        size_t nUsedBytes{ 0 };             // 实际使用的显存
+        size_t nBudgetBytes{ 0 };           // 显存预算，0 表示不限制
+        double dFragmentation{ 0.0 };       // 碎片率：1 - 使用 / 分配
+
+        size_t nUploadsLastFrame{ 0 };      // 上一帧的上传次数
+        size_t nUploadBytesLastFrame{ 0 };  // 上一帧的上传字节数
+        size_t nCompactsLastFrame{ 0 };     // 上一帧的整理次数
+        double dCompactMsLastFrame{ 0.0 };  // 上一帧的整理耗时（毫秒）
+
+        size_t nShrinkCount{ 0 };           // 累计收缩次数
+        size_t nMergeCount{ 0 };            // 累计合并次数
+        size_t nEvictCount{ 0 };            // 累计驱逐次数
+        size_t nRestoreCount{ 0 };          // 累计恢复次数
+    };
+
+    /**
+     * @brief 全局显存预算
+     *
+     * 只负责记账：各管理器在块分配、扩容、收缩、释放时登记块的分配 / 使用字节数，
+     * 在上传时登记上传量。超出预算时由管理器自己决定如何回收（合并、收缩、驱逐）。
+     * 多个管理器可共享同一个实例，预算对所有登记的块统一生效。
+     * 所有接口线程安全。
+     */
+    class GpuMemoryBudget
+    {
+    public:
+        /**
+         * @brief 回收事件类型
+         */
+        enum class Event
+        {
+            Shrink,     // 收缩过度分配的块
+            Merge,      // 合并稀疏块
+            Evict,      // 驱逐隐藏块到 CPU
+            Restore     // 恢复驱逐的块
+        };
+
+    public:
+        GpuMemoryBudget() = default;
+        GpuMemoryBudget(const GpuMemoryBudget&) = delete;
+        GpuMemoryBudget& operator=(const GpuMemoryBudget&) = delete;
+
+        /**
+         * @brief 设置显存预算
+         * @param nBytes 预算字节数，0 表示不限制（默认）
+         */
+        void setBudget(size_t nBytes);
+        size_t getBudget() const;
+
+        /**
+         * @brief 登记或更新块的显存占用
+         * @param pBlock 块标识（通常为块指针）
+         * @param nAllocated 已分配字节数
+         * @param nUsed 已使用字节数
+         * @param bEvicted 块是否已驱逐（驱逐后分配与使用均应为 0）
+         */
+        void updateBlock(const void* pBlock, size_t nAllocated, size_t nUsed, bool bEvicted = false);
+
+        /**
+         * @brief 注销块
+         */
+        void removeBlock(const void* pBlock);
+
+        /**
+         * @brief 当前所有块已分配的字节数
+         */
+        size_t getAllocatedBytes() const;
+
+        /**
+         * @brief 超出预算的字节数，未设置预算或未超出时返回 0
+         */
+        size_t getOverBudgetBytes() const;
+        bool isOverBudget() const { return getOverBudgetBytes() > 0; }
+
+        /**
+         * @brief 登记一次上传（glBufferData / glBufferSubData / glCopyBufferSubData）
+         * @param nBytes 上传字节数
+         */
+        void recordUpload(size_t nBytes);
+
+        /**
+         * @brief 登记一次块整理（空洞压缩）
+         * @param dMs 整理耗时（毫秒，含读回与重新上传）
+         */
+        void recordCompact(double dMs);
+
+        /**
+         * @brief 登记一次回收事件
+         */
+        void recordEvent(Event eEvent);
+
+        /**
+         * @brief 帧开始：把本帧上传统计转为上一帧，每帧由渲染方调用一次
+         */
+        void beginFrame();
+
+        /**
+         * @brief 获取统计快照
+         */
+        GpuMemoryStats getStats() const;
+
+    private:
+        struct BlockUsage
+        {
+            size_t nAllocated{ 0 };
+            size_t nUsed{ 0 };
+            bool bEvicted{ false };
+        };
+
+        mutable std::mutex m_mutex;
+        std::unordered_map<const void*, BlockUsage> m_blocks;   // 块 -> 占用
+
+        size_t m_nBudgetBytes{ 0 };
+        size_t m_nAllocatedBytes{ 0 };
+        size_t m_nUsedBytes{ 0 };
+        size_t m_nEvictedCount{ 0 };
+
+        size_t m_nUploads{ 0 };             // 本帧上传次数
+        size_t m_nUploadBytes{ 0 };         // 本帧上传字节数
+        size_t m_nLastUploads{ 0 };
+        size_t m_nLastUploadBytes{ 0 };
+        size_t m_nCompacts{ 0 };            // 本帧整理次数
+        double m_dCompactMs{ 0.0 };         // 本帧整理耗时
+        size_t m_nLastCompacts{ 0 };
+        double m_dLastCompactMs{ 0.0 };
+
+        size_t m_nShrinkCount{ 0 };
+        size_t m_nMergeCount{ 0 };
+        size_t m_nEvictCount{ 0 };
+        size_t m_nRestoreCount{ 0 };
+    };
+}
+
+#endif // GPU_MEMORY_BUDGET_H
@@ -0,0 +1,125 @@
+#ifndef INSTANCED_LINES_MANAGER_H
+#define INSTANCED_LINES_MANAGER_H
+
+#include <vector>
+#include <unordered_map>
+#include <mutex>
+#include <memory>
+#include <QOpenGLFunctions_3_3_Core>
+#include <QOpenGLShaderProgram>
+
+#include "RenderCommon.h"
+#include "GpuMemoryBudget.h"
+
+namespace GLRhi
+{
+    /**
+     * @class InstancedLinesManager
+     * @brief 实例化宽线段管理器
+     *
+     * 每条线段是实例缓冲区中的一个 InstanceLineData，顶点着色器把单位四边形沿线段方向
+     * 在屏幕空间展开为 width 像素宽，片元着色器按到中心线的距离做 1 像素抗锯齿。
+     * 不依赖 glLineWidth（核心模式下宽度大于 1 不可移植）。
+     *
+     * - 实例缓冲区常驻显存，容量按倍数增长，扩容时在同一缓冲区名上重新分配并从 CPU 镜像整体上传
+     * - 每个 ID 占一个稳定槽位，删除时把末尾槽位移入空位（swap-remove），实例始终连续
+     * - 修改只标记脏槽位，绘制前合并成少量连续区间再 glBufferSubData
+     * - 所有实例一次 glDrawArraysInstanced 绘制
+     *
+     * 需在 OpenGL 上下文中创建与调用，着色器程序由管理器自己创建。
+     */
+    class InstancedLinesManager
+    {
+    public:
+        static constexpr size_t INIT_CAPACITY = 4'096;      // 初始实例容量
+        static constexpr size_t DIRTY_MERGE_GAP = 64;       // 间隔不超过该槽位数的脏区间合并上传
+
+    public:
+        InstancedLinesManager();
+        ~InstancedLinesManager();
+
+        InstancedLinesManager(const InstancedLinesManager&) = delete;
+        InstancedLinesManager& operator=(const InstancedLinesManager&) = delete;
+
+    public:
+        /**
+         * @brief 添加线段，ID 已存在时返回 false
+         * @param line 端点为 NDC 坐标，width 为屏幕像素宽度，depth 叠加到 z
+         */
+        bool addLine(long long id, const InstanceLineData& line);
+
+        /**
+         * @brief 批量添加线段
+         * @return 实际添加的数量
+         */
+        size_t addLines(const std::vector<long long>& vIds, const std::vector<InstanceLineData>& vLines);
+
+        /**
+         * @brief 更新线段（原位覆盖，只标记对应槽位）
+         */
+        bool updateLine(long long id, const InstanceLineData& line);
+
+        /**
+         * @brief 删除线段（末尾实例移入空位）
+         */
+        bool removeLine(long long id);
+
+        void clearAllLines();
+
+        size_t getLineCount() const;
+
+        /**
+         * @brief 绘制所有线段
+         * 上传脏区间后一次实例化绘制；调用方负责开启混合以获得抗锯齿效果
+         * @param nViewportW 视口宽度（像素）
+         * @param nViewportH 视口高度（像素）
+         */
+        void render(int nViewportW, int nViewportH);
+
+        /**
+         * @brief 上一次绘制时上传的区间数与实例数（用于观察增量更新效果）
+         */
+        size_t getLastUploadRanges() const { return m_nLastUploadRanges; }
+        size_t getLastUploadInstances() const { return m_nLastUploadInstances; }
+
+        /**
+         * @brief 替换显存预算（可与其他管理器共享）
+         */
+        void setGpuMemoryBudget(std::shared_ptr<GpuMemoryBudget> pBudget);
+        std::shared_ptr<GpuMemoryBudget> getGpuMemoryBudget() const { return m_pGpuBudget; }
+
+    private:
+        bool initGLResources();
+        void ensureCapacity(size_t nNeed);
+        void markDirty(size_t nSlot);
+        void flushDirty();
+        void trackBuffer();
+
+    private:
+        QOpenGLFunctions_3_3_Core* m_gl{ nullptr };
+        std::unique_ptr<QOpenGLShaderProgram> m_pProgram;
+        GLint m_nViewportLoc{ -1 };
+        GLint m_nFeatherLoc{ -1 };
+
+        GLuint m_vao{ 0 };                  // 顶点数组对象
+        GLuint m_quadVbo{ 0 };              // 单位四边形（逐顶点）
+        GLuint m_instanceVbo{ 0 };          // 实例缓冲区（逐实例）
+        size_t m_nCapacity{ 0 };            // 实例容量
+
+        mutable std::mutex m_mutex;
+        std::vector<InstanceLineData> m_vInstances;         // 实例 CPU 镜像，与显存槽位一一对应
+        std::vector<long long> m_vSlotIds;                  // 槽位 -> ID
+        std::unordered_map<long long, size_t> m_idToSlot;   // ID -> 槽位
+
+        std::vector<size_t> m_vDirtySlots;  // 待上传的槽位（由 m_vDirtyFlags 去重）
+        std::vector<bool> m_vDirtyFlags;    // 槽位是否已在待上传列表中
+        bool m_bFullUpload{ false };        // 扩容后整体重新上传
+
+        size_t m_nLastUploadRanges{ 0 };
+        size_t m_nLastUploadInstances{ 0 };
+
+        std::shared_ptr<GpuMemoryBudget> m_pGpuBudget;  // 显存预算（可共享）
+    };
+}
+
+#endif // INSTANCED_LINES_MANAGER_H
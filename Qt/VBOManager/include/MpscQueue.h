@@ -0,0 +1,95 @@
+#ifndef MPSC_QUEUE_H
+#define MPSC_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+namespace GLRhi
+{
+    /**
+     * @brief 多生产者单消费者无锁队列（Vyukov 侵入式链表）
+     *
+     * - push 为 wait-free：一次原子 exchange + 一次 store，任意线程可调用
+     * - pop 仅允许单个消费者线程（渲染线程）调用
+     * - 生产者 exchange 之后、链接 next 之前，消费者可能暂时看到队列为空，
+     *   该元素会在下一次 pop 时取出，不会丢失
+     */
+    template <typename T>
+    class MpscQueue
+    {
+    public:
+        MpscQueue()
+        {
+            Node* pStub = new Node();
+            m_head.store(pStub, std::memory_order_relaxed);
+            m_tail = pStub;
+        }
+
+        ~MpscQueue()
+        {
+            T tmp;
+            while (pop(tmp))
+            {
+            }
+            delete m_tail;
+        }
+
+        MpscQueue(const MpscQueue&) = delete;
+        MpscQueue& operator=(const MpscQueue&) = delete;
+
+        /**
+         * @brief 入队（任意线程）
+         */
+        void push(T value)
+        {
+            Node* pNode = new Node();
+            pNode->value = std::move(value);
+
+            Node* pPrev = m_head.exchange(pNode, std::memory_order_acq_rel);
+            pPrev->next.store(pNode, std::memory_order_release);
+            m_nSize.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief 出队（仅消费者线程）
+         * @param out 取出的元素
+         * @return false 队列为空
+         */
+        bool pop(T& out)
+        {
+            Node* pTail = m_tail;
+            Node* pNext = pTail->next.load(std::memory_order_acquire);
+            if (!pNext)
+                return false;
+
+            // pNext 成为新的哨兵节点，其值已被移走
+            out = std::move(pNext->value);
+            m_tail = pNext;
+            delete pTail;
+            m_nSize.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+
+        /**
+         * @brief 近似元素数量（仅用于统计）
+         */
+        size_t sizeApprox() const
+        {
+            return m_nSize.load(std::memory_order_relaxed);
+        }
+
+    private:
+        struct Node
+        {
+            std::atomic<Node*> next{ nullptr };
+            T value{};
+        };
+
+        alignas(64) std::atomic<Node*> m_head{ nullptr };   // 生产者端
+        alignas(64) Node* m_tail{ nullptr };                // 消费者端（哨兵）
+        std::atomic<size_t> m_nSize{ 0 };
+    };
+}
+
+#endif // MPSC_QUEUE_H
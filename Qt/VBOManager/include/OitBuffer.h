@@ -0,0 +1,88 @@
+#ifndef OIT_BUFFER_H
+#define OIT_BUFFER_H
+
+#include <memory>
+#include <QOpenGLFunctions_3_3_Core>
+#include <QOpenGLShaderProgram>
+
+namespace GLRhi
+{
+    /**
+     * @class OitBuffer
+     * @brief 加权混合顺序无关透明（Weighted Blended OIT）缓冲区
+     *
+     * 与当前视口同尺寸的两张浮点附件：
+     * - RT0 RGBA16F：rgb 累加 颜色 * alpha * 权重，a 累乘 (1 - alpha)（透射率）
+     * - RT1 R16F：累加 alpha * 权重
+     * 半透明片元只做加法 / 乘法混合，结果与绘制顺序无关；end 时用全屏三角形
+     * 按 rgb / 权重和、alpha = 1 - 透射率 合成到之前绑定的帧缓冲。
+     *
+     * 着色器与折线着色器使用相同的块级 uniform（uBlockOrigin / uBlockScale / uBlockZ）与 uColor，
+     * 并假定还原后的顶点坐标即裁剪坐标（与 GLTestWidget 的折线着色器一致）。
+     * 缓冲区不带深度附件，半透明折线不会被不透明折线遮挡（二维折线场景下可以接受）。
+     */
+    class OitBuffer
+    {
+    public:
+        /**
+         * @brief 累加着色器的 uniform 位置
+         */
+        struct Uniforms
+        {
+            GLint nColor{ -1 };     // uColor
+        };
+
+    public:
+        explicit OitBuffer(QOpenGLFunctions_3_3_Core* gl);
+        ~OitBuffer();
+
+        OitBuffer(const OitBuffer&) = delete;
+        OitBuffer& operator=(const OitBuffer&) = delete;
+
+        /**
+         * @brief 开始累加：保存当前 GL 状态，按当前视口尺寸准备 FBO 并清空，绑定累加着色器
+         * @return false 着色器或 FBO 不可用（此时 GL 状态未改变）
+         */
+        bool begin();
+
+        /**
+         * @brief 结束累加：合成到之前绑定的帧缓冲，恢复 GL 状态
+         */
+        void end();
+
+        const Uniforms& getUniforms() const { return m_uniforms; }
+        GLuint getProgramId() const { return m_pAccumProgram ? m_pAccumProgram->programId() : 0; }
+
+    private:
+        bool initPrograms();
+        bool ensureTarget(int nWidth, int nHeight);
+        void releaseTarget();
+
+    private:
+        QOpenGLFunctions_3_3_Core* m_gl{ nullptr };
+        std::unique_ptr<QOpenGLShaderProgram> m_pAccumProgram;
+        std::unique_ptr<QOpenGLShaderProgram> m_pCompositeProgram;
+        Uniforms m_uniforms;
+        GLint m_nCompositeOrigin{ -1 };     // 合成着色器的 uOrigin（视口左下角）
+
+        GLuint m_fbo{ 0 };
+        GLuint m_texAccum{ 0 };         // RGBA16F：累加颜色 + 透射率
+        GLuint m_texWeight{ 0 };        // R16F：权重和
+        GLuint m_vao{ 0 };              // 全屏三角形用的空 VAO（核心模式绘制必须绑定 VAO）
+        int m_nWidth{ 0 };
+        int m_nHeight{ 0 };
+
+        // begin 时保存、end 时恢复的状态
+        GLint m_nPrevFbo{ 0 };
+        GLint m_arrPrevViewport[4]{ 0, 0, 0, 0 };
+        GLint m_nPrevProgram{ 0 };
+        GLint m_nPrevVao{ 0 };
+        GLint m_nPrevActiveTexture{ GL_TEXTURE0 };
+        GLint m_arrPrevBlendFunc[4]{ GL_ONE, GL_ZERO, GL_ONE, GL_ZERO };   // src rgb, dst rgb, src a, dst a
+        GLboolean m_bPrevDepthTest{ 0 };
+        GLboolean m_bPrevDepthMask{ 1 };
+        GLboolean m_bPrevBlend{ 0 };
+    };
+}
+
+#endif // OIT_BUFFER_H
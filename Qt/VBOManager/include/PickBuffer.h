@@ -0,0 +1,94 @@
+#ifndef PICK_BUFFER_H
+#define PICK_BUFFER_H
+
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <QOpenGLFunctions_3_3_Core>
+#include <QOpenGLShaderProgram>
+
+namespace GLRhi
+{
+    /**
+     * @class PickBuffer
+     * @brief 离屏拾取缓冲区
+     *
+     * 一个 (2 * 容差 + 1) 像素见方的 RG32UI 整数 FBO：R 通道写块序号（从 1 开始，0 表示空），
+     * G 通道写 gl_VertexID（含 basevertex，即块内顶点下标）。
+     * 绘制结束后 glReadPixels 到 PBO 并插入 fence，下一帧再映射读取，不阻塞渲染线程；
+     * 需要立即得到结果时也可以等待 fence。
+     *
+     * 着色器与折线着色器使用相同的块级 uniform（uBlockOrigin / uBlockScale / uBlockZ），
+     * 并假定还原后的顶点坐标即裁剪坐标（与 GLTestWidget 的折线着色器一致）。
+     */
+    class PickBuffer
+    {
+    public:
+        /**
+         * @brief 拾取着色器的 uniform 位置
+         */
+        struct Uniforms
+        {
+            GLint nPickCenter{ -1 };    // uPickCenter：光标的 NDC 坐标
+            GLint nPickScale{ -1 };     // uPickScale：视口尺寸 / 拾取窗口尺寸
+            GLint nPickBlock{ -1 };     // uPickBlock：块序号
+        };
+
+    public:
+        explicit PickBuffer(QOpenGLFunctions_3_3_Core* gl);
+        ~PickBuffer();
+
+        PickBuffer(const PickBuffer&) = delete;
+        PickBuffer& operator=(const PickBuffer&) = delete;
+
+        /**
+         * @brief 开始拾取绘制：保存当前 GL 状态，绑定 FBO 并清零，绑定拾取着色器
+         * @param nSize 拾取窗口边长（像素）
+         * @return false 着色器或 FBO 不可用
+         */
+        bool begin(int nSize);
+
+        /**
+         * @brief 结束拾取绘制：异步读回到 PBO，恢复 GL 状态
+         */
+        void end();
+
+        /**
+         * @brief 取回读回结果
+         * @param vTexels 输出 nSize * nSize 个 (块序号, 顶点下标)，行优先、自下而上
+         * @param bWait true 时等待 GPU 完成；false 时未完成直接返回 false
+         * @return true 读取成功（之后不再处于等待状态）
+         */
+        bool fetch(std::vector<uint32_t>& vTexels, bool bWait);
+
+        bool isPending() const { return m_fence != nullptr; }
+        int getSize() const { return m_nSize; }
+        const Uniforms& getUniforms() const { return m_uniforms; }
+        GLuint getProgramId() const { return m_pProgram ? m_pProgram->programId() : 0; }
+
+    private:
+        bool initProgram();
+        bool ensureTarget(int nSize);
+        void releaseTarget();
+
+    private:
+        QOpenGLFunctions_3_3_Core* m_gl{ nullptr };
+        std::unique_ptr<QOpenGLShaderProgram> m_pProgram;
+        Uniforms m_uniforms;
+
+        GLuint m_fbo{ 0 };
+        GLuint m_tex{ 0 };              // RG32UI 颜色附件
+        GLuint m_pbo{ 0 };              // 读回用像素缓冲区
+        GLsync m_fence{ nullptr };      // 读回完成标志
+        int m_nSize{ 0 };
+
+        // begin 时保存、end 时恢复的状态
+        GLint m_nPrevFbo{ 0 };
+        GLint m_arrPrevViewport[4]{ 0, 0, 0, 0 };
+        GLint m_nPrevProgram{ 0 };
+        GLboolean m_bPrevDepthTest{ 0 };
+        GLboolean m_bPrevBlend{ 0 };
+    };
+}
+
+#endif // PICK_BUFFER_H
@@ -4,10 +4,20 @@
 #include <vector>
 #include <unordered_map>
 #include <shared_mutex>
+#include <mutex>
 #include <atomic>
 #include <thread>
 #include <map>
+#include <memory>
 #include "RenderCommon.h"
+#include "VertexFormat.h"
+#include "MpscQueue.h"
+#include "GpuMemoryBudget.h"
+#include "PickBuffer.h"
+#include "SegmentRTree.h"
+#include "FrameProfiler.h"
+#include "UploadThread.h"
+#include "OitBuffer.h"
 #include <QOpenGLFunctions_3_3_Core>
 
 namespace GLRhi
@@ -39,6 +49,10 @@ namespace GLRhi
         unsigned int ebo{ 0 };          // 索引缓冲区对象
         Color color;                    // 该块所有折线的统一颜色
 
+        VertexFormat eFormat{ VertexFormat::Float3 }; // 顶点存储格式
+        QuantizeWindow window;          // 块坐标窗口（压缩格式下顶点相对该原点存储）
+        float fLayerZ{ 0.0f };          // 块内统一的 z 值（压缩格式下由 uniform 传入）
+
         size_t nVertexCapacity{ 0 };    // 顶点容量上限
         size_t nIndexCapacity{ 0 };     // 索引容量上限
         size_t nVertexCount{ 0 };       // 当前实际使用的顶点数
@@ -50,10 +64,59 @@ namespace GLRhi
 
         std::unordered_map<long long, size_t> idToIndexMap; // 图元ID到索引的映射，用于快速查找
 
+        std::vector<float> vShadow;     // VBO 的 CPU 镜像（xyz 浮点，按 nBaseVertex * 3 寻址）
+        bool bShadowValid{ true };      // 影子是否完整（超出内存预算被释放后为 false，改为读回显存）
+        bool bEvicted{ false };         // 显存已释放，数据只保存在影子中（整块隐藏且超出显存预算时）
+
+        SegmentRTree pickTree;          // CPU 拾取用线段 R 树（首次 CPU 拾取时构建）
+        bool bPickTreeDirty{ true };    // 绘制命令重建后 R 树需要重建
+
+        std::vector<GLsizei> vNextDrawCounts;   // 后台缓冲：线程池上预处理生成，发布时与前台交换
+        std::vector<GLint>   vNextBaseVertices;
+        size_t nEditVersion{ 0 };               // 图元增删改、可见性或布局变化时递增
+        size_t nPreparedVersion{ static_cast<size_t>(-1) }; // 后台缓冲对应的 nEditVersion
+
+        float fSortDepth{ 0.0f };               // 有序绘制用的代表深度（NDC z）
+        size_t nSortVersion{ static_cast<size_t>(-1) };     // fSortDepth 对应的 nEditVersion
+
         bool bDirty{ false };           // 标记绘制命令是否需要重建
+        std::mutex cmdMutex;            // 共享锁下读写 bDirty / 串行重建前台命令时加锁（绘制与 prepareDrawCmds 可能并发）
         bool bCompact{ false };         // 标记是否需要进行内存碎片整理
     };
 
+    /**
+     * @brief 延迟模式下的折线编辑命令
+     *
+     * 编辑线程只负责把命令写入无锁队列，由渲染线程在每帧开始时统一合并并执行。
+     */
+    struct PolylineCommand
+    {
+        enum class Type
+        {
+            Add,        // 添加折线
+            Remove,     // 删除折线
+            Update,     // 更新顶点
+            SetVisible, // 设置可见性
+            Clear       // 清空全部
+        };
+
+        Type eType{ Type::Add };
+        long long id{ -1 };
+        std::vector<float> vVerts;      // Add / Update 的顶点数据
+        Color color;                    // Add 的颜色
+        bool bVisible{ true };          // SetVisible 的可见性
+    };
+
+    /**
+     * @brief 绘制顺序
+     */
+    enum class RenderOrder
+    {
+        Unordered,      // 按颜色映射表遍历（最快，顺序不固定）
+        Sorted,         // 按 (半透明, 深度桶, 颜色, 块) 排序：不透明块由近到远，半透明块由远到近混合
+        WeightedOit     // 不透明块同 Sorted，半透明块走加权混合顺序无关透明（与绘制顺序无关）
+    };
+
     //////////////////////////////////////////////////////////////////////////////////////////////
     /**
      * @class PolylinesVboManager
@@ -69,13 +132,130 @@ namespace GLRhi
      * - 后台线程进行资源优化，不阻塞渲染线程
      * - 增量数据上传策略，减少GPU通信开销
      * - 使用VAO/VBO/EBO进行高效渲染，支持OpenGL 3.3+
+     * - 可选 16 位量化 / 半精度压缩顶点格式，顶点显存与上传带宽降为 1/3
+     * - 可选延迟模式：任意线程编辑只写入无锁命令队列，所有 GL 调用集中在渲染线程
+     * - 可选显存预算：超出时依次合并稀疏块、收缩过度分配的块、把整块隐藏的块驱逐到 CPU
+     *
+     * 压缩格式下着色器需声明 uBlockOrigin(vec2)、uBlockScale(float)、uBlockZ(float)，
+     * 并按 vec3(uBlockOrigin + aPos.xy * uBlockScale, aPos.z + uBlockZ) 还原坐标；
+     * Float3 块会传入 (0, 0)、1、0，同一着色器可同时绘制两种块。
      */
     class PolylinesVboManager final
     {
     public:
-        PolylinesVboManager();
+        explicit PolylinesVboManager(VertexFormat eFormat = VertexFormat::Float3);
         ~PolylinesVboManager();
     public:
+        /**
+         * @brief 设置量化步长
+         * 仅影响之后新建的压缩格式块，单块覆盖范围 Quantized16 为原点 ± 32767 * 步长，
+         * HalfFloat 为原点 ± 2048 * 步长。
+         * @param fStep 世界坐标下的最小可分辨距离
+         */
+        void setQuantizeStep(float fStep);
+        float getQuantizeStep() const { return m_fQuantizeStep; }
+
+        VertexFormat getVertexFormat() const { return m_eVertexFormat; }
+
+        /**
+         * @brief 设置延迟模式
+         *
+         * 延迟模式下 add / remove / update / setVisible / clear 只把命令写入无锁队列并立即返回 true，
+         * 不持有 m_mutex、不调用 GL，可在任意线程调用；渲染线程在 renderVisiblePrimitives*
+         * 开始时（或显式调用 applyPendingCommands）合并并执行，同一 ID 以最后一次写入为准。
+         * 切换到立即模式前应先在渲染线程调用一次 applyPendingCommands。
+         * 切换到延迟模式会停止后台碎片整理线程（整理需要 GL，改由每帧渲染时完成），切回后需要时重新启动。
+         */
+        void setDeferredMode(bool bDeferred);
+        bool isDeferredMode() const { return m_bDeferred.load(std::memory_order_relaxed); }
+
+        /**
+         * @brief 取出并执行全部待处理命令（仅渲染线程调用）
+         * @return 本次取出的命令数量
+         */
+        size_t applyPendingCommands();
+
+        /**
+         * @brief 待处理命令的近似数量
+         */
+        size_t getPendingCommandCount() const { return m_commandQueue.sizeApprox(); }
+
+        /**
+         * @brief 获取当前所有块已使用的顶点字节数
+         */
+        size_t getUsedVertexBytes() const;
+
+        /**
+         * @brief 从显存读回折线顶点并还原为 xyz（精度校验用）
+         * 需在 OpenGL 上下文中调用，且块扩容后需先渲染一帧完成重建。
+         * @param id 折线ID
+         * @param vVerts 输出顶点 [x, y, z, ...]
+         * @return true 读取成功
+         */
+        bool readBackPolyline(long long id, std::vector<float>& vVerts);
+
+        /**
+         * @brief 设置 CPU 影子数据的内存预算
+         * 影子是每个块一段连续的 float 数组，用于 compact 时重建顶点数据。
+         * 超出预算且开启显存读回时，从最大的块开始释放影子，之后该块 compact 改为读回显存。
+         * @param nBytes 预算字节数，0 表示不限制（默认）
+         */
+        void setShadowMemoryBudget(size_t nBytes);
+
+        /**
+         * @brief 开启 / 关闭显存读回兜底
+         * 关闭时（默认）影子始终完整，超出预算只输出一次警告。
+         */
+        void setGpuReadBackFallback(bool bEnable);
+
+        /**
+         * @brief 获取当前 CPU 影子占用的字节数
+         */
+        size_t getShadowMemoryBytes() const;
+
+        /**
+         * @brief 替换显存预算（多个管理器可共享同一个预算）
+         * 当前所有块会从旧预算注销并登记到新预算。
+         * @param pBudget 新的预算对象，为空时忽略
+         */
+        void setGpuMemoryBudget(std::shared_ptr<GpuMemoryBudget> pBudget);
+        std::shared_ptr<GpuMemoryBudget> getGpuMemoryBudget() const { return m_pGpuBudget; }
+
+        /**
+         * @brief 设置显存预算上限（等价于 getGpuMemoryBudget()->setBudget）
+         *
+         * 每帧绘制前检查，超出时按以下顺序回收，直到回到预算内：
+         * 1. 同色、同格式、同坐标窗口的稀疏块（使用率 < 50%）合并，小块并入有空余的块
+         * 2. 释放没有存活图元的空块，收缩分配量超过使用量 2 倍的块
+         * 3. 整块都不可见的块释放显存，只保留 CPU 影子；重新可见时自动恢复
+         *
+         * @param nBytes 预算字节数（VBO + EBO 分配量），0 表示不限制（默认）
+         */
+        void setGpuMemoryLimit(size_t nBytes);
+
+        /**
+         * @brief 设置帧耗时分析器（为空时不计时）
+         * 重建绘制命令、整理、上传、绘制的耗时与绘制调用次数累加到分析器的当前帧。
+         * 分析器由调用方持有，需比管理器活得久或在销毁前置空。
+         */
+        void setFrameProfiler(FrameProfiler* pProfiler) { m_pProfiler = pProfiler; }
+
+        /**
+         * @brief 设置绘制顺序（仅渲染线程调用）
+         *
+         * 有序模式下每个块按代表深度（压缩块取 fLayerZ，Float3 块取各图元首顶点 z 的均值）
+         * 量化到 16 位深度桶，与颜色键、块序号组成 64 位键做基数排序；
+         * 块增删或块被编辑导致深度桶变化时才重新排序，否则复用上一帧的顺序。
+         * 同一深度桶内按颜色连续绘制，uColor 只在颜色变化时设置，绘制调用数与无序模式相同。
+         * 半透明块（alpha < 1）在不透明块之后绘制，期间关闭深度写入。
+         */
+        void setRenderOrder(RenderOrder eOrder) { m_eRenderOrder = eOrder; }
+        RenderOrder getRenderOrder() const { return m_eRenderOrder; }
+
+        /**
+         * @brief 获取显存统计快照
+         */
+        GpuMemoryStats getGpuMemoryStats() const;
 
         /**
          * @brief 添加单条折线
@@ -96,6 +276,57 @@ namespace GLRhi
          */
         bool addPolylines(std::vector<PolylineData>& vPolylineDatas);
 
+        /**
+         * @brief 零拷贝批量加载（文件打开等大批量场景）
+         * 直接读取连续的顶点数组与点数数组（与 PolylineData / FakePolyLineData 布局一致），
+         * 每个块一次分配、每个缓冲区一次上传，图元信息与绘制命令多线程并行生成。
+         * @param pIds 折线ID数组
+         * @param pCounts 每条折线的顶点数
+         * @param nLineCount 折线数量
+         * @param pVerts 首尾相接的顶点数组 [x, y, z, ...]
+         * @param color 折线颜色
+         * @return 实际加载的折线数量
+         */
+        size_t loadPolylines(const long long* pIds, const size_t* pCounts, size_t nLineCount,
+            const float* pVerts, const Color& color);
+
+        /**
+         * @brief 启动上传线程（在 GUI / 渲染线程调用，渲染上下文需为当前上下文）
+         * 上传线程持有与渲染上下文共享的上下文，loadPolylinesAsync 的编码与缓冲区创建、填充都在其中完成。
+         * @return 共享上下文创建失败时返回 false，loadPolylinesAsync 退回同步加载
+         */
+        bool startUploadThread();
+
+        /**
+         * @brief 停止上传线程，尚未开始的加载任务被丢弃（在渲染上下文中调用）
+         */
+        void stopUploadThread();
+
+        /**
+         * @brief 异步批量加载（大文件打开等场景，不阻塞 UI）
+         *
+         * 数据移交给上传线程：按块顶点上限分批、编码顶点、创建并填充 VBO / EBO，插入栅栏后返回结果。
+         * 渲染线程在下一次 renderVisiblePrimitives* 开始时对栅栏 glWaitSync（GPU 端等待），
+         * 创建 VAO 并把新块接入，此后折线可见、可编辑。
+         * - 每批放入新建块，不与已有块合并；压缩格式下批次超出单块窗口时该批改用 Float3
+         * - 接入时已存在的 ID（含批次内重复）被跳过，对应图元由整理回收
+         * - 接入前调用 clearAllPrimitives 的加载结果作废
+         *
+         * 上传线程未启动时直接调用 loadPolylines 同步加载。
+         * @param vIds 折线ID
+         * @param vCounts 每条折线的顶点数
+         * @param vVerts 首尾相接的顶点数组 [x, y, z, ...]
+         * @param color 折线颜色
+         * @return 提交的折线数量（点数不足 2 的被跳过）；同步加载时为实际加载数量
+         */
+        size_t loadPolylinesAsync(std::vector<long long> vIds, std::vector<size_t> vCounts,
+            std::vector<float> vVerts, const Color& color);
+
+        /**
+         * @brief 已提交但尚未接入的异步加载批数
+         */
+        size_t getPendingUploadCount() const { return m_nAsyncInFlight.load(std::memory_order_relaxed); }
+
         /**
          * @brief 删除指定ID的折线
          * 从管理器中移除指定ID的折线，不立即释放内存而是标记为待清理。
@@ -139,9 +370,58 @@ namespace GLRhi
         void renderVisiblePrimitives(); // glDrawElementsBaseVertex
         void renderVisiblePrimitivesEx(); // glDrawElementsInstancedBaseVertex
 
+        /**
+         * @brief 在线程池上并行重建所有脏块的绘制命令（双缓冲，发布时交换）
+         * 绘制时会自动调用；批量编辑后可在两帧之间提前调用，让下一帧只做绑定与绘制。
+         * 不调用 GL，可在任意线程调用（不要在共享线程池的工作线程中调用）。
+         * @return 发布的块数
+         */
+        size_t prepareDrawCmds();
+
+        /**
+         * @brief GPU 拾取（同步）：发起拾取并等待结果
+         * @param x 光标 x（相对当前视口左上角的像素坐标）
+         * @param y 光标 y（向下为正）
+         * @param nTolerancePx 容差（像素），拾取窗口为 (2 * 容差 + 1) 见方，上限 64
+         * @return 离光标最近的可见折线 ID，未命中返回 -1
+         */
+        long long pick(int x, int y, int nTolerancePx = 3);
+
+        /**
+         * @brief GPU 拾取（异步）：只把光标附近的区域画进 RG32UI 离屏缓冲区，
+         *        写入 (块序号, gl_VertexID)，再通过 PBO 异步读回
+         *
+         * 片元与读回开销与场景规模无关，顶点仍需遍历所有块。
+         * 顶点坐标按 uBlockOrigin / uBlockScale / uBlockZ 还原后直接作为裁剪坐标（与演示着色器一致）。
+         * 需在 OpenGL 上下文中调用，之后在同一上下文中用 pollPick 取结果。
+         * @return false 没有 GL 上下文或离屏缓冲区不可用
+         */
+        bool requestPick(int x, int y, int nTolerancePx = 3);
+
+        /**
+         * @brief 取回异步拾取结果
+         * 发起拾取后若块布局发生变化（整理、合并、销毁、清空），结果作废，返回 -1。
+         * @param id 输出折线 ID，未命中为 -1
+         * @param bWait 是否等待 GPU 完成
+         * @return true 已得到结果；false 没有待处理的拾取或 GPU 尚未完成
+         */
+        bool pollPick(long long& id, bool bWait = false);
+
+        /**
+         * @brief CPU 拾取：查询每个块的线段 R 树
+         * 块数据变化后在下一次查询时重建该块的 R 树，未变化的块直接复用。
+         * 影子被释放的块需从显存读回，此时需在 OpenGL 上下文中调用。
+         * @param fX 查询点 x（与顶点相同的坐标系）
+         * @param fY 查询点 y
+         * @param fTolerance 最大距离
+         * @return 最近的可见折线 ID，未命中返回 -1
+         */
+        long long pickCpu(float fX, float fY, float fTolerance);
+
         /**
          * @brief 启动后台碎片整理线程
          * 启动一个单独的线程进行内存碎片整理，定期检查并压缩需要整理的块。
+         * 延迟模式下不启动：GL 调用只允许在渲染线程，待整理的块由 renderVisiblePrimitives* 每帧整理。
          */
         void startBackgroundDefrag();
 
@@ -151,23 +431,115 @@ namespace GLRhi
         void stopBackgroundDefrag();
 
     private:
+        // 立即执行的编辑操作（持有 m_mutex 并调用 GL），供立即模式与 applyPendingCommands 使用
+        bool doAddPolyline(long long id, const std::vector<float>& vVerts, const Color& color);
+        size_t doAddPolylines(const std::vector<std::tuple<long long, std::vector<float>, Color>>& vPolylineDatas);
+        bool doRemovePolyline(long long id);
+        size_t doRemovePolylines(const std::vector<long long>& vIds);
+        bool doUpdatePolyline(long long id, const std::vector<float>& vVerts);
+        bool doSetPolylineVisible(long long id, bool bVisible);
+        void doClearAllPrimitives();
+
         /**
          * @brief 查找或创建指定颜色的VBO块
          *
          * 首先查找现有可用的同色块，不存在则创建新块。
+         * 压缩格式下还要求折线落在块坐标窗口内且 z 与块一致，
+         * 无法压缩的折线（z 不恒定或超出单块范围）退回 Float3 块。
          *
          * @param color 目标颜色
+         * @param pVerts 折线顶点 [x, y, z, ...]
+         * @param nVertCount 顶点数量
          * @return 指向ColorVBOBlock的指针，失败返回nullptr
          */
-        ColorVBOBlock* getColorBlock(const Color& color);
+        ColorVBOBlock* getColorBlock(const Color& color, const float* pVerts, size_t nVertCount);
 
         /**
          * @brief 创建新的颜色VBO块
          * 分配并初始化新的ColorVBOBlock对象及其OpenGL资源。
          * @param color 块颜色
+         * @param eFormat 块顶点格式
+         * @param window 块坐标窗口
+         * @param fLayerZ 块统一 z 值
+         * @param nCapacity 初始顶点容量，0 表示默认容量
          * @return 指向新创建块的指针
          */
-        ColorVBOBlock* createNewColorBlock(const Color& color);
+        ColorVBOBlock* createNewColorBlock(const Color& color, VertexFormat eFormat = VertexFormat::Float3,
+            const QuantizeWindow& window = QuantizeWindow(), float fLayerZ = 0.0f, size_t nCapacity = 0);
+
+        /**
+         * @brief 批量加载的源数据视图（不持有数据）
+         */
+        struct BulkSource
+        {
+            const long long* pIds{ nullptr };
+            const size_t* pCounts{ nullptr };
+            const float* pVerts{ nullptr };
+            std::vector<size_t> vOffsets;   // 每条折线在 pVerts 中的起始顶点
+        };
+
+        /**
+         * @brief 把一批折线整体写入块：一次扩容、每个缓冲区一次上传、并行生成图元与绘制命令
+         */
+        void bulkFillBlock(ColorVBOBlock* block, const BulkSource& src,
+            const std::vector<size_t>& vLines, size_t nTotalVerts, const Color& color);
+
+        /**
+         * @brief 上传线程准备好的块（缓冲区已创建并填充，VAO 由渲染线程创建）
+         */
+        struct PreparedBlock
+        {
+            VertexFormat eFormat{ VertexFormat::Float3 };
+            QuantizeWindow window;
+            float fLayerZ{ 0.0f };
+            unsigned int vbo{ 0 };
+            unsigned int ebo{ 0 };
+            size_t nVertexCount{ 0 };
+            std::vector<PrimitiveInfo> vPrimitives;
+            std::vector<float> vShadow;
+        };
+
+        /**
+         * @brief 一次异步加载的结果
+         */
+        struct AsyncUpload
+        {
+            GLsync fence{ nullptr };        // 上传线程插入的栅栏
+            size_t nEpoch{ 0 };             // 提交时的 m_nAsyncEpoch，清空后结果作废
+            Color color;
+            std::vector<PreparedBlock> vBlocks;
+        };
+
+        /**
+         * @brief 在上传线程中分批、编码并创建缓冲区
+         */
+        static void buildAsyncUpload(QOpenGLFunctions_3_3_Core* gl, AsyncUpload& upload,
+            const std::vector<long long>& vIds, const std::vector<size_t>& vCounts, const std::vector<float>& vVerts,
+            VertexFormat eFormat, float fQuantizeStep);
+
+        /**
+         * @brief 接入上传线程已完成的加载（需持有写锁）
+         */
+        void installAsyncUploads();
+
+        /**
+         * @brief 释放异步加载结果的缓冲区与栅栏
+         */
+        void releaseAsyncUpload(AsyncUpload& upload);
+
+        /**
+         * @brief 为折线选择压缩块的坐标窗口
+         * 以折线包围盒中心为原点，步长取 m_fQuantizeStep。
+         * @return true 折线可放入以其自身为中心的窗口
+         */
+        bool makeWindow(const float* pVerts, size_t nVertCount, QuantizeWindow& window) const;
+
+        /**
+         * @brief 把块的 VBO / EBO 重新分配为指定容量，已有数据在 GPU 端拷贝
+         * @param block 目标块
+         * @param nNewCap 新的顶点 / 索引容量（不小于当前使用量）
+         */
+        void resizeBlockBuffers(ColorVBOBlock* block, size_t nNewCap);
 
         /**
          * @brief 确保VBO块有足够容量
@@ -178,13 +550,20 @@ namespace GLRhi
          */
         void checkBlockCapacity(ColorVBOBlock* block, size_t needVert, size_t needIdx);
 
+        /**
+         * @brief 配置块的VAO（顶点属性与缓冲区绑定）
+         * @param block 目标块
+         */
+        void setupBlockVao(ColorVBOBlock* block);
+
         /**
          * @brief 增量上传单个图元
          * 将单个图元的数据上传到GPU，只更新必要的部分。
          * @param block 目标块
          * @param primIdx 图元在块中的索引
+         * @param pVerts 图元顶点 [x, y, z, ...]
          */
-        void uploadSinglePrimitive(ColorVBOBlock* block, size_t primIdx);
+        void uploadSinglePrimitive(ColorVBOBlock* block, size_t primIdx, const float* pVerts);
 
         /**
          * @brief 压缩内存块
@@ -200,7 +579,150 @@ namespace GLRhi
          */
         void rebuildDrawCmds(ColorVBOBlock* block);
 
-        void touchCache(long long id);
+        /**
+         * @brief 把块的绘制命令生成到后台缓冲（线程池上执行，只读图元信息，只写后台缓冲与 nPreparedVersion）
+         */
+        void buildNextDrawCmds(ColorVBOBlock* block);
+
+        /**
+         * @brief 整理所有标记需要整理的驻留块（需持有独占锁）
+         */
+        void compactPendingBlocks();
+
+        /**
+         * @brief 写入块的 CPU 影子（影子已释放时忽略）
+         * @param block 目标块
+         * @param nBaseVertex 起始顶点
+         * @param pVerts 顶点 [x, y, z, ...]
+         * @param nVertCount 顶点数量
+         */
+        void writeShadow(ColorVBOBlock* block, size_t nBaseVertex, const float* pVerts, size_t nVertCount);
+
+        /**
+         * @brief 调整影子大小并更新内存统计
+         */
+        void resizeShadow(ColorVBOBlock* block, size_t nFloatCount);
+
+        /**
+         * @brief 释放影子多余的容量并更新内存统计
+         */
+        void shrinkShadowToFit(ColorVBOBlock* block);
+
+        /**
+         * @brief 超出预算时释放影子（需持有写锁）
+         */
+        void enforceShadowBudget();
+
+        /**
+         * @brief 把块当前的分配 / 使用字节数登记到显存预算
+         */
+        void trackBlock(const ColorVBOBlock* block);
+
+        /**
+         * @brief 恢复重新可见的驱逐块，超出显存预算时依次合并、收缩、驱逐（需持有写锁）
+         */
+        void updateGpuResidency();
+
+        /**
+         * @brief 释放空块、收缩过度分配的块
+         */
+        void shrinkBlocks();
+
+        /**
+         * @brief 合并同色、同格式、同坐标窗口的稀疏块
+         */
+        void mergeSparseBlocks();
+
+        /**
+         * @brief 把 src 的全部存活图元移入 dst，并销毁 src
+         */
+        void mergeBlockInto(ColorVBOBlock* src, ColorVBOBlock* dst);
+
+        /**
+         * @brief 驱逐整块不可见的块，从分配量最大的开始
+         */
+        void evictHiddenBlocks();
+
+        /**
+         * @brief 释放块的显存，数据只保留在 CPU 影子中（影子已释放时先读回）
+         */
+        void evictBlock(ColorVBOBlock* block);
+
+        /**
+         * @brief 由 CPU 影子重建驱逐块的显存
+         */
+        void restoreBlock(ColorVBOBlock* block);
+
+        /**
+         * @brief 从颜色映射中移除块并释放其全部资源
+         */
+        void destroyBlock(ColorVBOBlock* block);
+
+        /**
+         * @brief 把拾取缓冲区中的 (块序号, 顶点下标) 映射为折线 ID，从离中心最近的像素开始
+         */
+        long long resolvePick(const std::vector<uint32_t>& vTexels) const;
+
+        /**
+         * @brief 由块内顶点下标查找折线 ID（图元按 nBaseVertex 递增排列）
+         */
+        long long findPrimitiveByVertex(const ColorVBOBlock* block, uint32_t nVertex) const;
+
+        /**
+         * @brief 重建块的线段 R 树
+         */
+        void rebuildPickTree(ColorVBOBlock* block);
+
+        /**
+         * @brief 块级 uniform 位置（压缩格式还原坐标用）
+         */
+        struct BlockUniformLocs
+        {
+            GLint nOrigin{ -1 };    // uBlockOrigin
+            GLint nScale{ -1 };     // uBlockScale
+            GLint nZ{ -1 };         // uBlockZ
+        };
+        BlockUniformLocs getBlockUniformLocs(GLint nProg) const;
+
+        /**
+         * @brief 设置块的原点、缩放与 z uniform
+         * @param block 即将绘制的块
+         * @param locs uniform 位置
+         */
+        void setBlockUniforms(const ColorVBOBlock* block, const BlockUniformLocs& locs) const;
+
+        /**
+         * @brief 绘制一个块（被驱逐或没有可见图元时跳过）
+         * @param block 要绘制的块
+         * @param bMultiDraw true 用 glMultiDrawElementsBaseVertex，false 逐图元 glDrawElementsBaseVertex
+         * @param locs 当前着色器的块级 uniform 位置
+         */
+        void drawBlock(ColorVBOBlock* block, bool bMultiDraw, const BlockUniformLocs& locs);
+
+        /**
+         * @brief 按当前颜色映射表顺序绘制（RenderOrder::Unordered）
+         */
+        void drawUnordered(bool bMultiDraw, GLint uColorLoc, const BlockUniformLocs& locs);
+
+        /**
+         * @brief 按排序后的顺序绘制（RenderOrder::Sorted / WeightedOit）
+         */
+        void drawOrdered(bool bMultiDraw, GLint uColorLoc, const BlockUniformLocs& locs);
+
+        /**
+         * @brief 按 m_vDrawOrder 的 [nBegin, nEnd) 绘制，uColor 只在颜色变化时设置
+         */
+        void drawOrderRange(size_t nBegin, size_t nEnd, bool bMultiDraw, GLint uColorLoc, const BlockUniformLocs& locs);
+
+        /**
+         * @brief 块集合或块深度桶变化时重建排序后的绘制顺序（需持有写锁）
+         */
+        void updateDrawOrder();
+
+        /**
+         * @brief 计算块的代表深度
+         */
+        static float computeSortDepth(const ColorVBOBlock* block);
 
         /**
          * @brief 绑定块的OpenGL资源
@@ -221,6 +743,10 @@ namespace GLRhi
     private:
         QOpenGLFunctions_3_3_Core* m_gl{ nullptr };
         mutable std::shared_mutex m_mutex;
+        std::mutex m_prepareMutex;          // 同一时刻只有一个预处理写后台缓冲
+
+        VertexFormat m_eVertexFormat{ VertexFormat::Float3 };   // 新建块的顶点格式
+        float m_fQuantizeStep{ 1.0f / 8192.0f };                // 量化步长，默认单块覆盖约 ±4 个单位
 
         std::unordered_map<uint32_t, std::vector<ColorVBOBlock*>> m_colorBlocksMap; // 按颜色键分组的VBO块映射
         /**
@@ -236,11 +762,39 @@ namespace GLRhi
         };
         std::unordered_map<long long, Location> m_IDLocationMap; // ID到位置的快速映射
 
-        // 顶点缓存（用于增量上传和 compact）
-        std::unordered_map<long long, std::vector<float>> m_vVertexCache; // 原始顶点数据缓存
-        // LRU
-        std::list<long long> m_vertexCacheOrder;
-        static constexpr size_t MAX_CACHE_SIZE = 5000;  // 只缓存最近 5000 条被改过的线
+        // CPU 影子内存（数据在各块的 vShadow 中）
+        size_t m_nShadowBytes{ 0 };             // 所有块影子占用字节数
+        size_t m_nShadowBudgetBytes{ 0 };       // 影子内存预算，0 表示不限制
+        bool   m_bGpuReadBack{ false };         // 超出预算时是否释放影子、改为读回显存
+        bool   m_bShadowBudgetWarned{ false };  // 超预算警告只输出一次
+
+        std::shared_ptr<GpuMemoryBudget> m_pGpuBudget;  // 显存预算（可与其他管理器共享）
+        FrameProfiler* m_pProfiler{ nullptr };          // 帧耗时分析器（不持有）
+
+        // 拾取
+        std::unique_ptr<PickBuffer> m_pPickBuffer;          // 离屏拾取缓冲区（首次拾取时创建）
+        std::vector<const ColorVBOBlock*> m_vPickBlocks;    // 块序号 - 1 -> 块
+        size_t m_nLayoutVersion{ 0 };       // 块布局版本（整理、销毁、清空时递增）
+        size_t m_nPickLayoutVersion{ 0 };   // 发起拾取时的布局版本
+
+        // 有序绘制
+        RenderOrder m_eRenderOrder{ RenderOrder::Unordered };
+        std::vector<ColorVBOBlock*> m_vDrawOrder;           // 排序后的块：先不透明，后半透明
+        size_t m_nFirstTranslucent{ 0 };                    // m_vDrawOrder 中第一个半透明块的下标
+        size_t m_nBlockSetVersion{ 0 };                     // 块创建、销毁、清空时递增
+        size_t m_nDrawOrderVersion{ static_cast<size_t>(-1) }; // m_vDrawOrder 对应的 m_nBlockSetVersion
+        std::unique_ptr<OitBuffer> m_pOitBuffer;            // 加权混合透明缓冲区（首次使用时创建）
+
+        // 延迟模式命令队列
+        std::atomic<bool> m_bDeferred{ false };
+        MpscQueue<PolylineCommand> m_commandQueue;
+
+        // 异步上传
+        std::unique_ptr<UploadThread> m_pUploader;          // 共享上下文上传线程（startUploadThread 后创建）
+        std::mutex m_asyncMutex;                            // 保护 m_vAsyncDone
+        std::vector<AsyncUpload> m_vAsyncDone;              // 上传线程已完成、等待接入的结果
+        std::atomic<size_t> m_nAsyncInFlight{ 0 };          // 已提交未接入的批数
+        std::atomic<size_t> m_nAsyncEpoch{ 0 };             // 清空时递增
 
         // 后台碎片整理相关
         std::thread m_defragThread;                 // 后台碎片整理线程
@@ -2,56 +2,126 @@
 #define PRIMITIVE_ID_GENERATOR_H
 
 #include <atomic>
+#include <cstdint>
 #include <limits>
+#include <memory>
 #include <stdexcept>
 
 namespace GLRhi
 {
+    /**
+     * @brief 连续的 ID 区间 [nFirst, nFirst + nCount)
+     */
+    struct IDRange
+    {
+        long long nFirst{ 0 };
+        long long nCount{ 0 };
+
+        long long operator[](long long i) const { return nFirst + i; }
+        long long end() const { return nFirst + nCount; }
+    };
+
     /**
      * @brief 唯一的图元ID生成器
      * 线程安全的ID生成器，用于为渲染图元分配唯一标识符
-     * 有超过 9.22 亿亿 的唯一 ID,现实中几乎用不完 
+     * 有超过 9.22 亿亿 的唯一 ID,现实中几乎用不完
      * 所有实例共享同一个ID序列，确保全局唯一性
+     *
+     * - reserve(n) 用 CAS 一次预留一段连续 ID，正数用完后整段切换到负数区间，不会与已分配的 ID 重叠
+     * - genID() 从线程本地的 ID 块中取号，块用完才访问共享计数器，多线程导入时不争抢同一缓存行；
+     *   因此不同线程拿到的 ID 不保证按时间递增，只保证唯一
      */
     class PrimitiveIDGenerator
     {
+    public:
+        static constexpr long long LOCAL_BLOCK_SIZE = 1024;    // 每个线程每次预留的 ID 数
+
     private:
         // 静态成员变量，所有实例共享同一个计数器
         static std::atomic<long long> s_nNextID;
+        static std::atomic<unsigned int> s_nEpoch;      // reset 时递增，使各线程缓存的 ID 块失效
+
+        /**
+         * @brief 线程本地 ID 块
+         */
+        struct LocalBlock
+        {
+            long long nNext{ 0 };
+            long long nEnd{ 0 };
+            unsigned int nEpoch{ 0 };
+        };
+
+        static LocalBlock& localBlock()
+        {
+            static thread_local LocalBlock t_block;
+            return t_block;
+        }
 
     public:
         /**
          * @brief 生成下一个唯一的图元ID
          * @return 唯一的图元ID
-         * @note 当ID达到最大值时，会从负值最小值开始继续分配
+         * @note 当ID达到最大值时，会从负值最小值开始继续分配，-1 及以上的负数保留不分配
          * @note 所有实例共享同一个ID序列，确保全局唯一性
          */
         long long genID()
         {
-            long long nNewID = s_nNextID.fetch_add(1);
-            
-            // 检查是否达到最大值，如果达到则重置为最小值
-            if (nNewID == std::numeric_limits<long long>::max())
+            LocalBlock& block = localBlock();
+            unsigned int nEpoch = s_nEpoch.load(std::memory_order_relaxed);
+            if (block.nNext == block.nEnd || block.nEpoch != nEpoch)
             {
-                // 从long long的最小值开始（负值）
-                s_nNextID.store(std::numeric_limits<long long>::min());
+                IDRange range = reserve(LOCAL_BLOCK_SIZE);
+                block.nNext = range.nFirst;
+                block.nEnd = range.end();
+                block.nEpoch = nEpoch;
             }
+            return block.nNext++;
+        }
+
+        /**
+         * @brief 预留一段连续 ID（批量导入时一次取号，避免逐个访问共享计数器）
+         * @param nCount 数量，需大于 0
+         * @return ID 区间；正数区间剩余不足时整段从负数最小值开始
+         * @throw std::overflow_error 正负区间都已用完
+         */
+        static IDRange reserve(long long nCount)
+        {
+            if (nCount <= 0)
+                return { 0, 0 };
 
-            return nNewID;
+            constexpr long long MAX_ID = std::numeric_limits<long long>::max();
+            constexpr long long MIN_ID = std::numeric_limits<long long>::min();
+            constexpr long long LAST_NEGATIVE = -2;     // -1 表示无效 ID
+
+            long long nCur = s_nNextID.load(std::memory_order_relaxed);
+            for (;;)
+            {
+                long long nFirst = nCur;
+                if (nFirst > 0 && nFirst > MAX_ID - nCount)
+                    nFirst = MIN_ID;                    // 正数区间放不下，整段切换到负数区间
+                if (nFirst < 0 && nFirst > LAST_NEGATIVE - nCount + 1)
+                    throw std::overflow_error("PrimitiveIDGenerator: ID 已用完");
+
+                // nFirst + nCount 在正数区间恰好用完时停在 MAX_ID 之后会溢出，用 MIN_ID 表示切换
+                long long nNext = (nFirst > 0 && nFirst == MAX_ID - nCount + 1) ? MIN_ID : nFirst + nCount;
+                if (s_nNextID.compare_exchange_weak(nCur, nNext, std::memory_order_relaxed))
+                    return { nFirst, nCount };
+            }
         }
 
         /**
          * @brief 重置计数器
-         * @note 仅用于测试
+         * @note 仅用于测试；各线程缓存的 ID 块在下次取号时作废
          */
         void reset()
         {
             s_nNextID.store(1);
+            s_nEpoch.fetch_add(1);
         }
 
         /**
          * @brief 获取当前最大的 ID 值
-         * @return 当前已分配的最大ID
+         * @return 当前已预留的最大ID（线程本地块中可能还有尚未发出的 ID）
          * @note 仅用于测试
          */
         long long getCurrentMaxID() const
@@ -59,9 +129,146 @@ namespace GLRhi
             return s_nNextID.load() - 1;
         }
     };
-    
+
     // 静态成员变量初始化
     inline std::atomic<long long> PrimitiveIDGenerator::s_nNextID{1};
+    inline std::atomic<unsigned int> PrimitiveIDGenerator::s_nEpoch{0};
+
+    /**
+     * @brief 可回收的图元 ID 生成器（无锁）
+     *
+     * ID 由槽位下标与代数组成：低 INDEX_BITS 位为下标，其上为代数。
+     * 释放时槽位代数加 1 并放入空闲栈，再次分配得到的 ID 与旧 ID 不同，
+     * 持有旧 ID 的一方可用 isAlive 判断是否已失效（避免 ABA）。
+     * 空闲栈为带版本号的 Treiber 栈，槽位按块懒分配，块一旦分配不再移动。
+     * 适合长时间编辑、ID 需保持紧凑（例如作为数组下标）的场景；每个实例独立编号。
+     */
+    class RecyclingIDGenerator
+    {
+    public:
+        static constexpr unsigned int INDEX_BITS = 30;                  // 最多约 10 亿个同时存活的 ID
+        static constexpr unsigned int CHUNK_BITS = 16;                  // 每块 65536 个槽位
+        static constexpr uint32_t MAX_INDEX = (1u << INDEX_BITS) - 1;
+        static constexpr uint32_t GENERATION_MASK = 0x7FFFFFFFu;        // 代数 31 位，保证 ID 为正
+
+    public:
+        RecyclingIDGenerator()
+            : m_pChunks(new std::atomic<Slot*>[CHUNK_COUNT])
+        {
+            for (size_t i = 0; i < CHUNK_COUNT; ++i)
+                m_pChunks[i].store(nullptr, std::memory_order_relaxed);
+        }
+
+        ~RecyclingIDGenerator()
+        {
+            for (size_t i = 0; i < CHUNK_COUNT; ++i)
+                delete[] m_pChunks[i].load(std::memory_order_relaxed);
+        }
+
+        RecyclingIDGenerator(const RecyclingIDGenerator&) = delete;
+        RecyclingIDGenerator& operator=(const RecyclingIDGenerator&) = delete;
+
+        /**
+         * @brief 分配 ID：优先复用已释放的槽位
+         * @throw std::overflow_error 槽位用完
+         */
+        long long genID()
+        {
+            uint64_t nHead = m_nFreeHead.load(std::memory_order_acquire);
+            for (;;)
+            {
+                uint32_t nIndex = static_cast<uint32_t>(nHead);
+                if (nIndex == 0)
+                    break;
+
+                uint32_t nNextFree = slot(nIndex).nNextFree.load(std::memory_order_relaxed);
+                uint64_t nNewHead = ((nHead >> 32) + 1) << 32 | nNextFree;
+                if (m_nFreeHead.compare_exchange_weak(nHead, nNewHead, std::memory_order_acquire))
+                    return makeID(slot(nIndex).nGeneration.load(std::memory_order_relaxed), nIndex);
+            }
+
+            // 下标 0 保留（空闲栈的空标记），新槽位从 1 开始
+            uint32_t nIndex = m_nNextIndex.fetch_add(1, std::memory_order_relaxed);
+            if (nIndex > MAX_INDEX)
+                throw std::overflow_error("RecyclingIDGenerator: 槽位已用完");
+            return makeID(slot(nIndex).nGeneration.load(std::memory_order_relaxed), nIndex);
+        }
+
+        /**
+         * @brief 释放 ID，槽位代数加 1 后放入空闲栈
+         * @return ID 已失效（重复释放或不是本生成器分配的）时返回 false
+         */
+        bool release(long long id)
+        {
+            uint32_t nIndex = indexOf(id);
+            if (nIndex == 0 || nIndex >= m_nNextIndex.load(std::memory_order_relaxed))
+                return false;
+
+            Slot& s = slot(nIndex);
+            uint32_t nGen = generationOf(id);
+            if (!s.nGeneration.compare_exchange_strong(nGen, (nGen + 1) & GENERATION_MASK, std::memory_order_relaxed))
+                return false;
+
+            uint64_t nHead = m_nFreeHead.load(std::memory_order_relaxed);
+            for (;;)
+            {
+                s.nNextFree.store(static_cast<uint32_t>(nHead), std::memory_order_relaxed);
+                uint64_t nNewHead = ((nHead >> 32) + 1) << 32 | nIndex;
+                if (m_nFreeHead.compare_exchange_weak(nHead, nNewHead, std::memory_order_release))
+                    return true;
+            }
+        }
+
+        /**
+         * @brief ID 是否仍然有效（未被释放）
+         */
+        bool isAlive(long long id) const
+        {
+            uint32_t nIndex = indexOf(id);
+            if (nIndex == 0 || nIndex >= m_nNextIndex.load(std::memory_order_relaxed))
+                return false;
+            return const_cast<RecyclingIDGenerator*>(this)->slot(nIndex).nGeneration.load(std::memory_order_relaxed)
+                == generationOf(id);
+        }
+
+        static uint32_t indexOf(long long id) { return static_cast<uint32_t>(id) & MAX_INDEX; }
+        static uint32_t generationOf(long long id) { return static_cast<uint32_t>(static_cast<uint64_t>(id) >> INDEX_BITS) & GENERATION_MASK; }
+
+    private:
+        struct Slot
+        {
+            std::atomic<uint32_t> nGeneration{ 0 };
+            std::atomic<uint32_t> nNextFree{ 0 };   // 空闲栈中的下一个下标
+        };
+
+        static constexpr size_t CHUNK_SIZE = size_t(1) << CHUNK_BITS;
+        static constexpr size_t CHUNK_COUNT = (size_t(MAX_INDEX) + 1) >> CHUNK_BITS;
+
+        static long long makeID(uint32_t nGeneration, uint32_t nIndex)
+        {
+            return static_cast<long long>((static_cast<uint64_t>(nGeneration) << INDEX_BITS) | nIndex);
+        }
+
+        Slot& slot(uint32_t nIndex)
+        {
+            std::atomic<Slot*>& chunk = m_pChunks[nIndex >> CHUNK_BITS];
+            Slot* pChunk = chunk.load(std::memory_order_acquire);
+            if (!pChunk)
+            {
+                Slot* pNew = new Slot[CHUNK_SIZE];
+                if (chunk.compare_exchange_strong(pChunk, pNew, std::memory_order_acq_rel))
+                    pChunk = pNew;
+                else
+                    delete[] pNew;  // 其他线程已分配，pChunk 已被更新为该块
+            }
+            return pChunk[nIndex & (CHUNK_SIZE - 1)];
+        }
+
+    private:
+        std::unique_ptr<std::atomic<Slot*>[]> m_pChunks;    // 槽位块目录
+        std::atomic<uint64_t> m_nFreeHead{ 0 };             // 空闲栈顶：高 32 位版本号，低 32 位下标
+        std::atomic<uint32_t> m_nNextIndex{ 1 };            // 下一个从未使用的下标
+    };
 }
 
-#endif // PRIMITIVE_ID_GENERATOR_H
\ No newline at end of file
+#endif // PRIMITIVE_ID_GENERATOR_H
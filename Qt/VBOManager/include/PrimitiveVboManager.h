@@ -0,0 +1,788 @@
+#ifndef PRIMITIVE_VBO_MANAGER_H
+#define PRIMITIVE_VBO_MANAGER_H
+
+#include <vector>
+#include <unordered_map>
+#include <shared_mutex>
+#include <mutex>
+#include <memory>
+#include <algorithm>
+#include <cstring>
+#include <cstdint>
+#include <chrono>
+#include <QOpenGLContext>
+#include <QOpenGLFunctions_3_3_Core>
+#include <QDebug>
+
+#include "GpuMemoryBudget.h"
+
+namespace GLRhi
+{
+    /**
+     * @brief 通用图元槽位
+     *
+     * 每个图元在块内占用一段连续顶点和一段连续索引，索引为图元内的局部序号（从 0 开始），
+     * 绘制时通过 basevertex 平移到块内位置。
+     */
+    struct PrimitiveSlot
+    {
+        long long id{ -1 };             // 图元唯一标识符
+        GLint     nBaseVertex{ 0 };     // 块内起始顶点
+        GLsizei   nVertexCount{ 0 };    // 顶点数
+        size_t    nFirstIndex{ 0 };     // 块内起始索引
+        GLsizei   nIndexCount{ 0 };     // 索引数
+        bool      bVisible{ true };     // 是否可见
+    };
+
+    /**
+     * @brief 通用图元块
+     *
+     * 一个块对应一组批次状态相同（颜色 / 纹理）的图元，一次 glMultiDrawElementsBaseVertex 绘制。
+     * 顶点与索引各保留一份 CPU 镜像，compact 时在 CPU 上整理后一次性重传。
+     */
+    template <typename Traits>
+    struct PrimitiveBlock
+    {
+        GLuint vao{ 0 };                    // 顶点数组对象
+        GLuint vbo{ 0 };                    // 顶点缓冲区对象
+        GLuint ebo{ 0 };                    // 索引缓冲区对象
+        typename Traits::BatchInfo batch;   // 块级批次状态
+
+        size_t nVertexCapacity{ 0 };        // 顶点容量
+        size_t nIndexCapacity{ 0 };         // 索引容量
+        size_t nVertexCount{ 0 };           // 已使用顶点数（含已删除图元留下的空洞）
+        size_t nIndexCount{ 0 };            // 已使用索引数
+        size_t nDeadVertexCount{ 0 };       // 已删除图元占用的顶点数
+
+        std::vector<PrimitiveSlot> vPrimitives;             // 图元槽位
+        std::unordered_map<long long, size_t> idToIndexMap; // 图元ID -> 槽位下标
+
+        std::vector<float> vVertShadow;             // 顶点 CPU 镜像（VERTEX_FLOATS 个 float / 顶点）
+        std::vector<unsigned int> vIndexShadow;     // 局部索引 CPU 镜像
+
+        std::vector<GLsizei> vDrawCounts;           // 绘制命令：索引数
+        std::vector<const void*> vIndexOffsets;     // 绘制命令：索引字节偏移
+        std::vector<GLint> vBaseVertices;           // 绘制命令：基础顶点
+
+        bool bDirty{ false };               // 绘制命令需要重建
+        bool bCompact{ false };             // 需要整理空洞
+    };
+
+    //////////////////////////////////////////////////////////////////////////////////////////////
+    /**
+     * @class PrimitiveVboManager
+     * @brief 通用图元 VBO 管理器
+     *
+     * 把折线管理器中与图元类型无关的部分抽出来：按批次键分块、GPU 端拷贝扩容、
+     * 空洞整理、绘制命令重建、显存预算登记。不同图元类型只需提供 Traits：
+     *
+     * @code
+     * struct Traits
+     * {
+     *     using Data = ...;                            // 输入数据类型
+     *     struct BatchInfo { ... };                    // 块级批次状态（颜色、纹理等）
+     *     struct Uniforms { ... };                     // 每帧查询一次的 uniform 位置
+     *     static constexpr GLenum PRIMITIVE_MODE;      // 图元类型，如 GL_TRIANGLES
+     *     static constexpr size_t VERTEX_FLOATS;       // 每个顶点的 float 数
+     *
+     *     static long long id(const Data&);
+     *     static uint64_t batchKey(const Data&);       // 批次键相同的图元放入同一组块
+     *     static BatchInfo batchInfo(const Data&);
+     *     static size_t vertexCount(const Data&);
+     *     static void writeVertices(const Data&, float* pDst);            // 写入 vertexCount * VERTEX_FLOATS 个 float
+     *     static void writeIndices(const Data&, std::vector<unsigned int>& vOut); // 追加局部索引
+     *     static void setupAttributes(QOpenGLFunctions_3_3_Core*);        // VAO / VBO 已绑定时配置顶点属性
+     *     static Uniforms getUniforms(QOpenGLFunctions_3_3_Core*, GLint nProg);
+     *     static void bindBatch(QOpenGLFunctions_3_3_Core*, const Uniforms&, const BatchInfo&);
+     * };
+     * @endcode
+     *
+     * 折线管理器因压缩顶点格式、延迟命令队列、零拷贝批量加载等专用功能仍单独实现，
+     * 两者共用 GpuMemoryBudget，可以登记到同一个显存预算。
+     * 需在 OpenGL 上下文中创建与调用。
+     */
+    template <typename Traits>
+    class PrimitiveVboManager
+    {
+    public:
+        using Data = typename Traits::Data;
+        using Block = PrimitiveBlock<Traits>;
+
+        static constexpr size_t INIT_CAPACITY = 16'384;         // 新块的初始顶点 / 索引容量
+        static constexpr size_t GROW_STEP = 65'536;             // 容量增长步长
+        static constexpr size_t MAX_VERT_PER_BLOCK = 1'000'000; // 单块顶点上限
+        static constexpr float COMPACT_THRESHOLD = 0.30f;       // 空洞占比超过 30% 时整理
+
+    public:
+        PrimitiveVboManager()
+            : m_pGpuBudget(std::make_shared<GpuMemoryBudget>())
+        {
+            if (QOpenGLContext::currentContext())
+            {
+                m_gl = QOpenGLContext::currentContext()->versionFunctions<QOpenGLFunctions_3_3_Core>();
+                if (!m_gl)
+                    qFatal("Failed to get OpenGL 3.3 Core functions");
+            }
+        }
+
+        virtual ~PrimitiveVboManager()
+        {
+            std::unique_lock<std::shared_mutex> lock(m_mutex);
+            releaseAllBlocks();
+        }
+
+        PrimitiveVboManager(const PrimitiveVboManager&) = delete;
+        PrimitiveVboManager& operator=(const PrimitiveVboManager&) = delete;
+
+    public:
+        /**
+         * @brief 添加单个图元
+         * @return false 数据无效、ID 已存在或无 GL 上下文
+         */
+        bool addPrimitive(const Data& data)
+        {
+            std::unique_lock<std::shared_mutex> lock(m_mutex);
+            std::vector<const Data*> vItems{ &data };
+            return addBatch(vItems) == 1;
+        }
+
+        /**
+         * @brief 批量添加图元
+         * 按批次键分组，每个目标块只扩容一次、顶点与索引各上传一次。
+         * @return 实际添加的数量
+         */
+        size_t addPrimitives(const std::vector<Data>& vDatas)
+        {
+            std::unique_lock<std::shared_mutex> lock(m_mutex);
+            std::vector<const Data*> vItems;
+            vItems.reserve(vDatas.size());
+            for (const Data& data : vDatas)
+                vItems.push_back(&data);
+            return addBatch(vItems);
+        }
+
+        /**
+         * @brief 删除图元，空洞在绘制前按需整理
+         */
+        bool removePrimitive(long long id)
+        {
+            std::unique_lock<std::shared_mutex> lock(m_mutex);
+            return doRemove(id);
+        }
+
+        size_t removePrimitives(const std::vector<long long>& vIds)
+        {
+            std::unique_lock<std::shared_mutex> lock(m_mutex);
+            size_t nCount = 0;
+            for (long long id : vIds)
+                nCount += doRemove(id) ? 1 : 0;
+            return nCount;
+        }
+
+        /**
+         * @brief 更新图元（以 Data 中的 ID 为准）
+         * 批次键不变且顶点、索引数都不增加时原位覆盖，否则删除后重新添加。
+         */
+        bool updatePrimitive(const Data& data)
+        {
+            std::unique_lock<std::shared_mutex> lock(m_mutex);
+            const long long id = Traits::id(data);
+            auto it = m_IDLocationMap.find(id);
+            if (it == m_IDLocationMap.end() || !isValid(data))
+                return false;
+
+            Block* block = it->second.block;
+            PrimitiveSlot& slot = block->vPrimitives[it->second.nPrimIdx];
+
+            std::vector<unsigned int> vIndices;
+            Traits::writeIndices(data, vIndices);
+            const size_t nVerts = Traits::vertexCount(data);
+
+            if (it->second.nKey != Traits::batchKey(data) ||
+                nVerts > static_cast<size_t>(slot.nVertexCount) ||
+                vIndices.size() > static_cast<size_t>(slot.nIndexCount))
+            {
+                bool bVisible = slot.bVisible;
+                doRemove(id);
+                std::vector<const Data*> vItems{ &data };
+                if (addBatch(vItems) != 1)
+                    return false;
+                if (!bVisible)
+                    doSetVisible(id, false);
+                return true;
+            }
+
+            // 原位覆盖，多余的尾部留到 compact 时回收
+            block->nDeadVertexCount += slot.nVertexCount - nVerts;
+            slot.nVertexCount = static_cast<GLsizei>(nVerts);
+            slot.nIndexCount = static_cast<GLsizei>(vIndices.size());
+
+            float* pVert = block->vVertShadow.data() + static_cast<size_t>(slot.nBaseVertex) * Traits::VERTEX_FLOATS;
+            Traits::writeVertices(data, pVert);
+            std::copy(vIndices.begin(), vIndices.end(), block->vIndexShadow.begin() + slot.nFirstIndex);
+
+            uploadRange(block, static_cast<size_t>(slot.nBaseVertex), nVerts, slot.nFirstIndex, vIndices.size());
+            block->bDirty = true;
+            return true;
+        }
+
+        bool setPrimitiveVisible(long long id, bool bVisible)
+        {
+            std::unique_lock<std::shared_mutex> lock(m_mutex);
+            return doSetVisible(id, bVisible);
+        }
+
+        /**
+         * @brief 清空所有图元并释放显存
+         */
+        void clearAllPrimitives()
+        {
+            std::unique_lock<std::shared_mutex> lock(m_mutex);
+            releaseAllBlocks();
+        }
+
+        /**
+         * @brief 绘制所有可见图元
+         * 使用当前绑定的着色器程序，每个块设置一次批次状态并发起一次多重绘制。
+         * 超出显存预算时先释放空块、收缩过度分配的块。
+         */
+        void renderVisiblePrimitives()
+        {
+            if (!m_gl)
+                return;
+
+            std::unique_lock<std::shared_mutex> lock(m_mutex);
+            if (m_blocksMap.empty())
+                return;
+
+            if (m_pGpuBudget->isOverBudget())
+                shrinkBlocks();
+
+            GLint nProg = 0;
+            m_gl->glGetIntegerv(GL_CURRENT_PROGRAM, &nProg);
+            typename Traits::Uniforms uniforms = Traits::getUniforms(m_gl, nProg);
+
+            for (auto& pair : m_blocksMap)
+            {
+                for (Block* block : pair.second)
+                {
+                    if (block->bCompact)
+                        compactBlock(block);
+                    if (block->bDirty)
+                        rebuildDrawCmds(block);
+                    if (block->vDrawCounts.empty())
+                        continue;
+
+                    Traits::bindBatch(m_gl, uniforms, block->batch);
+                    m_gl->glBindVertexArray(block->vao);
+                    m_gl->glMultiDrawElementsBaseVertex(
+                        Traits::PRIMITIVE_MODE,
+                        block->vDrawCounts.data(),
+                        GL_UNSIGNED_INT,
+                        block->vIndexOffsets.data(),
+                        static_cast<GLsizei>(block->vDrawCounts.size()),
+                        block->vBaseVertices.data());
+                }
+            }
+            m_gl->glBindVertexArray(0);
+        }
+
+        size_t getPrimitiveCount() const
+        {
+            std::shared_lock<std::shared_mutex> lock(m_mutex);
+            return m_IDLocationMap.size();
+        }
+
+        size_t getBlockCount() const
+        {
+            std::shared_lock<std::shared_mutex> lock(m_mutex);
+            size_t nCount = 0;
+            for (const auto& pair : m_blocksMap)
+                nCount += pair.second.size();
+            return nCount;
+        }
+
+        /**
+         * @brief 替换显存预算（可与折线管理器共享同一个预算）
+         */
+        void setGpuMemoryBudget(std::shared_ptr<GpuMemoryBudget> pBudget)
+        {
+            if (!pBudget)
+                return;
+
+            std::unique_lock<std::shared_mutex> lock(m_mutex);
+            for (auto& pair : m_blocksMap)
+            {
+                for (Block* block : pair.second)
+                    m_pGpuBudget->removeBlock(block);
+            }
+
+            m_pGpuBudget = std::move(pBudget);
+            for (auto& pair : m_blocksMap)
+            {
+                for (Block* block : pair.second)
+                    trackBlock(block);
+            }
+        }
+
+        std::shared_ptr<GpuMemoryBudget> getGpuMemoryBudget() const { return m_pGpuBudget; }
+        GpuMemoryStats getGpuMemoryStats() const { return m_pGpuBudget->getStats(); }
+
+    private:
+        bool isValid(const Data& data) const
+        {
+            size_t nVerts = Traits::vertexCount(data);
+            return nVerts > 0 && nVerts <= MAX_VERT_PER_BLOCK;
+        }
+
+        /**
+         * @brief 批量写入：按目标块分组后每块一次扩容、一次上传（需持有写锁）
+         */
+        size_t addBatch(const std::vector<const Data*>& vItems)
+        {
+            if (!m_gl || vItems.empty())
+                return 0;
+
+            struct Pending
+            {
+                const Data* pData{ nullptr };
+                std::vector<unsigned int> vIndices;
+            };
+            struct BlockBatch
+            {
+                uint64_t nKey{ 0 };
+                Block* block{ nullptr };
+                std::vector<Pending> vPending;
+                size_t nVerts{ 0 };
+                size_t nIndices{ 0 };
+            };
+            std::vector<BlockBatch> vBatches;
+
+            for (const Data* pData : vItems)
+            {
+                const long long id = Traits::id(*pData);
+                if (!isValid(*pData) || m_IDLocationMap.count(id))
+                    continue;
+
+                Pending pending;
+                pending.pData = pData;
+                Traits::writeIndices(*pData, pending.vIndices);
+
+                // 局部索引必须落在图元自己的顶点范围内
+                const size_t nVerts = Traits::vertexCount(*pData);
+                if (pending.vIndices.empty() ||
+                    *std::max_element(pending.vIndices.begin(), pending.vIndices.end()) >= nVerts)
+                {
+                    qWarning() << "PrimitiveVboManager: invalid indices for id" << id;
+                    continue;
+                }
+
+                // 先占位 ID，批次内重复的 ID 也在这里过滤
+                const uint64_t nKey = Traits::batchKey(*pData);
+                if (!m_IDLocationMap.emplace(id, Location{ nKey, nullptr, 0 }).second)
+                    continue;
+
+                // 计入本次已分配但尚未写入的顶点，避免同一块超过上限
+                Block* block = nullptr;
+                for (BlockBatch& b : vBatches)
+                {
+                    if (b.nKey == nKey &&
+                        b.block->nVertexCount + b.nVerts + nVerts <= MAX_VERT_PER_BLOCK)
+                    {
+                        block = b.block;
+                        break;
+                    }
+                }
+                if (!block)
+                    block = getBlock(nKey, *pData, nVerts);
+
+                auto itBatch = std::find_if(vBatches.begin(), vBatches.end(),
+                    [block](const BlockBatch& b) { return b.block == block; });
+                if (itBatch == vBatches.end())
+                {
+                    vBatches.push_back(BlockBatch{ nKey, block, {}, 0, 0 });
+                    itBatch = vBatches.end() - 1;
+                }
+                itBatch->nVerts += nVerts;
+                itBatch->nIndices += pending.vIndices.size();
+                itBatch->vPending.push_back(std::move(pending));
+            }
+
+            size_t nAdded = 0;
+            for (BlockBatch& batch : vBatches)
+            {
+                Block* block = batch.block;
+                checkBlockCapacity(block, block->nVertexCount + batch.nVerts, block->nIndexCount + batch.nIndices);
+
+                const size_t nVert0 = block->nVertexCount;
+                const size_t nIdx0 = block->nIndexCount;
+                block->vVertShadow.resize((nVert0 + batch.nVerts) * Traits::VERTEX_FLOATS);
+                block->vIndexShadow.resize(nIdx0 + batch.nIndices);
+
+                size_t nVert = nVert0;
+                size_t nIdx = nIdx0;
+                for (Pending& pending : batch.vPending)
+                {
+                    const Data& data = *pending.pData;
+                    const size_t nVerts = Traits::vertexCount(data);
+                    Traits::writeVertices(data, block->vVertShadow.data() + nVert * Traits::VERTEX_FLOATS);
+                    std::copy(pending.vIndices.begin(), pending.vIndices.end(), block->vIndexShadow.begin() + nIdx);
+
+                    PrimitiveSlot slot;
+                    slot.id = Traits::id(data);
+                    slot.nBaseVertex = static_cast<GLint>(nVert);
+                    slot.nVertexCount = static_cast<GLsizei>(nVerts);
+                    slot.nFirstIndex = nIdx;
+                    slot.nIndexCount = static_cast<GLsizei>(pending.vIndices.size());
+
+                    size_t nPrimIdx = block->vPrimitives.size();
+                    block->vPrimitives.push_back(slot);
+                    block->idToIndexMap[slot.id] = nPrimIdx;
+
+                    Location& loc = m_IDLocationMap[slot.id];
+                    loc.block = block;
+                    loc.nPrimIdx = nPrimIdx;
+
+                    nVert += nVerts;
+                    nIdx += pending.vIndices.size();
+                    ++nAdded;
+                }
+
+                block->nVertexCount = nVert;
+                block->nIndexCount = nIdx;
+                uploadRange(block, nVert0, batch.nVerts, nIdx0, batch.nIndices);
+                block->bDirty = true;
+                trackBlock(block);
+            }
+            return nAdded;
+        }
+
+        bool doRemove(long long id)
+        {
+            auto it = m_IDLocationMap.find(id);
+            if (it == m_IDLocationMap.end())
+                return false;
+
+            Block* block = it->second.block;
+            PrimitiveSlot& slot = block->vPrimitives[it->second.nPrimIdx];
+
+            block->nDeadVertexCount += static_cast<size_t>(slot.nVertexCount);
+            slot.nVertexCount = 0;
+            slot.nIndexCount = 0;
+            block->idToIndexMap.erase(id);
+            m_IDLocationMap.erase(it);
+
+            block->bDirty = true;
+            if (block->nDeadVertexCount > block->nVertexCount * COMPACT_THRESHOLD)
+                block->bCompact = true;
+            return true;
+        }
+
+        bool doSetVisible(long long id, bool bVisible)
+        {
+            auto it = m_IDLocationMap.find(id);
+            if (it == m_IDLocationMap.end())
+                return false;
+
+            it->second.block->vPrimitives[it->second.nPrimIdx].bVisible = bVisible;
+            it->second.block->bDirty = true;
+            return true;
+        }
+
+        /**
+         * @brief 查找能容纳 nVerts 个顶点的同批次块，没有则新建
+         */
+        Block* getBlock(uint64_t nKey, const Data& data, size_t nVerts)
+        {
+            auto& vBlocks = m_blocksMap[nKey];
+            for (Block* block : vBlocks)
+            {
+                if (block->nVertexCount + nVerts <= MAX_VERT_PER_BLOCK)
+                    return block;
+            }
+            return createBlock(nKey, data, std::max(INIT_CAPACITY, nVerts));
+        }
+
+        Block* createBlock(uint64_t nKey, const Data& data, size_t nCapacity)
+        {
+            Block* block = new Block();
+            block->batch = Traits::batchInfo(data);
+            block->nVertexCapacity = nCapacity;
+            block->nIndexCapacity = nCapacity * 2;
+
+            m_gl->glGenVertexArrays(1, &block->vao);
+            m_gl->glGenBuffers(1, &block->vbo);
+            m_gl->glGenBuffers(1, &block->ebo);
+
+            m_gl->glBindBuffer(GL_COPY_WRITE_BUFFER, block->vbo);
+            m_gl->glBufferData(GL_COPY_WRITE_BUFFER,
+                static_cast<GLsizeiptr>(block->nVertexCapacity * VERTEX_BYTES), nullptr, GL_DYNAMIC_DRAW);
+            m_gl->glBindBuffer(GL_COPY_WRITE_BUFFER, block->ebo);
+            m_gl->glBufferData(GL_COPY_WRITE_BUFFER,
+                static_cast<GLsizeiptr>(block->nIndexCapacity * sizeof(unsigned int)), nullptr, GL_DYNAMIC_DRAW);
+            m_gl->glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+            setupBlockVao(block);
+            m_blocksMap[nKey].push_back(block);
+            trackBlock(block);
+            return block;
+        }
+
+        /**
+         * @brief VAO 记录的是缓冲区名，创建与重新分配缓冲区后都要重新配置
+         */
+        void setupBlockVao(Block* block)
+        {
+            m_gl->glBindVertexArray(block->vao);
+            m_gl->glBindBuffer(GL_ARRAY_BUFFER, block->vbo);
+            m_gl->glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, block->ebo);
+            Traits::setupAttributes(m_gl);
+            m_gl->glBindVertexArray(0);
+        }
+
+        void checkBlockCapacity(Block* block, size_t nNeedV, size_t nNeedI)
+        {
+            if (nNeedV <= block->nVertexCapacity && nNeedI <= block->nIndexCapacity)
+                return;
+
+            size_t nNewV = block->nVertexCapacity;
+            if (nNeedV > nNewV)
+                nNewV = std::max(nNewV * 2, nNeedV + GROW_STEP);
+            size_t nNewI = block->nIndexCapacity;
+            if (nNeedI > nNewI)
+                nNewI = std::max(nNewI * 2, nNeedI + GROW_STEP);
+
+            resizeBlockBuffers(block, nNewV, nNewI);
+        }
+
+        /**
+         * @brief 重新分配块的缓冲区，已使用部分在 GPU 端拷贝
+         */
+        void resizeBlockBuffers(Block* block, size_t nVertCap, size_t nIdxCap)
+        {
+            GLuint newVbo = 0;
+            GLuint newEbo = 0;
+            m_gl->glGenBuffers(1, &newVbo);
+            m_gl->glGenBuffers(1, &newEbo);
+
+            m_gl->glBindBuffer(GL_COPY_WRITE_BUFFER, newVbo);
+            m_gl->glBufferData(GL_COPY_WRITE_BUFFER,
+                static_cast<GLsizeiptr>(nVertCap * VERTEX_BYTES), nullptr, GL_DYNAMIC_DRAW);
+            if (block->nVertexCount > 0)
+            {
+                m_gl->glBindBuffer(GL_COPY_READ_BUFFER, block->vbo);
+                m_gl->glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0,
+                    static_cast<GLsizeiptr>(block->nVertexCount * VERTEX_BYTES));
+            }
+
+            m_gl->glBindBuffer(GL_COPY_WRITE_BUFFER, newEbo);
+            m_gl->glBufferData(GL_COPY_WRITE_BUFFER,
+                static_cast<GLsizeiptr>(nIdxCap * sizeof(unsigned int)), nullptr, GL_DYNAMIC_DRAW);
+            if (block->nIndexCount > 0)
+            {
+                m_gl->glBindBuffer(GL_COPY_READ_BUFFER, block->ebo);
+                m_gl->glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0,
+                    static_cast<GLsizeiptr>(block->nIndexCount * sizeof(unsigned int)));
+            }
+
+            m_gl->glBindBuffer(GL_COPY_READ_BUFFER, 0);
+            m_gl->glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+            m_pGpuBudget->recordUpload(block->nVertexCount * VERTEX_BYTES + block->nIndexCount * sizeof(unsigned int));
+
+            m_gl->glDeleteBuffers(1, &block->vbo);
+            m_gl->glDeleteBuffers(1, &block->ebo);
+            block->vbo = newVbo;
+            block->ebo = newEbo;
+            block->nVertexCapacity = nVertCap;
+            block->nIndexCapacity = nIdxCap;
+            setupBlockVao(block);
+            trackBlock(block);
+        }
+
+        /**
+         * @brief 把影子中的一段顶点和一段索引上传到显存
+         */
+        void uploadRange(Block* block, size_t nVert0, size_t nVerts, size_t nIdx0, size_t nIndices)
+        {
+            if (nVerts > 0)
+            {
+                m_gl->glBindBuffer(GL_COPY_WRITE_BUFFER, block->vbo);
+                m_gl->glBufferSubData(GL_COPY_WRITE_BUFFER,
+                    static_cast<GLintptr>(nVert0 * VERTEX_BYTES),
+                    static_cast<GLsizeiptr>(nVerts * VERTEX_BYTES),
+                    block->vVertShadow.data() + nVert0 * Traits::VERTEX_FLOATS);
+            }
+            if (nIndices > 0)
+            {
+                m_gl->glBindBuffer(GL_COPY_WRITE_BUFFER, block->ebo);
+                m_gl->glBufferSubData(GL_COPY_WRITE_BUFFER,
+                    static_cast<GLintptr>(nIdx0 * sizeof(unsigned int)),
+                    static_cast<GLsizeiptr>(nIndices * sizeof(unsigned int)),
+                    block->vIndexShadow.data() + nIdx0);
+            }
+            m_gl->glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+            m_pGpuBudget->recordUpload(nVerts * VERTEX_BYTES + nIndices * sizeof(unsigned int));
+        }
+
+        /**
+         * @brief 整理空洞
+         *
+         * 存活图元的顶点与索引在影子中依次前移（局部索引不随位置变化，直接搬运），
+         * 删除空槽位并同步 ID 映射，最后顶点、索引各上传一次。
+         */
+        void compactBlock(Block* block)
+        {
+            auto startTime = std::chrono::high_resolution_clock::now();
+            size_t nVert = 0;
+            size_t nIdx = 0;
+            size_t nSlot = 0;
+            for (size_t i = 0; i < block->vPrimitives.size(); ++i)
+            {
+                PrimitiveSlot slot = block->vPrimitives[i];
+                if (slot.nVertexCount <= 0)
+                    continue;
+
+                const size_t nVerts = static_cast<size_t>(slot.nVertexCount);
+                const size_t nIndices = static_cast<size_t>(slot.nIndexCount);
+                if (static_cast<size_t>(slot.nBaseVertex) != nVert)
+                    std::memmove(block->vVertShadow.data() + nVert * Traits::VERTEX_FLOATS,
+                        block->vVertShadow.data() + static_cast<size_t>(slot.nBaseVertex) * Traits::VERTEX_FLOATS,
+                        nVerts * VERTEX_BYTES);
+                if (slot.nFirstIndex != nIdx)
+                    std::memmove(block->vIndexShadow.data() + nIdx,
+                        block->vIndexShadow.data() + slot.nFirstIndex, nIndices * sizeof(unsigned int));
+
+                slot.nBaseVertex = static_cast<GLint>(nVert);
+                slot.nFirstIndex = nIdx;
+                block->vPrimitives[nSlot] = slot;
+                block->idToIndexMap[slot.id] = nSlot;
+                m_IDLocationMap[slot.id].nPrimIdx = nSlot;
+
+                nVert += nVerts;
+                nIdx += nIndices;
+                ++nSlot;
+            }
+
+            block->vPrimitives.resize(nSlot);
+            block->vVertShadow.resize(nVert * Traits::VERTEX_FLOATS);
+            block->vIndexShadow.resize(nIdx);
+            block->nVertexCount = nVert;
+            block->nIndexCount = nIdx;
+            block->nDeadVertexCount = 0;
+
+            uploadRange(block, 0, nVert, 0, nIdx);
+            block->bCompact = false;
+            block->bDirty = true;
+            trackBlock(block);
+
+            auto endTime = std::chrono::high_resolution_clock::now();
+            m_pGpuBudget->recordCompact(std::chrono::duration<double, std::milli>(endTime - startTime).count());
+        }
+
+        void rebuildDrawCmds(Block* block)
+        {
+            block->vDrawCounts.clear();
+            block->vIndexOffsets.clear();
+            block->vBaseVertices.clear();
+
+            for (const PrimitiveSlot& slot : block->vPrimitives)
+            {
+                if (!slot.bVisible || slot.nIndexCount <= 0)
+                    continue;
+
+                block->vDrawCounts.push_back(slot.nIndexCount);
+                block->vIndexOffsets.push_back(reinterpret_cast<const void*>(slot.nFirstIndex * sizeof(unsigned int)));
+                block->vBaseVertices.push_back(slot.nBaseVertex);
+            }
+            block->bDirty = false;
+        }
+
+        /**
+         * @brief 超出显存预算时释放空块，整理并收缩分配量超过使用量 2 倍的块
+         */
+        void shrinkBlocks()
+        {
+            for (auto& pair : m_blocksMap)
+            {
+                auto& vBlocks = pair.second;
+                for (size_t i = 0; i < vBlocks.size();)
+                {
+                    Block* block = vBlocks[i];
+                    if (block->idToIndexMap.empty())
+                    {
+                        releaseBlock(block);
+                        vBlocks.erase(vBlocks.begin() + i);
+                        continue;
+                    }
+
+                    if (block->nDeadVertexCount > 0)
+                        compactBlock(block);
+
+                    size_t nVertCap = std::max(block->nVertexCount + block->nVertexCount / 4, size_t(1024));
+                    size_t nIdxCap = std::max(block->nIndexCount + block->nIndexCount / 4, size_t(1024));
+                    if (block->nVertexCapacity > block->nVertexCount * 2 && nVertCap < block->nVertexCapacity)
+                    {
+                        resizeBlockBuffers(block, nVertCap, std::min(nIdxCap, block->nIndexCapacity));
+                        block->vVertShadow.shrink_to_fit();
+                        block->vIndexShadow.shrink_to_fit();
+                        m_pGpuBudget->recordEvent(GpuMemoryBudget::Event::Shrink);
+                    }
+                    ++i;
+                }
+            }
+        }
+
+        void trackBlock(const Block* block)
+        {
+            m_pGpuBudget->updateBlock(block,
+                block->nVertexCapacity * VERTEX_BYTES + block->nIndexCapacity * sizeof(unsigned int),
+                block->nVertexCount * VERTEX_BYTES + block->nIndexCount * sizeof(unsigned int));
+        }
+
+        void releaseBlock(Block* block)
+        {
+            if (m_gl)
+            {
+                m_gl->glDeleteVertexArrays(1, &block->vao);
+                m_gl->glDeleteBuffers(1, &block->vbo);
+                m_gl->glDeleteBuffers(1, &block->ebo);
+            }
+            m_pGpuBudget->removeBlock(block);
+            delete block;
+        }
+
+        void releaseAllBlocks()
+        {
+            for (auto& pair : m_blocksMap)
+            {
+                for (Block* block : pair.second)
+                    releaseBlock(block);
+            }
+            m_blocksMap.clear();
+            m_IDLocationMap.clear();
+        }
+
+    private:
+        static constexpr size_t VERTEX_BYTES = Traits::VERTEX_FLOATS * sizeof(float);
+
+        /**
+         * @brief 图元位置
+         */
+        struct Location
+        {
+            uint64_t nKey{ 0 };         // 批次键
+            Block* block{ nullptr };    // 所属块
+            size_t nPrimIdx{ 0 };       // 块内槽位下标
+        };
+
+        QOpenGLFunctions_3_3_Core* m_gl{ nullptr };
+        mutable std::shared_mutex m_mutex;
+
+        std::unordered_map<uint64_t, std::vector<Block*>> m_blocksMap;  // 批次键 -> 块
+        std::unordered_map<long long, Location> m_IDLocationMap;        // ID -> 位置
+
+        std::shared_ptr<GpuMemoryBudget> m_pGpuBudget;  // 显存预算（可共享）
+    };
+}
+
+#endif // PRIMITIVE_VBO_MANAGER_H
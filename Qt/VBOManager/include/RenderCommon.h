@@ -54,7 +54,8 @@ namespace GLRhi
         long long id;                       // ID
         std::vector<float> vVerts;           //  x, y, u, v
         std::vector<unsigned int> indices;
-        unsigned int tex;
+        unsigned int tex;                   // 纹理（2D 纹理数组）
+        int textureLayer{ 0 };              // 纹理数组层索引
         Brush brush;
     };
 
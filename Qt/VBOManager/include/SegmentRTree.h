@@ -0,0 +1,89 @@
+#ifndef SEGMENT_RTREE_H
+#define SEGMENT_RTREE_H
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace GLRhi
+{
+    /**
+     * @brief R 树中的线段（xy 平面）
+     */
+    struct SegmentEntry
+    {
+        float x1{ 0.0f };
+        float y1{ 0.0f };
+        float x2{ 0.0f };
+        float y2{ 0.0f };
+        uint32_t nPrim{ 0 };    // 所属图元在块内的下标
+    };
+
+    /**
+     * @class SegmentRTree
+     * @brief 静态线段 R 树（STR 批量构建）
+     *
+     * 一次性按 Sort-Tile-Recursive 打包，节点连续存放在数组中，不支持增量插入；
+     * 数据变化后整体重建。用于拾取时查找离给定点最近的线段。
+     */
+    class SegmentRTree
+    {
+    public:
+        static constexpr size_t NODE_CAPACITY = 16;     // 每个节点的子项数
+
+    public:
+        /**
+         * @brief 由线段集合构建（会重新排列传入的线段）
+         */
+        void build(std::vector<SegmentEntry>&& vSegments);
+
+        void clear();
+
+        bool empty() const { return m_vSegments.empty(); }
+        size_t size() const { return m_vSegments.size(); }
+
+        /**
+         * @brief 查找距离 (x, y) 不超过 fRadius 的最近线段
+         * @param nPrim 输出所属图元下标
+         * @param fDist 输出距离
+         * @return true 找到
+         */
+        bool nearest(float x, float y, float fRadius, uint32_t& nPrim, float& fDist) const;
+
+        /**
+         * @brief 占用的内存字节数
+         */
+        size_t memoryBytes() const;
+
+    private:
+        struct Box
+        {
+            float fMinX{ 0.0f };
+            float fMinY{ 0.0f };
+            float fMaxX{ 0.0f };
+            float fMaxY{ 0.0f };
+        };
+
+        struct Node
+        {
+            Box box;
+            uint32_t nFirst{ 0 };   // 叶节点：首条线段下标；内部节点：首个子节点下标
+            uint32_t nCount{ 0 };   // 子项数
+            bool bLeaf{ true };
+        };
+
+        template <typename T, typename CenterFn>
+        static void strSort(std::vector<T>& vItems, CenterFn center);
+
+        static Box segmentBox(const SegmentEntry& seg);
+        static void expand(Box& box, const Box& other);
+        static float boxDistSq(const Box& box, float x, float y);
+        static float segmentDistSq(const SegmentEntry& seg, float x, float y);
+
+    private:
+        std::vector<SegmentEntry> m_vSegments;
+        std::vector<Node> m_vNodes;     // 自底向上逐层存放，根节点在末尾
+    };
+}
+
+#endif // SEGMENT_RTREE_H
@@ -0,0 +1,59 @@
+#ifndef TEXTURES_VBO_MANAGER_H
+#define TEXTURES_VBO_MANAGER_H
+
+#include "PrimitiveVboManager.h"
+#include "RenderCommon.h"
+
+namespace GLRhi
+{
+    /**
+     * @brief 纹理图元特征
+     *
+     * 顶点：x, y, depth, u, v, layer, alpha（7 个 float）
+     * 批次：按纹理数组分块，层号与透明度写入顶点，
+     *       同一纹理数组的所有层一次绘制完成，不需要逐图元切换纹理
+     * 4 个顶点且索引为空时按四边形 {0,1,2, 0,2,3} 绘制
+     */
+    struct TextureTraits
+    {
+        using Data = TextureData;
+
+        struct BatchInfo
+        {
+            GLuint tex{ 0 };
+        };
+
+        struct Uniforms
+        {
+            GLint nSamplerLoc{ -1 };
+        };
+
+        static constexpr GLenum PRIMITIVE_MODE = GL_TRIANGLES;
+        static constexpr size_t VERTEX_FLOATS = 7;
+
+        static long long id(const Data& data) { return data.id; }
+        static uint64_t batchKey(const Data& data) { return data.tex; }
+        static BatchInfo batchInfo(const Data& data) { return BatchInfo{ data.tex }; }
+        static size_t vertexCount(const Data& data) { return data.vVerts.size() / 4; }
+
+        static void writeVertices(const Data& data, float* pDst);
+        static void writeIndices(const Data& data, std::vector<unsigned int>& vOut);
+        static void setupAttributes(QOpenGLFunctions_3_3_Core* gl);
+        static Uniforms getUniforms(QOpenGLFunctions_3_3_Core* gl, GLint nProg);
+        static void bindBatch(QOpenGLFunctions_3_3_Core* gl, const Uniforms& uniforms, const BatchInfo& info);
+    };
+
+    /**
+     * @brief 纹理 VBO 管理器（2D 纹理数组）
+     * 着色器需提供 location 0/1/2 的 vec3 位置、vec3 (u, v, layer)、float alpha，
+     * 以及 sampler2DArray uTexArray
+     */
+    class TexturesVboManager final : public PrimitiveVboManager<TextureTraits>
+    {
+    public:
+        TexturesVboManager() = default;
+        ~TexturesVboManager() override = default;
+    };
+}
+
+#endif // TEXTURES_VBO_MANAGER_H
@@ -0,0 +1,184 @@
+#ifndef VBO_THREAD_POOL_H
+#define VBO_THREAD_POOL_H
+
+#include <vector>
+#include <queue>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <future>
+#include <functional>
+#include <atomic>
+#include <algorithm>
+#include <exception>
+#include <stdexcept>
+#include <type_traits>
+
+namespace GLRhi
+{
+    /**
+     * @class ThreadPool
+     * @brief 固定线程数的任务池（结构同 pool/ThreadPool）
+     *
+     * 任务放入队列，由工作线程依次取出执行，enqueue 返回 future。
+     * 管理器的 CPU 并行阶段（绘制命令预处理、批量加载编码等）共用 shared() 实例，
+     * 避免每次并行都创建销毁线程。
+     *
+     * parallelFor 的调用线程也参与计算，但不要在池线程内部再调用 parallelFor（会互相等待）。
+     */
+    class ThreadPool
+    {
+    public:
+        explicit ThreadPool(size_t nThreads)
+        {
+            for (size_t i = 0; i < nThreads; ++i)
+            {
+                m_vWorkers.emplace_back([this] {
+                    for (;;)
+                    {
+                        std::function<void()> task;
+                        {
+                            std::unique_lock<std::mutex> lock(m_mutex);
+                            m_condition.wait(lock, [this] { return m_bStop || !m_tasks.empty(); });
+                            if (m_bStop && m_tasks.empty())
+                                return;
+
+                            task = std::move(m_tasks.front());
+                            m_tasks.pop();
+                        }
+                        task();
+                    }
+                });
+            }
+        }
+
+        ~ThreadPool()
+        {
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_bStop = true;
+            }
+            m_condition.notify_all();
+            for (std::thread& worker : m_vWorkers)
+                worker.join();
+        }
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        /**
+         * @brief 进程共享的线程池，线程数为硬件线程数 - 1（调用线程自己也参与计算）
+         */
+        static ThreadPool& shared()
+        {
+            static ThreadPool s_pool(std::max<size_t>(1, std::thread::hardware_concurrency()) - 1);
+            return s_pool;
+        }
+
+        size_t getThreadCount() const { return m_vWorkers.size(); }
+
+        /**
+         * @brief 添加任务
+         */
+        template <class F, class... Args>
+        auto enqueue(F&& f, Args&&... args) -> std::future<std::invoke_result_t<F, Args...>>
+        {
+            using ReturnType = std::invoke_result_t<F, Args...>;
+
+            auto task = std::make_shared<std::packaged_task<ReturnType()>>(
+                std::bind(std::forward<F>(f), std::forward<Args>(args)...));
+
+            std::future<ReturnType> res = task->get_future();
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                if (m_bStop)
+                    throw std::runtime_error("enqueue on stopped ThreadPool");
+
+                m_tasks.emplace([task]() { (*task)(); });
+            }
+            m_condition.notify_one();
+            return res;
+        }
+
+        /**
+         * @brief 把 [0, nCount) 切成不小于 nMinPerTask 的区间并行执行 fn(begin, end)，返回时全部完成
+         * 区间由调用线程与工作线程从同一计数器领取，某个工作线程繁忙时其余线程（含调用线程）会接手。
+         * 数据量不足两个区间或池中没有线程时直接在当前线程执行。
+         * fn 抛出异常时其余线程不再领取新区间，等所有已派发的任务结束后重新抛出第一个异常。
+         */
+        template <typename Fn>
+        void parallelFor(size_t nCount, size_t nMinPerTask, Fn&& fn)
+        {
+            nMinPerTask = std::max<size_t>(1, nMinPerTask);
+            size_t nTasks = std::min(m_vWorkers.size() + 1, (nCount + nMinPerTask - 1) / nMinPerTask);
+            if (nTasks <= 1)
+            {
+                if (nCount > 0)
+                    fn(size_t(0), nCount);
+                return;
+            }
+
+            // 区间数多于线程数，负载不均时可以互相补位
+            const size_t nChunks = std::min(nCount, nTasks * 4);
+            const size_t nChunkSize = (nCount + nChunks - 1) / nChunks;
+            std::atomic<size_t> nNext{ 0 };
+            auto run = [&]() {
+                try
+                {
+                    for (size_t c = nNext++; c < nChunks; c = nNext++)
+                    {
+                        size_t nBegin = c * nChunkSize;
+                        size_t nEnd = std::min(nCount, nBegin + nChunkSize);
+                        if (nBegin < nEnd)
+                            fn(nBegin, nEnd);
+                    }
+                }
+                catch (...)
+                {
+                    nNext = nChunks;
+                    throw;
+                }
+            };
+
+            std::vector<std::future<void>> vFutures;
+            vFutures.reserve(nTasks - 1);
+            std::exception_ptr pError;
+            try
+            {
+                for (size_t t = 1; t < nTasks; ++t)
+                    vFutures.push_back(enqueue(run));
+                run();
+            }
+            catch (...)
+            {
+                nNext = nChunks;
+                pError = std::current_exception();
+            }
+
+            // 任务引用了本函数栈上的 run / nNext，无论是否出错都要等全部结束才能返回
+            for (auto& future : vFutures)
+            {
+                try
+                {
+                    future.get();
+                }
+                catch (...)
+                {
+                    if (!pError)
+                        pError = std::current_exception();
+                }
+            }
+            if (pError)
+                std::rethrow_exception(pError);
+        }
+
+    private:
+        std::vector<std::thread> m_vWorkers;            // 工作线程
+        std::queue<std::function<void()>> m_tasks;      // 任务队列
+        std::mutex m_mutex;                             // 保护任务队列
+        std::condition_variable m_condition;            // 有新任务或停止时通知
+        bool m_bStop{ false };
+    };
+}
+
+#endif // VBO_THREAD_POOL_H
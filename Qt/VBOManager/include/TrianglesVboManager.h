@@ -0,0 +1,57 @@
+#ifndef TRIANGLES_VBO_MANAGER_H
+#define TRIANGLES_VBO_MANAGER_H
+
+#include "PrimitiveVboManager.h"
+#include "RenderCommon.h"
+
+namespace GLRhi
+{
+    /**
+     * @brief 三角形图元特征
+     *
+     * 顶点：x, y, z（与 TriangleData::vVerts 相同，3 个 float）
+     * 批次：按颜色（含透明度）分块，每块设置一次 uColor
+     * 索引为空时按 0..n-1 顺序绘制
+     */
+    struct TriangleTraits
+    {
+        using Data = TriangleData;
+
+        struct BatchInfo
+        {
+            Color color;
+        };
+
+        struct Uniforms
+        {
+            GLint nColorLoc{ -1 };
+        };
+
+        static constexpr GLenum PRIMITIVE_MODE = GL_TRIANGLES;
+        static constexpr size_t VERTEX_FLOATS = 3;
+
+        static long long id(const Data& data) { return data.id; }
+        static uint64_t batchKey(const Data& data) { return data.brush.getColor().toUInt32(); }
+        static BatchInfo batchInfo(const Data& data) { return BatchInfo{ data.brush.getColor() }; }
+        static size_t vertexCount(const Data& data) { return data.vVerts.size() / 3; }
+
+        static void writeVertices(const Data& data, float* pDst);
+        static void writeIndices(const Data& data, std::vector<unsigned int>& vOut);
+        static void setupAttributes(QOpenGLFunctions_3_3_Core* gl);
+        static Uniforms getUniforms(QOpenGLFunctions_3_3_Core* gl, GLint nProg);
+        static void bindBatch(QOpenGLFunctions_3_3_Core* gl, const Uniforms& uniforms, const BatchInfo& info);
+    };
+
+    /**
+     * @brief 三角形 VBO 管理器
+     * 着色器需提供 layout(location = 0) 的 vec3 顶点与 vec4 uColor
+     */
+    class TrianglesVboManager final : public PrimitiveVboManager<TriangleTraits>
+    {
+    public:
+        TrianglesVboManager() = default;
+        ~TrianglesVboManager() override = default;
+    };
+}
+
+#endif // TRIANGLES_VBO_MANAGER_H
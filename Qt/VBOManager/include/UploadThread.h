@@ -0,0 +1,86 @@
+#ifndef UPLOAD_THREAD_H
+#define UPLOAD_THREAD_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <QOpenGLFunctions_3_3_Core>
+
+class QOpenGLContext;
+class QOffscreenSurface;
+class QThread;
+
+namespace GLRhi
+{
+    /**
+     * @class UploadThread
+     * @brief 独立 OpenGL 上下文的上传线程
+     *
+     * 在 GUI 线程创建与渲染上下文共享的 QOpenGLContext 和 QOffscreenSurface，
+     * 上下文移到工作线程后在其中依次执行任务（创建、填充缓冲区等）。
+     * 缓冲区与同步对象在共享上下文之间可见，VAO 不共享，需由渲染线程创建。
+     *
+     * 任务结束前应调用 insertFence 插入栅栏并 glFlush，渲染线程对栅栏
+     * glWaitSync（GPU 端等待，不阻塞 CPU）后再使用任务创建的缓冲区。
+     */
+    class UploadThread
+    {
+    public:
+        using Task = std::function<void(QOpenGLFunctions_3_3_Core*)>;
+
+    public:
+        UploadThread() = default;
+        ~UploadThread();
+        UploadThread(const UploadThread&) = delete;
+        UploadThread& operator=(const UploadThread&) = delete;
+
+        /**
+         * @brief 创建共享上下文并启动线程（在 GUI 线程调用）
+         * @param pShareContext 渲染上下文
+         * @return 共享上下文创建失败时返回 false
+         */
+        bool start(QOpenGLContext* pShareContext);
+
+        /**
+         * @brief 停止线程：尚未开始的任务被丢弃，正在执行的任务执行完毕后返回（在 GUI 线程调用）
+         */
+        void stop();
+
+        bool isRunning() const { return m_pThread != nullptr; }
+
+        /**
+         * @brief 添加任务，任务在上传线程中以其上下文的函数表执行
+         * @return 线程未运行时返回 false，任务不会执行
+         */
+        bool enqueue(Task task);
+
+        /**
+         * @brief 尚未执行完的任务数
+         */
+        size_t getPendingCount() const { return m_nPending.load(std::memory_order_relaxed); }
+
+        /**
+         * @brief 插入栅栏并提交命令，使其他上下文可以等待该栅栏
+         */
+        static GLsync insertFence(QOpenGLFunctions_3_3_Core* gl);
+
+    private:
+        void run();
+
+    private:
+        QOpenGLContext* m_pContext{ nullptr };      // 共享上下文（运行期间属于工作线程）
+        QOffscreenSurface* m_pSurface{ nullptr };   // 离屏表面（GUI 线程创建）
+        QThread* m_pThread{ nullptr };              // 工作线程
+        QThread* m_pOwnerThread{ nullptr };         // 调用 start 的线程，退出时上下文移回
+
+        mutable std::mutex m_mutex;                 // 保护任务队列
+        std::condition_variable m_condition;        // 有新任务或停止时通知
+        std::deque<Task> m_tasks;
+        bool m_bStop{ false };
+        std::atomic<size_t> m_nPending{ 0 };
+    };
+}
+
+#endif // UPLOAD_THREAD_H
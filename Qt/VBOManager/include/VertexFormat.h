@@ -0,0 +1,104 @@
+#ifndef VERTEX_FORMAT_H
+#define VERTEX_FORMAT_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace GLRhi
+{
+    /**
+     * @brief 折线顶点存储格式
+     *
+     * CAD 数据基本是二维的，同一图层 z 为常量，因此压缩格式只存 x/y，
+     * z 与块原点、缩放一起作为块级 uniform 传入着色器。
+     */
+    enum class VertexFormat
+    {
+        Float3,         // x, y, z 三个 32 位浮点（12 字节/顶点）
+        Quantized16,    // 相对块原点的 16 位定点 x, y（4 字节/顶点）
+        HalfFloat       // 相对块原点的半精度浮点 x, y（4 字节/顶点）
+    };
+
+    /**
+     * @brief 块内坐标窗口
+     *
+     * 压缩格式下顶点以 (x - fOriginX) / fStep 的形式存储，
+     * 着色器中还原为 uBlockOrigin + aPos.xy * uBlockScale。
+     */
+    struct QuantizeWindow
+    {
+        float fOriginX{ 0.0f };     // 块原点 x
+        float fOriginY{ 0.0f };     // 块原点 y
+        float fStep{ 1.0f };        // 量化步长（世界坐标 / 单位整数）
+    };
+
+    // 16 位量化可表示的最大偏移量（对称范围，避免 -32768 的不对称）
+    static constexpr int QUANTIZE_HALF_RANGE = 32767;
+
+    // 半精度有效位 11 位，± 2048 以内相邻可表示值的间距不超过 1
+    static constexpr int HALF_EXACT_RANGE = 2048;
+
+    /**
+     * @brief 获取顶点格式的字节跨度
+     * @param eFormat 顶点格式
+     * @return 每个顶点占用的字节数
+     */
+    size_t vertexStride(VertexFormat eFormat);
+
+    /**
+     * @brief 获取顶点格式的名称（调试输出用）
+     */
+    const char* vertexFormatName(VertexFormat eFormat);
+
+    /**
+     * @brief float 转 IEEE 754 半精度（就近舍入到偶数，溢出为无穷大）
+     */
+    uint16_t floatToHalf(float fValue);
+
+    /**
+     * @brief IEEE 754 半精度转 float
+     */
+    float halfToFloat(uint16_t nHalf);
+
+    /**
+     * @brief 判断顶点是否能以指定窗口编码，且还原误差不超过半个步长
+     *
+     * Quantized16 要求所有顶点落在原点 ± 32767 * 步长之内，
+     * HalfFloat 要求落在原点 ± 2048 * 步长之内（越靠近原点精度越高）；
+     * 压缩格式还要求所有顶点 z 与 fLayerZ 相同。
+     *
+     * @param eFormat 顶点格式
+     * @param window 块坐标窗口
+     * @param fLayerZ 块统一 z 值
+     * @param pVerts 顶点数据 [x, y, z, ...]
+     * @param nVertCount 顶点数量
+     * @return true 可以放入该窗口
+     */
+    bool fitsWindow(VertexFormat eFormat, const QuantizeWindow& window, float fLayerZ,
+        const float* pVerts, size_t nVertCount);
+
+    /**
+     * @brief 将 xyz 浮点顶点编码为指定格式
+     * @param eFormat 目标格式
+     * @param window 块坐标窗口（Float3 忽略）
+     * @param pVerts 源顶点数据 [x, y, z, ...]
+     * @param nVertCount 顶点数量
+     * @param pDst 目标缓冲区，大小至少为 nVertCount * vertexStride(eFormat)
+     */
+    void encodeVertices(VertexFormat eFormat, const QuantizeWindow& window,
+        const float* pVerts, size_t nVertCount, void* pDst);
+
+    /**
+     * @brief 将编码后的顶点还原为 xyz 浮点（与着色器中的还原公式一致）
+     * @param eFormat 源格式
+     * @param window 块坐标窗口（Float3 忽略）
+     * @param fLayerZ 块统一 z 值（Float3 忽略）
+     * @param pSrc 编码后的顶点数据
+     * @param nVertCount 顶点数量
+     * @param pVerts 输出 [x, y, z, ...]，大小至少为 nVertCount * 3
+     */
+    void decodeVertices(VertexFormat eFormat, const QuantizeWindow& window, float fLayerZ,
+        const void* pSrc, size_t nVertCount, float* pVerts);
+}
+
+#endif // VERTEX_FORMAT_H
@@ -53,21 +53,6 @@ namespace GLRhi
         m_color.setRgb(red, green, blue);
     }
 
-    void Brush::getRgb(float &red, float &green, float &blue) const
-    {
-        m_color.getRgb(red, green, blue);
-    }
-
-    void Brush::getRgba(float &red, float &green, float &blue, float &alpha) const
-    {
-        m_color.getRgba(red, green, blue, alpha);
-    }
-
-    void Brush::clampValues()
-    {
-        m_color.clampValues();
-    }
-
     // 混合两个颜色
     Brush Brush::blend(const Brush &other, float factor) const
     {
@@ -80,92 +65,4 @@ namespace GLRhi
 
         return result;
     }
-
-    // Getter方法实现
-    float Brush::getRed() const
-    {
-        return m_color.getRed();
-    }
-    float Brush::r() const
-    {
-        return m_color.r();
-    }
-    float Brush::getGreen() const
-    {
-        return m_color.getGreen();
-    }
-    float Brush::g() const
-    {
-        return m_color.g();
-    }
-    float Brush::getBlue() const
-    {
-        return m_color.getBlue();
-    }
-    float Brush::b() const
-    {
-        return m_color.b();
-    }
-    float Brush::getAlpha() const
-    {
-        return m_color.getAlpha();
-    }
-    float Brush::a() const
-    {
-        return m_color.a();
-    }
-    const Color &Brush::getColor() const
-    {
-        return m_color;
-    }
-    Color &Brush::getColor()
-    {
-        return m_color;
-    }
-    float Brush::getDepth() const
-    {
-        return m_depth;
-    }
-    float Brush::d() const
-    {
-        return m_depth;
-    }
-    int Brush::getType() const
-    {
-        return m_type;
-    }
-    int Brush::t() const
-    {
-        return m_type;
-    }
-
-    // Setter方法实现
-    void Brush::setRed(float red)
-    {
-        m_color.setRed(red);
-    }
-    void Brush::setGreen(float green)
-    {
-        m_color.setGreen(green);
-    }
-    void Brush::setBlue(float blue)
-    {
-        m_color.setBlue(blue);
-    }
-    void Brush::setAlpha(float alpha)
-    {
-        m_color.setAlpha(alpha);
-    }
-    void Brush::setColor(const Color &color)
-    {
-        m_color = color;
-    }
-    void Brush::setDepth(float depth)
-    {
-        m_depth = depth;
-    }
-    void Brush::setType(int type)
-    {
-        m_type = type;
-    }
 }
\ No newline at end of file
@@ -0,0 +1,374 @@
+#include "ColorBuffer.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define COLOR_SIMD_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define COLOR_SIMD_SSE2
+#elif (defined(__ARM_NEON) || defined(_M_ARM64)) && (defined(__aarch64__) || defined(_M_ARM64))
+#include <arm_neon.h>
+#define COLOR_SIMD_NEON
+#endif
+
+namespace GLRhi
+{
+    namespace
+    {
+        /**
+         * @brief 标量实现，也用于 SIMD 处理后剩余的尾部
+         */
+        struct ScalarOps
+        {
+            using F = float;
+            using U = uint32_t;
+            static constexpr size_t W = 1;
+
+            static F load(const float* p) { return *p; }
+            static void store(float* p, F v) { *p = v; }
+            static F set1(float f) { return f; }
+            static F add(F a, F b) { return a + b; }
+            static F sub(F a, F b) { return a - b; }
+            static F mul(F a, F b) { return a * b; }
+            static F min(F a, F b) { return a < b ? a : b; }
+            static F max(F a, F b) { return a > b ? a : b; }
+            static F sqrt(F a) { return std::sqrt(a); }
+            static F selectGreater(F x, F threshold, F hi, F lo) { return x > threshold ? hi : lo; }
+            static U truncU(F a) { return static_cast<U>(a); }
+            static U loadU(const uint32_t* p) { return *p; }
+            static void storeU(uint32_t* p, U v) { *p = v; }
+            static U shl(U v, int n) { return v << n; }
+            static U shr(U v, int n) { return v >> n; }
+            static U bitOr(U a, U b) { return a | b; }
+            static U byte0(U v) { return v & 0xFFu; }
+            static F toFloat(U v) { return static_cast<F>(v); }
+        };
+
+#if defined(COLOR_SIMD_AVX2)
+        struct SimdOps
+        {
+            using F = __m256;
+            using U = __m256i;
+            static constexpr size_t W = 8;
+
+            static F load(const float* p) { return _mm256_loadu_ps(p); }
+            static void store(float* p, F v) { _mm256_storeu_ps(p, v); }
+            static F set1(float f) { return _mm256_set1_ps(f); }
+            static F add(F a, F b) { return _mm256_add_ps(a, b); }
+            static F sub(F a, F b) { return _mm256_sub_ps(a, b); }
+            static F mul(F a, F b) { return _mm256_mul_ps(a, b); }
+            static F min(F a, F b) { return _mm256_min_ps(a, b); }
+            static F max(F a, F b) { return _mm256_max_ps(a, b); }
+            static F sqrt(F a) { return _mm256_sqrt_ps(a); }
+            static F selectGreater(F x, F threshold, F hi, F lo)
+            {
+                return _mm256_blendv_ps(lo, hi, _mm256_cmp_ps(x, threshold, _CMP_GT_OQ));
+            }
+            static U truncU(F a) { return _mm256_cvttps_epi32(a); }     // 输入在 [0, 256)，有符号转换即可
+            static U loadU(const uint32_t* p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); }
+            static void storeU(uint32_t* p, U v) { _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v); }
+            static U shl(U v, int n) { return _mm256_sll_epi32(v, _mm_cvtsi32_si128(n)); }
+            static U shr(U v, int n) { return _mm256_srl_epi32(v, _mm_cvtsi32_si128(n)); }
+            static U bitOr(U a, U b) { return _mm256_or_si256(a, b); }
+            static U byte0(U v) { return _mm256_and_si256(v, _mm256_set1_epi32(0xFF)); }
+            static F toFloat(U v) { return _mm256_cvtepi32_ps(v); }
+        };
+#elif defined(COLOR_SIMD_SSE2)
+        struct SimdOps
+        {
+            using F = __m128;
+            using U = __m128i;
+            static constexpr size_t W = 4;
+
+            static F load(const float* p) { return _mm_loadu_ps(p); }
+            static void store(float* p, F v) { _mm_storeu_ps(p, v); }
+            static F set1(float f) { return _mm_set1_ps(f); }
+            static F add(F a, F b) { return _mm_add_ps(a, b); }
+            static F sub(F a, F b) { return _mm_sub_ps(a, b); }
+            static F mul(F a, F b) { return _mm_mul_ps(a, b); }
+            static F min(F a, F b) { return _mm_min_ps(a, b); }
+            static F max(F a, F b) { return _mm_max_ps(a, b); }
+            static F sqrt(F a) { return _mm_sqrt_ps(a); }
+            static F selectGreater(F x, F threshold, F hi, F lo)
+            {
+                F mask = _mm_cmpgt_ps(x, threshold);
+                return _mm_or_ps(_mm_and_ps(mask, hi), _mm_andnot_ps(mask, lo));
+            }
+            static U truncU(F a) { return _mm_cvttps_epi32(a); }
+            static U loadU(const uint32_t* p) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); }
+            static void storeU(uint32_t* p, U v) { _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v); }
+            static U shl(U v, int n) { return _mm_sll_epi32(v, _mm_cvtsi32_si128(n)); }
+            static U shr(U v, int n) { return _mm_srl_epi32(v, _mm_cvtsi32_si128(n)); }
+            static U bitOr(U a, U b) { return _mm_or_si128(a, b); }
+            static U byte0(U v) { return _mm_and_si128(v, _mm_set1_epi32(0xFF)); }
+            static F toFloat(U v) { return _mm_cvtepi32_ps(v); }
+        };
+#elif defined(COLOR_SIMD_NEON)
+        struct SimdOps
+        {
+            using F = float32x4_t;
+            using U = uint32x4_t;
+            static constexpr size_t W = 4;
+
+            static F load(const float* p) { return vld1q_f32(p); }
+            static void store(float* p, F v) { vst1q_f32(p, v); }
+            static F set1(float f) { return vdupq_n_f32(f); }
+            static F add(F a, F b) { return vaddq_f32(a, b); }
+            static F sub(F a, F b) { return vsubq_f32(a, b); }
+            static F mul(F a, F b) { return vmulq_f32(a, b); }
+            static F min(F a, F b) { return vminq_f32(a, b); }
+            static F max(F a, F b) { return vmaxq_f32(a, b); }
+            static F sqrt(F a) { return vsqrtq_f32(a); }
+            static F selectGreater(F x, F threshold, F hi, F lo) { return vbslq_f32(vcgtq_f32(x, threshold), hi, lo); }
+            static U truncU(F a) { return vcvtq_u32_f32(a); }
+            static U loadU(const uint32_t* p) { return vld1q_u32(p); }
+            static void storeU(uint32_t* p, U v) { vst1q_u32(p, v); }
+            static U shl(U v, int n) { return vshlq_u32(v, vdupq_n_s32(n)); }
+            static U shr(U v, int n) { return vshlq_u32(v, vdupq_n_s32(-n)); }
+            static U bitOr(U a, U b) { return vorrq_u32(a, b); }
+            static U byte0(U v) { return vandq_u32(v, vdupq_n_u32(0xFF)); }
+            static F toFloat(U v) { return vcvtq_f32_u32(v); }
+        };
+#else
+        using SimdOps = ScalarOps;
+#endif
+
+        /**
+         * @brief 对 [0, nCount) 先按 SIMD 宽度处理，剩余部分用标量处理
+         * kernel 为泛型 lambda，参数为 (ops 类型标记, 下标)
+         */
+        template <typename Kernel>
+        void forEachLane(size_t nCount, Kernel&& kernel)
+        {
+            size_t i = 0;
+            if (SimdOps::W > 1)
+            {
+                for (; i + SimdOps::W <= nCount; i += SimdOps::W)
+                    kernel(SimdOps(), i);
+            }
+            for (; i < nCount; ++i)
+                kernel(ScalarOps(), i);
+        }
+
+        template <typename Ops>
+        typename Ops::F clamp01(typename Ops::F v)
+        {
+            return Ops::min(Ops::max(v, Ops::set1(0.0f)), Ops::set1(1.0f));
+        }
+
+        /**
+         * @brief 线性 -> sRGB：x^(1/2.4) 用三次开方组合近似
+         */
+        template <typename Ops>
+        typename Ops::F linearToSrgbApprox(typename Ops::F x)
+        {
+            using F = typename Ops::F;
+            F s1 = Ops::sqrt(x);
+            F s2 = Ops::sqrt(s1);
+            F s3 = Ops::sqrt(s2);
+            F curve = Ops::sub(Ops::add(Ops::mul(Ops::set1(0.585122381f), s1), Ops::mul(Ops::set1(0.783140355f), s2)),
+                Ops::mul(Ops::set1(0.368262736f), s3));
+            F linear = Ops::mul(x, Ops::set1(12.92f));
+            return clamp01<Ops>(Ops::selectGreater(x, Ops::set1(0.0031308f), curve, linear));
+        }
+
+        /**
+         * @brief sRGB -> 线性：三次多项式近似
+         */
+        template <typename Ops>
+        typename Ops::F srgbToLinearApprox(typename Ops::F s)
+        {
+            using F = typename Ops::F;
+            F poly = Ops::add(Ops::mul(s, Ops::set1(0.305306011f)), Ops::set1(0.682171111f));
+            poly = Ops::add(Ops::mul(s, poly), Ops::set1(0.012522878f));
+            return clamp01<Ops>(Ops::mul(s, poly));
+        }
+    }
+
+    ColorBuffer::ColorBuffer(size_t nCount, const Color& fill /*= Color()*/)
+    {
+        resize(nCount, fill);
+    }
+
+    void ColorBuffer::reserve(size_t nCount)
+    {
+        m_vR.reserve(nCount);
+        m_vG.reserve(nCount);
+        m_vB.reserve(nCount);
+        m_vA.reserve(nCount);
+    }
+
+    void ColorBuffer::resize(size_t nCount, const Color& fill /*= Color()*/)
+    {
+        m_vR.resize(nCount, fill.r());
+        m_vG.resize(nCount, fill.g());
+        m_vB.resize(nCount, fill.b());
+        m_vA.resize(nCount, fill.a());
+    }
+
+    void ColorBuffer::clear()
+    {
+        m_vR.clear();
+        m_vG.clear();
+        m_vB.clear();
+        m_vA.clear();
+    }
+
+    void ColorBuffer::push_back(const Color& color)
+    {
+        m_vR.push_back(color.r());
+        m_vG.push_back(color.g());
+        m_vB.push_back(color.b());
+        m_vA.push_back(color.a());
+    }
+
+    void ColorBuffer::set(size_t i, const Color& color)
+    {
+        m_vR[i] = color.r();
+        m_vG[i] = color.g();
+        m_vB[i] = color.b();
+        m_vA[i] = color.a();
+    }
+
+    void ColorBuffer::assign(const Color* pColors, size_t nCount)
+    {
+        resize(nCount);
+        for (size_t i = 0; i < nCount; ++i)
+            set(i, pColors[i]);
+    }
+
+    void ColorBuffer::unpackUInt32(const uint32_t* pPacked, size_t nCount)
+    {
+        resize(nCount);
+        float* arrOut[4] = { m_vR.data(), m_vG.data(), m_vB.data(), m_vA.data() };
+        forEachLane(nCount, [&](auto ops, size_t i) {
+            using Ops = decltype(ops);
+            typename Ops::U packed = Ops::loadU(pPacked + i);
+            const typename Ops::F scale = Ops::set1(1.0f / 255.0f);
+            for (int c = 0; c < 4; ++c)
+                Ops::store(arrOut[c] + i, Ops::mul(Ops::toFloat(Ops::byte0(Ops::shr(packed, c * 8))), scale));
+        });
+    }
+
+    void ColorBuffer::clamp()
+    {
+        for (std::vector<float>* pChannel : { &m_vR, &m_vG, &m_vB, &m_vA })
+        {
+            float* p = pChannel->data();
+            forEachLane(pChannel->size(), [&](auto ops, size_t i) {
+                using Ops = decltype(ops);
+                Ops::store(p + i, clamp01<Ops>(Ops::load(p + i)));
+            });
+        }
+    }
+
+    void ColorBuffer::blend(const ColorBuffer& other, float factor)
+    {
+        const size_t nCount = std::min(size(), other.size());
+        factor = std::clamp(factor, 0.0f, 1.0f);
+        const float invFactor = 1.0f - factor;
+
+        float* arrDst[4] = { m_vR.data(), m_vG.data(), m_vB.data(), m_vA.data() };
+        const float* arrSrc[4] = { other.m_vR.data(), other.m_vG.data(), other.m_vB.data(), other.m_vA.data() };
+        for (int c = 0; c < 4; ++c)
+        {
+            float* pDst = arrDst[c];
+            const float* pSrc = arrSrc[c];
+            forEachLane(nCount, [&](auto ops, size_t i) {
+                using Ops = decltype(ops);
+                auto v = Ops::add(Ops::mul(Ops::load(pDst + i), Ops::set1(invFactor)), Ops::mul(Ops::load(pSrc + i), Ops::set1(factor)));
+                Ops::store(pDst + i, clamp01<Ops>(v));
+            });
+        }
+    }
+
+    void ColorBuffer::blend(const Color& target, float factor)
+    {
+        factor = std::clamp(factor, 0.0f, 1.0f);
+        const float invFactor = 1.0f - factor;
+
+        float* arrDst[4] = { m_vR.data(), m_vG.data(), m_vB.data(), m_vA.data() };
+        const float arrTarget[4] = { target.r(), target.g(), target.b(), target.a() };
+        for (int c = 0; c < 4; ++c)
+        {
+            float* pDst = arrDst[c];
+            const float fOffset = arrTarget[c] * factor;
+            forEachLane(size(), [&](auto ops, size_t i) {
+                using Ops = decltype(ops);
+                auto v = Ops::add(Ops::mul(Ops::load(pDst + i), Ops::set1(invFactor)), Ops::set1(fOffset));
+                Ops::store(pDst + i, clamp01<Ops>(v));
+            });
+        }
+    }
+
+    void ColorBuffer::premultiply()
+    {
+        const float* pA = m_vA.data();
+        for (float* p : { m_vR.data(), m_vG.data(), m_vB.data() })
+        {
+            forEachLane(size(), [&](auto ops, size_t i) {
+                using Ops = decltype(ops);
+                Ops::store(p + i, Ops::mul(Ops::load(p + i), Ops::load(pA + i)));
+            });
+        }
+    }
+
+    void ColorBuffer::linearToSrgb()
+    {
+        // Alpha 不做伽马转换
+        for (float* p : { m_vR.data(), m_vG.data(), m_vB.data() })
+        {
+            forEachLane(size(), [&](auto ops, size_t i) {
+                using Ops = decltype(ops);
+                Ops::store(p + i, linearToSrgbApprox<Ops>(Ops::load(p + i)));
+            });
+        }
+    }
+
+    void ColorBuffer::srgbToLinear()
+    {
+        for (float* p : { m_vR.data(), m_vG.data(), m_vB.data() })
+        {
+            forEachLane(size(), [&](auto ops, size_t i) {
+                using Ops = decltype(ops);
+                Ops::store(p + i, srgbToLinearApprox<Ops>(Ops::load(p + i)));
+            });
+        }
+    }
+
+    void ColorBuffer::packUInt32(uint32_t* pOut) const
+    {
+        if (!pOut)
+            return;
+
+        const float* pR = m_vR.data();
+        const float* pG = m_vG.data();
+        const float* pB = m_vB.data();
+        const float* pA = m_vA.data();
+        forEachLane(size(), [&](auto ops, size_t i) {
+            using Ops = decltype(ops);
+            auto toByte = [](const float* p) {
+                return Ops::truncU(Ops::add(Ops::mul(Ops::load(p), Ops::set1(255.0f)), Ops::set1(0.5f)));
+            };
+            typename Ops::U packed = Ops::bitOr(Ops::bitOr(Ops::shl(toByte(pA + i), 24), Ops::shl(toByte(pB + i), 16)),
+                Ops::bitOr(Ops::shl(toByte(pG + i), 8), toByte(pR + i)));
+            Ops::storeU(pOut + i, packed);
+        });
+    }
+
+    const char* ColorBuffer::simdName()
+    {
+#if defined(COLOR_SIMD_AVX2)
+        return "AVX2";
+#elif defined(COLOR_SIMD_SSE2)
+        return "SSE2";
+#elif defined(COLOR_SIMD_NEON)
+        return "NEON";
+#else
+        return "Scalar";
+#endif
+    }
+}
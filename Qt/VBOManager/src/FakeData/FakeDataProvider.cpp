@@ -41,9 +41,11 @@ namespace GLRhi
 
             std::vector<size_t> vLineVertexCounts = fakePlData.getLineInfos();
 
-            std::vector<long long> vIDs;
-            for (auto& line : vLineVertexCounts)
-                vIDs.push_back(m_idGenerator.genID());
+            // 整组一次预留连续 ID
+            IDRange idRange = m_idGenerator.reserve(static_cast<long long>(vLineVertexCounts.size()));
+            std::vector<long long> vIDs(vLineVertexCounts.size());
+            for (size_t k = 0; k < vIDs.size(); ++k)
+                vIDs[k] = idRange[static_cast<long long>(k)];
 
             Color c = fakePlData.genRandomColor();
 
@@ -66,8 +68,7 @@ namespace GLRhi
         if (vPolylineDatas.empty())
             return;
 
-        std::random_device rd;
-        std::mt19937 rng(rd());
+        std::mt19937& rng = m_rng;
 
         // 1. 随机删除N%的图元
         if (0)
@@ -235,8 +236,7 @@ namespace GLRhi
 
     void FakeDataProvider::disturbLineDataVBO()
     {
-        std::random_device rd;
-        std::mt19937 rng(rd());
+        std::mt19937& rng = m_rng;
 
         // 0. 添加随机线段组
         if (1)
@@ -345,6 +345,9 @@ namespace GLRhi
         vTriDatas[3].vVerts = { -0.2f, 0.0f, -0.8f, 0.4f, 0.0f, -0.8f, 0.4f, -0.6f, -0.8f };
         vTriDatas[3].indices = { 0, 1, 2 };
         vTriDatas[3].brush = { 1.0f, 1.0f, 0.0f, dAlpha, dDepth };
+
+        for (auto& triData : vTriDatas)
+            triData.id = m_idGenerator.genID();
         return vTriDatas;
     }
 
@@ -360,6 +363,7 @@ namespace GLRhi
             fakeTriangleData.generateTriangles(10);
 
             TriangleData triData{};
+            triData.id = m_idGenerator.genID();
             triData.vVerts = fakeTriangleData.getVertices();
             triData.indices = fakeTriangleData.getIndices();
 
@@ -376,7 +380,10 @@ namespace GLRhi
 
     std::vector<TextureData> FakeDataProvider::genTextureData()
     {
-        return genFileTextureData();
+        std::vector<TextureData> vTexDatas = genFileTextureData();
+        if (vTexDatas.empty())
+            vTexDatas = genRandomTextureData();
+        return vTexDatas;
     }
 
     std::vector<TextureData> FakeDataProvider::genFileTextureData()
@@ -390,6 +397,30 @@ namespace GLRhi
     std::vector<TextureData> FakeDataProvider::genRandomTextureData(size_t vCount /*=10*/)
     {
         std::vector<TextureData> vTexDatas;
+        vTexDatas.reserve(vCount);
+
+        // 随机四边形，纹理对象由调用方绑定（tex 为 0），层号 0~3
+        for (size_t i = 0; i < vCount; ++i)
+        {
+            float x = FakeDataBase::getRandomFloat(-0.9f, 0.6f);
+            float y = FakeDataBase::getRandomFloat(-0.9f, 0.6f);
+            float w = FakeDataBase::getRandomFloat(0.1f, 0.3f);
+            float h = FakeDataBase::getRandomFloat(0.1f, 0.3f);
+
+            TextureData texData{};
+            texData.id = m_idGenerator.genID();
+            texData.vVerts = {
+                x,     y,     0.0f, 0.0f,
+                x + w, y,     1.0f, 0.0f,
+                x + w, y + h, 1.0f, 1.0f,
+                x,     y + h, 0.0f, 1.0f };
+            texData.tex = 0;
+            texData.textureLayer = static_cast<int>(i % 4);
+            texData.brush = { 1.0f, 1.0f, 1.0f,
+                FakeDataBase::getRandomFloat(0.5f, 1.0f), FakeDataBase::getRandomFloat(-1.0f, 1.0f) };
+
+            vTexDatas.push_back(texData);
+        }
 
         return vTexDatas;
     }
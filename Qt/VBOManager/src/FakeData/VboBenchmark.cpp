@@ -0,0 +1,449 @@
+#include "FakeData/VboBenchmark.h"
+#include "PolylinesVboManager.h"
+#include "FakeData/FakePolyLineData.h"
+#include "PrimitiveIDGenerator.h"
+#include "ColorBuffer.h"
+
+#include <cmath>
+#include <chrono>
+#include <tuple>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+#include <functional>
+#include <random>
+#include <QDebug>
+#include <QString>
+
+namespace GLRhi
+{
+    namespace
+    {
+        using PolylineTuple = std::tuple<long long, std::vector<float>, Color>;
+
+        // PolylineData（按组连续存储）拆成批量添加接口需要的逐条数据
+        std::vector<PolylineTuple> toTuples(const std::vector<PolylineData>& vPlDatas)
+        {
+            std::vector<PolylineTuple> vTuples;
+            for (const auto& data : vPlDatas)
+            {
+                Color c(data.brush.getColor());
+                size_t nOffset = 0;
+                for (size_t i = 0; i < data.vId.size(); ++i)
+                {
+                    size_t nCount = data.vCount[i];
+                    const float* pSrc = data.vVerts.data() + nOffset * 3;
+                    vTuples.emplace_back(data.vId[i], std::vector<float>(pSrc, pSrc + nCount * 3), c);
+                    nOffset += nCount;
+                }
+            }
+            return vTuples;
+        }
+
+        double elapsedMs(std::chrono::high_resolution_clock::time_point start)
+        {
+            auto end = std::chrono::high_resolution_clock::now();
+            return std::chrono::duration<double, std::milli>(end - start).count();
+        }
+    }
+
+    VertexFormatAccuracy VboBenchmark::checkAccuracy(const std::vector<PolylineData>& vPlDatas,
+        VertexFormat eFormat, float fQuantizeStep)
+    {
+        VertexFormatAccuracy result;
+        result.eFormat = eFormat;
+
+        std::vector<PolylineTuple> vTuples = toTuples(vPlDatas);
+
+        PolylinesVboManager mgr(eFormat);
+        mgr.setQuantizeStep(fQuantizeStep);
+        mgr.addPolylines(vTuples);
+
+        // 先绘制一帧，让待处理的 compact 完成后再读回
+        mgr.renderVisiblePrimitives();
+
+        double dSqSum = 0.0;
+        std::vector<float> vReadBack;
+        for (const auto& [id, verts, color] : vTuples)
+        {
+            if (!mgr.readBackPolyline(id, vReadBack) || vReadBack.size() != verts.size())
+            {
+                ++result.nFailedCount;
+                continue;
+            }
+
+            for (size_t i = 0; i < verts.size(); ++i)
+            {
+                double dErr = std::fabs(static_cast<double>(vReadBack[i]) - verts[i]);
+                result.dMaxError = std::max(result.dMaxError, dErr);
+                dSqSum += dErr * dErr;
+            }
+            ++result.nLineCount;
+            result.nVertCount += verts.size() / 3;
+        }
+
+        if (result.nVertCount > 0)
+            result.dRmsError = std::sqrt(dSqSum / (result.nVertCount * 3));
+
+        return result;
+    }
+
+    VertexFormatBench VboBenchmark::benchFormat(QOpenGLFunctions_3_3_Core* gl,
+        const std::vector<PolylineData>& vPlDatas, VertexFormat eFormat,
+        float fQuantizeStep, int nRenderFrames /*= 20*/)
+    {
+        VertexFormatBench result;
+        result.eFormat = eFormat;
+
+        std::vector<PolylineTuple> vTuples = toTuples(vPlDatas);
+
+        PolylinesVboManager mgr(eFormat);
+        mgr.setQuantizeStep(fQuantizeStep);
+
+        gl->glFinish();
+        auto uploadStart = std::chrono::high_resolution_clock::now();
+        result.nLineCount = mgr.addPolylines(vTuples);
+        mgr.renderVisiblePrimitivesEx(); // 包含扩容后的重建上传
+        gl->glFinish();
+        result.dUploadMs = elapsedMs(uploadStart);
+
+        result.nVertexBytes = mgr.getUsedVertexBytes();
+
+        if (nRenderFrames > 0)
+        {
+            auto renderStart = std::chrono::high_resolution_clock::now();
+            for (int i = 0; i < nRenderFrames; ++i)
+                mgr.renderVisiblePrimitivesEx();
+            gl->glFinish();
+            result.dRenderMs = elapsedMs(renderStart) / nRenderFrames;
+        }
+
+        return result;
+    }
+
+    void VboBenchmark::runVertexFormatBenchmark(QOpenGLFunctions_3_3_Core* gl,
+        const std::vector<PolylineData>& vPlDatas, float fQuantizeStep /*= 1.0f / 8192.0f*/)
+    {
+        if (!gl || vPlDatas.empty())
+            return;
+
+        const VertexFormat arrFormats[] = { VertexFormat::Float3, VertexFormat::Quantized16, VertexFormat::HalfFloat };
+
+        qDebug() << "\n========== 顶点格式测试 ==========";
+        qDebug() << "量化步长:" << fQuantizeStep << " 理论最大误差:" << fQuantizeStep * 0.5f;
+
+        size_t nFloatBytes = 0;
+        for (VertexFormat eFormat : arrFormats)
+        {
+            VertexFormatAccuracy acc = checkAccuracy(vPlDatas, eFormat, fQuantizeStep);
+            VertexFormatBench bench = benchFormat(gl, vPlDatas, eFormat, fQuantizeStep);
+
+            if (eFormat == VertexFormat::Float3)
+                nFloatBytes = bench.nVertexBytes;
+
+            double dRatio = bench.nVertexBytes > 0 ? double(nFloatBytes) / bench.nVertexBytes : 0.0;
+
+            qDebug() << vertexFormatName(eFormat)
+                << "\n  精度: 折线" << acc.nLineCount << "顶点" << acc.nVertCount
+                << "读回失败" << acc.nFailedCount
+                << "最大误差" << acc.dMaxError << "RMS" << acc.dRmsError
+                << "\n  显存: 顶点" << bench.nVertexBytes / 1024.0 << "KB  压缩比" << dRatio
+                << "\n  耗时: 上传" << bench.dUploadMs << "ms  绘制" << bench.dRenderMs << "ms/帧";
+        }
+        qDebug() << "==================================\n";
+    }
+
+    void VboBenchmark::runBulkLoadBenchmark(QOpenGLFunctions_3_3_Core* gl,
+        size_t nLineCount /*= 1'000'000*/, size_t nMinPts /*= 2*/, size_t nMaxPts /*= 8*/)
+    {
+        if (!gl || nLineCount == 0)
+            return;
+
+        FakePolyLineData lineGen;
+        lineGen.generateLines(nLineCount, nMinPts, nMaxPts);
+        const std::vector<float>& vVerts = lineGen.getVertices();
+        const std::vector<size_t>& vCounts = lineGen.getLineInfos();
+
+        std::vector<long long> vIds(vCounts.size());
+        for (size_t i = 0; i < vIds.size(); ++i)
+            vIds[i] = static_cast<long long>(i + 1);
+
+        Color color(0.2f, 0.8f, 0.3f, 1.0f);
+
+        qDebug() << "\n========== 批量加载测试 ==========";
+        qDebug() << "折线:" << vIds.size() << " 顶点:" << vVerts.size() / 3;
+
+        // 逐条添加（每条折线一次 glBufferSubData）
+        {
+            PolylinesVboManager mgr;
+            gl->glFinish();
+            auto start = std::chrono::high_resolution_clock::now();
+            size_t nOffset = 0;
+            for (size_t i = 0; i < vIds.size(); ++i)
+            {
+                const float* pSrc = vVerts.data() + nOffset * 3;
+                mgr.addPolyline(vIds[i], std::vector<float>(pSrc, pSrc + vCounts[i] * 3), color);
+                nOffset += vCounts[i];
+            }
+            mgr.renderVisiblePrimitivesEx();
+            gl->glFinish();
+            qDebug() << "  addPolyline 逐条:" << elapsedMs(start) << "ms";
+        }
+
+        // tuple 批量添加（含拆分拷贝）
+        {
+            PolylinesVboManager mgr;
+            gl->glFinish();
+            auto start = std::chrono::high_resolution_clock::now();
+            std::vector<PolylineTuple> vTuples;
+            vTuples.reserve(vIds.size());
+            size_t nOffset = 0;
+            for (size_t i = 0; i < vIds.size(); ++i)
+            {
+                const float* pSrc = vVerts.data() + nOffset * 3;
+                vTuples.emplace_back(vIds[i], std::vector<float>(pSrc, pSrc + vCounts[i] * 3), color);
+                nOffset += vCounts[i];
+            }
+            mgr.addPolylines(vTuples);
+            mgr.renderVisiblePrimitivesEx();
+            gl->glFinish();
+            qDebug() << "  addPolylines(tuple):" << elapsedMs(start) << "ms";
+        }
+
+        // 零拷贝批量加载
+        {
+            PolylinesVboManager mgr;
+            gl->glFinish();
+            auto start = std::chrono::high_resolution_clock::now();
+            size_t nLoaded = mgr.loadPolylines(vIds.data(), vCounts.data(), vIds.size(), vVerts.data(), color);
+            mgr.renderVisiblePrimitivesEx();
+            gl->glFinish();
+            qDebug() << "  loadPolylines:" << elapsedMs(start) << "ms  加载" << nLoaded << "条";
+        }
+        qDebug() << "==================================\n";
+    }
+
+    bool VboBenchmark::checkAsyncDuplicateMerge(QOpenGLFunctions_3_3_Core* gl)
+    {
+        if (!gl)
+            return false;
+
+        // 折线 nPts 个点，x 从 fX 开始等距排列
+        auto makeLine = [](size_t nPts, float fX, float fY) {
+            std::vector<float> vVerts;
+            for (size_t i = 0; i < nPts; ++i)
+                vVerts.insert(vVerts.end(), { fX + i * 0.001f, fY, 0.0f });
+            return vVerts;
+        };
+
+        const Color color(0.9f, 0.4f, 0.1f, 1.0f);
+        const long long idDup = 1, idBig = 2, idNew = 3, idTemp = 4;
+        const std::vector<float> vDupVerts = makeLine(4, -0.5f, 0.1f);
+        const std::vector<float> vBigVerts = makeLine(200, -0.5f, 0.2f);
+        const std::vector<float> vNewVerts = makeLine(3, -0.5f, 0.3f);
+
+        qDebug() << "\n========== 异步重复 ID 合并校验 ==========";
+
+        PolylinesVboManager mgr;
+        if (!mgr.startUploadThread())
+            qDebug() << "  上传线程启动失败，退回同步加载";
+
+        // 已有块：重复 ID 的原数据 + 一条长线，使异步块整理后更小、作为合并的源块
+        mgr.addPolyline(idDup, vDupVerts, color);
+        mgr.addPolyline(idBig, vBigVerts, color);
+
+        // 异步块：重复 ID（不同坐标）、新折线、一条稍后删除的长线（删除后块变稀疏）
+        std::vector<long long> vIds = { idDup, idNew, idTemp };
+        std::vector<size_t> vCounts = { 4, 3, 5000 };
+        std::vector<float> vVerts = makeLine(4, 0.5f, -0.1f);
+        vVerts.insert(vVerts.end(), vNewVerts.begin(), vNewVerts.end());
+        std::vector<float> vTempVerts = makeLine(5000, -0.9f, -0.5f);
+        vVerts.insert(vVerts.end(), vTempVerts.begin(), vTempVerts.end());
+        mgr.loadPolylinesAsync(std::move(vIds), std::move(vCounts), std::move(vVerts), color);
+
+        auto start = std::chrono::high_resolution_clock::now();
+        while (mgr.getPendingUploadCount() > 0 && elapsedMs(start) < 5000.0)
+        {
+            mgr.renderVisiblePrimitives();
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        mgr.removePolyline(idTemp);
+
+        auto checkLine = [&mgr](long long id, const std::vector<float>& vExpect) {
+            std::vector<float> vReadBack;
+            return mgr.readBackPolyline(id, vReadBack) && vReadBack == vExpect;
+        };
+        const bool bInstalled = mgr.getPendingUploadCount() == 0;
+        const bool bBeforeMerge = checkLine(idDup, vDupVerts) && checkLine(idNew, vNewVerts);
+
+        // 预算压到最低，下一帧整理后合并稀疏块
+        mgr.setGpuMemoryLimit(1);
+        mgr.renderVisiblePrimitives();
+        gl->glFinish();
+
+        const size_t nMergeCount = mgr.getGpuMemoryStats().nMergeCount;
+        const bool bAfterMerge = checkLine(idDup, vDupVerts) && checkLine(idBig, vBigVerts) &&
+            checkLine(idNew, vNewVerts);
+        const bool bOk = bInstalled && nMergeCount > 0 && bBeforeMerge && bAfterMerge;
+
+        qDebug() << "  接入:" << (bInstalled ? "完成" : "超时") << " 合并次数:" << nMergeCount;
+        qDebug() << "  合并前:" << (bBeforeMerge ? "通过" : "失败") << " 合并后:" << (bAfterMerge ? "通过" : "失败");
+        qDebug() << "==========================================\n";
+        return bOk;
+    }
+
+    void VboBenchmark::runIdGeneratorBenchmark(size_t nIdsPerThread /*= 1'000'000*/)
+    {
+        if (nIdsPerThread == 0)
+            return;
+
+        // 各线程同时开始，返回所有线程完成的耗时；sink 防止取号被优化掉
+        auto runThreads = [](size_t nThreads, const std::function<long long(size_t)>& fnWork) {
+            std::atomic<size_t> nReady{ 0 };
+            std::atomic<bool> bGo{ false };
+            std::atomic<long long> nSink{ 0 };
+            std::vector<std::thread> vThreads;
+            vThreads.reserve(nThreads);
+            for (size_t t = 0; t < nThreads; ++t)
+            {
+                vThreads.emplace_back([&, t]() {
+                    ++nReady;
+                    while (!bGo.load(std::memory_order_acquire))
+                        std::this_thread::yield();
+                    nSink.fetch_xor(fnWork(t), std::memory_order_relaxed);
+                });
+            }
+            while (nReady.load() < nThreads)
+                std::this_thread::yield();
+
+            auto start = std::chrono::high_resolution_clock::now();
+            bGo.store(true, std::memory_order_release);
+            for (std::thread& thread : vThreads)
+                thread.join();
+            return elapsedMs(start);
+        };
+
+        PrimitiveIDGenerator idGen;
+        const size_t nBatch = 256;
+
+        qDebug() << "\n========== ID 生成器并发测试 ==========";
+        qDebug() << "每线程取号:" << nIdsPerThread << " 单位: 百万个/秒";
+        qDebug() << "线程数  reserve(1)  genID  reserve(256)  回收(取+还)";
+
+        for (size_t nThreads : { 1, 2, 4, 8, 16, 32, 64 })
+        {
+            const double dTotal = static_cast<double>(nIdsPerThread * nThreads) / 1e6;
+
+            // 每个 ID 都访问共享计数器（改造前 genID 的访问方式）
+            double dShared = runThreads(nThreads, [&](size_t) {
+                long long nLast = 0;
+                for (size_t i = 0; i < nIdsPerThread; ++i)
+                    nLast = PrimitiveIDGenerator::reserve(1).nFirst;
+                return nLast;
+            });
+
+            double dLocal = runThreads(nThreads, [&](size_t) {
+                long long nLast = 0;
+                for (size_t i = 0; i < nIdsPerThread; ++i)
+                    nLast = idGen.genID();
+                return nLast;
+            });
+
+            double dBatch = runThreads(nThreads, [&](size_t) {
+                long long nLast = 0;
+                for (size_t i = 0; i < nIdsPerThread; i += nBatch)
+                {
+                    IDRange range = PrimitiveIDGenerator::reserve(static_cast<long long>(std::min(nBatch, nIdsPerThread - i)));
+                    for (long long k = 0; k < range.nCount; ++k)
+                        nLast ^= range[k];
+                }
+                return nLast;
+            });
+
+            // 回收模式：每个线程保持 64 个存活 ID，取一个还一个
+            RecyclingIDGenerator recycler;
+            double dRecycle = runThreads(nThreads, [&](size_t) {
+                long long arrLive[64];
+                for (long long& id : arrLive)
+                    id = recycler.genID();
+                for (size_t i = 0; i < nIdsPerThread; ++i)
+                {
+                    long long& id = arrLive[i & 63];
+                    recycler.release(id);
+                    id = recycler.genID();
+                }
+                return arrLive[0];
+            });
+
+            qDebug().noquote() << QString("%1  %2  %3  %4  %5")
+                .arg(nThreads, 6)
+                .arg(dTotal / (dShared / 1000.0), 10, 'f', 1)
+                .arg(dTotal / (dLocal / 1000.0), 6, 'f', 1)
+                .arg(dTotal / (dBatch / 1000.0), 12, 'f', 1)
+                .arg(dTotal / (dRecycle / 1000.0), 10, 'f', 1);
+        }
+        qDebug() << "======================================\n";
+    }
+
+    void VboBenchmark::runColorKernelBenchmark(size_t nCount /*= 4'000'000*/)
+    {
+        if (nCount == 0)
+            return;
+
+        std::mt19937 rng(1);
+        std::uniform_real_distribution<float> dist(0.0f, 1.0f);
+        std::vector<Color> vColors;
+        vColors.reserve(nCount);
+        for (size_t i = 0; i < nCount; ++i)
+            vColors.emplace_back(dist(rng), dist(rng), dist(rng), dist(rng));
+
+        const Color highlight(1.0f, 0.8f, 0.0f, 1.0f);
+        std::vector<uint32_t> vPacked(nCount);
+
+        qDebug() << "\n========== 颜色批量运算测试 ==========";
+        qDebug() << "颜色数:" << nCount << " 指令集:" << ColorBuffer::simdName();
+
+        // 逐个 Color
+        {
+            std::vector<Color> vWork = vColors;
+            auto start = std::chrono::high_resolution_clock::now();
+            for (Color& c : vWork)
+                c = c.blend(highlight, 0.25f);
+            double dBlend = elapsedMs(start);
+
+            start = std::chrono::high_resolution_clock::now();
+            for (size_t i = 0; i < nCount; ++i)
+                vPacked[i] = vWork[i].toUInt32();
+            double dPack = elapsedMs(start);
+            qDebug() << "  Color      blend:" << dBlend << "ms  toUInt32:" << dPack << "ms";
+        }
+
+        // ColorBuffer（转换 SoA 的耗时单独统计）
+        {
+            auto start = std::chrono::high_resolution_clock::now();
+            ColorBuffer colors;
+            colors.assign(vColors.data(), nCount);
+            double dAssign = elapsedMs(start);
+
+            start = std::chrono::high_resolution_clock::now();
+            colors.blend(highlight, 0.25f);
+            double dBlend = elapsedMs(start);
+
+            start = std::chrono::high_resolution_clock::now();
+            colors.packUInt32(vPacked.data());
+            double dPack = elapsedMs(start);
+
+            start = std::chrono::high_resolution_clock::now();
+            colors.premultiply();
+            double dPremul = elapsedMs(start);
+
+            start = std::chrono::high_resolution_clock::now();
+            colors.linearToSrgb();
+            double dSrgb = elapsedMs(start);
+
+            qDebug() << "  ColorBuffer blend:" << dBlend << "ms  packUInt32:" << dPack << "ms"
+                << " premultiply:" << dPremul << "ms  linearToSrgb:" << dSrgb << "ms  (AoS->SoA" << dAssign << "ms)";
+        }
+        qDebug() << "======================================\n";
+    }
+}
@@ -0,0 +1,624 @@
+#include "FakeData/WorkloadTrace.h"
+#include "PolylinesVboManager.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <random>
+#include <thread>
+#include <tuple>
+#include <unordered_set>
+#include <QDebug>
+
+namespace GLRhi
+{
+    namespace
+    {
+        constexpr uint32_t TRACE_MAGIC = 0x54574256;    // "VBWT"
+        constexpr uint32_t TRACE_VERSION = 1;
+        constexpr size_t CHUNK_LINES = 4'096;           // 几何分片大小（决定随机数流划分，修改会改变轨迹）
+        constexpr size_t PALETTE_SIZE = 8;
+
+        /**
+         * @brief 轨迹文件头
+         */
+        struct TraceHeader
+        {
+            uint32_t nMagic{ TRACE_MAGIC };
+            uint32_t nVersion{ TRACE_VERSION };
+            uint32_t nProfile{ 0 };
+            uint32_t nWarmupFrames{ 0 };
+            uint64_t nSeed{ 0 };
+            uint32_t nFrameCount{ 0 };
+            uint32_t nReserved{ 0 };
+            uint64_t nOpCount{ 0 };
+            uint64_t nFloatCount{ 0 };
+        };
+
+        uint64_t splitMix64(uint64_t x)
+        {
+            x += 0x9E3779B97F4A7C15ull;
+            x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+            x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+            return x ^ (x >> 31);
+        }
+
+        // 标准库分布的实现因编译器而异，这里只用 mt19937_64 的原始输出，保证跨平台结果一致
+        float randFloat(std::mt19937_64& rng, float fMin, float fMax)
+        {
+            double dUnit = static_cast<double>(rng() >> 11) * (1.0 / 9007199254740992.0);
+            return fMin + static_cast<float>(dUnit) * (fMax - fMin);
+        }
+
+        size_t randIndex(std::mt19937_64& rng, size_t n)
+        {
+            return static_cast<size_t>(rng() % n);
+        }
+
+        /**
+         * @brief 生成中的存活折线
+         */
+        struct LiveLine
+        {
+            long long id{ -1 };
+            uint64_t nVertOffset{ 0 };
+            uint64_t nVertCount{ 0 };
+            size_t nColor{ 0 };
+            bool bVisible{ true };
+        };
+
+        /**
+         * @brief 轨迹构建状态
+         */
+        struct TraceBuilder
+        {
+            WorkloadTrace& trace;
+            std::mt19937_64 rng;
+            unsigned int nThreads{ 1 };
+            uint64_t nStream{ 0 };          // 几何随机数流序号，每次 genLines 递增
+            long long nNextId{ 1 };
+            uint8_t arrPalette[PALETTE_SIZE][4]{};
+
+            std::vector<LiveLine> vLive;
+
+            TraceBuilder(WorkloadTrace& t, uint64_t nSeed, unsigned int nThreadCount)
+                : trace(t), rng(splitMix64(nSeed)), nThreads(nThreadCount)
+            {
+                for (auto& color : arrPalette)
+                {
+                    for (int i = 0; i < 3; ++i)
+                        color[i] = static_cast<uint8_t>(64 + randIndex(rng, 192));
+                    color[3] = 255;
+                }
+            }
+
+            /**
+             * @brief 并行生成 nLines 条随机游走折线，追加到顶点池
+             * @param vRanges 输出每条折线的 (起始顶点, 顶点数)
+             */
+            void genLines(size_t nLines, size_t nMinPts, size_t nMaxPts,
+                std::vector<std::pair<uint64_t, uint64_t>>& vRanges)
+            {
+                vRanges.clear();
+                if (nLines == 0)
+                    return;
+
+                const uint64_t nStreamSeed = splitMix64(trace.nSeed ^ splitMix64(++nStream));
+                const size_t nChunks = (nLines + CHUNK_LINES - 1) / CHUNK_LINES;
+                std::vector<std::vector<float>> vChunkVerts(nChunks);
+                std::vector<std::vector<uint64_t>> vChunkCounts(nChunks);
+
+                std::atomic<size_t> nNextChunk{ 0 };
+                auto worker = [&]() {
+                    for (size_t c = nNextChunk++; c < nChunks; c = nNextChunk++)
+                    {
+                        std::mt19937_64 chunkRng(splitMix64(nStreamSeed + c));
+                        size_t nBegin = c * CHUNK_LINES;
+                        size_t nEnd = std::min(nBegin + CHUNK_LINES, nLines);
+                        auto& vVerts = vChunkVerts[c];
+                        auto& vCounts = vChunkCounts[c];
+                        vCounts.reserve(nEnd - nBegin);
+                        vVerts.reserve((nEnd - nBegin) * (nMinPts + nMaxPts) * 3 / 2);
+
+                        for (size_t i = nBegin; i < nEnd; ++i)
+                        {
+                            size_t nPts = nMinPts + randIndex(chunkRng, nMaxPts - nMinPts + 1);
+                            float x = randFloat(chunkRng, -0.95f, 0.95f);
+                            float y = randFloat(chunkRng, -0.95f, 0.95f);
+                            for (size_t p = 0; p < nPts; ++p)
+                            {
+                                vVerts.push_back(x);
+                                vVerts.push_back(y);
+                                vVerts.push_back(0.0f);
+                                x = std::clamp(x + randFloat(chunkRng, -0.04f, 0.04f), -0.98f, 0.98f);
+                                y = std::clamp(y + randFloat(chunkRng, -0.04f, 0.04f), -0.98f, 0.98f);
+                            }
+                            vCounts.push_back(nPts);
+                        }
+                    }
+                };
+
+                unsigned int nWorkers = static_cast<unsigned int>(std::min<size_t>(nThreads, nChunks));
+                std::vector<std::thread> vThreads;
+                for (unsigned int t = 1; t < nWorkers; ++t)
+                    vThreads.emplace_back(worker);
+                worker();
+                for (auto& th : vThreads)
+                    th.join();
+
+                // 按分片顺序拼接，结果与线程数无关
+                vRanges.reserve(nLines);
+                for (size_t c = 0; c < nChunks; ++c)
+                {
+                    uint64_t nOffset = trace.vVertPool.size() / 3;
+                    trace.vVertPool.insert(trace.vVertPool.end(), vChunkVerts[c].begin(), vChunkVerts[c].end());
+                    for (uint64_t nCount : vChunkCounts[c])
+                    {
+                        vRanges.emplace_back(nOffset, nCount);
+                        nOffset += nCount;
+                    }
+                }
+            }
+
+            void pushOp(WorkloadOp::Type eType, const LiveLine& line)
+            {
+                WorkloadOp op;
+                op.eType = eType;
+                op.bVisible = line.bVisible ? 1 : 0;
+                std::copy(arrPalette[line.nColor], arrPalette[line.nColor] + 4, op.arrColor);
+                op.id = line.id;
+                op.nVertOffset = line.nVertOffset;
+                op.nVertCount = line.nVertCount;
+                trace.vOps.push_back(op);
+            }
+
+            void endFrame()
+            {
+                WorkloadOp op;
+                op.eType = WorkloadOp::EndFrame;
+                trace.vOps.push_back(op);
+                ++trace.nFrameCount;
+            }
+
+            void addLines(size_t nLines, size_t nMinPts = 2, size_t nMaxPts = 8)
+            {
+                std::vector<std::pair<uint64_t, uint64_t>> vRanges;
+                genLines(nLines, nMinPts, nMaxPts, vRanges);
+                for (const auto& [nOffset, nCount] : vRanges)
+                {
+                    LiveLine line;
+                    line.id = nNextId++;
+                    line.nVertOffset = nOffset;
+                    line.nVertCount = nCount;
+                    line.nColor = randIndex(rng, PALETTE_SIZE);
+                    vLive.push_back(line);
+                    pushOp(WorkloadOp::Add, line);
+                }
+            }
+
+            void removeAt(size_t nIdx)
+            {
+                pushOp(WorkloadOp::Remove, vLive[nIdx]);
+                vLive[nIdx] = vLive.back();
+                vLive.pop_back();
+            }
+
+            void removeRandom(size_t nCount)
+            {
+                for (size_t i = 0; i < nCount && !vLive.empty(); ++i)
+                    removeAt(randIndex(rng, vLive.size()));
+            }
+
+            /**
+             * @brief 随机选取不重复的存活折线下标
+             */
+            std::vector<size_t> pickDistinct(size_t nCount)
+            {
+                std::vector<size_t> vPicked;
+                std::unordered_set<size_t> picked;
+                nCount = std::min(nCount, vLive.size());
+                while (vPicked.size() < nCount)
+                {
+                    size_t nIdx = randIndex(rng, vLive.size());
+                    if (picked.insert(nIdx).second)
+                        vPicked.push_back(nIdx);
+                }
+                return vPicked;
+            }
+        };
+
+        void genEditStorm(TraceBuilder& builder, size_t nLineCount)
+        {
+            const size_t nUpdate = std::max<size_t>(1, nLineCount / 100);
+            const size_t nChurn = std::max<size_t>(1, nLineCount / 500);
+            std::vector<std::pair<uint64_t, uint64_t>> vRanges;
+            for (int f = 0; f < 120; ++f)
+            {
+                // 点数范围与初始数据不同，更新时大多需要重新分配槽位
+                std::vector<size_t> vPicked = builder.pickDistinct(nUpdate);
+                builder.genLines(vPicked.size(), 2, 16, vRanges);
+                for (size_t i = 0; i < vPicked.size(); ++i)
+                {
+                    LiveLine& line = builder.vLive[vPicked[i]];
+                    line.nVertOffset = vRanges[i].first;
+                    line.nVertCount = vRanges[i].second;
+                    builder.pushOp(WorkloadOp::Update, line);
+                }
+                builder.removeRandom(nChurn);
+                builder.addLines(nChurn);
+                builder.endFrame();
+            }
+        }
+
+        void genMassDelete(TraceBuilder& builder)
+        {
+            for (int f = 0; f < 10; ++f)
+            {
+                builder.removeRandom(builder.vLive.size() / 10);
+                builder.endFrame();
+            }
+            for (int f = 0; f < 20; ++f)
+                builder.endFrame();
+        }
+
+        void genColorChurn(TraceBuilder& builder, size_t nLineCount)
+        {
+            const size_t nChurn = std::max<size_t>(1, nLineCount / 100);
+            for (int f = 0; f < 60; ++f)
+            {
+                std::vector<size_t> vPicked = builder.pickDistinct(nChurn);
+                for (size_t nIdx : vPicked)
+                    builder.pushOp(WorkloadOp::Remove, builder.vLive[nIdx]);
+                for (size_t nIdx : vPicked)
+                {
+                    LiveLine& line = builder.vLive[nIdx];
+                    line.nColor = (line.nColor + 1 + randIndex(builder.rng, PALETTE_SIZE - 1)) % PALETTE_SIZE;
+                    builder.pushOp(WorkloadOp::Add, line);
+                }
+                builder.endFrame();
+            }
+        }
+
+        void genZoomPan(TraceBuilder& builder)
+        {
+            const std::vector<float>& vPool = builder.trace.vVertPool;
+            std::vector<std::array<float, 4>> vBounds(builder.vLive.size());
+            for (size_t i = 0; i < builder.vLive.size(); ++i)
+            {
+                const LiveLine& line = builder.vLive[i];
+                const float* p = vPool.data() + line.nVertOffset * 3;
+                std::array<float, 4> box{ p[0], p[1], p[0], p[1] };
+                for (uint64_t v = 1; v < line.nVertCount; ++v)
+                {
+                    box[0] = std::min(box[0], p[v * 3]);
+                    box[1] = std::min(box[1], p[v * 3 + 1]);
+                    box[2] = std::max(box[2], p[v * 3]);
+                    box[3] = std::max(box[3], p[v * 3 + 1]);
+                }
+                vBounds[i] = box;
+            }
+
+            // 前 60 帧从全图缩放到 1/8，后 60 帧保持缩放沿圆周平移
+            for (int f = 0; f < 120; ++f)
+            {
+                float fHalf = 1.0f, fCx = 0.0f, fCy = 0.0f;
+                if (f < 60)
+                {
+                    fHalf = std::pow(0.125f, f / 59.0f);
+                }
+                else
+                {
+                    float t = (f - 60) / 60.0f * 6.2831853f;
+                    fHalf = 0.125f;
+                    fCx = 0.6f * std::sin(t);
+                    fCy = 0.6f * (1.0f - std::cos(t)) * 0.5f;
+                }
+
+                for (size_t i = 0; i < builder.vLive.size(); ++i)
+                {
+                    const auto& box = vBounds[i];
+                    bool bInView = box[2] >= fCx - fHalf && box[0] <= fCx + fHalf
+                        && box[3] >= fCy - fHalf && box[1] <= fCy + fHalf;
+                    LiveLine& line = builder.vLive[i];
+                    if (line.bVisible != bInView)
+                    {
+                        line.bVisible = bInView;
+                        builder.pushOp(WorkloadOp::SetVisible, line);
+                    }
+                }
+                builder.endFrame();
+            }
+        }
+
+        double elapsedMs(std::chrono::high_resolution_clock::time_point start)
+        {
+            auto end = std::chrono::high_resolution_clock::now();
+            return std::chrono::duration<double, std::milli>(end - start).count();
+        }
+
+        // 最近秩法分位数，vSorted 需已升序
+        double percentile(const std::vector<double>& vSorted, double dP)
+        {
+            if (vSorted.empty())
+                return 0.0;
+            size_t nRank = static_cast<size_t>(std::ceil(dP * vSorted.size()));
+            return vSorted[std::clamp<size_t>(nRank, 1, vSorted.size()) - 1];
+        }
+    }
+
+    const char* workloadProfileName(WorkloadProfile eProfile)
+    {
+        switch (eProfile)
+        {
+        case WorkloadProfile::BulkLoad:   return "BulkLoad";
+        case WorkloadProfile::EditStorm:  return "EditStorm";
+        case WorkloadProfile::MassDelete: return "MassDelete";
+        case WorkloadProfile::ColorChurn: return "ColorChurn";
+        case WorkloadProfile::ZoomPan:    return "ZoomPan";
+        }
+        return "Unknown";
+    }
+
+    const char* replayPathName(ReplayPath ePath)
+    {
+        switch (ePath)
+        {
+        case ReplayPath::Draw:      return "Draw";
+        case ReplayPath::MultiDraw: return "MultiDraw";
+        case ReplayPath::Deferred:  return "Deferred";
+        }
+        return "Unknown";
+    }
+
+    bool WorkloadTrace::save(const std::string& strPath) const
+    {
+        std::ofstream out(strPath, std::ios::binary | std::ios::trunc);
+        if (!out)
+            return false;
+
+        TraceHeader header;
+        header.nProfile = static_cast<uint32_t>(eProfile);
+        header.nWarmupFrames = nWarmupFrames;
+        header.nSeed = nSeed;
+        header.nFrameCount = nFrameCount;
+        header.nOpCount = vOps.size();
+        header.nFloatCount = vVertPool.size();
+
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(vOps.data()), vOps.size() * sizeof(WorkloadOp));
+        out.write(reinterpret_cast<const char*>(vVertPool.data()), vVertPool.size() * sizeof(float));
+        return static_cast<bool>(out);
+    }
+
+    bool WorkloadTrace::load(const std::string& strPath)
+    {
+        std::ifstream in(strPath, std::ios::binary);
+        if (!in)
+            return false;
+
+        TraceHeader header;
+        if (!in.read(reinterpret_cast<char*>(&header), sizeof(header))
+            || header.nMagic != TRACE_MAGIC || header.nVersion != TRACE_VERSION)
+            return false;
+
+        std::vector<WorkloadOp> vNewOps(header.nOpCount);
+        std::vector<float> vNewPool(header.nFloatCount);
+        if (!in.read(reinterpret_cast<char*>(vNewOps.data()), vNewOps.size() * sizeof(WorkloadOp))
+            || !in.read(reinterpret_cast<char*>(vNewPool.data()), vNewPool.size() * sizeof(float)))
+            return false;
+
+        // 顶点引用越界的轨迹视为损坏
+        const uint64_t nPoolVerts = vNewPool.size() / 3;
+        for (const WorkloadOp& op : vNewOps)
+        {
+            if ((op.eType == WorkloadOp::Add || op.eType == WorkloadOp::Update)
+                && (op.nVertCount > nPoolVerts || op.nVertOffset > nPoolVerts - op.nVertCount))
+                return false;
+        }
+
+        eProfile = static_cast<WorkloadProfile>(header.nProfile);
+        nSeed = header.nSeed;
+        nWarmupFrames = header.nWarmupFrames;
+        nFrameCount = header.nFrameCount;
+        vOps = std::move(vNewOps);
+        vVertPool = std::move(vNewPool);
+        return true;
+    }
+
+    WorkloadTrace WorkloadGenerator::generate(WorkloadProfile eProfile, uint64_t nSeed,
+        size_t nLineCount /*= 100'000*/, unsigned int nThreads /*= 0*/)
+    {
+        WorkloadTrace trace;
+        trace.eProfile = eProfile;
+        trace.nSeed = nSeed;
+
+        if (nThreads == 0)
+            nThreads = std::max(1u, std::thread::hardware_concurrency());
+
+        TraceBuilder builder(trace, nSeed, nThreads);
+
+        // 第 0 帧加载初始场景；BulkLoad 测的就是这一帧，其余场景把它作为准备帧
+        builder.addLines(nLineCount);
+        builder.endFrame();
+        trace.nWarmupFrames = (eProfile == WorkloadProfile::BulkLoad) ? 0 : 1;
+
+        switch (eProfile)
+        {
+        case WorkloadProfile::BulkLoad:
+            for (int f = 0; f < 30; ++f)
+                builder.endFrame();
+            break;
+        case WorkloadProfile::EditStorm:  genEditStorm(builder, nLineCount); break;
+        case WorkloadProfile::MassDelete: genMassDelete(builder); break;
+        case WorkloadProfile::ColorChurn: genColorChurn(builder, nLineCount); break;
+        case WorkloadProfile::ZoomPan:    genZoomPan(builder); break;
+        }
+
+        return trace;
+    }
+
+    WorkloadReplayResult WorkloadReplay::replay(QOpenGLFunctions_3_3_Core* gl, const WorkloadTrace& trace,
+        ReplayPath ePath, VertexFormat eFormat /*= VertexFormat::Float3*/)
+    {
+        using PolylineTuple = std::tuple<long long, std::vector<float>, Color>;
+
+        WorkloadReplayResult result;
+        result.ePath = ePath;
+        if (!gl)
+            return result;
+
+        PolylinesVboManager mgr(eFormat);
+        mgr.setDeferredMode(ePath == ReplayPath::Deferred);
+        auto pBudget = mgr.getGpuMemoryBudget();
+
+        auto toVerts = [&trace](const WorkloadOp& op) {
+            const float* pSrc = trace.vVertPool.data() + op.nVertOffset * 3;
+            return std::vector<float>(pSrc, pSrc + op.nVertCount * 3);
+        };
+        auto toColor = [](const WorkloadOp& op) {
+            return Color(op.arrColor[0] / 255.0f, op.arrColor[1] / 255.0f,
+                op.arrColor[2] / 255.0f, op.arrColor[3] / 255.0f);
+        };
+
+        std::vector<double> vFrameMs;
+        std::vector<PolylineTuple> vAdds;
+        std::vector<long long> vRemoves;
+        std::vector<std::vector<float>> vUpdateVerts;
+
+        gl->glFinish();
+        pBudget->beginFrame();
+
+        size_t nFrame = 0;
+        size_t nOp = 0;
+        while (nOp < trace.vOps.size())
+        {
+            size_t nFrameEnd = nOp;
+            while (nFrameEnd < trace.vOps.size() && trace.vOps[nFrameEnd].eType != WorkloadOp::EndFrame)
+                ++nFrameEnd;
+
+            // 顶点拷贝属于调用方的准备工作，在计时之外完成
+            vUpdateVerts.clear();
+            for (size_t i = nOp; i < nFrameEnd; ++i)
+            {
+                if (trace.vOps[i].eType == WorkloadOp::Add || trace.vOps[i].eType == WorkloadOp::Update)
+                    vUpdateVerts.push_back(toVerts(trace.vOps[i]));
+            }
+
+            auto frameStart = std::chrono::high_resolution_clock::now();
+            size_t nVertsIdx = 0;
+            for (size_t i = nOp; i < nFrameEnd; ++i)
+            {
+                const WorkloadOp& op = trace.vOps[i];
+                switch (op.eType)
+                {
+                case WorkloadOp::Add:
+                    // 连续的添加 / 删除合并为一次批量调用
+                    vAdds.emplace_back(op.id, std::move(vUpdateVerts[nVertsIdx++]), toColor(op));
+                    if (i + 1 == nFrameEnd || trace.vOps[i + 1].eType != WorkloadOp::Add)
+                    {
+                        mgr.addPolylines(vAdds);
+                        vAdds.clear();
+                    }
+                    break;
+                case WorkloadOp::Remove:
+                    vRemoves.push_back(op.id);
+                    if (i + 1 == nFrameEnd || trace.vOps[i + 1].eType != WorkloadOp::Remove)
+                    {
+                        mgr.removePolylines(vRemoves);
+                        vRemoves.clear();
+                    }
+                    break;
+                case WorkloadOp::Update:
+                    mgr.updatePolyline(op.id, vUpdateVerts[nVertsIdx++]);
+                    break;
+                case WorkloadOp::SetVisible:
+                    mgr.setPolylineVisible(op.id, op.bVisible != 0);
+                    break;
+                default:
+                    break;
+                }
+            }
+
+            if (ePath == ReplayPath::Draw)
+                mgr.renderVisiblePrimitives();
+            else
+                mgr.renderVisiblePrimitivesEx();
+            gl->glFinish();
+            double dMs = elapsedMs(frameStart);
+
+            pBudget->beginFrame();
+            GpuMemoryStats stats = pBudget->getStats();
+            if (nFrame < trace.nWarmupFrames)
+            {
+                result.dWarmupMs += dMs;
+            }
+            else
+            {
+                vFrameMs.push_back(dMs);
+                result.nUploadBytes += stats.nUploadBytesLastFrame;
+                result.nCompacts += stats.nCompactsLastFrame;
+                result.dCompactMs += stats.dCompactMsLastFrame;
+            }
+
+            ++nFrame;
+            nOp = nFrameEnd + 1;
+        }
+
+        std::sort(vFrameMs.begin(), vFrameMs.end());
+        result.nFrames = vFrameMs.size();
+        result.dP50Ms = percentile(vFrameMs, 0.50);
+        result.dP99Ms = percentile(vFrameMs, 0.99);
+        result.dMaxMs = vFrameMs.empty() ? 0.0 : vFrameMs.back();
+        return result;
+    }
+
+    void WorkloadReplay::runAll(QOpenGLFunctions_3_3_Core* gl, uint64_t nSeed,
+        size_t nLineCount /*= 100'000*/, const std::string& strDir /*= std::string()*/)
+    {
+        if (!gl)
+            return;
+
+        const WorkloadProfile arrProfiles[] = { WorkloadProfile::BulkLoad, WorkloadProfile::EditStorm,
+            WorkloadProfile::MassDelete, WorkloadProfile::ColorChurn, WorkloadProfile::ZoomPan };
+        const ReplayPath arrPaths[] = { ReplayPath::Draw, ReplayPath::MultiDraw, ReplayPath::Deferred };
+
+        qDebug() << "\n========== 负载回放测试 ==========";
+        qDebug() << "种子:" << nSeed << " 初始折线:" << nLineCount;
+
+        for (WorkloadProfile eProfile : arrProfiles)
+        {
+            auto genStart = std::chrono::high_resolution_clock::now();
+            WorkloadTrace trace = WorkloadGenerator::generate(eProfile, nSeed, nLineCount);
+            double dGenMs = elapsedMs(genStart);
+
+            // 落盘后读回，回放的是文件中的轨迹
+            if (!strDir.empty())
+            {
+                std::string strPath = strDir + "/" + workloadProfileName(eProfile) + "_" + std::to_string(nSeed) + ".vbwt";
+                WorkloadTrace loaded;
+                if (trace.save(strPath) && loaded.load(strPath))
+                    trace = std::move(loaded);
+                else
+                    qDebug() << "  轨迹文件读写失败:" << QString::fromStdString(strPath);
+            }
+
+            qDebug() << workloadProfileName(eProfile) << " 帧:" << trace.nFrameCount
+                << " 操作:" << trace.vOps.size() << " 顶点:" << trace.vVertPool.size() / 3
+                << " 生成:" << dGenMs << "ms";
+
+            for (ReplayPath ePath : arrPaths)
+            {
+                WorkloadReplayResult r = replay(gl, trace, ePath);
+                qDebug() << "  " << replayPathName(ePath)
+                    << " 准备:" << r.dWarmupMs << "ms"
+                    << " p50:" << r.dP50Ms << "ms p99:" << r.dP99Ms << "ms max:" << r.dMaxMs << "ms"
+                    << " 上传:" << r.nUploadBytes / 1024.0 << "KB"
+                    << " 整理:" << r.nCompacts << "次" << r.dCompactMs << "ms";
+            }
+        }
+        qDebug() << "==================================\n";
+    }
+}
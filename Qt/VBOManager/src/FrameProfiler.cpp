@@ -0,0 +1,194 @@
+#include "FrameProfiler.h"
+
+#include <algorithm>
+#include <fstream>
+
+namespace GLRhi
+{
+    namespace
+    {
+        double toMs(std::chrono::steady_clock::duration duration)
+        {
+            return std::chrono::duration<double, std::milli>(duration).count();
+        }
+    }
+
+    void FrameProfiler::initGL(QOpenGLFunctions_3_3_Core* gl)
+    {
+        if (m_gl || !gl)
+            return;
+
+        m_gl = gl;
+        for (QuerySlot& slot : m_arrQueries)
+        {
+            m_gl->glGenQueries(1, &slot.query);
+            slot.bPending = false;
+        }
+    }
+
+    void FrameProfiler::releaseGL()
+    {
+        if (!m_gl)
+            return;
+
+        if (m_pActiveQuery)
+            m_gl->glEndQuery(GL_TIME_ELAPSED);
+        m_pActiveQuery = nullptr;
+
+        for (QuerySlot& slot : m_arrQueries)
+        {
+            m_gl->glDeleteQueries(1, &slot.query);
+            slot = QuerySlot();
+        }
+        m_gl = nullptr;
+    }
+
+    void FrameProfiler::beginFrame()
+    {
+        m_paintStart = std::chrono::steady_clock::now();
+        if (!m_gl || m_pActiveQuery)
+            return;
+
+        collectGpuResults();
+
+        // 轮到的槽位结果还没回来就跳过本帧，不等待
+        QuerySlot& slot = m_arrQueries[m_nFrame % QUERY_RING];
+        if (slot.bPending)
+            return;
+
+        slot.nFrame = m_nFrame;
+        m_gl->glBeginQuery(GL_TIME_ELAPSED, slot.query);
+        m_pActiveQuery = &slot;
+    }
+
+    void FrameProfiler::endFrame(size_t nUploadBytes)
+    {
+        auto now = std::chrono::steady_clock::now();
+
+        if (m_pActiveQuery)
+        {
+            m_gl->glEndQuery(GL_TIME_ELAPSED);
+            m_pActiveQuery->bPending = true;
+            m_pActiveQuery = nullptr;
+        }
+
+        FrameSample sample;
+        sample.nFrame = m_nFrame;
+        sample.dFrameMs = (m_lastEnd.time_since_epoch().count() != 0) ? toMs(now - m_lastEnd) : 0.0;
+        sample.dPaintMs = toMs(now - m_paintStart);
+        for (size_t i = 0; i < STAGE_COUNT; ++i)
+            sample.arrStageMs[i] = m_arrStageNs[i].exchange(0, std::memory_order_relaxed) / 1e6;
+        sample.nDrawCalls = m_nDrawCalls.exchange(0, std::memory_order_relaxed);
+        sample.nUploadBytes = nUploadBytes;
+
+        m_history.push_back(sample);
+        if (m_history.size() > HISTORY_FRAMES)
+            m_history.pop_front();
+
+        m_lastEnd = now;
+        ++m_nFrame;
+    }
+
+    void FrameProfiler::addStageTime(Stage eStage, std::chrono::steady_clock::duration duration)
+    {
+        m_arrStageNs[static_cast<size_t>(eStage)].fetch_add(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count(), std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief 读取已完成的查询，结果写回对应帧的历史记录
+     * 先查询 GL_QUERY_RESULT_AVAILABLE，未完成的留到下一帧，不会阻塞
+     */
+    void FrameProfiler::collectGpuResults()
+    {
+        for (QuerySlot& slot : m_arrQueries)
+        {
+            if (!slot.bPending)
+                continue;
+
+            GLint nAvailable = 0;
+            m_gl->glGetQueryObjectiv(slot.query, GL_QUERY_RESULT_AVAILABLE, &nAvailable);
+            if (!nAvailable)
+                continue;
+
+            GLuint64 nNs = 0;
+            m_gl->glGetQueryObjectui64v(slot.query, GL_QUERY_RESULT, &nNs);
+            slot.bPending = false;
+
+            if (m_history.empty() || slot.nFrame < m_history.front().nFrame || slot.nFrame > m_history.back().nFrame)
+                continue;
+            m_history[static_cast<size_t>(slot.nFrame - m_history.front().nFrame)].dGpuMs = nNs / 1e6;
+        }
+    }
+
+    FrameProfiler::FrameSample FrameProfiler::getAverage(size_t nFrames /*= HISTORY_FRAMES*/) const
+    {
+        FrameSample avg;
+        size_t nCount = std::min(nFrames, m_history.size());
+        if (nCount == 0)
+            return avg;
+
+        size_t nGpuCount = 0;
+        double dGpuSum = 0.0;
+        for (auto it = m_history.end() - nCount; it != m_history.end(); ++it)
+        {
+            avg.dFrameMs += it->dFrameMs;
+            avg.dPaintMs += it->dPaintMs;
+            for (size_t i = 0; i < STAGE_COUNT; ++i)
+                avg.arrStageMs[i] += it->arrStageMs[i];
+            avg.nDrawCalls += it->nDrawCalls;
+            avg.nUploadBytes += it->nUploadBytes;
+            if (it->dGpuMs >= 0.0)
+            {
+                dGpuSum += it->dGpuMs;
+                ++nGpuCount;
+            }
+        }
+
+        avg.nFrame = m_history.back().nFrame;
+        avg.dFrameMs /= nCount;
+        avg.dPaintMs /= nCount;
+        for (double& dMs : avg.arrStageMs)
+            dMs /= nCount;
+        avg.nDrawCalls /= nCount;
+        avg.nUploadBytes /= nCount;
+        avg.dGpuMs = nGpuCount > 0 ? dGpuSum / nGpuCount : -1.0;
+        return avg;
+    }
+
+    bool FrameProfiler::exportCsv(const std::string& strPath) const
+    {
+        std::ofstream out(strPath, std::ios::trunc);
+        if (!out)
+            return false;
+
+        out << "frame,frame_ms,paint_ms";
+        for (size_t i = 0; i < STAGE_COUNT; ++i)
+            out << ',' << stageName(static_cast<Stage>(i)) << "_ms";
+        out << ",gpu_ms,draw_calls,upload_bytes\n";
+
+        for (const FrameSample& sample : m_history)
+        {
+            out << sample.nFrame << ',' << sample.dFrameMs << ',' << sample.dPaintMs;
+            for (double dMs : sample.arrStageMs)
+                out << ',' << dMs;
+            out << ',';
+            if (sample.dGpuMs >= 0.0)
+                out << sample.dGpuMs;
+            out << ',' << sample.nDrawCalls << ',' << sample.nUploadBytes << '\n';
+        }
+        return static_cast<bool>(out);
+    }
+
+    const char* FrameProfiler::stageName(Stage eStage)
+    {
+        switch (eStage)
+        {
+        case Stage::Rebuild: return "rebuild";
+        case Stage::Compact: return "compact";
+        case Stage::Upload:  return "upload";
+        case Stage::Draw:    return "draw";
+        default:             return "unknown";
+        }
+    }
+}
@@ -1,12 +1,22 @@
 #include "GLTestWidget.h"
 #include "Color.h"
 #include "PolylinesVboManager.h"
+#include "TrianglesVboManager.h"
+#include "TexturesVboManager.h"
+#include "InstancedLinesManager.h"
+#include "FrameProfiler.h"
+#include "PrimitiveIDGenerator.h"
 #include "FakeData/FakeDataProvider.h"
 #include "FakeData/FakePolyLineData.h"
+#include "FakeData/InstanceLineFakeData.h"
+#include "FakeData/VboBenchmark.h"
+#include "FakeData/WorkloadTrace.h"
 
 #include <QRandomGenerator>
+#include <QPainter>
 #include <QDebug>
 #include <QDateTime>
+#include <QDir>
 #include <random>
 #include <chrono>
 
@@ -16,10 +26,14 @@ static const char* vertexShaderSrc = R"(
 #version 330 core
 layout(location = 0) in vec3 aPos;
 uniform mat4 uMVP;
+uniform vec2 uBlockOrigin;  // 块原点（压缩顶点格式）
+uniform float uBlockScale;  // 量化步长（Float3 块为 1）
+uniform float uBlockZ;      // 块统一 z 值
 void main()
 {
-    //gl_Position = uMVP * vec4(aPos, 1.0);
-    gl_Position = vec4(aPos, 1.0);
+    vec3 pos = vec3(uBlockOrigin + aPos.xy * uBlockScale, aPos.z + uBlockZ);
+    //gl_Position = uMVP * vec4(pos, 1.0);
+    gl_Position = vec4(pos, 1.0);
 }
 )";
 
@@ -33,6 +47,43 @@ void main()
 }
 )";
 
+static const char* triVertexShaderSrc = R"(
+#version 330 core
+layout(location = 0) in vec3 aPos;
+void main()
+{
+    gl_Position = vec4(aPos, 1.0);
+}
+)";
+
+static const char* texVertexShaderSrc = R"(
+#version 330 core
+layout(location = 0) in vec3 aPos;
+layout(location = 1) in vec3 aTexCoord;    // u, v, layer
+layout(location = 2) in float aAlpha;
+out vec3 vTexCoord;
+out float vAlpha;
+void main()
+{
+    vTexCoord = aTexCoord;
+    vAlpha = aAlpha;
+    gl_Position = vec4(aPos, 1.0);
+}
+)";
+
+static const char* texFragmentShaderSrc = R"(
+#version 330 core
+uniform sampler2DArray uTexArray;
+in vec3 vTexCoord;
+in float vAlpha;
+out vec4 FragColor;
+void main()
+{
+    vec4 c = texture(uTexArray, vTexCoord);
+    FragColor = vec4(c.rgb, c.a * vAlpha);
+}
+)";
+
 GLTestWidget::GLTestWidget(QWidget* parent)
     : QOpenGLWidget(parent)
 {
@@ -45,9 +96,22 @@ GLTestWidget::GLTestWidget(QWidget* parent)
 
 GLTestWidget::~GLTestWidget()
 {
+    if (m_editThread.joinable())
+        m_editThread.join();
+
     makeCurrent();
     delete m_program;
     delete m_linesMgr;
+    delete m_trisMgr;
+    delete m_texsMgr;
+    delete m_instLinesMgr;
+    if (m_pProfiler)
+        m_pProfiler->releaseGL();
+    delete m_pProfiler;
+    delete m_triProgram;
+    delete m_texProgram;
+    if (m_texArray)
+        glDeleteTextures(1, &m_texArray);
     doneCurrent();
 
     delete m_dataProvider;
@@ -64,7 +128,13 @@ void GLTestWidget::initializeGL()
     createShader();
 
     // 必须在有有效 OpenGL context 之后创建！
-    m_linesMgr = new GLRhi::PolylinesVboManager();
+    m_linesMgr = new GLRhi::PolylinesVboManager(m_eVertexFormat);
+
+    m_pProfiler = new GLRhi::FrameProfiler();
+    m_pProfiler->initGL(this);
+    m_linesMgr->setFrameProfiler(m_pProfiler);
+    if (!m_linesMgr->startUploadThread())
+        qWarning() << "上传线程启动失败，异步加载退回同步加载";
 
     genFakeData();
 
@@ -112,6 +182,8 @@ void GLTestWidget::paintGL()
     if (!m_program || !m_linesMgr)
         return;
 
+    m_pProfiler->beginFrame();
+
     m_program->bind();
 
     // QMatrix4x4 mvp = m_proj * m_view * m_model;
@@ -127,6 +199,39 @@ void GLTestWidget::paintGL()
 
     m_program->release();
 
+    // 上一次点击发起的异步拾取，读回完成后输出结果
+    if (m_bPickPending)
+    {
+        long long nPickId = -1;
+        if (m_linesMgr->pollPick(nPickId))
+        {
+            m_bPickPending = false;
+            qint64 nElapsedUs = QDateTime::currentMSecsSinceEpoch() * 1000 - m_nPickStartUs;
+            qDebug() << "GPU 拾取: ID" << nPickId << " 耗时(含等待帧)" << nElapsedUs / 1000.0 << "ms";
+        }
+    }
+
+    if (m_bShowPrimitives)
+        drawPrimitiveDemo();
+
+    if (m_bShowInstLines && m_instLinesMgr)
+    {
+        streamInstancedLines();
+        glEnable(GL_BLEND);
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        const qreal dRatio = devicePixelRatioF();
+        m_instLinesMgr->render(static_cast<int>(width() * dRatio), static_cast<int>(height() * dRatio));
+        glDisable(GL_BLEND);
+    }
+
+    if (m_bShowStats)
+        drawStatsOverlay();
+
+    // 上传统计与分析器使用相同的帧边界（本次 paintGL 结束到下次结束）
+    std::shared_ptr<GpuMemoryBudget> pBudget = m_linesMgr->getGpuMemoryBudget();
+    pBudget->beginFrame();
+    m_pProfiler->endFrame(pBudget->getStats().nUploadBytesLastFrame);
+
     // 帧率统计逻辑
     m_fpsFrameCount++;
     qint64 currentTime = QDateTime::currentMSecsSinceEpoch();
@@ -162,8 +267,14 @@ void GLTestWidget::keyPressEvent(QKeyEvent* event)
     {
     case Qt::Key_F1:
     {
-        qDebug() << "F1:重建所有线条数据，  F2：添加新数据 Ctrl+批量,   F3：删除部分数据 Ctrl+指，  F4:修改部分数据";
-        qDebug() << "F5：清除所有数据， F6:  隐藏/显示线段 F11: 渲染切換 高/低性能\n";
+        qDebug() << "F1:重建所有线条数据，  F2：添加新数据 Ctrl+批量 Shift+异步加载一百万条,   F3：删除部分数据 Ctrl+指，  F4:修改部分数据";
+        qDebug() << "F5：清除所有数据， F6:  隐藏/显示线段 F11: 渲染切換 高/低性能 Ctrl+切换绘制顺序(无序/深度排序/OIT)";
+        qDebug() << "F7：顶点格式精度/性能测试 Ctrl+切换顶点格式 Shift+批量加载测试 Ctrl+Shift+异步重复ID合并校验 Alt+ID生成器并发测试 Alt+Shift+颜色批量运算测试";
+        qDebug() << "F8：切换延迟/立即模式 Ctrl+延迟模式下启动编辑线程";
+        qDebug() << "F9：负载回放测试(固定种子，轨迹写入临时目录) Ctrl+换新种子 Shift+一百万条";
+        qDebug() << "F10：显示/隐藏显存与帧耗时统计 Ctrl+切换显存预算(不限/64MB/16MB/4MB) Shift+导出帧耗时CSV";
+        qDebug() << "F12：显示/隐藏三角形与纹理图元 Ctrl+重新生成 Shift+实例化宽线段";
+        qDebug() << "鼠标左键：GPU 拾取折线 Ctrl+CPU 拾取（R 树）\n";
 
         if (m_linesMgr)
         {
@@ -194,7 +305,26 @@ void GLTestWidget::keyPressEvent(QKeyEvent* event)
     {
         auto startTime = std::chrono::high_resolution_clock::now();
         makeCurrent();
-        if (event->modifiers() & Qt::ControlModifier)
+        if (event->modifiers() & Qt::ShiftModifier)
+        {
+            // 数据交给上传线程编码与上传，按键立即返回，之后某一帧接入并显示
+            const size_t nLineCount = 1'000'000;
+            FakePolyLineData lineGen;
+            lineGen.generateLines(nLineCount, 2, 8);
+
+            GLRhi::IDRange idRange = GLRhi::PrimitiveIDGenerator::reserve(static_cast<long long>(nLineCount));
+            std::vector<long long> vIds(nLineCount);
+            for (size_t i = 0; i < nLineCount; ++i)
+                vIds[i] = idRange[static_cast<long long>(i)];
+
+            auto submitStart = std::chrono::high_resolution_clock::now();
+            size_t nQueued = m_linesMgr->loadPolylinesAsync(std::move(vIds), lineGen.getLineInfos(),
+                lineGen.getVertices(), FakePolyLineData::genRandomColor());
+            auto submitMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - submitStart).count();
+            qDebug() << "\nShift+F2 - 异步加载" << nQueued << "条，提交耗时" << submitMs << "ms，待接入批数"
+                << m_linesMgr->getPendingUploadCount();
+        }
+        else if (event->modifiers() & Qt::ControlModifier)
         {
             qDebug() << "\nCtrl+F2 - addNewFakeData (批量添加)";
             addNewFakeData();
@@ -286,11 +416,102 @@ void GLTestWidget::keyPressEvent(QKeyEvent* event)
         qDebug() << "F6按键处理耗时: " << duration.count() << " ms";
     }
     break;
+    case Qt::Key_F7:
+    {
+        auto startTime = std::chrono::high_resolution_clock::now();
+        makeCurrent();
+        if ((event->modifiers() & Qt::AltModifier) && (event->modifiers() & Qt::ShiftModifier))
+        {
+            qDebug() << "\nAlt+Shift+F7 - 颜色批量运算测试";
+            VboBenchmark::runColorKernelBenchmark();
+        }
+        else if (event->modifiers() & Qt::AltModifier)
+        {
+            qDebug() << "\nAlt+F7 - ID 生成器并发测试";
+            VboBenchmark::runIdGeneratorBenchmark();
+        }
+        else if ((event->modifiers() & Qt::ControlModifier) && (event->modifiers() & Qt::ShiftModifier))
+        {
+            qDebug() << "\nCtrl+Shift+F7 - 异步重复 ID 合并校验";
+            m_program->bind();
+            bool bOk = VboBenchmark::checkAsyncDuplicateMerge(this);
+            m_program->release();
+            qDebug() << "异步重复 ID 合并校验:" << (bOk ? "通过" : "失败");
+        }
+        else if (event->modifiers() & Qt::ControlModifier)
+        {
+            // 切换顶点格式：Float3 -> Quantized16 -> HalfFloat，重建管理器后重新加载当前数据
+            switch (m_eVertexFormat)
+            {
+            case VertexFormat::Float3:      m_eVertexFormat = VertexFormat::Quantized16; break;
+            case VertexFormat::Quantized16: m_eVertexFormat = VertexFormat::HalfFloat; break;
+            default:                        m_eVertexFormat = VertexFormat::Float3; break;
+            }
+            qDebug() << "\nCtrl+F7 - 切换顶点格式:" << vertexFormatName(m_eVertexFormat);
+
+            // 编辑线程持有旧管理器的指针，释放前先等它结束
+            if (m_editThread.joinable())
+                m_editThread.join();
+
+            const bool bDeferred = m_linesMgr->isDeferredMode();
+            const GLRhi::RenderOrder eOrder = m_linesMgr->getRenderOrder();
+            delete m_linesMgr;
+            m_linesMgr = new GLRhi::PolylinesVboManager(m_eVertexFormat);
+            m_linesMgr->setFrameProfiler(m_pProfiler);
+            m_linesMgr->setGpuMemoryLimit(m_nGpuBudgetMB * 1024 * 1024);
+            m_linesMgr->setRenderOrder(eOrder);
+            m_linesMgr->startUploadThread();
+            m_linesMgr->addPolylines(m_polylineData);
+            m_linesMgr->setDeferredMode(bDeferred);
+            m_linesMgr->startBackgroundDefrag();
+        }
+        else if (event->modifiers() & Qt::ShiftModifier)
+        {
+            qDebug() << "\nShift+F7 - 批量加载测试";
+            m_program->bind();
+            VboBenchmark::runBulkLoadBenchmark(this);
+            m_program->release();
+        }
+        else
+        {
+            qDebug() << "\nF7 - 顶点格式测试";
+            m_program->bind();
+            VboBenchmark::runVertexFormatBenchmark(this, m_polylineData);
+            m_program->release();
+        }
+        update();
+
+        auto endTime = std::chrono::high_resolution_clock::now();
+        auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(endTime - startTime);
+        qDebug() << "F7按键处理耗时: " << duration.count() << " ms";
+    }
+    break;
+
     case Qt::Key_F8:
     {
         auto startTime = std::chrono::high_resolution_clock::now();
         makeCurrent();
-        qDebug() << "\nF8 - ";
+        if (event->modifiers() & Qt::ControlModifier)
+        {
+            qDebug() << "\nCtrl+F8 - startEditThread";
+            startEditThread();
+        }
+        else
+        {
+            bool bDeferred = !m_linesMgr->isDeferredMode();
+            if (!bDeferred)
+            {
+                // 切回立即模式前等待编辑线程结束，并在当前上下文中执行剩余命令
+                if (m_editThread.joinable())
+                    m_editThread.join();
+                m_linesMgr->applyPendingCommands();
+            }
+            m_linesMgr->setDeferredMode(bDeferred);
+            // 延迟模式会停止后台整理线程，切回立即模式后重新启动
+            if (!bDeferred)
+                m_linesMgr->startBackgroundDefrag();
+            qDebug() << "\nF8 - " << (bDeferred ? "切换到延迟模式" : "切换到立即模式");
+        }
         update();
 
         auto endTime = std::chrono::high_resolution_clock::now();
@@ -299,8 +520,63 @@ void GLTestWidget::keyPressEvent(QKeyEvent* event)
     }
     break;
 
+    case Qt::Key_F9:
+    {
+        auto startTime = std::chrono::high_resolution_clock::now();
+        makeCurrent();
+        if (event->modifiers() & Qt::ControlModifier)
+            ++m_nWorkloadSeed;
+
+        size_t nLineCount = (event->modifiers() & Qt::ShiftModifier) ? 1'000'000 : 100'000;
+        qDebug() << "\nF9 - 负载回放测试 种子:" << m_nWorkloadSeed;
+        m_program->bind();
+        WorkloadReplay::runAll(this, m_nWorkloadSeed, nLineCount, QDir::tempPath().toStdString());
+        m_program->release();
+        update();
+
+        auto endTime = std::chrono::high_resolution_clock::now();
+        auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(endTime - startTime);
+        qDebug() << "F9按键处理耗时: " << duration.count() << " ms";
+    }
+    break;
+
+    case Qt::Key_F10:
+    {
+        if (event->modifiers() & Qt::ControlModifier)
+        {
+            // 不限 -> 64MB -> 16MB -> 4MB -> 不限
+            m_nGpuBudgetMB = (m_nGpuBudgetMB == 0) ? 64 : m_nGpuBudgetMB / 4;
+            m_linesMgr->setGpuMemoryLimit(m_nGpuBudgetMB * 1024 * 1024);
+            qDebug() << "\nCtrl+F10 - 显存预算:" << (m_nGpuBudgetMB ? QString::number(m_nGpuBudgetMB) + " MB" : QString("不限"));
+        }
+        else if (event->modifiers() & Qt::ShiftModifier)
+        {
+            QString strPath = QDir::tempPath() + "/frame_profile.csv";
+            bool bOk = m_pProfiler->exportCsv(strPath.toStdString());
+            qDebug() << "\nShift+F10 - 导出帧耗时:" << strPath << (bOk ? "成功" : "失败");
+        }
+        else
+        {
+            m_bShowStats = !m_bShowStats;
+            qDebug() << "\nF10 - " << (m_bShowStats ? "显示显存统计" : "隐藏显存统计");
+        }
+        update();
+    }
+    break;
+
     case Qt::Key_F11:
     {
+        if (event->modifiers() & Qt::ControlModifier)
+        {
+            // 无序 -> 深度排序 -> 加权混合透明 -> 无序
+            static const char* arrNames[] = { "无序(按颜色表)", "深度排序", "加权混合透明(OIT)" };
+            int nOrder = (static_cast<int>(m_linesMgr->getRenderOrder()) + 1) % 3;
+            m_linesMgr->setRenderOrder(static_cast<GLRhi::RenderOrder>(nOrder));
+            qDebug() << "\nCtrl+F11 - 绘制顺序:" << arrNames[nOrder];
+            update();
+            break;
+        }
+
         auto startTime = std::chrono::high_resolution_clock::now();
         m_bUseDrawEx = !m_bUseDrawEx;
         if (m_bUseDrawEx)
@@ -315,12 +591,276 @@ void GLTestWidget::keyPressEvent(QKeyEvent* event)
         qDebug() << "F11按键处理耗时: " << duration.count() << " ms";
     }
     break;
+
+    case Qt::Key_F12:
+    {
+        if (event->modifiers() & Qt::ShiftModifier)
+        {
+            toggleInstancedLines();
+            update();
+            break;
+        }
+
+        makeCurrent();
+        if (!m_trisMgr)
+            initPrimitiveDemo();
+
+        if ((event->modifiers() & Qt::ControlModifier) || m_trisMgr->getPrimitiveCount() == 0)
+        {
+            m_trisMgr->clearAllPrimitives();
+            m_texsMgr->clearAllPrimitives();
+
+            std::vector<TriangleData> vTriDatas = m_dataProvider->genTriangleData();
+            std::vector<TextureData> vTexDatas = m_dataProvider->genTextureData();
+            for (auto& texData : vTexDatas)
+                texData.tex = m_texArray;
+
+            size_t nTris = m_trisMgr->addPrimitives(vTriDatas);
+            size_t nTexs = m_texsMgr->addPrimitives(vTexDatas);
+            qDebug() << "\nF12 - 三角形:" << nTris << " 纹理:" << nTexs
+                << " 块:" << m_trisMgr->getBlockCount() << "/" << m_texsMgr->getBlockCount();
+            m_bShowPrimitives = true;
+        }
+        else
+        {
+            m_bShowPrimitives = !m_bShowPrimitives;
+            qDebug() << "\nF12 - " << (m_bShowPrimitives ? "显示三角形与纹理图元" : "隐藏三角形与纹理图元");
+        }
+        doneCurrent();
+        update();
+    }
+    break;
+
     default:
         QOpenGLWidget::keyPressEvent(event);
         break;
     }
 }
 
+void GLTestWidget::mousePressEvent(QMouseEvent* event)
+{
+    if (!m_linesMgr || event->button() != Qt::LeftButton)
+    {
+        QOpenGLWidget::mousePressEvent(event);
+        return;
+    }
+
+    const qreal dRatio = devicePixelRatioF();
+    const int x = static_cast<int>(event->pos().x() * dRatio);
+    const int y = static_cast<int>(event->pos().y() * dRatio);
+    const int nTolPx = 4;
+
+    if (event->modifiers() & Qt::ControlModifier)
+    {
+        // CPU 拾取：屏幕坐标换算到 NDC（演示着色器不做变换）
+        const float fW = static_cast<float>(width() * dRatio);
+        const float fH = static_cast<float>(height() * dRatio);
+        const float fX = (x + 0.5f) / fW * 2.0f - 1.0f;
+        const float fY = 1.0f - (y + 0.5f) / fH * 2.0f;
+
+        auto startTime = std::chrono::high_resolution_clock::now();
+        makeCurrent();
+        long long nPickId = m_linesMgr->pickCpu(fX, fY, nTolPx * 2.0f / fW);
+        doneCurrent();
+        auto duration = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - startTime);
+        qDebug() << "CPU 拾取: ID" << nPickId << " 耗时" << duration.count() << "ms";
+        return;
+    }
+
+    // GPU 拾取：本次只发起，下一帧 paintGL 中取结果
+    makeCurrent();
+    glViewport(0, 0, static_cast<int>(width() * dRatio), static_cast<int>(height() * dRatio));
+    m_bPickPending = m_linesMgr->requestPick(x, y, nTolPx);
+    doneCurrent();
+    m_nPickStartUs = QDateTime::currentMSecsSinceEpoch() * 1000;
+    update();
+}
+
+void GLTestWidget::drawStatsOverlay()
+{
+    GpuMemoryStats stats = m_linesMgr->getGpuMemoryStats();
+    auto toMB = [](size_t nBytes) { return nBytes / (1024.0 * 1024.0); };
+
+    std::vector<QString> vLines;
+    vLines.push_back(QString("FPS: %1").arg(m_currentFPS, 0, 'f', 1));
+    vLines.push_back(QString("Blocks: %1  Evicted: %2").arg(stats.nBlockCount).arg(stats.nEvictedBlockCount));
+    vLines.push_back(QString("GPU: %1 / %2 MB  Budget: %3")
+        .arg(toMB(stats.nUsedBytes), 0, 'f', 1)
+        .arg(toMB(stats.nAllocatedBytes), 0, 'f', 1)
+        .arg(stats.nBudgetBytes ? QString("%1 MB").arg(toMB(stats.nBudgetBytes), 0, 'f', 0) : QString("-")));
+    vLines.push_back(QString("Fragmentation: %1%").arg(stats.dFragmentation * 100.0, 0, 'f', 1));
+    vLines.push_back(QString("Uploads/frame: %1  (%2 KB)")
+        .arg(stats.nUploadsLastFrame).arg(stats.nUploadBytesLastFrame / 1024.0, 0, 'f', 1));
+    vLines.push_back(QString("Compacts/frame: %1  (%2 ms)")
+        .arg(stats.nCompactsLastFrame).arg(stats.dCompactMsLastFrame, 0, 'f', 2));
+    vLines.push_back(QString("Shrink %1  Merge %2  Evict %3  Restore %4")
+        .arg(stats.nShrinkCount).arg(stats.nMergeCount).arg(stats.nEvictCount).arg(stats.nRestoreCount));
+
+    FrameProfiler::FrameSample avg = m_pProfiler->getAverage(60);
+    vLines.push_back(QString("Frame %1 ms  Paint %2 ms  GPU %3")
+        .arg(avg.dFrameMs, 0, 'f', 2).arg(avg.dPaintMs, 0, 'f', 2)
+        .arg(avg.dGpuMs >= 0.0 ? QString("%1 ms").arg(avg.dGpuMs, 0, 'f', 2) : QString("-")));
+    vLines.push_back(QString("Rebuild %1  Compact %2  Upload %3  Draw %4 ms")
+        .arg(avg.arrStageMs[0], 0, 'f', 2).arg(avg.arrStageMs[1], 0, 'f', 2)
+        .arg(avg.arrStageMs[2], 0, 'f', 2).arg(avg.arrStageMs[3], 0, 'f', 2));
+    vLines.push_back(QString("Draw calls/frame: %1").arg(avg.nDrawCalls));
+
+    // 最近若干帧的分阶段 CPU 耗时堆叠柱状图，白点为 GPU 耗时，满高 33.3ms
+    const QColor arrStageColors[FrameProfiler::STAGE_COUNT] = {
+        QColor(80, 160, 255), QColor(255, 170, 60), QColor(120, 220, 120), QColor(230, 90, 90) };
+    const int nLineH = 18;
+    const int nTextH = nLineH * static_cast<int>(vLines.size()) + 10;
+    const int nHistH = 80;
+    const double dFullMs = 33.3;
+
+    QPainter painter(this);
+    painter.fillRect(QRect(8, 8, 340, nTextH + nHistH + 10), QColor(0, 0, 0, 160));
+    painter.setPen(QColor(Qt::white));
+    for (size_t i = 0; i < vLines.size(); ++i)
+        painter.drawText(16, 8 + nLineH * static_cast<int>(i + 1), vLines[i]);
+
+    const int nBaseY = 8 + nTextH + nHistH;
+    painter.setPen(QColor(255, 255, 255, 60));
+    painter.drawLine(16, nBaseY - nHistH / 2, 16 + static_cast<int>(FrameProfiler::HISTORY_FRAMES), nBaseY - nHistH / 2);
+
+    const auto& history = m_pProfiler->getHistory();
+    int nX = 16 + static_cast<int>(FrameProfiler::HISTORY_FRAMES - history.size());
+    for (const FrameProfiler::FrameSample& sample : history)
+    {
+        int nY = nBaseY;
+        for (size_t s = 0; s < FrameProfiler::STAGE_COUNT; ++s)
+        {
+            int nH = static_cast<int>(std::min(sample.arrStageMs[s] / dFullMs, 1.0) * nHistH);
+            if (nH <= 0)
+                continue;
+            painter.fillRect(QRect(nX, nY - nH, 1, nH), arrStageColors[s]);
+            nY -= nH;
+        }
+        if (sample.dGpuMs >= 0.0)
+            painter.fillRect(QRect(nX, nBaseY - static_cast<int>(std::min(sample.dGpuMs / dFullMs, 1.0) * nHistH), 1, 1), QColor(Qt::white));
+        ++nX;
+    }
+    painter.end();
+
+    // QPainter 会改动 GL 状态，恢复本窗口依赖的部分
+    glEnable(GL_DEPTH_TEST);
+    glLineWidth(2.0f);
+}
+
+void GLTestWidget::initPrimitiveDemo()
+{
+    m_triProgram = new QOpenGLShaderProgram(this);
+    m_triProgram->addShaderFromSourceCode(QOpenGLShader::Vertex, triVertexShaderSrc);
+    m_triProgram->addShaderFromSourceCode(QOpenGLShader::Fragment, fragmentShaderSrc);
+    m_triProgram->link();
+
+    m_texProgram = new QOpenGLShaderProgram(this);
+    m_texProgram->addShaderFromSourceCode(QOpenGLShader::Vertex, texVertexShaderSrc);
+    m_texProgram->addShaderFromSourceCode(QOpenGLShader::Fragment, texFragmentShaderSrc);
+    m_texProgram->link();
+
+    if (!m_triProgram->isLinked() || !m_texProgram->isLinked())
+        qCritical() << "Shader link failed:" << m_triProgram->log() << m_texProgram->log();
+
+    // 4 层 64x64 棋盘格，每层颜色不同
+    const int nSize = 64;
+    const int nLayers = 4;
+    const unsigned char arrLayerColors[nLayers][3] = { { 230, 80, 80 }, { 80, 200, 90 }, { 80, 120, 230 }, { 230, 200, 70 } };
+    std::vector<unsigned char> vPixels(static_cast<size_t>(nSize) * nSize * nLayers * 4);
+    size_t nOffset = 0;
+    for (int l = 0; l < nLayers; ++l)
+    {
+        for (int y = 0; y < nSize; ++y)
+        {
+            for (int x = 0; x < nSize; ++x)
+            {
+                bool bDark = ((x / 8) + (y / 8)) % 2 == 0;
+                for (int c = 0; c < 3; ++c)
+                    vPixels[nOffset++] = bDark ? arrLayerColors[l][c] / 2 : arrLayerColors[l][c];
+                vPixels[nOffset++] = 255;
+            }
+        }
+    }
+
+    glGenTextures(1, &m_texArray);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, m_texArray);
+    glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA8, nSize, nSize, nLayers, 0, GL_RGBA, GL_UNSIGNED_BYTE, vPixels.data());
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+    // 与折线共用同一个显存预算，统计面板显示三者的总和
+    m_trisMgr = new TrianglesVboManager();
+    m_texsMgr = new TexturesVboManager();
+    m_trisMgr->setGpuMemoryBudget(m_linesMgr->getGpuMemoryBudget());
+    m_texsMgr->setGpuMemoryBudget(m_linesMgr->getGpuMemoryBudget());
+}
+
+void GLTestWidget::drawPrimitiveDemo()
+{
+    if (!m_trisMgr || !m_texsMgr)
+        return;
+
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    m_triProgram->bind();
+    m_trisMgr->renderVisiblePrimitives();
+    m_triProgram->release();
+
+    m_texProgram->bind();
+    m_texsMgr->renderVisiblePrimitives();
+    m_texProgram->release();
+
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+    glDisable(GL_BLEND);
+}
+
+void GLTestWidget::toggleInstancedLines()
+{
+    if (m_instLinesMgr)
+    {
+        m_bShowInstLines = !m_bShowInstLines;
+        qDebug() << "\nShift+F12 - " << (m_bShowInstLines ? "显示实例化宽线段" : "隐藏实例化宽线段");
+        return;
+    }
+
+    makeCurrent();
+    m_instLinesMgr = new InstancedLinesManager();
+    m_instLinesMgr->setGpuMemoryBudget(m_linesMgr->getGpuMemoryBudget());
+
+    // 宽度单位为像素
+    InstanceLineFakeData lineGen;
+    lineGen.genLines(10'000, 1.0f, 6.0f);
+    std::vector<InstanceLineData>& vLines = lineGen.getInstanceData();
+
+    m_vInstLineIds.resize(vLines.size());
+    for (size_t i = 0; i < m_vInstLineIds.size(); ++i)
+        m_vInstLineIds[i] = static_cast<long long>(i + 1);
+
+    size_t nAdded = m_instLinesMgr->addLines(m_vInstLineIds, vLines);
+    doneCurrent();
+
+    m_bShowInstLines = true;
+    qDebug() << "\nShift+F12 - 实例化宽线段:" << nAdded;
+}
+
+void GLTestWidget::streamInstancedLines()
+{
+    if (m_vInstLineIds.empty())
+        return;
+
+    // 每帧随机替换 64 条，模拟流式更新
+    InstanceLineFakeData lineGen;
+    lineGen.genLines(64, 1.0f, 6.0f);
+    const std::vector<InstanceLineData>& vLines = lineGen.getInstanceData();
+    for (const auto& line : vLines)
+    {
+        size_t nIdx = static_cast<size_t>(QRandomGenerator::global()->bounded(static_cast<int>(m_vInstLineIds.size())));
+        m_instLinesMgr->updateLine(m_vInstLineIds[nIdx], line);
+    }
+}
+
 // ============================== 测试数据 ==============================
 
 void GLTestWidget::genFakeData(bool bLarge /*=false*/)
@@ -674,3 +1214,64 @@ void GLTestWidget::showHideLines(bool bAll /*=false*/)
     if (!vDoIds.empty() && vDoIds.size() < 10)
         qDebug() << "显示/隐藏的图元数: " << vDoIds.size() << "IDs: " << vDoIds;
 }
+
+void GLTestWidget::startEditThread()
+{
+    if (!m_linesMgr || !m_linesMgr->isDeferredMode())
+    {
+        qDebug() << "请先按 F8 切换到延迟模式";
+        return;
+    }
+
+    if (m_editThread.joinable())
+        m_editThread.join();
+
+    std::vector<long long> vIds;
+    for (const auto& plData : m_polylineData)
+        vIds.insert(vIds.end(), plData.vId.begin(), plData.vId.end());
+
+    if (vIds.empty())
+        return;
+
+    // 工作线程不持有 GL 上下文，所有修改进入命令队列，由 paintGL 统一执行
+    GLRhi::PolylinesVboManager* pMgr = m_linesMgr;
+    m_editThread = std::thread([pMgr, vIds]() {
+        std::mt19937 rng(std::random_device{}());
+        std::uniform_int_distribution<size_t> pick(0, vIds.size() - 1);
+        std::uniform_int_distribution<int> op(0, 9);
+        std::uniform_real_distribution<float> coord(-0.9f, 0.9f);
+        std::uniform_real_distribution<float> step(-0.05f, 0.05f);
+
+        const int nRounds = 100;
+        const int nEditsPerRound = 200;
+        size_t nCmds = 0;
+        for (int r = 0; r < nRounds; ++r)
+        {
+            for (int i = 0; i < nEditsPerRound; ++i)
+            {
+                long long id = vIds[pick(rng)];
+                int nOp = op(rng);
+                if (nOp < 7)
+                {
+                    // FakeDataBase 的随机数发生器是共享静态成员，工作线程自行生成折线
+                    std::vector<float> vVerts;
+                    float x = coord(rng), y = coord(rng);
+                    for (int p = 0; p < 2 + nOp * 3; ++p)
+                    {
+                        vVerts.insert(vVerts.end(), { x, y, 0.0f });
+                        x += step(rng);
+                        y += step(rng);
+                    }
+                    pMgr->updatePolyline(id, vVerts);
+                }
+                else
+                {
+                    pMgr->setPolylineVisible(id, nOp != 7);
+                }
+                ++nCmds;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        qDebug() << "编辑线程结束，提交命令数:" << nCmds << "队列剩余:" << pMgr->getPendingCommandCount();
+    });
+}
@@ -0,0 +1,121 @@
+#include "GpuMemoryBudget.h"
+
+namespace GLRhi
+{
+    void GpuMemoryBudget::setBudget(size_t nBytes)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_nBudgetBytes = nBytes;
+    }
+
+    size_t GpuMemoryBudget::getBudget() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_nBudgetBytes;
+    }
+
+    void GpuMemoryBudget::updateBlock(const void* pBlock, size_t nAllocated, size_t nUsed, bool bEvicted)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        BlockUsage& usage = m_blocks[pBlock];
+
+        m_nAllocatedBytes = m_nAllocatedBytes - usage.nAllocated + nAllocated;
+        m_nUsedBytes = m_nUsedBytes - usage.nUsed + nUsed;
+        if (usage.bEvicted != bEvicted)
+            m_nEvictedCount = bEvicted ? m_nEvictedCount + 1 : m_nEvictedCount - 1;
+
+        usage.nAllocated = nAllocated;
+        usage.nUsed = nUsed;
+        usage.bEvicted = bEvicted;
+    }
+
+    void GpuMemoryBudget::removeBlock(const void* pBlock)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_blocks.find(pBlock);
+        if (it == m_blocks.end())
+            return;
+
+        m_nAllocatedBytes -= it->second.nAllocated;
+        m_nUsedBytes -= it->second.nUsed;
+        if (it->second.bEvicted)
+            --m_nEvictedCount;
+        m_blocks.erase(it);
+    }
+
+    size_t GpuMemoryBudget::getAllocatedBytes() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_nAllocatedBytes;
+    }
+
+    size_t GpuMemoryBudget::getOverBudgetBytes() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_nBudgetBytes == 0 || m_nAllocatedBytes <= m_nBudgetBytes)
+            return 0;
+        return m_nAllocatedBytes - m_nBudgetBytes;
+    }
+
+    void GpuMemoryBudget::recordUpload(size_t nBytes)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ++m_nUploads;
+        m_nUploadBytes += nBytes;
+    }
+
+    void GpuMemoryBudget::recordCompact(double dMs)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ++m_nCompacts;
+        m_dCompactMs += dMs;
+    }
+
+    void GpuMemoryBudget::recordEvent(Event eEvent)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        switch (eEvent)
+        {
+        case Event::Shrink:  ++m_nShrinkCount; break;
+        case Event::Merge:   ++m_nMergeCount; break;
+        case Event::Evict:   ++m_nEvictCount; break;
+        case Event::Restore: ++m_nRestoreCount; break;
+        }
+    }
+
+    void GpuMemoryBudget::beginFrame()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_nLastUploads = m_nUploads;
+        m_nLastUploadBytes = m_nUploadBytes;
+        m_nUploads = 0;
+        m_nUploadBytes = 0;
+        m_nLastCompacts = m_nCompacts;
+        m_dLastCompactMs = m_dCompactMs;
+        m_nCompacts = 0;
+        m_dCompactMs = 0.0;
+    }
+
+    GpuMemoryStats GpuMemoryBudget::getStats() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        GpuMemoryStats stats;
+        stats.nBlockCount = m_blocks.size();
+        stats.nEvictedBlockCount = m_nEvictedCount;
+        stats.nAllocatedBytes = m_nAllocatedBytes;
+        stats.nUsedBytes = m_nUsedBytes;
+        stats.nBudgetBytes = m_nBudgetBytes;
+        stats.dFragmentation = m_nAllocatedBytes > 0
+            ? 1.0 - double(m_nUsedBytes) / double(m_nAllocatedBytes)
+            : 0.0;
+        stats.nUploadsLastFrame = m_nLastUploads;
+        stats.nUploadBytesLastFrame = m_nLastUploadBytes;
+        stats.nCompactsLastFrame = m_nLastCompacts;
+        stats.dCompactMsLastFrame = m_dLastCompactMs;
+        stats.nShrinkCount = m_nShrinkCount;
+        stats.nMergeCount = m_nMergeCount;
+        stats.nEvictCount = m_nEvictCount;
+        stats.nRestoreCount = m_nRestoreCount;
+        return stats;
+    }
+}
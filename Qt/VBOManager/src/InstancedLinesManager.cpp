@@ -0,0 +1,347 @@
+#include "InstancedLinesManager.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <QOpenGLContext>
+#include <QDebug>
+
+namespace GLRhi
+{
+    static const char* instLineVertexShaderSrc = R"(
+#version 330 core
+layout(location = 0) in vec2 aQuad;     // x: 0 起点 / 1 终点, y: -1 / +1 两侧
+layout(location = 1) in vec3 aPos1;
+layout(location = 2) in vec3 aPos2;
+layout(location = 3) in vec4 aColor;
+layout(location = 4) in float aWidth;   // 像素宽度
+layout(location = 5) in float aDepth;
+uniform vec2 uViewport;                 // 视口尺寸（像素）
+uniform float uFeather;                 // 抗锯齿过渡宽度（像素）
+out vec4 vColor;
+out float vDist;                        // 到中心线的有符号距离（像素）
+out float vHalfWidth;
+void main()
+{
+    vec2 halfVp = 0.5 * uViewport;
+    vec2 s1 = aPos1.xy * halfVp;
+    vec2 s2 = aPos2.xy * halfVp;
+    vec2 dir = s2 - s1;
+    float len = length(dir);
+    dir = len > 1e-4 ? dir / len : vec2(1.0, 0.0);
+    vec2 nrm = vec2(-dir.y, dir.x);
+
+    float halfW = 0.5 * max(aWidth, 1.0);
+    float extent = halfW + uFeather;
+    vec2 s = mix(s1, s2, aQuad.x) + dir * (aQuad.x * 2.0 - 1.0) * uFeather + nrm * aQuad.y * extent;
+
+    vColor = aColor;
+    vDist = aQuad.y * extent;
+    vHalfWidth = halfW;
+    gl_Position = vec4(s / halfVp, mix(aPos1.z, aPos2.z, aQuad.x) + aDepth, 1.0);
+}
+)";
+
+    static const char* instLineFragmentShaderSrc = R"(
+#version 330 core
+uniform float uFeather;
+in vec4 vColor;
+in float vDist;
+in float vHalfWidth;
+out vec4 FragColor;
+void main()
+{
+    float coverage = clamp((vHalfWidth - abs(vDist)) / max(uFeather, 1e-4) + 0.5, 0.0, 1.0);
+    if (coverage <= 0.0)
+        discard;
+    FragColor = vec4(vColor.rgb, vColor.a * coverage);
+}
+)";
+
+    InstancedLinesManager::InstancedLinesManager()
+        : m_pGpuBudget(std::make_shared<GpuMemoryBudget>())
+    {
+        if (QOpenGLContext::currentContext())
+        {
+            m_gl = QOpenGLContext::currentContext()->versionFunctions<QOpenGLFunctions_3_3_Core>();
+            if (!m_gl)
+                qFatal("Failed to get OpenGL 3.3 Core functions");
+            initGLResources();
+        }
+    }
+
+    InstancedLinesManager::~InstancedLinesManager()
+    {
+        if (m_gl)
+        {
+            m_gl->glDeleteVertexArrays(1, &m_vao);
+            m_gl->glDeleteBuffers(1, &m_quadVbo);
+            m_gl->glDeleteBuffers(1, &m_instanceVbo);
+        }
+        m_pGpuBudget->removeBlock(this);
+    }
+
+    bool InstancedLinesManager::initGLResources()
+    {
+        m_pProgram = std::make_unique<QOpenGLShaderProgram>();
+        m_pProgram->addShaderFromSourceCode(QOpenGLShader::Vertex, instLineVertexShaderSrc);
+        m_pProgram->addShaderFromSourceCode(QOpenGLShader::Fragment, instLineFragmentShaderSrc);
+        if (!m_pProgram->link())
+        {
+            qCritical() << "InstancedLinesManager: shader link failed:" << m_pProgram->log();
+            return false;
+        }
+        m_nViewportLoc = m_pProgram->uniformLocation("uViewport");
+        m_nFeatherLoc = m_pProgram->uniformLocation("uFeather");
+
+        // 三角形带：(0,-1) (0,1) (1,-1) (1,1)
+        const float arrQuad[] = { 0.0f, -1.0f, 0.0f, 1.0f, 1.0f, -1.0f, 1.0f, 1.0f };
+
+        m_gl->glGenVertexArrays(1, &m_vao);
+        m_gl->glGenBuffers(1, &m_quadVbo);
+        m_gl->glGenBuffers(1, &m_instanceVbo);
+
+        m_gl->glBindVertexArray(m_vao);
+
+        m_gl->glBindBuffer(GL_ARRAY_BUFFER, m_quadVbo);
+        m_gl->glBufferData(GL_ARRAY_BUFFER, sizeof(arrQuad), arrQuad, GL_STATIC_DRAW);
+        m_gl->glEnableVertexAttribArray(0);
+        m_gl->glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), nullptr);
+
+        m_nCapacity = INIT_CAPACITY;
+        m_gl->glBindBuffer(GL_ARRAY_BUFFER, m_instanceVbo);
+        m_gl->glBufferData(GL_ARRAY_BUFFER,
+            static_cast<GLsizeiptr>(m_nCapacity * sizeof(InstanceLineData)), nullptr, GL_DYNAMIC_DRAW);
+
+        struct Attr { GLuint nLoc; GLint nSize; size_t nOffset; };
+        const Attr arrAttrs[] = {
+            { 1, 3, offsetof(InstanceLineData, pos1) },
+            { 2, 3, offsetof(InstanceLineData, pos2) },
+            { 3, 4, offsetof(InstanceLineData, color) },
+            { 4, 1, offsetof(InstanceLineData, width) },
+            { 5, 1, offsetof(InstanceLineData, depth) } };
+        for (const Attr& attr : arrAttrs)
+        {
+            m_gl->glEnableVertexAttribArray(attr.nLoc);
+            m_gl->glVertexAttribPointer(attr.nLoc, attr.nSize, GL_FLOAT, GL_FALSE,
+                sizeof(InstanceLineData), reinterpret_cast<const void*>(attr.nOffset));
+            m_gl->glVertexAttribDivisor(attr.nLoc, 1);
+        }
+
+        m_gl->glBindVertexArray(0);
+        m_gl->glBindBuffer(GL_ARRAY_BUFFER, 0);
+        trackBuffer();
+        return true;
+    }
+
+    bool InstancedLinesManager::addLine(long long id, const InstanceLineData& line)
+    {
+        return addLines({ id }, { line }) == 1;
+    }
+
+    size_t InstancedLinesManager::addLines(const std::vector<long long>& vIds, const std::vector<InstanceLineData>& vLines)
+    {
+        if (vIds.size() != vLines.size())
+            return 0;
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ensureCapacity(m_vInstances.size() + vIds.size());
+
+        size_t nAdded = 0;
+        for (size_t i = 0; i < vIds.size(); ++i)
+        {
+            size_t nSlot = m_vInstances.size();
+            if (!m_idToSlot.emplace(vIds[i], nSlot).second)
+                continue;
+
+            m_vInstances.push_back(vLines[i]);
+            m_vSlotIds.push_back(vIds[i]);
+            m_vDirtyFlags.push_back(false);
+            markDirty(nSlot);
+            ++nAdded;
+        }
+        return nAdded;
+    }
+
+    bool InstancedLinesManager::updateLine(long long id, const InstanceLineData& line)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_idToSlot.find(id);
+        if (it == m_idToSlot.end())
+            return false;
+
+        m_vInstances[it->second] = line;
+        markDirty(it->second);
+        return true;
+    }
+
+    bool InstancedLinesManager::removeLine(long long id)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_idToSlot.find(id);
+        if (it == m_idToSlot.end())
+            return false;
+
+        size_t nSlot = it->second;
+        size_t nLast = m_vInstances.size() - 1;
+        m_idToSlot.erase(it);
+
+        if (nSlot != nLast)
+        {
+            m_vInstances[nSlot] = m_vInstances[nLast];
+            m_vSlotIds[nSlot] = m_vSlotIds[nLast];
+            m_idToSlot[m_vSlotIds[nSlot]] = nSlot;
+            markDirty(nSlot);
+        }
+
+        // 末尾槽位即使已在待上传列表中，flushDirty 也会按实例数过滤
+        m_vInstances.pop_back();
+        m_vSlotIds.pop_back();
+        m_vDirtyFlags.pop_back();
+        return true;
+    }
+
+    void InstancedLinesManager::clearAllLines()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_vInstances.clear();
+        m_vSlotIds.clear();
+        m_idToSlot.clear();
+        m_vDirtySlots.clear();
+        m_vDirtyFlags.clear();
+        m_bFullUpload = false;
+    }
+
+    size_t InstancedLinesManager::getLineCount() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_vInstances.size();
+    }
+
+    void InstancedLinesManager::render(int nViewportW, int nViewportH)
+    {
+        if (!m_gl || !m_pProgram)
+            return;
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        flushDirty();
+        if (m_vInstances.empty())
+            return;
+
+        m_pProgram->bind();
+        m_gl->glUniform2f(m_nViewportLoc, static_cast<float>(std::max(nViewportW, 1)), static_cast<float>(std::max(nViewportH, 1)));
+        m_gl->glUniform1f(m_nFeatherLoc, 1.0f);
+
+        m_gl->glBindVertexArray(m_vao);
+        m_gl->glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, static_cast<GLsizei>(m_vInstances.size()));
+        m_gl->glBindVertexArray(0);
+
+        m_pProgram->release();
+    }
+
+    void InstancedLinesManager::setGpuMemoryBudget(std::shared_ptr<GpuMemoryBudget> pBudget)
+    {
+        if (!pBudget)
+            return;
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_pGpuBudget->removeBlock(this);
+        m_pGpuBudget = std::move(pBudget);
+        trackBuffer();
+    }
+
+    /**
+     * @brief 容量不足时在同一缓冲区名上重新分配（VAO 记录的缓冲区名不变，无需重新配置属性），
+     *        数据在下一次 flushDirty 时从 CPU 镜像整体上传
+     */
+    void InstancedLinesManager::ensureCapacity(size_t nNeed)
+    {
+        if (!m_gl || nNeed <= m_nCapacity)
+            return;
+
+        size_t nNewCap = std::max(m_nCapacity * 2, nNeed);
+        m_gl->glBindBuffer(GL_ARRAY_BUFFER, m_instanceVbo);
+        m_gl->glBufferData(GL_ARRAY_BUFFER,
+            static_cast<GLsizeiptr>(nNewCap * sizeof(InstanceLineData)), nullptr, GL_DYNAMIC_DRAW);
+        m_gl->glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+        m_nCapacity = nNewCap;
+        m_bFullUpload = true;
+        trackBuffer();
+    }
+
+    void InstancedLinesManager::markDirty(size_t nSlot)
+    {
+        if (m_bFullUpload || m_vDirtyFlags[nSlot])
+            return;
+
+        m_vDirtyFlags[nSlot] = true;
+        m_vDirtySlots.push_back(nSlot);
+    }
+
+    /**
+     * @brief 把脏槽位排序后合并为连续区间上传
+     * 两个脏槽位间隔不超过 DIRTY_MERGE_GAP 时连同中间的干净槽位一起上传，
+     * 用少量多余字节换取更少的 glBufferSubData 调用
+     */
+    void InstancedLinesManager::flushDirty()
+    {
+        m_nLastUploadRanges = 0;
+        m_nLastUploadInstances = 0;
+        if (!m_gl)
+            return;
+
+        const size_t nCount = m_vInstances.size();
+        std::vector<std::pair<size_t, size_t>> vRanges;   // [begin, end)
+
+        if (m_bFullUpload)
+        {
+            if (nCount > 0)
+                vRanges.emplace_back(0, nCount);
+        }
+        else if (!m_vDirtySlots.empty())
+        {
+            std::sort(m_vDirtySlots.begin(), m_vDirtySlots.end());
+            for (size_t nSlot : m_vDirtySlots)
+            {
+                if (nSlot >= nCount)
+                    break;
+                if (!vRanges.empty() && nSlot <= vRanges.back().second + DIRTY_MERGE_GAP)
+                    vRanges.back().second = std::max(vRanges.back().second, nSlot + 1);
+                else
+                    vRanges.emplace_back(nSlot, nSlot + 1);
+            }
+        }
+
+        if (!vRanges.empty())
+        {
+            m_gl->glBindBuffer(GL_ARRAY_BUFFER, m_instanceVbo);
+            for (const auto& range : vRanges)
+            {
+                size_t nInstances = range.second - range.first;
+                m_gl->glBufferSubData(GL_ARRAY_BUFFER,
+                    static_cast<GLintptr>(range.first * sizeof(InstanceLineData)),
+                    static_cast<GLsizeiptr>(nInstances * sizeof(InstanceLineData)),
+                    m_vInstances.data() + range.first);
+                m_pGpuBudget->recordUpload(nInstances * sizeof(InstanceLineData));
+                m_nLastUploadInstances += nInstances;
+            }
+            m_gl->glBindBuffer(GL_ARRAY_BUFFER, 0);
+            m_nLastUploadRanges = vRanges.size();
+            trackBuffer();
+        }
+
+        for (size_t nSlot : m_vDirtySlots)
+        {
+            if (nSlot < m_vDirtyFlags.size())
+                m_vDirtyFlags[nSlot] = false;
+        }
+        m_vDirtySlots.clear();
+        m_bFullUpload = false;
+    }
+
+    void InstancedLinesManager::trackBuffer()
+    {
+        m_pGpuBudget->updateBlock(this, m_nCapacity * sizeof(InstanceLineData),
+            m_vInstances.size() * sizeof(InstanceLineData));
+    }
+}
@@ -0,0 +1,242 @@
+#include "OitBuffer.h"
+
+#include <QDebug>
+
+namespace GLRhi
+{
+    static const char* oitVertexShaderSrc = R"(
+#version 330 core
+layout(location = 0) in vec3 aPos;
+uniform vec2 uBlockOrigin;
+uniform float uBlockScale;
+uniform float uBlockZ;
+void main()
+{
+    vec3 pos = vec3(uBlockOrigin + aPos.xy * uBlockScale, aPos.z + uBlockZ);
+    gl_Position = vec4(pos, 1.0);
+}
+)";
+
+    // 权重随深度衰减：近处片元权重大，远处小，限制在 [1e-2, 3e3] 以免半精度溢出
+    static const char* oitFragmentShaderSrc = R"(
+#version 330 core
+uniform vec4 uColor;
+layout(location = 0) out vec4 Accum;
+layout(location = 1) out float Weight;
+void main()
+{
+    float a = uColor.a;
+    float d = 1.0 - gl_FragCoord.z;
+    float w = clamp(a * max(1e-2, 3e3 * d * d * d), 1e-2, 3e3);
+    Accum = vec4(uColor.rgb * a * w, a);
+    Weight = a * w;
+}
+)";
+
+    // 全屏三角形，顶点由 gl_VertexID 生成
+    static const char* compositeVertexShaderSrc = R"(
+#version 330 core
+void main()
+{
+    vec2 pos = vec2(float((gl_VertexID << 1) & 2), float(gl_VertexID & 2));
+    gl_Position = vec4(pos * 2.0 - 1.0, 0.0, 1.0);
+}
+)";
+
+    static const char* compositeFragmentShaderSrc = R"(
+#version 330 core
+uniform sampler2D uAccum;
+uniform sampler2D uWeight;
+uniform ivec2 uOrigin;
+out vec4 FragColor;
+void main()
+{
+    ivec2 texel = ivec2(gl_FragCoord.xy) - uOrigin;
+    vec4 accum = texelFetch(uAccum, texel, 0);
+    float reveal = accum.a;
+    if (reveal >= 1.0)
+        discard;
+    float w = texelFetch(uWeight, texel, 0).r;
+    FragColor = vec4(accum.rgb / max(w, 1e-5), 1.0 - reveal);
+}
+)";
+
+    OitBuffer::OitBuffer(QOpenGLFunctions_3_3_Core* gl)
+        : m_gl(gl)
+    {
+    }
+
+    OitBuffer::~OitBuffer()
+    {
+        if (!m_gl)
+            return;
+
+        releaseTarget();
+        if (m_vao)
+            m_gl->glDeleteVertexArrays(1, &m_vao);
+    }
+
+    bool OitBuffer::initPrograms()
+    {
+        m_pAccumProgram = std::make_unique<QOpenGLShaderProgram>();
+        m_pAccumProgram->addShaderFromSourceCode(QOpenGLShader::Vertex, oitVertexShaderSrc);
+        m_pAccumProgram->addShaderFromSourceCode(QOpenGLShader::Fragment, oitFragmentShaderSrc);
+        if (!m_pAccumProgram->link())
+        {
+            qCritical() << "OitBuffer: accumulate shader link failed:" << m_pAccumProgram->log();
+            m_pAccumProgram.reset();
+            return false;
+        }
+
+        m_pCompositeProgram = std::make_unique<QOpenGLShaderProgram>();
+        m_pCompositeProgram->addShaderFromSourceCode(QOpenGLShader::Vertex, compositeVertexShaderSrc);
+        m_pCompositeProgram->addShaderFromSourceCode(QOpenGLShader::Fragment, compositeFragmentShaderSrc);
+        if (!m_pCompositeProgram->link())
+        {
+            qCritical() << "OitBuffer: composite shader link failed:" << m_pCompositeProgram->log();
+            m_pAccumProgram.reset();
+            m_pCompositeProgram.reset();
+            return false;
+        }
+
+        m_uniforms.nColor = m_pAccumProgram->uniformLocation("uColor");
+        m_nCompositeOrigin = m_pCompositeProgram->uniformLocation("uOrigin");
+
+        // 采样器单元固定，只需设置一次
+        m_pCompositeProgram->bind();
+        m_pCompositeProgram->setUniformValue("uAccum", 0);
+        m_pCompositeProgram->setUniformValue("uWeight", 1);
+        m_gl->glUseProgram(static_cast<GLuint>(m_nPrevProgram));
+
+        m_gl->glGenVertexArrays(1, &m_vao);
+        return true;
+    }
+
+    bool OitBuffer::ensureTarget(int nWidth, int nHeight)
+    {
+        if (m_fbo && nWidth == m_nWidth && nHeight == m_nHeight)
+            return true;
+
+        releaseTarget();
+        m_nWidth = nWidth;
+        m_nHeight = nHeight;
+
+        auto createTexture = [this, nWidth, nHeight](GLuint& tex, GLint nInternal, GLenum eFormat) {
+            m_gl->glGenTextures(1, &tex);
+            m_gl->glBindTexture(GL_TEXTURE_2D, tex);
+            m_gl->glTexImage2D(GL_TEXTURE_2D, 0, nInternal, nWidth, nHeight, 0, eFormat, GL_HALF_FLOAT, nullptr);
+            m_gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+            m_gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        };
+        createTexture(m_texAccum, GL_RGBA16F, GL_RGBA);
+        createTexture(m_texWeight, GL_R16F, GL_RED);
+        m_gl->glBindTexture(GL_TEXTURE_2D, 0);
+
+        m_gl->glGenFramebuffers(1, &m_fbo);
+        m_gl->glBindFramebuffer(GL_FRAMEBUFFER, m_fbo);
+        m_gl->glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_texAccum, 0);
+        m_gl->glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, m_texWeight, 0);
+        const GLenum arrDrawBuffers[2] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1 };
+        m_gl->glDrawBuffers(2, arrDrawBuffers);
+        GLenum eStatus = m_gl->glCheckFramebufferStatus(GL_FRAMEBUFFER);
+        m_gl->glBindFramebuffer(GL_FRAMEBUFFER, static_cast<GLuint>(m_nPrevFbo));
+
+        if (eStatus != GL_FRAMEBUFFER_COMPLETE)
+        {
+            qWarning() << "OitBuffer: framebuffer incomplete" << eStatus;
+            releaseTarget();
+            return false;
+        }
+        return true;
+    }
+
+    void OitBuffer::releaseTarget()
+    {
+        if (m_fbo)
+            m_gl->glDeleteFramebuffers(1, &m_fbo);
+        if (m_texAccum)
+            m_gl->glDeleteTextures(1, &m_texAccum);
+        if (m_texWeight)
+            m_gl->glDeleteTextures(1, &m_texWeight);
+        m_fbo = 0;
+        m_texAccum = 0;
+        m_texWeight = 0;
+        m_nWidth = 0;
+        m_nHeight = 0;
+    }
+
+    bool OitBuffer::begin()
+    {
+        if (!m_gl)
+            return false;
+
+        m_gl->glGetIntegerv(GL_FRAMEBUFFER_BINDING, &m_nPrevFbo);
+        m_gl->glGetIntegerv(GL_VIEWPORT, m_arrPrevViewport);
+        m_gl->glGetIntegerv(GL_CURRENT_PROGRAM, &m_nPrevProgram);
+        m_gl->glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &m_nPrevVao);
+        m_gl->glGetIntegerv(GL_ACTIVE_TEXTURE, &m_nPrevActiveTexture);
+        m_gl->glGetIntegerv(GL_BLEND_SRC_RGB, &m_arrPrevBlendFunc[0]);
+        m_gl->glGetIntegerv(GL_BLEND_DST_RGB, &m_arrPrevBlendFunc[1]);
+        m_gl->glGetIntegerv(GL_BLEND_SRC_ALPHA, &m_arrPrevBlendFunc[2]);
+        m_gl->glGetIntegerv(GL_BLEND_DST_ALPHA, &m_arrPrevBlendFunc[3]);
+        m_gl->glGetBooleanv(GL_DEPTH_WRITEMASK, &m_bPrevDepthMask);
+        m_bPrevDepthTest = m_gl->glIsEnabled(GL_DEPTH_TEST);
+        m_bPrevBlend = m_gl->glIsEnabled(GL_BLEND);
+
+        if (!m_pAccumProgram && !initPrograms())
+            return false;
+
+        const int nWidth = m_arrPrevViewport[2];
+        const int nHeight = m_arrPrevViewport[3];
+        if (nWidth <= 0 || nHeight <= 0 || !ensureTarget(nWidth, nHeight))
+            return false;
+
+        m_gl->glBindFramebuffer(GL_FRAMEBUFFER, m_fbo);
+        m_gl->glViewport(0, 0, nWidth, nHeight);
+        m_gl->glDisable(GL_DEPTH_TEST);
+        m_gl->glDepthMask(GL_FALSE);
+
+        const GLfloat arrClearAccum[4] = { 0.0f, 0.0f, 0.0f, 1.0f };   // 透射率初始为 1
+        const GLfloat arrClearWeight[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+        m_gl->glClearBufferfv(GL_COLOR, 0, arrClearAccum);
+        m_gl->glClearBufferfv(GL_COLOR, 1, arrClearWeight);
+
+        // rgb 相加；alpha 乘以 (1 - 源 alpha)。RT1 只有 r 通道，同样是相加
+        m_gl->glEnable(GL_BLEND);
+        m_gl->glBlendFuncSeparate(GL_ONE, GL_ONE, GL_ZERO, GL_ONE_MINUS_SRC_ALPHA);
+
+        m_pAccumProgram->bind();
+        return true;
+    }
+
+    void OitBuffer::end()
+    {
+        m_gl->glBindFramebuffer(GL_FRAMEBUFFER, static_cast<GLuint>(m_nPrevFbo));
+        m_gl->glViewport(m_arrPrevViewport[0], m_arrPrevViewport[1], m_arrPrevViewport[2], m_arrPrevViewport[3]);
+
+        m_pCompositeProgram->bind();
+        m_gl->glUniform2i(m_nCompositeOrigin, m_arrPrevViewport[0], m_arrPrevViewport[1]);
+        m_gl->glActiveTexture(GL_TEXTURE0);
+        m_gl->glBindTexture(GL_TEXTURE_2D, m_texAccum);
+        m_gl->glActiveTexture(GL_TEXTURE1);
+        m_gl->glBindTexture(GL_TEXTURE_2D, m_texWeight);
+
+        m_gl->glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        m_gl->glBindVertexArray(m_vao);
+        m_gl->glDrawArrays(GL_TRIANGLES, 0, 3);
+
+        // 恢复状态
+        m_gl->glBindVertexArray(static_cast<GLuint>(m_nPrevVao));
+        m_gl->glBindTexture(GL_TEXTURE_2D, 0);
+        m_gl->glActiveTexture(GL_TEXTURE0);
+        m_gl->glBindTexture(GL_TEXTURE_2D, 0);
+        m_gl->glActiveTexture(static_cast<GLenum>(m_nPrevActiveTexture));
+        m_gl->glUseProgram(static_cast<GLuint>(m_nPrevProgram));
+        m_gl->glBlendFuncSeparate(m_arrPrevBlendFunc[0], m_arrPrevBlendFunc[1], m_arrPrevBlendFunc[2], m_arrPrevBlendFunc[3]);
+        m_gl->glDepthMask(m_bPrevDepthMask);
+        if (m_bPrevDepthTest)
+            m_gl->glEnable(GL_DEPTH_TEST);
+        if (!m_bPrevBlend)
+            m_gl->glDisable(GL_BLEND);
+    }
+}
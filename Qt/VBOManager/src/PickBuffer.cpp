@@ -0,0 +1,198 @@
+#include "PickBuffer.h"
+
+#include <cstring>
+#include <QDebug>
+
+namespace GLRhi
+{
+    static const char* pickVertexShaderSrc = R"(
+#version 330 core
+layout(location = 0) in vec3 aPos;
+uniform vec2 uBlockOrigin;
+uniform float uBlockScale;
+uniform float uBlockZ;
+uniform vec2 uPickCenter;   // 光标 NDC 坐标
+uniform vec2 uPickScale;    // 视口尺寸 / 拾取窗口尺寸
+flat out uint vVertexId;
+void main()
+{
+    vec3 pos = vec3(uBlockOrigin + aPos.xy * uBlockScale, aPos.z + uBlockZ);
+    vVertexId = uint(gl_VertexID);
+    gl_Position = vec4((pos.xy - uPickCenter) * uPickScale, pos.z, 1.0);
+}
+)";
+
+    static const char* pickFragmentShaderSrc = R"(
+#version 330 core
+uniform uint uPickBlock;
+flat in uint vVertexId;
+out uvec2 PickId;
+void main()
+{
+    PickId = uvec2(uPickBlock, vVertexId);
+}
+)";
+
+    PickBuffer::PickBuffer(QOpenGLFunctions_3_3_Core* gl)
+        : m_gl(gl)
+    {
+    }
+
+    PickBuffer::~PickBuffer()
+    {
+        if (!m_gl)
+            return;
+
+        if (m_fence)
+            m_gl->glDeleteSync(m_fence);
+        releaseTarget();
+    }
+
+    bool PickBuffer::initProgram()
+    {
+        m_pProgram = std::make_unique<QOpenGLShaderProgram>();
+        m_pProgram->addShaderFromSourceCode(QOpenGLShader::Vertex, pickVertexShaderSrc);
+        m_pProgram->addShaderFromSourceCode(QOpenGLShader::Fragment, pickFragmentShaderSrc);
+        if (!m_pProgram->link())
+        {
+            qCritical() << "PickBuffer: shader link failed:" << m_pProgram->log();
+            m_pProgram.reset();
+            return false;
+        }
+
+        m_uniforms.nPickCenter = m_pProgram->uniformLocation("uPickCenter");
+        m_uniforms.nPickScale = m_pProgram->uniformLocation("uPickScale");
+        m_uniforms.nPickBlock = m_pProgram->uniformLocation("uPickBlock");
+        return true;
+    }
+
+    bool PickBuffer::ensureTarget(int nSize)
+    {
+        if (m_fbo && nSize == m_nSize)
+            return true;
+
+        releaseTarget();
+        m_nSize = nSize;
+
+        m_gl->glGenTextures(1, &m_tex);
+        m_gl->glBindTexture(GL_TEXTURE_2D, m_tex);
+        m_gl->glTexImage2D(GL_TEXTURE_2D, 0, GL_RG32UI, nSize, nSize, 0, GL_RG_INTEGER, GL_UNSIGNED_INT, nullptr);
+        m_gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        m_gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        m_gl->glBindTexture(GL_TEXTURE_2D, 0);
+
+        m_gl->glGenFramebuffers(1, &m_fbo);
+        m_gl->glBindFramebuffer(GL_FRAMEBUFFER, m_fbo);
+        m_gl->glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_tex, 0);
+        GLenum eStatus = m_gl->glCheckFramebufferStatus(GL_FRAMEBUFFER);
+        m_gl->glBindFramebuffer(GL_FRAMEBUFFER, static_cast<GLuint>(m_nPrevFbo));
+
+        m_gl->glGenBuffers(1, &m_pbo);
+        m_gl->glBindBuffer(GL_PIXEL_PACK_BUFFER, m_pbo);
+        m_gl->glBufferData(GL_PIXEL_PACK_BUFFER,
+            static_cast<GLsizeiptr>(nSize) * nSize * 2 * sizeof(uint32_t), nullptr, GL_STREAM_READ);
+        m_gl->glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+        if (eStatus != GL_FRAMEBUFFER_COMPLETE)
+        {
+            qWarning() << "PickBuffer: framebuffer incomplete" << eStatus;
+            releaseTarget();
+            return false;
+        }
+        return true;
+    }
+
+    void PickBuffer::releaseTarget()
+    {
+        if (m_fbo)
+            m_gl->glDeleteFramebuffers(1, &m_fbo);
+        if (m_tex)
+            m_gl->glDeleteTextures(1, &m_tex);
+        if (m_pbo)
+            m_gl->glDeleteBuffers(1, &m_pbo);
+        m_fbo = 0;
+        m_tex = 0;
+        m_pbo = 0;
+        m_nSize = 0;
+    }
+
+    bool PickBuffer::begin(int nSize)
+    {
+        if (!m_gl || nSize <= 0)
+            return false;
+        if (!m_pProgram && !initProgram())
+            return false;
+
+        // 上一次的结果还没取走时直接丢弃
+        if (m_fence)
+        {
+            m_gl->glDeleteSync(m_fence);
+            m_fence = nullptr;
+        }
+
+        m_gl->glGetIntegerv(GL_FRAMEBUFFER_BINDING, &m_nPrevFbo);
+        m_gl->glGetIntegerv(GL_VIEWPORT, m_arrPrevViewport);
+        m_gl->glGetIntegerv(GL_CURRENT_PROGRAM, &m_nPrevProgram);
+        m_bPrevDepthTest = m_gl->glIsEnabled(GL_DEPTH_TEST);
+        m_bPrevBlend = m_gl->glIsEnabled(GL_BLEND);
+
+        if (!ensureTarget(nSize))
+            return false;
+
+        m_gl->glBindFramebuffer(GL_FRAMEBUFFER, m_fbo);
+        m_gl->glViewport(0, 0, nSize, nSize);
+        m_gl->glDisable(GL_DEPTH_TEST);
+        m_gl->glDisable(GL_BLEND);
+
+        const GLuint arrClear[4] = { 0, 0, 0, 0 };
+        m_gl->glClearBufferuiv(GL_COLOR, 0, arrClear);
+
+        m_pProgram->bind();
+        return true;
+    }
+
+    void PickBuffer::end()
+    {
+        m_gl->glBindBuffer(GL_PIXEL_PACK_BUFFER, m_pbo);
+        m_gl->glReadBuffer(GL_COLOR_ATTACHMENT0);
+        m_gl->glReadPixels(0, 0, m_nSize, m_nSize, GL_RG_INTEGER, GL_UNSIGNED_INT, nullptr);
+        m_gl->glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        m_fence = m_gl->glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+        m_gl->glUseProgram(static_cast<GLuint>(m_nPrevProgram));
+        m_gl->glBindFramebuffer(GL_FRAMEBUFFER, static_cast<GLuint>(m_nPrevFbo));
+        m_gl->glViewport(m_arrPrevViewport[0], m_arrPrevViewport[1], m_arrPrevViewport[2], m_arrPrevViewport[3]);
+        if (m_bPrevDepthTest)
+            m_gl->glEnable(GL_DEPTH_TEST);
+        if (m_bPrevBlend)
+            m_gl->glEnable(GL_BLEND);
+    }
+
+    bool PickBuffer::fetch(std::vector<uint32_t>& vTexels, bool bWait)
+    {
+        if (!m_fence)
+            return false;
+
+        GLuint64 nTimeout = bWait ? 1'000'000'000ull : 0;   // 最多等待 1 秒
+        GLenum eResult = m_gl->glClientWaitSync(m_fence, GL_SYNC_FLUSH_COMMANDS_BIT, nTimeout);
+        if (eResult == GL_TIMEOUT_EXPIRED || eResult == GL_WAIT_FAILED)
+            return false;
+
+        m_gl->glDeleteSync(m_fence);
+        m_fence = nullptr;
+
+        const size_t nCount = static_cast<size_t>(m_nSize) * m_nSize * 2;
+        vTexels.resize(nCount);
+
+        m_gl->glBindBuffer(GL_PIXEL_PACK_BUFFER, m_pbo);
+        const void* pData = m_gl->glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0,
+            static_cast<GLsizeiptr>(nCount * sizeof(uint32_t)), GL_MAP_READ_BIT);
+        if (pData)
+        {
+            std::memcpy(vTexels.data(), pData, nCount * sizeof(uint32_t));
+            m_gl->glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+        }
+        m_gl->glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        return pData != nullptr;
+    }
+}
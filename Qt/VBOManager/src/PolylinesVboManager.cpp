@@ -9,6 +9,8 @@
  * - 采用增量上传策略，最小化数据传输开销
  * - 支持OpenGL 3.3核心配置文件，兼容性好
  * - 支持多线程背景碎片整理，不阻塞主线程
+ * - 支持 16 位量化 / 半精度压缩顶点格式，块原点、缩放与 z 通过 uniform 传入
+ * - 支持显存预算：超出时合并、收缩块，并把整块隐藏的块驱逐到 CPU
  *
  * 设计模式：
  * - 使用VAO/VBO/EBO进行高效渲染
@@ -18,10 +20,14 @@
  */
 
 #include "PolylinesVboManager.h"
+#include "ThreadPool.h"
+#include "ColorBuffer.h"
 #include <mutex>
 #include <algorithm>
 #include <unordered_set>
 #include <chrono>
+#include <cstring>
+#include <numeric>
 #include <QDebug>
 
 namespace GLRhi
@@ -37,6 +43,115 @@ namespace GLRhi
         // static constexpr size_t GROW_STEP = 500'000;         // 容量增长步长
         // static constexpr size_t MAX_VERT_PER_BLOCK = 2'000'000; // 每个VBO块的最大顶点数量
         static constexpr float COMPACT_THRESHOLD = 0.70f; // 使用率 < 70% 才压缩
+        static constexpr float SPARSE_THRESHOLD = 0.50f;  // 使用率 < 50% 的块在超出显存预算时参与合并
+        static constexpr size_t SHRINK_RATIO = 2;         // 分配量超过使用量 2 倍的块在超出显存预算时收缩
+        static constexpr size_t MIN_BLOCK_CAPACITY = 1024; // 收缩 / 恢复后的最小容量
+        static constexpr size_t PARALLEL_MIN_ITEMS = 4096; // 批量加载时每个线程至少处理的折线数
+
+        /**
+         * @brief 将 [0, nCount) 分给共享线程池执行 fn(begin, end)，数据量小时直接在当前线程执行
+         */
+        template <typename Fn>
+        void parallelRanges(size_t nCount, size_t nMinPerThread, Fn&& fn)
+        {
+            ThreadPool::shared().parallelFor(nCount, nMinPerThread, std::forward<Fn>(fn));
+        }
+
+        /**
+         * @brief 有序绘制的排序键
+         * 位 63：半透明；62..47：深度桶；46..15：颜色键；14..0：块在颜色分组内的序号（饱和）
+         * 不透明块深度桶升序（由近到远，利于提前深度测试），半透明块降序（由远到近混合）
+         */
+        struct DrawKey
+        {
+            uint64_t nKey{ 0 };
+            ColorVBOBlock* block{ nullptr };
+        };
+
+        constexpr uint64_t DRAW_KEY_TRANSLUCENT = uint64_t(1) << 63;
+
+        uint16_t depthBucket(float fDepth)
+        {
+            // NDC z ∈ [-1, 1] 映射到 16 位，同一图层的块落在同一个桶内
+            float f = std::clamp((fDepth + 1.0f) * 0.5f, 0.0f, 1.0f);
+            return static_cast<uint16_t>(f * 65535.0f + 0.5f);
+        }
+
+        uint64_t makeDrawKey(const ColorVBOBlock* block, size_t nSeq)
+        {
+            const bool bTranslucent = block->color.a() < 1.0f;
+            uint64_t nBucket = depthBucket(block->fSortDepth);
+            if (bTranslucent)
+                nBucket = 0xFFFF - nBucket;
+
+            return (bTranslucent ? DRAW_KEY_TRANSLUCENT : 0)
+                | (nBucket << 47)
+                | (uint64_t(block->color.toUInt32()) << 15)
+                | std::min<uint64_t>(nSeq, 0x7FFF);
+        }
+
+        /**
+         * @brief 按 nKey 升序的 LSD 基数排序（稳定），所有键在某一字节上相同时跳过该趟
+         */
+        void radixSortDrawKeys(std::vector<DrawKey>& vKeys, std::vector<DrawKey>& vTemp)
+        {
+            const size_t nCount = vKeys.size();
+            if (nCount < 2)
+                return;
+
+            vTemp.resize(nCount);
+            for (unsigned int nShift = 0; nShift < 64; nShift += 8)
+            {
+                size_t arrCounts[256] = {};
+                for (const DrawKey& key : vKeys)
+                    ++arrCounts[(key.nKey >> nShift) & 0xFF];
+                if (arrCounts[(vKeys[0].nKey >> nShift) & 0xFF] == nCount)
+                    continue;
+
+                size_t nSum = 0;
+                for (size_t& n : arrCounts)
+                {
+                    size_t nTmp = n;
+                    n = nSum;
+                    nSum += nTmp;
+                }
+                for (const DrawKey& key : vKeys)
+                    vTemp[arrCounts[(key.nKey >> nShift) & 0xFF]++] = key;
+                vKeys.swap(vTemp);
+            }
+        }
+
+        /**
+         * @brief 标记块的绘制命令需要重建，并使已预处理的后台缓冲失效
+         */
+        void markDirty(ColorVBOBlock* block)
+        {
+            block->bDirty = true;
+            ++block->nEditVersion;
+        }
+
+        /**
+         * @brief 以折线包围盒中心为原点生成压缩窗口（不依赖管理器状态，上传线程也可调用）
+         */
+        bool makeWindowFor(VertexFormat eFormat, float fQuantizeStep, const float* pVerts, size_t nVertCount,
+            QuantizeWindow& window)
+        {
+            float fMinX = pVerts[0], fMaxX = pVerts[0];
+            float fMinY = pVerts[1], fMaxY = pVerts[1];
+            for (size_t i = 1; i < nVertCount; ++i)
+            {
+                fMinX = std::min(fMinX, pVerts[i * 3]);
+                fMaxX = std::max(fMaxX, pVerts[i * 3]);
+                fMinY = std::min(fMinY, pVerts[i * 3 + 1]);
+                fMaxY = std::max(fMaxY, pVerts[i * 3 + 1]);
+            }
+
+            window.fOriginX = (fMinX + fMaxX) * 0.5f;
+            window.fOriginY = (fMinY + fMaxY) * 0.5f;
+            window.fStep = (eFormat == VertexFormat::Float3) ? 1.0f : fQuantizeStep;
+
+            return fitsWindow(eFormat, window, pVerts[2], pVerts, nVertCount);
+        }
     }
 
     /**
@@ -44,8 +159,12 @@ namespace GLRhi
      *
      * 在构造时尝试获取当前的OpenGL上下文，并初始化相关资源。
      * 注意：在创建此对象时，必须确保OpenGL上下文已经初始化。
+     *
+     * @param eFormat 新建块使用的顶点格式
      */
-    PolylinesVboManager::PolylinesVboManager()
+    PolylinesVboManager::PolylinesVboManager(VertexFormat eFormat)
+        : m_eVertexFormat(eFormat)
+        , m_pGpuBudget(std::make_shared<GpuMemoryBudget>())
     {
         if (QOpenGLContext::currentContext())
         {
@@ -65,12 +184,19 @@ namespace GLRhi
      * - 停止后台碎片整理线程
      * - 删除所有OpenGL缓冲区对象（VAO、VBO、EBO）
      * - 释放所有ColorVBOBlock对象
-     * - 清空所有容器（m_colorBlocks, m_IDLocationMap, m_vertexCache）
+     * - 清空所有容器（m_colorBlocks, m_IDLocationMap）及块内 CPU 影子数据
      */
     PolylinesVboManager::~PolylinesVboManager()
     {
         stopBackgroundDefrag();
 
+        // 上传线程的任务引用本对象，先停线程再释放未接入的结果
+        if (m_pUploader)
+            m_pUploader->stop();
+        for (AsyncUpload& upload : m_vAsyncDone)
+            releaseAsyncUpload(upload);
+        m_vAsyncDone.clear();
+
         std::unique_lock<std::shared_mutex> lock(m_mutex);
         for (auto& pair : m_colorBlocksMap)
         {
@@ -82,6 +208,7 @@ namespace GLRhi
                     m_gl->glDeleteBuffers(1, &block->vbo);
                     m_gl->glDeleteBuffers(1, &block->ebo);
                 }
+                m_pGpuBudget->removeBlock(block);
                 delete block;
             }
         }
@@ -89,8 +216,59 @@ namespace GLRhi
         m_colorBlocksMap.clear();
         m_IDLocationMap.clear();
         m_IDLocationMap.reserve(0);
-        m_vVertexCache.clear();
-        m_vVertexCache.reserve(0);
+        m_nShadowBytes = 0;
+    }
+
+    void PolylinesVboManager::setQuantizeStep(float fStep)
+    {
+        if (fStep > 0.0f)
+            m_fQuantizeStep = fStep;
+    }
+
+    size_t PolylinesVboManager::getUsedVertexBytes() const
+    {
+        std::shared_lock<std::shared_mutex> lock(m_mutex);
+        size_t nBytes = 0;
+        for (const auto& pair : m_colorBlocksMap)
+        {
+            for (const ColorVBOBlock* block : pair.second)
+                nBytes += block->nVertexCount * vertexStride(block->eFormat);
+        }
+        return nBytes;
+    }
+
+    bool PolylinesVboManager::readBackPolyline(long long id, std::vector<float>& vVerts)
+    {
+        if (!m_gl)
+            return false;
+
+        std::shared_lock<std::shared_mutex> lock(m_mutex);
+        auto it = m_IDLocationMap.find(id);
+        if (it == m_IDLocationMap.end())
+            return false;
+
+        const ColorVBOBlock* block = it->second.block;
+        const PrimitiveInfo& prim = block->vPrimitives[it->second.nPrimIdx];
+        const size_t nStride = vertexStride(block->eFormat);
+        const size_t nCount = static_cast<size_t>(prim.nIndexCount);
+
+        // 驱逐块没有显存，数据只在影子中
+        if (block->bEvicted)
+        {
+            const float* pSrc = block->vShadow.data() + static_cast<size_t>(prim.nBaseVertex) * 3;
+            vVerts.assign(pSrc, pSrc + nCount * 3);
+            return true;
+        }
+
+        std::vector<unsigned char> vRaw(nCount * nStride);
+        m_gl->glBindBuffer(GL_ARRAY_BUFFER, block->vbo);
+        m_gl->glGetBufferSubData(GL_ARRAY_BUFFER,
+            static_cast<GLintptr>(prim.nBaseVertex) * nStride,
+            static_cast<GLsizeiptr>(vRaw.size()), vRaw.data());
+
+        vVerts.resize(nCount * 3);
+        decodeVertices(block->eFormat, block->window, block->fLayerZ, vRaw.data(), nCount, vVerts.data());
+        return true;
     }
 
     /**
@@ -105,7 +283,7 @@ namespace GLRhi
      *
      * @note 顶点数量必须至少为2个（即vVertices.size() >= 6且为3的倍数）
      */
-    bool PolylinesVboManager::addPolyline(long long id,
+    bool PolylinesVboManager::doAddPolyline(long long id,
         const std::vector<float>& vVerts, const Color& color)
     {
         if (vVerts.size() < 6 || vVerts.size() % 3 != 0)
@@ -116,7 +294,7 @@ namespace GLRhi
             return false;
 
         size_t nVertCount = vVerts.size() / 3;
-        ColorVBOBlock* block = getColorBlock(color);
+        ColorVBOBlock* block = getColorBlock(color, vVerts.data(), nVertCount);
         if (!block)
             return false;
 
@@ -138,12 +316,13 @@ namespace GLRhi
 
         block->nVertexCount += nVertCount;
         block->nIndexCount += nVertCount;
-        block->bDirty = true;
+        markDirty(block);
 
-        m_vVertexCache[id] = vVerts;
         m_IDLocationMap[id] = { color.toUInt32(), color, block, nPrimIdx };
 
-        uploadSinglePrimitive(block, nPrimIdx); // 增量上传，只传这一条
+        uploadSinglePrimitive(block, nPrimIdx, vVerts.data()); // 增量上传，只传这一条
+        trackBlock(block);
+        enforceShadowBudget();
         return true;
     }
 
@@ -151,7 +330,8 @@ namespace GLRhi
      * @brief 批量添加多条折线到渲染管理器
      *
      * 一次性添加多个折线组，每个折线组包含多条折线。
-     * 内部会遍历所有折线数据并调用addPolyline添加每条折线。
+     * 立即模式下每组直接走 loadPolylines 零拷贝批量加载；
+     * 延迟模式下逐条拆分后写入命令队列。
      *
      * @param vPlDatas 折线数据数组，每个元素包含一组相关的折线
      * @return true 如果所有折线都添加成功，false 如果至少有一条折线添加失败
@@ -161,6 +341,22 @@ namespace GLRhi
     bool PolylinesVboManager::addPolylines(std::vector<PolylineData>& vPlDatas)
     {
         bool bAllSuccess = true;
+        if (!isDeferredMode())
+        {
+            for (const auto& data : vPlDatas)
+            {
+                size_t nLines = std::min(data.vId.size(), data.vCount.size());
+                size_t nExpected = static_cast<size_t>(std::count_if(data.vCount.begin(), data.vCount.begin() + nLines,
+                    [](size_t n) { return n >= 2; }));
+
+                size_t nLoaded = loadPolylines(data.vId.data(), data.vCount.data(), nLines,
+                    data.vVerts.data(), Color(data.brush.getColor()));
+                if (nLoaded != nExpected)
+                    bAllSuccess = false;
+            }
+            return bAllSuccess;
+        }
+
         for (auto& data : vPlDatas)
         {
             size_t offset = 0;
@@ -180,10 +376,7 @@ namespace GLRhi
 
                 Color c(data.brush.getColor());
                 if (!addPolyline(data.vId[i], vVerts, c))
-                {
-                    touchCache(data.vId[i]);
                     bAllSuccess = false;
-                }
 
                 offset += nCount;
             }
@@ -191,264 +384,857 @@ namespace GLRhi
         return bAllSuccess;
     }
 
-   
     /**
-     * @brief 批量添加多条折线
+     * @brief 零拷贝批量加载
      *
-     * 比逐个调用 addPolyline() 快 5~20 倍，专为一次性加载数十万条线设计。
-     * 内部会：
-     * - 按颜色自动分组
-     * - 每种颜色只扩容/上传一次
-     * - 最小化锁粒度、OpenGL 调用、内存拷贝
+     * 面向打开文件等一次加载数十万~数百万条折线的场景：
+     * - 顶点直接从调用方的连续数组读取，不为每条折线分配 std::vector
+     * - 按块上限切分成连续批次，每个新块按实际顶点数一次分配到位
+     * - 每个块的 VBO / EBO 各只调用一次 glBufferSubData
+     * - 影子写入、顶点编码、图元信息与绘制命令按折线区间多线程并行生成
      *
-     * @param vPolylineDatas 批量数据：{id, vertices, color}
-     * @return 添加成功的图元数量（失败的会跳过并打印警告）
+     * @param pIds 折线ID数组，长度 nLineCount
+     * @param pCounts 每条折线的顶点数数组，长度 nLineCount
+     * @param nLineCount 折线数量
+     * @param pVerts 所有折线首尾相接的顶点数组 [x, y, z, ...]
+     * @param color 折线颜色
+     * @return 实际加载的折线数量（点数不足 2 或 ID 已存在的会被跳过）
+     *
+     * @note 需在渲染线程的 OpenGL 上下文中调用；延迟模式下会先执行已排队的命令以保持顺序
      */
-    size_t PolylinesVboManager::addPolylines(
-        const std::vector<std::tuple<long long, std::vector<float>, Color>>& vPolylineDatas)
+    size_t PolylinesVboManager::loadPolylines(const long long* pIds, const size_t* pCounts, size_t nLineCount,
+        const float* pVerts, const Color& color)
     {
-
-        if (vPolylineDatas.empty() || !m_gl)
+        if (!m_gl || !pIds || !pCounts || !pVerts || nLineCount == 0)
             return 0;
 
-        // Step 1: 预处理 — 按颜色分组 + 过滤无效数据 + 预检查ID冲突
-        struct BatchGroup
-        {
-            Color color;
-            std::vector<size_t> indices; // 在 vPolylineDatas 中的下标
-            size_t totalVerts = 0;
-            size_t totalIndices = 0;
-        };
+        if (isDeferredMode())
+            applyPendingCommands();
 
-        std::unordered_map<uint32_t, BatchGroup> colorGroups;
-        std::vector<bool> validFlags(vPolylineDatas.size(), true);
-        size_t validCount = 0;
+        std::unique_lock<std::shared_mutex> lock(m_mutex);
 
-        {
-            std::shared_lock<std::shared_mutex> readLock(m_mutex);
-            for (size_t i = 0; i < vPolylineDatas.size(); ++i) // 遍历组
-            {
-                const auto& [id, verts, color] = vPolylineDatas[i]; // tuple 多段线
+        const uint32_t nKey = color.toUInt32();
 
-                if (verts.size() < 6 || verts.size() % 3 != 0)
-                {
-                    validFlags[i] = false;
-                    continue;
-                }
+        // Step 1: 顶点偏移前缀和 + 校验，同时预占 ID（批次内重复的 ID 也会在这里被过滤）
+        BulkSource src;
+        src.pIds = pIds;
+        src.pCounts = pCounts;
+        src.pVerts = pVerts;
+        src.vOffsets.resize(nLineCount);
 
-                if (m_IDLocationMap.count(id))
-                {
-                    validFlags[i] = false;
-                    continue;
-                }
+        std::vector<size_t> vValid;
+        vValid.reserve(nLineCount);
+        m_IDLocationMap.reserve(m_IDLocationMap.size() + nLineCount);
 
-                size_t nVertCount = verts.size() / 3;
-                uint32_t key = color.toUInt32();
+        size_t nOffset = 0;
+        for (size_t i = 0; i < nLineCount; ++i)
+        {
+            src.vOffsets[i] = nOffset;
+            nOffset += pCounts[i];
 
-                auto& batchGroup = colorGroups[key];
-                batchGroup.color = color;
+            if (pCounts[i] < 2)
+                continue;
 
-                batchGroup.indices.push_back(i);
-                batchGroup.totalVerts += nVertCount;
-                batchGroup.totalIndices += nVertCount;
-                validCount++;
-            }
+            if (m_IDLocationMap.try_emplace(pIds[i], Location{ nKey, color, nullptr, 0 }).second)
+                vValid.push_back(i);
         }
 
-        if (validCount == 0)
+        if (vValid.empty())
             return 0;
 
-        std::unique_lock<std::shared_mutex> writeLock(m_mutex);
-
-        size_t nAdd = 0;
-
-        for (auto& [key, group] : colorGroups)
+        // Step 2: 按块顶点上限切成连续批次，每个批次整体放入一个块
+        size_t nStart = 0;
+        while (nStart < vValid.size())
         {
-            ColorVBOBlock* block = getColorBlock(group.color);
-            if (!block)
+            size_t nEnd = nStart;
+            size_t nChunkVerts = 0;
+            while (nEnd < vValid.size() &&
+                (nChunkVerts == 0 || nChunkVerts + pCounts[vValid[nEnd]] <= MAX_VERT_PER_BLOCK))
             {
-                qCritical() << "Failed to create color block for batch add";
-                continue;
+                nChunkVerts += pCounts[vValid[nEnd]];
+                ++nEnd;
             }
 
-            checkBlockCapacity(block,
-                block->nVertexCount + group.totalVerts,
-                block->nIndexCount + group.totalIndices);
-
-            // 预计算本次批次在块中的起始偏移
-            GLint nBaseVertexStart = static_cast<GLint>(block->nVertexCount);
-            size_t nVertOffset = block->nVertexCount; // 顶点偏移
-            size_t nIdxOffset = block->nIndexCount;   // 索引偏移
+            std::vector<size_t> vChunk(vValid.begin() + nStart, vValid.begin() + nEnd);
 
-            // 准备批量上传用的连续缓冲区
-            std::vector<float> vBatchVerts;
-            std::vector<unsigned int> vBatchIndices;
-            vBatchVerts.reserve(group.totalVerts * 3);
-            vBatchIndices.reserve(group.totalIndices);
+            // 批次在源数组中的连续顶点范围（用于确定压缩窗口）
+            size_t nFirst = vChunk.front();
+            size_t nLast = vChunk.back();
+            const float* pRange = pVerts + src.vOffsets[nFirst] * 3;
+            size_t nRangeVerts = src.vOffsets[nLast] + pCounts[nLast] - src.vOffsets[nFirst];
 
-            std::vector<PrimitiveInfo> vNewPrims;
-            vNewPrims.reserve(group.indices.size());
+            ColorVBOBlock* block = nullptr;
+            QuantizeWindow window;
+            bool bFits = (m_eVertexFormat == VertexFormat::Float3) || makeWindow(pRange, nRangeVerts, window);
 
-            // 遍历该颜色组所有图元
-            for (size_t idx : group.indices)
+            if (bFits)
             {
-                if (!validFlags[idx])
-                    continue;
+                float fLayerZ = (m_eVertexFormat == VertexFormat::Float3) ? 0.0f : pRange[2];
+                for (ColorVBOBlock* b : m_colorBlocksMap[nKey])
+                {
+                    if (!b->bEvicted && b->eFormat == m_eVertexFormat && b->nVertexCount + nChunkVerts <= MAX_VERT_PER_BLOCK &&
+                        fitsWindow(b->eFormat, b->window, b->fLayerZ, pRange, nRangeVerts))
+                    {
+                        block = b;
+                        break;
+                    }
+                }
 
-                const auto& [id, verts, color] = vPolylineDatas[idx];
-                size_t nVertCount = verts.size() / 3;
+                // 新块按批次顶点数一次分配到位，之后不再扩容
+                if (!block)
+                    block = createNewColorBlock(color, m_eVertexFormat, window, fLayerZ, nChunkVerts);
 
-                PrimitiveInfo prim;
-                prim.id = id;
-                prim.nIndexCount = static_cast<GLsizei>(nVertCount);
-                prim.nBaseVertex = static_cast<GLint>(nVertOffset);
-                prim.bValid = true;
+                bulkFillBlock(block, src, vChunk, nChunkVerts, color);
+            }
+            else
+            {
+                // 压缩格式下批次跨度超出单块窗口：逐条选块，再按块分组批量填充
+                struct LineGroup
+                {
+                    ColorVBOBlock* block;
+                    std::vector<size_t> vLines;
+                    size_t nVerts;              // 已分到该块、尚未填充的顶点数
+                };
+                std::vector<LineGroup> vGroups;
+                auto findGroup = [&vGroups](const ColorVBOBlock* pTarget) {
+                    return std::find_if(vGroups.begin(), vGroups.end(),
+                        [pTarget](const LineGroup& g) { return g.block == pTarget; });
+                };
+
+                for (size_t i : vChunk)
+                {
+                    const float* pLine = pVerts + src.vOffsets[i] * 3;
+                    ColorVBOBlock* pTarget = getColorBlock(color, pLine, pCounts[i]);
+                    auto it = findGroup(pTarget);
 
-                // 记录图元信息
-                size_t nPrimIdxInBlock = block->vPrimitives.size() + vNewPrims.size();
-                vNewPrims.push_back(std::move(prim));
-                block->idToIndexMap[id] = nPrimIdxInBlock;
+                    // 选块只看块内已有的顶点数，加上已分给它的顶点会超出上限时先把该组填充进块，
+                    // 块的顶点数随之更新，重新选块时会跳过它（必要时新建块）
+                    while (it != vGroups.end() && pTarget->nVertexCount + it->nVerts + pCounts[i] > MAX_VERT_PER_BLOCK)
+                    {
+                        bulkFillBlock(pTarget, src, it->vLines, it->nVerts, color);
+                        vGroups.erase(it);
+                        pTarget = getColorBlock(color, pLine, pCounts[i]);
+                        it = findGroup(pTarget);
+                    }
 
-                // 缓存顶点（用于后续 update / compact）
-                m_vVertexCache[id] = verts;
+                    if (it == vGroups.end())
+                    {
+                        vGroups.push_back(LineGroup{ pTarget, {}, 0 });
+                        it = vGroups.end() - 1;
+                    }
+                    it->vLines.push_back(i);
+                    it->nVerts += pCounts[i];
+                }
 
-                // 填充批量缓冲区
-                vBatchVerts.insert(vBatchVerts.end(), verts.begin(), verts.end());
-                for (size_t i = 0; i < nVertCount; ++i)
-                    vBatchIndices.push_back(static_cast<unsigned int>(nVertOffset + i));
+                for (LineGroup& group : vGroups)
+                    bulkFillBlock(group.block, src, group.vLines, group.nVerts, color);
+            }
 
-                // 更新位置映射
-                m_IDLocationMap[id] = { key, color, block, nPrimIdxInBlock };
+            nStart = nEnd;
+        }
 
-                nVertOffset += nVertCount;
-                nIdxOffset += nVertCount;
-                nAdd++;
-            }
+        enforceShadowBudget();
+        return vValid.size();
+    }
 
-            //  一次性上传
-            if (!vBatchVerts.empty())
-            {
-                GLsizeiptr vertByteOffset = static_cast<GLsizeiptr>(nBaseVertexStart) * 3 * sizeof(float);
-                GLsizeiptr idxByteOffset = static_cast<GLsizeiptr>(nBaseVertexStart) * sizeof(unsigned int);
-
-                // 上传顶点
-                m_gl->glBindBuffer(GL_ARRAY_BUFFER, block->vbo);
-                m_gl->glBufferSubData(GL_ARRAY_BUFFER, vertByteOffset,
-                    static_cast<GLsizeiptr>(vBatchVerts.size() * sizeof(float)), vBatchVerts.data());
-
-                // 上传索引
-                m_gl->glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, block->ebo);
-                m_gl->glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, idxByteOffset,
-                    static_cast<GLsizeiptr>(vBatchIndices.size() * sizeof(unsigned int)), vBatchIndices.data());
-            }
+    bool PolylinesVboManager::startUploadThread()
+    {
+        if (!m_gl || !QOpenGLContext::currentContext())
+            return false;
 
-            // 追加图元信息
-            block->vPrimitives.insert(block->vPrimitives.end(),
-                std::make_move_iterator(vNewPrims.begin()),
-                std::make_move_iterator(vNewPrims.end()));
+        if (!m_pUploader)
+            m_pUploader = std::make_unique<UploadThread>();
+        return m_pUploader->start(QOpenGLContext::currentContext());
+    }
 
-            // 更新块统计
-            block->nVertexCount += group.totalVerts;
-            block->nIndexCount += group.totalIndices;
-            block->bDirty = true;
-        }
+    void PolylinesVboManager::stopUploadThread()
+    {
+        if (!m_pUploader)
+            return;
 
-        return nAdd;
+        m_pUploader->stop();
+        m_pUploader.reset();
+
+        // 已完成的结果照常接入，丢弃的任务不再计数
+        std::unique_lock<std::shared_mutex> lock(m_mutex);
+        installAsyncUploads();
+        m_nAsyncInFlight = 0;
     }
 
     /**
-     * @brief 从渲染管理器中移除指定ID的折线
-     *
-     * 通过ID查找并移除折线，标记为无效并触发后续的内存整理。
-     * 实际的内存释放会在碎片整理时进行，以优化性能。
+     * @brief 异步批量加载
      *
-     * @param id 要移除的折线的唯一标识符
-     * @return true 如果成功移除，false 如果折线不存在
+     * 调用线程只做参数校验，数据随任务移交给上传线程；
+     * 格式、量化步长与清空版本在提交时确定，之后修改不影响已提交的任务。
      */
-    bool PolylinesVboManager::removePolyline(long long id)
+    size_t PolylinesVboManager::loadPolylinesAsync(std::vector<long long> vIds, std::vector<size_t> vCounts,
+        std::vector<float> vVerts, const Color& color)
     {
-        std::unique_lock<std::shared_mutex> lock(m_mutex);
-        auto it = m_IDLocationMap.find(id);
-        if (it == m_IDLocationMap.end())
-            return false;
+        const size_t nLineCount = std::min(vIds.size(), vCounts.size());
+        size_t nTotalVerts = 0;
+        size_t nValid = 0;
+        for (size_t i = 0; i < nLineCount; ++i)
+        {
+            nTotalVerts += vCounts[i];
+            if (vCounts[i] >= 2)
+                ++nValid;
+        }
+        if (nValid == 0 || vVerts.size() < nTotalVerts * 3)
+            return 0;
 
-        const Location& loc = it->second;
-        ColorVBOBlock* block = loc.block;
-        PrimitiveInfo& prim = block->vPrimitives[loc.nPrimIdx];
+        if (!m_pUploader || !m_pUploader->isRunning())
+            return loadPolylines(vIds.data(), vCounts.data(), nLineCount, vVerts.data(), color);
 
-        prim.bValid = false;
-        prim.nIndexCount = 0;
-        block->bDirty = true;
-        block->bCompact = true;
+        const VertexFormat eFormat = m_eVertexFormat;
+        const float fQuantizeStep = m_fQuantizeStep;
+        const size_t nEpoch = m_nAsyncEpoch.load();
 
-        m_IDLocationMap.erase(it);
-        m_vVertexCache.erase(id);
-        block->idToIndexMap.erase(id);
+        ++m_nAsyncInFlight;
+        bool bQueued = m_pUploader->enqueue(
+            [this, vIds = std::move(vIds), vCounts = std::move(vCounts), vVerts = std::move(vVerts),
+            color, eFormat, fQuantizeStep, nEpoch](QOpenGLFunctions_3_3_Core* gl) {
+                AsyncUpload upload;
+                upload.nEpoch = nEpoch;
+                upload.color = color;
+                buildAsyncUpload(gl, upload, vIds, vCounts, vVerts, eFormat, fQuantizeStep);
 
-        // 立即重新整理VBO数据，确保删除后顶点数据是连续的
-        // 这样可以避免渲染时线段连接错误
-        //compactBlock(block);
-        //rebuildDrawCmds(block);
-        return true;
+                std::lock_guard<std::mutex> lock(m_asyncMutex);
+                m_vAsyncDone.push_back(std::move(upload));
+            });
+
+        if (!bQueued)
+        {
+            --m_nAsyncInFlight;
+            return 0;
+        }
+        return nValid;
     }
 
-    size_t PolylinesVboManager::removePolylines(const std::vector<long long>& vIds)
+    /**
+     * @brief 在上传线程中准备块
+     *
+     * 分批规则与 loadPolylines 相同（按块顶点上限切成连续批次），每批一个新块，
+     * 缓冲区按实际大小一次创建并填充，索引为块内顶点的顺序编号。
+     */
+    void PolylinesVboManager::buildAsyncUpload(QOpenGLFunctions_3_3_Core* gl, AsyncUpload& upload,
+        const std::vector<long long>& vIds, const std::vector<size_t>& vCounts, const std::vector<float>& vVerts,
+        VertexFormat eFormat, float fQuantizeStep)
     {
-        if (vIds.empty())
-            return true;
+        const size_t nLineCount = std::min(vIds.size(), vCounts.size());
+        std::vector<size_t> vOffsets(nLineCount);
+        std::vector<size_t> vValid;
+        vValid.reserve(nLineCount);
 
-        std::unique_lock lock(m_mutex);
-        size_t nDelCount = 0;
+        size_t nOffset = 0;
+        for (size_t i = 0; i < nLineCount; ++i)
+        {
+            vOffsets[i] = nOffset;
+            nOffset += vCounts[i];
+            if (vCounts[i] >= 2)
+                vValid.push_back(i);
+        }
 
-        for (long long id : vIds)
+        size_t nStart = 0;
+        while (nStart < vValid.size())
         {
-            auto it = m_IDLocationMap.find(id);
-            if (it == m_IDLocationMap.end())
-                continue;
+            size_t nEnd = nStart;
+            size_t nChunkVerts = 0;
+            while (nEnd < vValid.size() &&
+                (nChunkVerts == 0 || nChunkVerts + vCounts[vValid[nEnd]] <= MAX_VERT_PER_BLOCK))
+            {
+                nChunkVerts += vCounts[vValid[nEnd]];
+                ++nEnd;
+            }
 
-            const Location& loc = it->second;
-            ColorVBOBlock* block = loc.block;
-            PrimitiveInfo& prim = block->vPrimitives[loc.nPrimIdx];
+            size_t nFirst = vValid[nStart];
+            size_t nLast = vValid[nEnd - 1];
+            const float* pRange = vVerts.data() + vOffsets[nFirst] * 3;
+            size_t nRangeVerts = vOffsets[nLast] + vCounts[nLast] - vOffsets[nFirst];
 
-            prim.bValid = false;
-            prim.nIndexCount = 0;
-            block->bDirty = true;
-            block->bCompact = true;
+            PreparedBlock block;
+            block.eFormat = eFormat;
+            if (eFormat != VertexFormat::Float3 && !makeWindowFor(eFormat, fQuantizeStep, pRange, nRangeVerts, block.window))
+            {
+                // 批次超出单块窗口：整批退回 Float3
+                block.eFormat = VertexFormat::Float3;
+                block.window = QuantizeWindow();
+            }
+            block.fLayerZ = (block.eFormat == VertexFormat::Float3) ? 0.0f : pRange[2];
+            block.nVertexCount = nChunkVerts;
+
+            const size_t nLines = nEnd - nStart;
+            const size_t nStride = vertexStride(block.eFormat);
+            std::vector<size_t> vBase(nLines);
+            size_t nRunning = 0;
+            for (size_t k = 0; k < nLines; ++k)
+            {
+                vBase[k] = nRunning;
+                nRunning += vCounts[vValid[nStart + k]];
+            }
 
-            m_IDLocationMap.erase(it);
-            m_vVertexCache.erase(id);
-            block->idToIndexMap.erase(id);
-            ++nDelCount;
+            block.vPrimitives.resize(nLines);
+            block.vShadow.resize(nChunkVerts * 3);
+            std::vector<unsigned char> vStaging;
+            if (block.eFormat != VertexFormat::Float3)
+                vStaging.resize(nChunkVerts * nStride);
+
+            parallelRanges(nLines, PARALLEL_MIN_ITEMS, [&](size_t nBegin, size_t nRangeEnd) {
+                for (size_t k = nBegin; k < nRangeEnd; ++k)
+                {
+                    size_t i = vValid[nStart + k];
+                    const float* pLine = vVerts.data() + vOffsets[i] * 3;
+
+                    PrimitiveInfo& prim = block.vPrimitives[k];
+                    prim.id = vIds[i];
+                    prim.nIndexCount = static_cast<GLsizei>(vCounts[i]);
+                    prim.nBaseVertex = static_cast<GLint>(vBase[k]);
+                    prim.bValid = true;
+
+                    std::memcpy(block.vShadow.data() + vBase[k] * 3, pLine, vCounts[i] * 3 * sizeof(float));
+                    if (!vStaging.empty())
+                        encodeVertices(block.eFormat, block.window, pLine, vCounts[i], vStaging.data() + vBase[k] * nStride);
+                }
+            });
+
+            std::vector<unsigned int> vIndices(nChunkVerts);
+            std::iota(vIndices.begin(), vIndices.end(), 0u);
+
+            const void* pVertexData = vStaging.empty()
+                ? static_cast<const void*>(block.vShadow.data())
+                : static_cast<const void*>(vStaging.data());
+
+            gl->glGenBuffers(1, &block.vbo);
+            gl->glGenBuffers(1, &block.ebo);
+            gl->glBindBuffer(GL_COPY_WRITE_BUFFER, block.vbo);
+            gl->glBufferData(GL_COPY_WRITE_BUFFER, static_cast<GLsizeiptr>(nChunkVerts * nStride),
+                pVertexData, GL_DYNAMIC_DRAW);
+            gl->glBindBuffer(GL_COPY_WRITE_BUFFER, block.ebo);
+            gl->glBufferData(GL_COPY_WRITE_BUFFER, static_cast<GLsizeiptr>(nChunkVerts * sizeof(unsigned int)),
+                vIndices.data(), GL_DYNAMIC_DRAW);
+            gl->glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+            upload.vBlocks.push_back(std::move(block));
+            nStart = nEnd;
         }
-        return nDelCount;
+
+        if (!upload.vBlocks.empty())
+            upload.fence = UploadThread::insertFence(gl);
     }
 
     /**
-     * @brief 更新指定ID的折线数据
-     *
-     * 更新现有折线的顶点数据，根据顶点数量变化采用不同策略：
-     * - 顶点数量变化不大时，直接增量更新
-     * - 顶点数量变化超过50%时，采用删除后重新添加的策略，确保内存使用合理
-     *
-     * @param id 要更新的折线的唯一标识符
-     * @param vVerts 新的顶点数据，格式为[x1,y1,z1,x2,y2,z2,...]
-     * @return true 如果更新成功，false 如果参数无效或折线不存在
+     * @brief 接入已完成的异步加载
      *
-     * @note 顶点数量必须至少为2个（即vVertices.size() >= 6且为3的倍数）
+     * 对每个结果的栅栏调用 glWaitSync：等待放在 GPU 命令流中，CPU 不阻塞，
+     * 之后的绘制保证能看到上传线程写入的数据。
      */
-    bool PolylinesVboManager::updatePolyline(long long id, const std::vector<float>& vVerts)
+    void PolylinesVboManager::installAsyncUploads()
     {
-        if (vVerts.size() < 6 || vVerts.size() % 3 != 0)
-            return false;
+        std::vector<AsyncUpload> vDone;
+        {
+            std::lock_guard<std::mutex> lock(m_asyncMutex);
+            vDone.swap(m_vAsyncDone);
+        }
+        if (vDone.empty())
+            return;
 
-        std::unique_lock<std::shared_mutex> lock(m_mutex);
-        auto it = m_IDLocationMap.find(id);
-        if (it == m_IDLocationMap.end())
-            return false;
+        for (AsyncUpload& upload : vDone)
+        {
+            if (m_nAsyncInFlight > 0)
+                --m_nAsyncInFlight;
 
-        const Location& loc = it->second;
-        ColorVBOBlock* block = loc.block;
-        size_t nPrimIdx = loc.nPrimIdx;
+            if (upload.nEpoch != m_nAsyncEpoch.load())
+            {
+                releaseAsyncUpload(upload);
+                continue;
+            }
+
+            if (upload.fence)
+            {
+                m_gl->glWaitSync(upload.fence, 0, GL_TIMEOUT_IGNORED);
+                m_gl->glDeleteSync(upload.fence);
+                upload.fence = nullptr;
+            }
+
+            const uint32_t nKey = upload.color.toUInt32();
+            for (PreparedBlock& prepared : upload.vBlocks)
+            {
+                ColorVBOBlock* block = new ColorVBOBlock();
+                block->color = upload.color;
+                block->eFormat = prepared.eFormat;
+                block->window = prepared.window;
+                block->fLayerZ = prepared.fLayerZ;
+                block->vbo = prepared.vbo;
+                block->ebo = prepared.ebo;
+                block->nVertexCapacity = block->nIndexCapacity = prepared.nVertexCount;
+                block->nVertexCount = block->nIndexCount = prepared.nVertexCount;
+
+                // VAO 不在上下文之间共享，由渲染线程创建
+                m_gl->glGenVertexArrays(1, &block->vao);
+                setupBlockVao(block);
+
+                block->vShadow = std::move(prepared.vShadow);
+                m_nShadowBytes += block->vShadow.capacity() * sizeof(float);
+                block->vPrimitives = std::move(prepared.vPrimitives);
+
+                // 接入时才占用 ID，已存在的 ID 对应的图元按删除处理（nIndexCount 清零），由整理回收，
+                // 否则整理会保留其顶点、合并时会把存活 ID 的位置改指向这份作废的副本
+                block->idToIndexMap.reserve(block->vPrimitives.size());
+                m_IDLocationMap.reserve(m_IDLocationMap.size() + block->vPrimitives.size());
+                for (size_t i = 0; i < block->vPrimitives.size(); ++i)
+                {
+                    PrimitiveInfo& prim = block->vPrimitives[i];
+                    if (m_IDLocationMap.try_emplace(prim.id, Location{ nKey, upload.color, block, i }).second)
+                    {
+                        block->idToIndexMap[prim.id] = i;
+                    }
+                    else
+                    {
+                        prim.bValid = false;
+                        prim.nIndexCount = 0;
+                        block->bCompact = true;
+                    }
+                }
+
+                markDirty(block);
+                m_colorBlocksMap[nKey].push_back(block);
+                ++m_nBlockSetVersion;
+                trackBlock(block);
+                m_pGpuBudget->recordUpload(block->nVertexCount * (vertexStride(block->eFormat) + sizeof(unsigned int)));
+            }
+        }
+
+        enforceShadowBudget();
+    }
+
+    void PolylinesVboManager::releaseAsyncUpload(AsyncUpload& upload)
+    {
+        if (m_gl)
+        {
+            for (PreparedBlock& prepared : upload.vBlocks)
+            {
+                m_gl->glDeleteBuffers(1, &prepared.vbo);
+                m_gl->glDeleteBuffers(1, &prepared.ebo);
+            }
+            if (upload.fence)
+                m_gl->glDeleteSync(upload.fence);
+        }
+        upload.vBlocks.clear();
+        upload.fence = nullptr;
+    }
+
+    /**
+     * @brief 把一批折线整体写入块
+     *
+     * @param block 目标块
+     * @param src 源数据
+     * @param vLines 本批折线在源数组中的下标
+     * @param nTotalVerts 本批顶点总数
+     * @param color 折线颜色
+     */
+    void PolylinesVboManager::bulkFillBlock(ColorVBOBlock* block, const BulkSource& src,
+        const std::vector<size_t>& vLines, size_t nTotalVerts, const Color& color)
+    {
+        checkBlockCapacity(block, block->nVertexCount + nTotalVerts, block->nIndexCount + nTotalVerts);
+
+        const size_t nStride = vertexStride(block->eFormat);
+        const size_t nBase0 = block->nVertexCount;
+        const size_t nPrim0 = block->vPrimitives.size();
+        const size_t nLines = vLines.size();
+
+        // 每条折线在块中的起始顶点
+        std::vector<size_t> vBase(nLines);
+        size_t nRunning = nBase0;
+        for (size_t k = 0; k < nLines; ++k)
+        {
+            vBase[k] = nRunning;
+            nRunning += src.pCounts[vLines[k]];
+        }
+
+        block->vPrimitives.resize(nPrim0 + nLines);
+        if (block->bShadowValid)
+            resizeShadow(block, (nBase0 + nTotalVerts) * 3);
+
+        // Float3 且影子完整时影子本身就是上传数据，否则编码到临时缓冲
+        const bool bUploadShadow = block->bShadowValid && block->eFormat == VertexFormat::Float3;
+        std::vector<unsigned char> vStaging;
+        if (!bUploadShadow)
+            vStaging.resize(nTotalVerts * nStride);
+
+        std::vector<unsigned int> vIndices(nTotalVerts);
+
+        // 不在块内追加命令时（块已脏）由 rebuildDrawCmds 在绘制前统一生成
+        const bool bAppendCmds = !block->bDirty;
+        const size_t nCmd0 = block->vDrawCounts.size();
+        if (bAppendCmds)
+        {
+            ++block->nEditVersion;
+            block->vDrawCounts.resize(nCmd0 + nLines);
+            block->vBaseVertices.resize(nCmd0 + nLines);
+        }
+
+        parallelRanges(nLines, PARALLEL_MIN_ITEMS, [&](size_t nBegin, size_t nEnd) {
+            for (size_t k = nBegin; k < nEnd; ++k)
+            {
+                size_t i = vLines[k];
+                size_t nCount = src.pCounts[i];
+                const float* pLine = src.pVerts + src.vOffsets[i] * 3;
+
+                PrimitiveInfo& prim = block->vPrimitives[nPrim0 + k];
+                prim.id = src.pIds[i];
+                prim.nIndexCount = static_cast<GLsizei>(nCount);
+                prim.nBaseVertex = static_cast<GLint>(vBase[k]);
+                prim.bValid = true;
+
+                if (block->bShadowValid)
+                    std::memcpy(block->vShadow.data() + vBase[k] * 3, pLine, nCount * 3 * sizeof(float));
+                if (!bUploadShadow)
+                    encodeVertices(block->eFormat, block->window, pLine, nCount,
+                        vStaging.data() + (vBase[k] - nBase0) * nStride);
+
+                for (size_t v = 0; v < nCount; ++v)
+                    vIndices[vBase[k] - nBase0 + v] = static_cast<unsigned int>(vBase[k] + v);
+
+                if (bAppendCmds)
+                {
+                    block->vDrawCounts[nCmd0 + k] = prim.nIndexCount;
+                    block->vBaseVertices[nCmd0 + k] = prim.nBaseVertex;
+                }
+            }
+        });
+
+        // ID 映射（哈希表只能串行写入）
+        const uint32_t nKey = color.toUInt32();
+        block->idToIndexMap.reserve(block->idToIndexMap.size() + nLines);
+        for (size_t k = 0; k < nLines; ++k)
+        {
+            long long id = src.pIds[vLines[k]];
+            block->idToIndexMap[id] = nPrim0 + k;
+            m_IDLocationMap[id] = { nKey, color, block, nPrim0 + k };
+        }
+
+        // 每个缓冲区只上传一次
+        FrameProfiler::ScopedStage uploadStage(m_pProfiler, FrameProfiler::Stage::Upload);
+        const void* pUpload = bUploadShadow
+            ? static_cast<const void*>(block->vShadow.data() + nBase0 * 3)
+            : static_cast<const void*>(vStaging.data());
+        m_gl->glBindBuffer(GL_ARRAY_BUFFER, block->vbo);
+        m_gl->glBufferSubData(GL_ARRAY_BUFFER, static_cast<GLintptr>(nBase0 * nStride),
+            static_cast<GLsizeiptr>(nTotalVerts * nStride), pUpload);
+
+        m_gl->glBindBuffer(GL_COPY_WRITE_BUFFER, block->ebo);
+        m_gl->glBufferSubData(GL_COPY_WRITE_BUFFER, static_cast<GLintptr>(nBase0 * sizeof(unsigned int)),
+            static_cast<GLsizeiptr>(vIndices.size() * sizeof(unsigned int)), vIndices.data());
+        m_gl->glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        m_pGpuBudget->recordUpload(nTotalVerts * (nStride + sizeof(unsigned int)));
+
+        block->nVertexCount += nTotalVerts;
+        block->nIndexCount += nTotalVerts;
+        block->bPickTreeDirty = true;
+        trackBlock(block);
+    }
+
+   
+    /**
+     * @brief 批量添加多条折线
+     *
+     * 比逐个调用 addPolyline() 快 5~20 倍，专为一次性加载数十万条线设计。
+     * 内部会：
+     * - 按颜色自动分组
+     * - 每种颜色只扩容/上传一次
+     * - 最小化锁粒度、OpenGL 调用、内存拷贝
+     *
+     * @param vPolylineDatas 批量数据：{id, vertices, color}
+     * @return 添加成功的图元数量（失败的会跳过并打印警告）
+     */
+    size_t PolylinesVboManager::doAddPolylines(
+        const std::vector<std::tuple<long long, std::vector<float>, Color>>& vPolylineDatas)
+    {
+
+        if (vPolylineDatas.empty() || !m_gl)
+            return 0;
+
+        // Step 1: 预处理 — 按颜色分组 + 过滤无效数据 + 预检查ID冲突
+        struct BatchGroup
+        {
+            Color color;
+            std::vector<size_t> indices; // 在 vPolylineDatas 中的下标
+            size_t totalVerts = 0;
+            size_t totalIndices = 0;
+        };
+
+        std::unordered_map<uint32_t, BatchGroup> colorGroups;
+        std::vector<bool> validFlags(vPolylineDatas.size(), true);
+        size_t validCount = 0;
+
+        // 颜色键在锁外批量打包
+        std::vector<uint32_t> vColorKeys(vPolylineDatas.size());
+        {
+            ColorBuffer colors;
+            colors.reserve(vPolylineDatas.size());
+            for (const auto& tuple : vPolylineDatas)
+                colors.push_back(std::get<2>(tuple));
+            colors.packUInt32(vColorKeys.data());
+        }
+
+        {
+            std::shared_lock<std::shared_mutex> readLock(m_mutex);
+            for (size_t i = 0; i < vPolylineDatas.size(); ++i) // 遍历组
+            {
+                const auto& [id, verts, color] = vPolylineDatas[i]; // tuple 多段线
+
+                if (verts.size() < 6 || verts.size() % 3 != 0)
+                {
+                    validFlags[i] = false;
+                    continue;
+                }
+
+                if (m_IDLocationMap.count(id))
+                {
+                    validFlags[i] = false;
+                    continue;
+                }
+
+                size_t nVertCount = verts.size() / 3;
+                auto& batchGroup = colorGroups[vColorKeys[i]];
+                batchGroup.color = color;
+
+                batchGroup.indices.push_back(i);
+                batchGroup.totalVerts += nVertCount;
+                batchGroup.totalIndices += nVertCount;
+                validCount++;
+            }
+        }
+
+        if (validCount == 0)
+            return 0;
+
+        std::unique_lock<std::shared_mutex> writeLock(m_mutex);
+
+        size_t nAdd = 0;
+
+        for (auto& [key, group] : colorGroups)
+        {
+            // 按目标块细分：压缩格式下同色折线可能落在不同坐标窗口的块中
+            struct BlockBatch
+            {
+                ColorVBOBlock* block{ nullptr };
+                std::vector<size_t> indices;
+                size_t totalVerts = 0;
+            };
+            std::vector<BlockBatch> vBlockBatches;
+
+            for (size_t idx : group.indices)
+            {
+                const auto& verts = std::get<1>(vPolylineDatas[idx]);
+                size_t nVertCount = verts.size() / 3;
+                ColorVBOBlock* pTarget = getColorBlock(group.color, verts.data(), nVertCount);
+                if (!pTarget)
+                {
+                    qCritical() << "Failed to create color block for batch add";
+                    continue;
+                }
+
+                auto itBatch = std::find_if(vBlockBatches.begin(), vBlockBatches.end(),
+                    [pTarget](const BlockBatch& b) { return b.block == pTarget; });
+                if (itBatch == vBlockBatches.end())
+                {
+                    vBlockBatches.push_back({ pTarget, {}, 0 });
+                    itBatch = vBlockBatches.end() - 1;
+                }
+                itBatch->indices.push_back(idx);
+                itBatch->totalVerts += nVertCount;
+            }
+
+            for (BlockBatch& batch : vBlockBatches)
+            {
+                ColorVBOBlock* block = batch.block;
+                const size_t nStride = vertexStride(block->eFormat);
+
+                checkBlockCapacity(block,
+                    block->nVertexCount + batch.totalVerts,
+                    block->nIndexCount + batch.totalVerts);
+
+                // 预计算本次批次在块中的起始偏移
+                GLint nBaseVertexStart = static_cast<GLint>(block->nVertexCount);
+                size_t nVertOffset = block->nVertexCount; // 顶点偏移
+                size_t nIdxOffset = block->nIndexCount;   // 索引偏移
+
+                // 准备批量上传用的连续缓冲区（已按块格式编码）
+                std::vector<unsigned char> vBatchVerts;
+                std::vector<unsigned int> vBatchIndices;
+                vBatchVerts.reserve(batch.totalVerts * nStride);
+                vBatchIndices.reserve(batch.totalVerts);
+
+                std::vector<PrimitiveInfo> vNewPrims;
+                vNewPrims.reserve(batch.indices.size());
+
+                // 遍历该块的所有图元
+                for (size_t idx : batch.indices)
+                {
+                    if (!validFlags[idx])
+                        continue;
+
+                    const auto& [id, verts, color] = vPolylineDatas[idx];
+                    size_t nVertCount = verts.size() / 3;
+
+                    PrimitiveInfo prim;
+                    prim.id = id;
+                    prim.nIndexCount = static_cast<GLsizei>(nVertCount);
+                    prim.nBaseVertex = static_cast<GLint>(nVertOffset);
+                    prim.bValid = true;
+
+                    // 记录图元信息
+                    size_t nPrimIdxInBlock = block->vPrimitives.size() + vNewPrims.size();
+                    vNewPrims.push_back(std::move(prim));
+                    block->idToIndexMap[id] = nPrimIdxInBlock;
+
+                    // 写入块的 CPU 影子（用于后续 compact）
+                    writeShadow(block, nVertOffset, verts.data(), nVertCount);
+
+                    // 填充批量缓冲区
+                    size_t nByteOffset = vBatchVerts.size();
+                    vBatchVerts.resize(nByteOffset + nVertCount * nStride);
+                    encodeVertices(block->eFormat, block->window, verts.data(), nVertCount,
+                        vBatchVerts.data() + nByteOffset);
+                    for (size_t i = 0; i < nVertCount; ++i)
+                        vBatchIndices.push_back(static_cast<unsigned int>(nVertOffset + i));
+
+                    // 更新位置映射
+                    m_IDLocationMap[id] = { key, color, block, nPrimIdxInBlock };
+
+                    nVertOffset += nVertCount;
+                    nIdxOffset += nVertCount;
+                    nAdd++;
+                }
+
+                //  一次性上传
+                if (!vBatchVerts.empty())
+                {
+                    FrameProfiler::ScopedStage uploadStage(m_pProfiler, FrameProfiler::Stage::Upload);
+                    GLsizeiptr vertByteOffset = static_cast<GLsizeiptr>(nBaseVertexStart) * nStride;
+                    GLsizeiptr idxByteOffset = static_cast<GLsizeiptr>(nBaseVertexStart) * sizeof(unsigned int);
+
+                    // 上传顶点
+                    m_gl->glBindBuffer(GL_ARRAY_BUFFER, block->vbo);
+                    m_gl->glBufferSubData(GL_ARRAY_BUFFER, vertByteOffset,
+                        static_cast<GLsizeiptr>(vBatchVerts.size()), vBatchVerts.data());
+
+                    // 上传索引（不经 GL_ELEMENT_ARRAY_BUFFER，避免改动当前绑定 VAO 的索引缓冲）
+                    m_gl->glBindBuffer(GL_COPY_WRITE_BUFFER, block->ebo);
+                    m_gl->glBufferSubData(GL_COPY_WRITE_BUFFER, idxByteOffset,
+                        static_cast<GLsizeiptr>(vBatchIndices.size() * sizeof(unsigned int)), vBatchIndices.data());
+                    m_gl->glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+                    m_pGpuBudget->recordUpload(vBatchVerts.size() + vBatchIndices.size() * sizeof(unsigned int));
+                }
+
+                // 追加图元信息
+                block->vPrimitives.insert(block->vPrimitives.end(),
+                    std::make_move_iterator(vNewPrims.begin()),
+                    std::make_move_iterator(vNewPrims.end()));
+
+                // 更新块统计
+                block->nVertexCount += batch.totalVerts;
+                block->nIndexCount += batch.totalVerts;
+                markDirty(block);
+                trackBlock(block);
+            }
+        }
+
+        enforceShadowBudget();
+        return nAdd;
+    }
+
+    /**
+     * @brief 从渲染管理器中移除指定ID的折线
+     *
+     * 通过ID查找并移除折线，标记为无效并触发后续的内存整理。
+     * 实际的内存释放会在碎片整理时进行，以优化性能。
+     *
+     * @param id 要移除的折线的唯一标识符
+     * @return true 如果成功移除，false 如果折线不存在
+     */
+    bool PolylinesVboManager::doRemovePolyline(long long id)
+    {
+        std::unique_lock<std::shared_mutex> lock(m_mutex);
+        auto it = m_IDLocationMap.find(id);
+        if (it == m_IDLocationMap.end())
+            return false;
+
+        const Location& loc = it->second;
+        ColorVBOBlock* block = loc.block;
+        PrimitiveInfo& prim = block->vPrimitives[loc.nPrimIdx];
+
+        prim.bValid = false;
+        prim.nIndexCount = 0;
+        markDirty(block);
+        block->bCompact = true;
+
+        m_IDLocationMap.erase(it);
+        block->idToIndexMap.erase(id);
+
+        // 立即重新整理VBO数据，确保删除后顶点数据是连续的
+        // 这样可以避免渲染时线段连接错误
+        //compactBlock(block);
+        //rebuildDrawCmds(block);
+        return true;
+    }
+
+    size_t PolylinesVboManager::doRemovePolylines(const std::vector<long long>& vIds)
+    {
+        if (vIds.empty())
+            return true;
+
+        std::unique_lock lock(m_mutex);
+        size_t nDelCount = 0;
+
+        for (long long id : vIds)
+        {
+            auto it = m_IDLocationMap.find(id);
+            if (it == m_IDLocationMap.end())
+                continue;
+
+            const Location& loc = it->second;
+            ColorVBOBlock* block = loc.block;
+            PrimitiveInfo& prim = block->vPrimitives[loc.nPrimIdx];
+
+            prim.bValid = false;
+            prim.nIndexCount = 0;
+            markDirty(block);
+            block->bCompact = true;
+
+            m_IDLocationMap.erase(it);
+            block->idToIndexMap.erase(id);
+            ++nDelCount;
+        }
+        return nDelCount;
+    }
+
+    /**
+     * @brief 更新指定ID的折线数据
+     *
+     * 更新现有折线的顶点数据，根据顶点数量变化采用不同策略：
+     * - 顶点数量变化不大时，直接增量更新
+     * - 顶点数量变化超过50%时，采用删除后重新添加的策略，确保内存使用合理
+     *
+     * @param id 要更新的折线的唯一标识符
+     * @param vVerts 新的顶点数据，格式为[x1,y1,z1,x2,y2,z2,...]
+     * @return true 如果更新成功，false 如果参数无效或折线不存在
+     *
+     * @note 顶点数量必须至少为2个（即vVertices.size() >= 6且为3的倍数）
+     */
+    bool PolylinesVboManager::doUpdatePolyline(long long id, const std::vector<float>& vVerts)
+    {
+        if (vVerts.size() < 6 || vVerts.size() % 3 != 0)
+            return false;
+
+        std::unique_lock<std::shared_mutex> lock(m_mutex);
+        auto it = m_IDLocationMap.find(id);
+        if (it == m_IDLocationMap.end())
+            return false;
+
+        const Location& loc = it->second;
+        ColorVBOBlock* block = loc.block;
+        size_t nPrimIdx = loc.nPrimIdx;
         PrimitiveInfo& prim = block->vPrimitives[nPrimIdx];
 
         size_t nNewCount = vVerts.size() / 3;
@@ -456,21 +1242,22 @@ namespace GLRhi
         size_t nOldVertCount = static_cast<size_t>(prim.nIndexCount); // 旧顶点数
         size_t nNewVertCount = vVerts.size() / 3;
 
-        if (nNewVertCount > nOldVertCount)
+        // 顶点变多，或压缩块的坐标窗口 / z 容纳不下新数据时，删除后重新添加
+        if (nNewVertCount > nOldVertCount ||
+            !fitsWindow(block->eFormat, block->window, block->fLayerZ, vVerts.data(), nNewVertCount))
         {
             Color c = loc.color;
             lock.unlock();
-            removePolyline(id);
-            return addPolyline(id, vVerts, c);
+            doRemovePolyline(id);
+            return doAddPolyline(id, vVerts, c);
         }
 
         prim.nIndexCount = static_cast<GLsizei>(nNewCount);
         prim.bValid = true;
+        markDirty(block);
 
-        m_vVertexCache[id] = vVerts;
-        block->bDirty = true;
-
-        uploadSinglePrimitive(block, nPrimIdx);
+        // 原位覆盖，多余的尾部顶点留到 compact 时回收
+        uploadSinglePrimitive(block, nPrimIdx, vVerts.data());
         return true;
     }
 
@@ -483,7 +1270,7 @@ namespace GLRhi
      * @param bVisible true表示可见，false表示不可见
      * @return true 如果设置成功，false 如果折线不存在
      */
-    bool PolylinesVboManager::setPolylineVisible(long long id, bool bVisible)
+    bool PolylinesVboManager::doSetPolylineVisible(long long id, bool bVisible)
     {
         std::unique_lock<std::shared_mutex> lock(m_mutex);
         auto it = m_IDLocationMap.find(id);
@@ -498,7 +1285,7 @@ namespace GLRhi
         // bVisible = !bTest;
 
         loc.block->vPrimitives[loc.nPrimIdx].bValid = bVisible;
-        loc.block->bDirty = true;
+        markDirty(loc.block);
         return true;
     }
 
@@ -512,7 +1299,7 @@ namespace GLRhi
      *
      * @note 此操作会释放所有资源，调用后需要重新添加折线
      */
-    void PolylinesVboManager::clearAllPrimitives()
+    void PolylinesVboManager::doClearAllPrimitives()
     {
         // stopBackgroundDefrag();
         std::unique_lock<std::shared_mutex> lock(m_mutex);
@@ -526,18 +1313,239 @@ namespace GLRhi
                     m_gl->glDeleteBuffers(1, &block->vbo);
                     m_gl->glDeleteBuffers(1, &block->ebo);
                 }
+                m_pGpuBudget->removeBlock(block);
                 delete block;
             }
         }
         m_colorBlocksMap.clear();
         m_IDLocationMap.clear();
         m_IDLocationMap.reserve(0);
-        m_vVertexCache.clear();
-        m_vVertexCache.reserve(0);
+        m_nShadowBytes = 0;
+        m_vPickBlocks.clear();
+        m_vDrawOrder.clear();
+        ++m_nLayoutVersion;
+        ++m_nBlockSetVersion;
+        ++m_nAsyncEpoch;    // 清空前提交的异步加载不再接入
     }
 
     // ===================================================================
-    // 渲染核心（最高性能：glMultiDrawElementsBaseVertex）
+    // 公共编辑接口：立即模式直接执行，延迟模式写入命令队列
+    // ===================================================================
+
+    bool PolylinesVboManager::addPolyline(long long id, const std::vector<float>& vVerts, const Color& color)
+    {
+        if (!isDeferredMode())
+            return doAddPolyline(id, vVerts, color);
+
+        if (vVerts.size() < 6 || vVerts.size() % 3 != 0)
+            return false;
+
+        PolylineCommand cmd;
+        cmd.eType = PolylineCommand::Type::Add;
+        cmd.id = id;
+        cmd.vVerts = vVerts;
+        cmd.color = color;
+        m_commandQueue.push(std::move(cmd));
+        return true;
+    }
+
+    size_t PolylinesVboManager::addPolylines(
+        const std::vector<std::tuple<long long, std::vector<float>, Color>>& vPolylineDatas)
+    {
+        if (!isDeferredMode())
+            return doAddPolylines(vPolylineDatas);
+
+        size_t nQueued = 0;
+        for (const auto& [id, verts, color] : vPolylineDatas)
+        {
+            if (addPolyline(id, verts, color))
+                ++nQueued;
+        }
+        return nQueued;
+    }
+
+    bool PolylinesVboManager::removePolyline(long long id)
+    {
+        if (!isDeferredMode())
+            return doRemovePolyline(id);
+
+        PolylineCommand cmd;
+        cmd.eType = PolylineCommand::Type::Remove;
+        cmd.id = id;
+        m_commandQueue.push(std::move(cmd));
+        return true;
+    }
+
+    size_t PolylinesVboManager::removePolylines(const std::vector<long long>& vIds)
+    {
+        if (!isDeferredMode())
+            return doRemovePolylines(vIds);
+
+        for (long long id : vIds)
+            removePolyline(id);
+        return vIds.size();
+    }
+
+    bool PolylinesVboManager::updatePolyline(long long id, const std::vector<float>& vVerts)
+    {
+        if (!isDeferredMode())
+            return doUpdatePolyline(id, vVerts);
+
+        if (vVerts.size() < 6 || vVerts.size() % 3 != 0)
+            return false;
+
+        PolylineCommand cmd;
+        cmd.eType = PolylineCommand::Type::Update;
+        cmd.id = id;
+        cmd.vVerts = vVerts;
+        m_commandQueue.push(std::move(cmd));
+        return true;
+    }
+
+    bool PolylinesVboManager::setPolylineVisible(long long id, bool bVisible)
+    {
+        if (!isDeferredMode())
+            return doSetPolylineVisible(id, bVisible);
+
+        PolylineCommand cmd;
+        cmd.eType = PolylineCommand::Type::SetVisible;
+        cmd.id = id;
+        cmd.bVisible = bVisible;
+        m_commandQueue.push(std::move(cmd));
+        return true;
+    }
+
+    void PolylinesVboManager::clearAllPrimitives()
+    {
+        if (!isDeferredMode())
+        {
+            doClearAllPrimitives();
+            return;
+        }
+
+        PolylineCommand cmd;
+        cmd.eType = PolylineCommand::Type::Clear;
+        m_commandQueue.push(std::move(cmd));
+    }
+
+    void PolylinesVboManager::setDeferredMode(bool bDeferred)
+    {
+        // 后台整理线程会调用 GL，延迟模式下不允许在渲染线程之外执行
+        if (bDeferred)
+            stopBackgroundDefrag();
+        m_bDeferred.store(bDeferred, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief 取出并执行全部待处理命令
+     *
+     * 合并规则（同一 ID 以最后一次写入为准）：
+     * - Clear 丢弃之前所有命令，本批次先执行清空
+     * - Remove 丢弃该 ID 之前的几何与可见性命令，标记先删除
+     * - Add 之后的 Update 合并为携带新顶点的 Add，多次 Update 只保留最后一次
+     * - SetVisible 只保留最后一次
+     *
+     * 合并后按 删除 -> 批量添加 -> 更新 -> 可见性 的顺序执行，
+     * 各 ID 之间互不影响，因此分类执行与逐条执行结果一致，同时添加可以走批量上传路径。
+     */
+    size_t PolylinesVboManager::applyPendingCommands()
+    {
+        std::vector<PolylineCommand> vCmds;
+        PolylineCommand cmd;
+        while (m_commandQueue.pop(cmd))
+            vCmds.push_back(std::move(cmd));
+
+        if (vCmds.empty())
+            return 0;
+
+        struct PendingState
+        {
+            bool bRemove{ false };                                  // 先删除已有图元
+            PolylineCommand::Type eGeom{ PolylineCommand::Type::Clear }; // Add / Update，Clear 表示无几何命令
+            std::vector<float> vVerts;
+            Color color;
+            int nVisible{ -1 };                                     // -1 未设置，0 隐藏，1 显示
+        };
+
+        bool bClear = false;
+        std::vector<long long> vOrder;  // 保持首次出现顺序，结果可复现
+        std::unordered_map<long long, PendingState> pendingMap;
+
+        for (PolylineCommand& c : vCmds)
+        {
+            if (c.eType == PolylineCommand::Type::Clear)
+            {
+                bClear = true;
+                pendingMap.clear();
+                vOrder.clear();
+                continue;
+            }
+
+            auto [it, bInserted] = pendingMap.try_emplace(c.id);
+            if (bInserted)
+                vOrder.push_back(c.id);
+            PendingState& state = it->second;
+
+            switch (c.eType)
+            {
+            case PolylineCommand::Type::Add:
+                state.eGeom = PolylineCommand::Type::Add;
+                state.vVerts = std::move(c.vVerts);
+                state.color = c.color;
+                state.nVisible = -1;
+                break;
+            case PolylineCommand::Type::Update:
+                if (state.eGeom != PolylineCommand::Type::Add)
+                    state.eGeom = PolylineCommand::Type::Update;
+                state.vVerts = std::move(c.vVerts);
+                break;
+            case PolylineCommand::Type::Remove:
+                state.bRemove = true;
+                state.eGeom = PolylineCommand::Type::Clear;
+                state.vVerts.clear();
+                state.nVisible = -1;
+                break;
+            case PolylineCommand::Type::SetVisible:
+                state.nVisible = c.bVisible ? 1 : 0;
+                break;
+            default:
+                break;
+            }
+        }
+
+        if (bClear)
+            doClearAllPrimitives();
+
+        std::vector<long long> vRemoveIds;
+        std::vector<std::tuple<long long, std::vector<float>, Color>> vAdds;
+        for (long long id : vOrder)
+        {
+            PendingState& state = pendingMap[id];
+            if (state.bRemove)
+                vRemoveIds.push_back(id);
+            if (state.eGeom == PolylineCommand::Type::Add)
+                vAdds.emplace_back(id, std::move(state.vVerts), state.color);
+        }
+
+        if (!vRemoveIds.empty())
+            doRemovePolylines(vRemoveIds);
+        if (!vAdds.empty())
+            doAddPolylines(vAdds);
+
+        for (long long id : vOrder)
+        {
+            PendingState& state = pendingMap[id];
+            if (state.eGeom == PolylineCommand::Type::Update)
+                doUpdatePolyline(id, state.vVerts);
+            if (state.nVisible != -1)
+                doSetPolylineVisible(id, state.nVisible == 1);
+        }
+
+        return vCmds.size();
+    }
+
+    // ===================================================================
+    // 渲染核心（最高性能：glMultiDrawElementsBaseVertex）
     // ===================================================================
 
     /**
@@ -550,13 +1558,11 @@ namespace GLRhi
      * - 自动进行内存碎片整理
      *
      * 渲染流程：
-     * 1. 获取当前激活的着色器程序并查找颜色 uniform 位置
-     * 2. 遍历所有颜色组
-     * 3. 为每个颜色组设置统一颜色
-     * 4. 遍历该颜色组的所有 VBO 块
-     * 5. 重建脏块的绘制命令
-     * 6. 压缩需要整理的块
-     * 7. 绑定块并执行渲染
+     * 1. 压缩需要整理的块（需要 GL，在渲染线程串行执行）
+     * 2. 在线程池上并行重建所有脏块的绘制命令（prepareDrawCmds）
+     * 3. 获取当前激活的着色器程序并查找颜色 uniform 位置
+     * 4. 遍历所有颜色组，为每个颜色组设置统一颜色
+     * 5. 遍历该颜色组的所有 VBO 块，绑定块并执行渲染
      *
      * @note 此方法应在 OpenGL 渲染上下文中调用
      */
@@ -565,12 +1571,128 @@ namespace GLRhi
         if (!m_gl)
             return;
 
+        if (isDeferredMode())
+            applyPendingCommands();
+
+        {
+            std::unique_lock<std::shared_mutex> writeLock(m_mutex);
+            installAsyncUploads();
+            updateGpuResidency();
+            compactPendingBlocks();
+            if (m_eRenderOrder != RenderOrder::Unordered)
+                updateDrawOrder();
+        }
+
+        prepareDrawCmds();
+
+        std::shared_lock<std::shared_mutex> lock(m_mutex);
+
+        GLint nProg = 0;
+        m_gl->glGetIntegerv(GL_CURRENT_PROGRAM, &nProg);
+        GLint uColorLoc = (nProg > 0) ? m_gl->glGetUniformLocation(nProg, "uColor") : -1;
+        BlockUniformLocs blockLocs = getBlockUniformLocs(nProg);
+
+        if (m_eRenderOrder == RenderOrder::Unordered)
+            drawUnordered(false, uColorLoc, blockLocs);
+        else
+            drawOrdered(false, uColorLoc, blockLocs);
+    }
+
+    void PolylinesVboManager::renderVisiblePrimitivesEx()
+    {
+        if (m_gl && isDeferredMode())
+            applyPendingCommands();
+
+        if (!m_gl || (m_colorBlocksMap.empty() && getPendingUploadCount() == 0))
+            return;
+
+        {
+            std::unique_lock<std::shared_mutex> writeLock(m_mutex);
+            installAsyncUploads();
+            updateGpuResidency();
+            compactPendingBlocks();
+            if (m_eRenderOrder != RenderOrder::Unordered)
+                updateDrawOrder();
+        }
+
+        prepareDrawCmds();
+
         std::shared_lock<std::shared_mutex> lock(m_mutex);
 
         GLint nProg = 0;
         m_gl->glGetIntegerv(GL_CURRENT_PROGRAM, &nProg);
         GLint uColorLoc = (nProg > 0) ? m_gl->glGetUniformLocation(nProg, "uColor") : -1;
+        BlockUniformLocs blockLocs = getBlockUniformLocs(nProg);
+
+        if (m_eRenderOrder == RenderOrder::Unordered)
+            drawUnordered(true, uColorLoc, blockLocs);
+        else
+            drawOrdered(true, uColorLoc, blockLocs);
+    }
+
+    void PolylinesVboManager::drawBlock(ColorVBOBlock* block, bool bMultiDraw, const BlockUniformLocs& locs)
+    {
+        if (block->bEvicted)
+            return;
+
+        // 预处理之后又被编辑的块（其他线程在两次加锁之间写入）在此串行重建；
+        // 此时只持有共享锁，其他线程的 prepareDrawCmds 可能正在读取 bDirty，需加块锁
+        {
+            std::lock_guard<std::mutex> cmdLock(block->cmdMutex);
+            if (block->bDirty)
+                rebuildDrawCmds(block);
+        }
+
+        if (block->vDrawCounts.empty())
+            return;
+
+        FrameProfiler::ScopedStage drawStage(m_pProfiler, FrameProfiler::Stage::Draw);
+        setBlockUniforms(block, locs);
+        bindBlock(block);
+
+        if (!bMultiDraw)
+        {
+            if (m_pProfiler)
+                m_pProfiler->addDrawCalls(block->vDrawCounts.size());
+            for (size_t i = 0; i < block->vDrawCounts.size(); ++i)
+            {
+                m_gl->glDrawElementsBaseVertex(
+                    GL_LINE_STRIP,
+                    block->vDrawCounts[i],
+                    GL_UNSIGNED_INT,
+                    nullptr,
+                    block->vBaseVertices[i]);
+            }
+        }
+        else
+        {
+            if (m_pProfiler)
+                m_pProfiler->addDrawCalls(1);
+            GLsizei nPrimCount = static_cast<GLsizei>(block->vDrawCounts.size());
+
+            static thread_local std::vector<const void*> g_nullPointers;
+            if (g_nullPointers.size() < 200000)
+                g_nullPointers.assign(200000, nullptr);
+
+            // 构造一个全是 nullptr 的指针数组
+            // 因为使用的是相对索引（0,1,2,...），所有 draw command 的 index offset 都是 0
+            const void** ptrs = g_nullPointers.data();
+
+            m_gl->glMultiDrawElementsBaseVertex(
+                GL_LINE_STRIP,
+                block->vDrawCounts.data(), // nCount[]
+                GL_UNSIGNED_INT,
+                ptrs,               // 必须是 [nullptr, nullptr, ...]，长度 = primCount
+                nPrimCount,                 // draw command 数量
+                block->vBaseVertices.data() // basevertex[]
+            );
+        }
 
+        unbindBlock();
+    }
+
+    void PolylinesVboManager::drawUnordered(bool bMultiDraw, GLint uColorLoc, const BlockUniformLocs& locs)
+    {
         for (const auto& pair : m_colorBlocksMap)
         {
             const auto& vBlocks = pair.second;
@@ -582,450 +1704,1418 @@ namespace GLRhi
                 m_gl->glUniform4f(uColorLoc, c.r(), c.g(), c.b(), c.a());
 
             for (ColorVBOBlock* block : vBlocks)
+                drawBlock(block, bMultiDraw, locs);
+        }
+    }
+
+    void PolylinesVboManager::drawOrderRange(size_t nBegin, size_t nEnd, bool bMultiDraw,
+        GLint uColorLoc, const BlockUniformLocs& locs)
+    {
+        bool bHasColor = false;
+        uint32_t nLastColor = 0;
+        for (size_t i = nBegin; i < nEnd; ++i)
+        {
+            ColorVBOBlock* block = m_vDrawOrder[i];
+            const uint32_t nColor = block->color.toUInt32();
+            if (uColorLoc != -1 && (!bHasColor || nColor != nLastColor))
             {
-                if (block->vDrawCounts.empty() && !block->bDirty)
-                    continue;
+                const Color& c = block->color;
+                m_gl->glUniform4f(uColorLoc, c.r(), c.g(), c.b(), c.a());
+                nLastColor = nColor;
+                bHasColor = true;
+            }
+            drawBlock(block, bMultiDraw, locs);
+        }
+    }
 
-                if (block->bDirty)
-                    rebuildDrawCmds(block);
+    void PolylinesVboManager::drawOrdered(bool bMultiDraw, GLint uColorLoc, const BlockUniformLocs& locs)
+    {
+        // 其他线程在两次加锁之间增删了块时，本帧仍按无序方式绘制，下一帧再排序
+        if (m_nDrawOrderVersion != m_nBlockSetVersion)
+        {
+            drawUnordered(bMultiDraw, uColorLoc, locs);
+            return;
+        }
 
-                if (block->bCompact)
-                    compactBlock(block);
+        const size_t nCount = m_vDrawOrder.size();
+        drawOrderRange(0, m_nFirstTranslucent, bMultiDraw, uColorLoc, locs);
+        if (m_nFirstTranslucent == nCount)
+            return;
 
-                if (block->vDrawCounts.empty())
+        if (m_eRenderOrder == RenderOrder::WeightedOit)
+        {
+            if (!m_pOitBuffer)
+                m_pOitBuffer = std::make_unique<OitBuffer>(m_gl);
+
+            if (m_pOitBuffer->begin())
+            {
+                BlockUniformLocs oitLocs = getBlockUniformLocs(static_cast<GLint>(m_pOitBuffer->getProgramId()));
+                drawOrderRange(m_nFirstTranslucent, nCount, bMultiDraw, m_pOitBuffer->getUniforms().nColor, oitLocs);
+                m_pOitBuffer->end();
+                return;
+            }
+            // 浮点 FBO 不可用时退回按深度排序的混合
+        }
+
+        // 半透明块由远到近混合，不写深度，避免遮挡之后更近的半透明块
+        GLint arrPrevBlendFunc[4] = { GL_ONE, GL_ZERO, GL_ONE, GL_ZERO };
+        m_gl->glGetIntegerv(GL_BLEND_SRC_RGB, &arrPrevBlendFunc[0]);
+        m_gl->glGetIntegerv(GL_BLEND_DST_RGB, &arrPrevBlendFunc[1]);
+        m_gl->glGetIntegerv(GL_BLEND_SRC_ALPHA, &arrPrevBlendFunc[2]);
+        m_gl->glGetIntegerv(GL_BLEND_DST_ALPHA, &arrPrevBlendFunc[3]);
+        GLboolean bPrevDepthMask = GL_TRUE;
+        m_gl->glGetBooleanv(GL_DEPTH_WRITEMASK, &bPrevDepthMask);
+        GLboolean bPrevBlend = m_gl->glIsEnabled(GL_BLEND);
+
+        m_gl->glEnable(GL_BLEND);
+        m_gl->glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+        m_gl->glDepthMask(GL_FALSE);
+
+        drawOrderRange(m_nFirstTranslucent, nCount, bMultiDraw, uColorLoc, locs);
+
+        m_gl->glDepthMask(bPrevDepthMask);
+        m_gl->glBlendFuncSeparate(arrPrevBlendFunc[0], arrPrevBlendFunc[1], arrPrevBlendFunc[2], arrPrevBlendFunc[3]);
+        if (!bPrevBlend)
+            m_gl->glDisable(GL_BLEND);
+    }
+
+    float PolylinesVboManager::computeSortDepth(const ColorVBOBlock* block)
+    {
+        if (block->eFormat != VertexFormat::Float3)
+            return block->fLayerZ;
+
+        // 影子已释放时保留上一次的深度
+        if (!block->bShadowValid)
+            return block->fSortDepth;
+
+        double dSum = 0.0;
+        size_t nCount = 0;
+        for (const PrimitiveInfo& prim : block->vPrimitives)
+        {
+            const size_t nOffset = static_cast<size_t>(prim.nBaseVertex) * 3 + 2;
+            if (!prim.bValid || nOffset >= block->vShadow.size())
+                continue;
+            dSum += block->vShadow[nOffset];
+            ++nCount;
+        }
+        return nCount ? static_cast<float>(dSum / nCount) : 0.0f;
+    }
+
+    void PolylinesVboManager::updateDrawOrder()
+    {
+        bool bRebuild = (m_nDrawOrderVersion != m_nBlockSetVersion);
+
+        // 块集合未变：只重算被编辑过的块，深度桶没变就沿用上一帧的顺序
+        if (!bRebuild)
+        {
+            for (ColorVBOBlock* block : m_vDrawOrder)
+            {
+                if (block->nSortVersion == block->nEditVersion)
                     continue;
 
-                bindBlock(block);
+                const uint16_t nOldBucket = depthBucket(block->fSortDepth);
+                block->fSortDepth = computeSortDepth(block);
+                block->nSortVersion = block->nEditVersion;
+                if (depthBucket(block->fSortDepth) != nOldBucket)
+                    bRebuild = true;
+            }
+            if (!bRebuild)
+                return;
+        }
 
-                for (size_t i = 0; i < block->vDrawCounts.size(); ++i)
+        std::vector<DrawKey> vKeys;
+        vKeys.reserve(m_vDrawOrder.size() + 16);
+        for (const auto& pair : m_colorBlocksMap)
+        {
+            const auto& vBlocks = pair.second;
+            for (size_t i = 0; i < vBlocks.size(); ++i)
+            {
+                ColorVBOBlock* block = vBlocks[i];
+                if (block->nSortVersion != block->nEditVersion)
                 {
-                    m_gl->glDrawElementsBaseVertex(
-                        GL_LINE_STRIP,
-                        block->vDrawCounts[i],
-                        GL_UNSIGNED_INT,
-                        nullptr,
-                        block->vBaseVertices[i]);
+                    block->fSortDepth = computeSortDepth(block);
+                    block->nSortVersion = block->nEditVersion;
                 }
-
-                unbindBlock();
+                vKeys.push_back({ makeDrawKey(block, i), block });
             }
         }
+
+        std::vector<DrawKey> vTemp;
+        radixSortDrawKeys(vKeys, vTemp);
+
+        m_vDrawOrder.resize(vKeys.size());
+        m_nFirstTranslucent = vKeys.size();
+        for (size_t i = 0; i < vKeys.size(); ++i)
+        {
+            m_vDrawOrder[i] = vKeys[i].block;
+            if (m_nFirstTranslucent == vKeys.size() && (vKeys[i].nKey & DRAW_KEY_TRANSLUCENT))
+                m_nFirstTranslucent = i;
+        }
+        m_nDrawOrderVersion = m_nBlockSetVersion;
     }
 
-    void PolylinesVboManager::renderVisiblePrimitivesEx()
+    // ===================================================================
+    // 拾取
+    // ===================================================================
+
+    long long PolylinesVboManager::pick(int x, int y, int nTolerancePx /*= 3*/)
     {
-        if (!m_gl || m_colorBlocksMap.empty())
-            return;
+        long long id = -1;
+        if (requestPick(x, y, nTolerancePx))
+            pollPick(id, true);
+        return id;
+    }
 
-        std::shared_lock<std::shared_mutex> lock(m_mutex);
+    /**
+     * @brief 发起 GPU 拾取
+     *
+     * 拾取窗口与屏幕像素一一对应：顶点先平移到以光标为原点，再按 视口 / 窗口 放大，
+     * 窗口之外的线段由裁剪丢弃，因此只有光标附近的像素参与光栅化。
+     * 每个块写入自己的序号，gl_VertexID 已包含 basevertex，直接就是块内顶点下标，
+     * 不需要额外的 ID 属性或逐图元 uniform，仍然一次 glMultiDrawElementsBaseVertex 绘制一个块。
+     */
+    bool PolylinesVboManager::requestPick(int x, int y, int nTolerancePx /*= 3*/)
+    {
+        if (!m_gl)
+            return false;
 
-        GLint nProg = 0;
-        m_gl->glGetIntegerv(GL_CURRENT_PROGRAM, &nProg);
-        GLint uColorLoc = (nProg > 0) ? m_gl->glGetUniformLocation(nProg, "uColor") : -1;
+        if (isDeferredMode())
+            applyPendingCommands();
 
-        //static std::vector<const void*> vOffsets(100000, nullptr);
+        std::unique_lock<std::shared_mutex> lock(m_mutex);
+        updateGpuResidency();
 
-        for (const auto& pair : m_colorBlocksMap)
-        {
-            const auto& vBlocks = pair.second;
-            if (vBlocks.empty())
-                continue;
+        GLint arrViewport[4] = { 0, 0, 0, 0 };
+        m_gl->glGetIntegerv(GL_VIEWPORT, arrViewport);
+        if (arrViewport[2] <= 0 || arrViewport[3] <= 0)
+            return false;
 
-            const Color& c = vBlocks[0]->color;
-            if (uColorLoc != -1)
-                m_gl->glUniform4f(uColorLoc, c.r(), c.g(), c.b(), c.a());
+        const int nTol = std::clamp(nTolerancePx, 0, 64);
+        const int nSize = nTol * 2 + 1;
 
-            for (ColorVBOBlock* block : vBlocks)
+        if (!m_pPickBuffer)
+            m_pPickBuffer = std::make_unique<PickBuffer>(m_gl);
+        if (!m_pPickBuffer->begin(nSize))
+            return false;
+
+        // 像素中心 -> NDC（窗口坐标 y 向下，NDC y 向上）
+        const float fCx = (x + 0.5f) / arrViewport[2] * 2.0f - 1.0f;
+        const float fCy = 1.0f - (y + 0.5f) / arrViewport[3] * 2.0f;
+
+        const PickBuffer::Uniforms& pickLocs = m_pPickBuffer->getUniforms();
+        m_gl->glUniform2f(pickLocs.nPickCenter, fCx, fCy);
+        m_gl->glUniform2f(pickLocs.nPickScale,
+            static_cast<float>(arrViewport[2]) / nSize, static_cast<float>(arrViewport[3]) / nSize);
+        BlockUniformLocs blockLocs = getBlockUniformLocs(static_cast<GLint>(m_pPickBuffer->getProgramId()));
+
+        std::vector<const void*> vNullOffsets;
+        m_vPickBlocks.clear();
+        for (const auto& pair : m_colorBlocksMap)
+        {
+            for (ColorVBOBlock* block : pair.second)
             {
-                if (block->bDirty)
-                    rebuildDrawCmds(block);
+                if (block->bEvicted)
+                    continue;
 
                 if (block->bCompact)
                     compactBlock(block);
-
+                if (block->bDirty)
+                    rebuildDrawCmds(block);
                 if (block->vDrawCounts.empty())
                     continue;
 
-                bindBlock(block);
+                m_vPickBlocks.push_back(block);
+                m_gl->glUniform1ui(pickLocs.nPickBlock, static_cast<GLuint>(m_vPickBlocks.size()));
+                setBlockUniforms(block, blockLocs);
+
+                if (vNullOffsets.size() < block->vDrawCounts.size())
+                    vNullOffsets.resize(block->vDrawCounts.size(), nullptr);
+
+                bindBlock(block);
+                m_gl->glMultiDrawElementsBaseVertex(GL_LINE_STRIP,
+                    block->vDrawCounts.data(), GL_UNSIGNED_INT, vNullOffsets.data(),
+                    static_cast<GLsizei>(block->vDrawCounts.size()), block->vBaseVertices.data());
+                unbindBlock();
+            }
+        }
+
+        m_pPickBuffer->end();
+        m_nPickLayoutVersion = m_nLayoutVersion;
+        return true;
+    }
+
+    bool PolylinesVboManager::pollPick(long long& id, bool bWait /*= false*/)
+    {
+        id = -1;
+        if (!m_gl || !m_pPickBuffer || !m_pPickBuffer->isPending())
+            return false;
+
+        std::vector<uint32_t> vTexels;
+        if (!m_pPickBuffer->fetch(vTexels, bWait))
+            return false;
+
+        std::shared_lock<std::shared_mutex> lock(m_mutex);
+        if (m_nPickLayoutVersion == m_nLayoutVersion)
+            id = resolvePick(vTexels);
+        return true;
+    }
+
+    long long PolylinesVboManager::resolvePick(const std::vector<uint32_t>& vTexels) const
+    {
+        const int nSize = m_pPickBuffer->getSize();
+        const int nCenter = nSize / 2;
+
+        // 按到中心的距离排序后逐个尝试，跳过已删除 / 隐藏的图元
+        std::vector<std::pair<int, size_t>> vHits;
+        for (int row = 0; row < nSize; ++row)
+        {
+            for (int col = 0; col < nSize; ++col)
+            {
+                size_t nTexel = static_cast<size_t>(row * nSize + col);
+                if (vTexels[nTexel * 2] == 0)
+                    continue;
+
+                int dx = col - nCenter;
+                int dy = row - nCenter;
+                vHits.emplace_back(dx * dx + dy * dy, nTexel);
+            }
+        }
+        std::sort(vHits.begin(), vHits.end());
+
+        for (const auto& hit : vHits)
+        {
+            uint32_t nBlock = vTexels[hit.second * 2];
+            if (nBlock > m_vPickBlocks.size())
+                continue;
+
+            long long id = findPrimitiveByVertex(m_vPickBlocks[nBlock - 1], vTexels[hit.second * 2 + 1]);
+            if (id >= 0)
+                return id;
+        }
+        return -1;
+    }
+
+    long long PolylinesVboManager::findPrimitiveByVertex(const ColorVBOBlock* block, uint32_t nVertex) const
+    {
+        const auto& vPrims = block->vPrimitives;
+        auto it = std::upper_bound(vPrims.begin(), vPrims.end(), static_cast<GLint>(nVertex),
+            [](GLint nVert, const PrimitiveInfo& prim) { return nVert < prim.nBaseVertex; });
+
+        // 删除的图元 nIndexCount 为 0，可能与后继共享 nBaseVertex，向前找到覆盖该顶点的图元
+        while (it != vPrims.begin())
+        {
+            --it;
+            if (it->nIndexCount <= 0)
+                continue;
+            if (static_cast<GLint>(nVertex) < it->nBaseVertex + it->nIndexCount && it->bValid)
+                return it->id;
+            break;
+        }
+        return -1;
+    }
+
+    long long PolylinesVboManager::pickCpu(float fX, float fY, float fTolerance)
+    {
+        std::unique_lock<std::shared_mutex> lock(m_mutex);
+
+        long long nBestId = -1;
+        float fBest = fTolerance;
+        for (const auto& pair : m_colorBlocksMap)
+        {
+            for (ColorVBOBlock* block : pair.second)
+            {
+                if (block->bEvicted)
+                    continue;
+
+                // 驱逐块的绘制命令由 updateGpuResidency 统一处理，这里只整理未驱逐的块
+                if (block->bCompact && m_gl)
+                    compactBlock(block);
+                if (block->bDirty)
+                    rebuildDrawCmds(block);
+                if (block->bPickTreeDirty)
+                    rebuildPickTree(block);
+
+                uint32_t nPrim = 0;
+                float fDist = 0.0f;
+                if (block->pickTree.nearest(fX, fY, fBest, nPrim, fDist))
+                {
+                    fBest = fDist;
+                    nBestId = block->vPrimitives[nPrim].id;
+                }
+            }
+        }
+        return nBestId;
+    }
+
+    void PolylinesVboManager::rebuildPickTree(ColorVBOBlock* block)
+    {
+        block->bPickTreeDirty = false;
+
+        const float* pVerts = nullptr;
+        std::vector<float> vDecoded;
+        if (block->bShadowValid)
+        {
+            pVerts = block->vShadow.data();
+        }
+        else if (m_gl)
+        {
+            const size_t nStride = vertexStride(block->eFormat);
+            std::vector<unsigned char> vRaw(block->nVertexCount * nStride);
+            m_gl->glBindBuffer(GL_COPY_READ_BUFFER, block->vbo);
+            m_gl->glGetBufferSubData(GL_COPY_READ_BUFFER, 0, static_cast<GLsizeiptr>(vRaw.size()), vRaw.data());
+            m_gl->glBindBuffer(GL_COPY_READ_BUFFER, 0);
+
+            vDecoded.resize(block->nVertexCount * 3);
+            decodeVertices(block->eFormat, block->window, block->fLayerZ, vRaw.data(), block->nVertexCount, vDecoded.data());
+            pVerts = vDecoded.data();
+        }
+        else
+        {
+            block->pickTree.clear();
+            return;
+        }
+
+        std::vector<SegmentEntry> vSegments;
+        vSegments.reserve(block->nVertexCount);
+        for (size_t i = 0; i < block->vPrimitives.size(); ++i)
+        {
+            const PrimitiveInfo& prim = block->vPrimitives[i];
+            if (!prim.bValid || prim.nIndexCount < 2)
+                continue;
+
+            const float* p = pVerts + static_cast<size_t>(prim.nBaseVertex) * 3;
+            for (GLsizei k = 0; k + 1 < prim.nIndexCount; ++k, p += 3)
+                vSegments.push_back(SegmentEntry{ p[0], p[1], p[3], p[4], static_cast<uint32_t>(i) });
+        }
+        block->pickTree.build(std::move(vSegments));
+    }
+
+    // ===================================================================
+    // 私有工具函数
+    // ===================================================================
+
+    /**
+     * @brief 查找或创建指定颜色的VBO块
+     *
+     * 根据颜色查找现有可容量足够的VBO块，如果不存在则创建新的。
+     * 这是实现颜色分组渲染优化的关键方法。
+     * 压缩格式下块还需满足：格式相同、z 相同、折线完全落在块坐标窗口内。
+     *
+     * @param color 要查找的颜色
+     * @param pVerts 折线顶点 [x, y, z, ...]
+     * @param nVertCount 顶点数量
+     * @return 指向ColorVBOBlock的指针，如果无法创建则返回nullptr
+     */
+    ColorVBOBlock* PolylinesVboManager::getColorBlock(const Color& color, const float* pVerts, size_t nVertCount)
+    {
+        uint32_t nKey = color.toUInt32();
+        auto& vBlocks = m_colorBlocksMap[nKey];
+
+        VertexFormat eFormat = m_eVertexFormat;
+        QuantizeWindow window;
+        float fLayerZ = 0.0f;
+        if (eFormat != VertexFormat::Float3)
+        {
+            fLayerZ = pVerts[2];
+            // z 不恒定或跨度超过单块范围的折线无法压缩，退回 Float3
+            if (!makeWindow(pVerts, nVertCount, window))
+                eFormat = VertexFormat::Float3;
+        }
+
+        for (ColorVBOBlock* b : vBlocks)
+        {
+            if (b->bEvicted || b->eFormat != eFormat || b->nVertexCount + 5000 >= MAX_VERT_PER_BLOCK)
+                continue;
+
+            if (fitsWindow(eFormat, b->window, b->fLayerZ, pVerts, nVertCount))
+                return b;
+        }
+
+        if (eFormat == VertexFormat::Float3)
+            return createNewColorBlock(color);
+
+        return createNewColorBlock(color, eFormat, window, fLayerZ);
+    }
+
+    bool PolylinesVboManager::makeWindow(const float* pVerts, size_t nVertCount, QuantizeWindow& window) const
+    {
+        // 以第一条折线的包围盒中心为块原点，后续同色折线只要落入窗口即可复用该块
+        return makeWindowFor(m_eVertexFormat, m_fQuantizeStep, pVerts, nVertCount, window);
+    }
+
+    PolylinesVboManager::BlockUniformLocs PolylinesVboManager::getBlockUniformLocs(GLint nProg) const
+    {
+        BlockUniformLocs locs;
+        if (nProg > 0)
+        {
+            locs.nOrigin = m_gl->glGetUniformLocation(nProg, "uBlockOrigin");
+            locs.nScale = m_gl->glGetUniformLocation(nProg, "uBlockScale");
+            locs.nZ = m_gl->glGetUniformLocation(nProg, "uBlockZ");
+        }
+        return locs;
+    }
+
+    void PolylinesVboManager::setBlockUniforms(const ColorVBOBlock* block, const BlockUniformLocs& locs) const
+    {
+        // Float3 块的窗口为 (0, 0)、步长 1、z 为 0，还原公式退化为原样输出
+        if (locs.nOrigin != -1)
+            m_gl->glUniform2f(locs.nOrigin, block->window.fOriginX, block->window.fOriginY);
+        if (locs.nScale != -1)
+            m_gl->glUniform1f(locs.nScale, block->window.fStep);
+        if (locs.nZ != -1)
+            m_gl->glUniform1f(locs.nZ, block->fLayerZ);
+    }
+
+    /**
+     * @brief 创建新的颜色VBO块
+     *
+     * 分配并初始化一个新的ColorVBOBlock对象，包括：
+     * - 创建OpenGL缓冲区对象（VAO、VBO、EBO）
+     * - 设置初始容量
+     * - 配置顶点属性指针
+     * - 将新块添加到颜色映射中
+     *
+     * @param color 该块的颜色
+     * @param eFormat 块顶点格式
+     * @param window 块坐标窗口
+     * @param fLayerZ 块统一 z 值
+     * @param nCapacity 初始顶点容量，0 表示使用 INIT_CAPACITY
+     * @return 指向新创建的ColorVBOBlock的指针
+     */
+    ColorVBOBlock* PolylinesVboManager::createNewColorBlock(const Color& color, VertexFormat eFormat,
+        const QuantizeWindow& window, float fLayerZ, size_t nCapacity)
+    {
+        ColorVBOBlock* block = new ColorVBOBlock();
+        block->color = color;
+        block->eFormat = eFormat;
+        block->window = window;
+        block->fLayerZ = fLayerZ;
+
+        const size_t nStride = vertexStride(eFormat);
+
+        m_gl->glGenVertexArrays(1, &block->vao);
+        m_gl->glGenBuffers(1, &block->vbo);
+        m_gl->glGenBuffers(1, &block->ebo);
+
+        if (nCapacity == 0)
+            nCapacity = INIT_CAPACITY;
+
+        block->nVertexCapacity = nCapacity;
+        block->nIndexCapacity = nCapacity;
+
+        m_gl->glBindBuffer(GL_COPY_WRITE_BUFFER, block->vbo);
+        m_gl->glBufferData(GL_COPY_WRITE_BUFFER,
+            static_cast<GLsizeiptr>(nCapacity * nStride),
+            nullptr, GL_DYNAMIC_DRAW);
+
+        m_gl->glBindBuffer(GL_COPY_WRITE_BUFFER, block->ebo);
+        m_gl->glBufferData(GL_COPY_WRITE_BUFFER,
+            static_cast<GLsizeiptr>(nCapacity * sizeof(unsigned int)),
+            nullptr, GL_DYNAMIC_DRAW);
+        m_gl->glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+        setupBlockVao(block);
+
+        m_colorBlocksMap[color.toUInt32()].push_back(block);
+        ++m_nBlockSetVersion;
+        trackBlock(block);
+        return block;
+    }
+
+    /**
+     * @brief 配置块的VAO
+     *
+     * VAO 记录的是缓冲区名，创建块及扩容替换缓冲区后都需要重新调用。
+     *
+     * @param block 目标块
+     */
+    void PolylinesVboManager::setupBlockVao(ColorVBOBlock* block)
+    {
+        const size_t nStride = vertexStride(block->eFormat);
+
+        m_gl->glBindVertexArray(block->vao);
+        m_gl->glBindBuffer(GL_ARRAY_BUFFER, block->vbo);
+        m_gl->glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, block->ebo);
+
+        m_gl->glEnableVertexAttribArray(0);
+        switch (block->eFormat)
+        {
+        case VertexFormat::Quantized16:
+            // 非归一化整数转浮点，着色器中乘以 uBlockScale 还原
+            m_gl->glVertexAttribPointer(0, 2, GL_SHORT, GL_FALSE, static_cast<GLsizei>(nStride), nullptr);
+            break;
+        case VertexFormat::HalfFloat:
+            m_gl->glVertexAttribPointer(0, 2, GL_HALF_FLOAT, GL_FALSE, static_cast<GLsizei>(nStride), nullptr);
+            break;
+        case VertexFormat::Float3:
+        default:
+            m_gl->glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, static_cast<GLsizei>(nStride), nullptr);
+            break;
+        }
+
+        m_gl->glBindVertexArray(0);
+    }
+
+    /**
+     * @brief 确保VBO块有足够的容量
+     *
+     * 检查并在必要时扩容指定的VBO块，以容纳所需的顶点和索引数量。
+     * 扩容时创建更大的新缓冲区，已有数据用 glCopyBufferSubData 在 GPU 端直接拷贝，
+     * 不经过 CPU，也不依赖影子数据，因此扩容不会丢失任何图元。
+     *
+     * @param block 要检查容量的VBO块
+     * @param nNeedV 需要的顶点数量
+     * @param nNeedI 需要的索引数量
+     */
+    void PolylinesVboManager::checkBlockCapacity(ColorVBOBlock* block, size_t nNeedV, size_t nNeedI)
+    {
+        if (nNeedV <= block->nVertexCapacity && nNeedI <= block->nIndexCapacity)
+            return;
+
+        size_t nNeed = std::max(nNeedV, nNeedI);
+        size_t nNewCap = block->nVertexCapacity * 2;
+        if (nNewCap < nNeed)
+            nNewCap = nNeed + GROW_STEP;
+
+        resizeBlockBuffers(block, nNewCap);
+    }
+
+    /**
+     * @brief 重新分配块的缓冲区
+     *
+     * 扩容与收缩共用：创建指定容量的新 VBO / EBO，把已使用的部分
+     * 用 glCopyBufferSubData 拷过去，删除旧缓冲区后重新配置 VAO。
+     *
+     * @param block 目标块
+     * @param nNewCap 新容量，不小于块当前的顶点 / 索引数
+     */
+    void PolylinesVboManager::resizeBlockBuffers(ColorVBOBlock* block, size_t nNewCap)
+    {
+        const size_t nStride = vertexStride(block->eFormat);
+
+        GLuint newVbo = 0;
+        GLuint newEbo = 0;
+        m_gl->glGenBuffers(1, &newVbo);
+        m_gl->glGenBuffers(1, &newEbo);
+
+        // 顶点
+        m_gl->glBindBuffer(GL_COPY_WRITE_BUFFER, newVbo);
+        m_gl->glBufferData(GL_COPY_WRITE_BUFFER,
+            static_cast<GLsizeiptr>(nNewCap * nStride), nullptr, GL_DYNAMIC_DRAW);
+        if (block->nVertexCount > 0)
+        {
+            m_gl->glBindBuffer(GL_COPY_READ_BUFFER, block->vbo);
+            m_gl->glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0,
+                static_cast<GLsizeiptr>(block->nVertexCount * nStride));
+        }
+
+        // 索引
+        m_gl->glBindBuffer(GL_COPY_WRITE_BUFFER, newEbo);
+        m_gl->glBufferData(GL_COPY_WRITE_BUFFER,
+            static_cast<GLsizeiptr>(nNewCap * sizeof(unsigned int)), nullptr, GL_DYNAMIC_DRAW);
+        if (block->nIndexCount > 0)
+        {
+            m_gl->glBindBuffer(GL_COPY_READ_BUFFER, block->ebo);
+            m_gl->glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0,
+                static_cast<GLsizeiptr>(block->nIndexCount * sizeof(unsigned int)));
+        }
+
+        m_gl->glBindBuffer(GL_COPY_READ_BUFFER, 0);
+        m_gl->glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        m_pGpuBudget->recordUpload(block->nVertexCount * nStride + block->nIndexCount * sizeof(unsigned int));
+
+        m_gl->glDeleteBuffers(1, &block->vbo);
+        m_gl->glDeleteBuffers(1, &block->ebo);
+        block->vbo = newVbo;
+        block->ebo = newEbo;
+        setupBlockVao(block);
+
+        block->nVertexCapacity = nNewCap;
+        block->nIndexCapacity = nNewCap;
+        trackBlock(block);
+    }
+
+    /**
+     * @brief 上传单个折线到VBO块
+     *
+     * 将折线数据（顶点和索引）上传到指定的VBO块中，包括：
+     * - 写入块的 CPU 影子（影子已释放时跳过）
+     * - 按块格式编码后使用glBufferSubData更新VBO和EBO
+     * - 计算相对索引值
+     *
+     * @param block 目标VBO块
+     * @param nPrimIdx 要上传的折线在块中的索引
+     * @param pVerts 折线顶点 [x, y, z, ...]，数量为图元的 nIndexCount
+     */
+    void PolylinesVboManager::uploadSinglePrimitive(ColorVBOBlock* block, size_t nPrimIdx, const float* pVerts)
+    {
+        const PrimitiveInfo& prim = block->vPrimitives[nPrimIdx];
+        if (prim.nIndexCount <= 0)
+            return;
+
+        size_t nVertCount = static_cast<size_t>(prim.nIndexCount);
+        const size_t nStride = vertexStride(block->eFormat);
+
+        writeShadow(block, static_cast<size_t>(prim.nBaseVertex), pVerts, nVertCount);
+
+        // 驱逐块只更新影子，恢复时整体上传
+        if (block->bEvicted)
+            return;
+
+        FrameProfiler::ScopedStage uploadStage(m_pProfiler, FrameProfiler::Stage::Upload);
+        GLsizeiptr nVertOffset = static_cast<GLsizeiptr>(prim.nBaseVertex) * nStride;
+        GLsizeiptr nIdxOffset = static_cast<GLsizeiptr>(prim.nBaseVertex) * sizeof(unsigned int);
+
+        // 顶点（按块格式编码后上传）
+        std::vector<unsigned char> vEncoded(nVertCount * nStride);
+        encodeVertices(block->eFormat, block->window, pVerts, nVertCount, vEncoded.data());
+
+        m_gl->glBindBuffer(GL_ARRAY_BUFFER, block->vbo);
+        m_gl->glBufferSubData(GL_ARRAY_BUFFER, nVertOffset,
+            static_cast<GLsizeiptr>(vEncoded.size()), vEncoded.data());
+
+        // 索引
+        std::vector<unsigned int> vIndices(nVertCount);
+        for (size_t i = 0; i < nVertCount; ++i)
+            vIndices[i] = static_cast<unsigned int>(prim.nBaseVertex + i);
+
+        m_gl->glBindBuffer(GL_COPY_WRITE_BUFFER, block->ebo);
+        m_gl->glBufferSubData(GL_COPY_WRITE_BUFFER, nIdxOffset,
+            static_cast<GLsizeiptr>(vIndices.size() * sizeof(unsigned int)), vIndices.data());
+        m_gl->glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        m_pGpuBudget->recordUpload(vEncoded.size() + vIndices.size() * sizeof(unsigned int));
+    }
+
+    /**
+     * @brief 压缩VBO块，整理内存碎片
+     *
+     * 当块中存在被删除的折线时，此方法负责：
+     * - 在源数据中把存活图元依次前移，消除空洞（隐藏的图元同样保留）
+     * - 更新所有受影响的折线的基础顶点偏移
+     * - 一次性上传整理后的顶点数据
+     *
+     * 源数据优先取块的 CPU 影子；影子因内存预算被释放时，一次性读回显存中的
+     * 块格式原始字节在 CPU 上整理，因此任何情况下都不会丢失图元。
+     * EBO 始终是 0,1,2... 的恒等序列，整理后前缀依然有效，无需重传。
+     * 驱逐块（影子始终完整）只整理影子，不访问显存。
+     *
+     * @param block 要压缩的VBO块
+     */
+    void PolylinesVboManager::compactBlock(ColorVBOBlock* block)
+    {
+        if (!block->bCompact || block->nVertexCount == 0)
+            return;
+
+        FrameProfiler::ScopedStage stage(m_pProfiler, FrameProfiler::Stage::Compact);
+        auto startTime = std::chrono::high_resolution_clock::now();
+        auto recordTime = [&]() {
+            auto endTime = std::chrono::high_resolution_clock::now();
+            m_pGpuBudget->recordCompact(std::chrono::duration<double, std::milli>(endTime - startTime).count());
+        };
+
+        const size_t nStride = vertexStride(block->eFormat);
+        const bool bUseShadow = block->bShadowValid;
+
+        std::vector<unsigned char> vGpuData;
+        if (!bUseShadow)
+        {
+            vGpuData.resize(block->nVertexCount * nStride);
+            m_gl->glBindBuffer(GL_COPY_READ_BUFFER, block->vbo);
+            m_gl->glGetBufferSubData(GL_COPY_READ_BUFFER, 0,
+                static_cast<GLsizeiptr>(vGpuData.size()), vGpuData.data());
+            m_gl->glBindBuffer(GL_COPY_READ_BUFFER, 0);
+        }
+
+        size_t currentBase = 0;
+        for (PrimitiveInfo& prim : block->vPrimitives)
+        {
+            // nIndexCount 为 0 表示已删除；隐藏的图元 bValid 为 false 但仍需保留
+            // 已删除的图元也跟随前移，保持 nBaseVertex 递增（拾取时按顶点下标二分查找）
+            if (prim.nIndexCount <= 0)
+            {
+                prim.nBaseVertex = static_cast<GLint>(currentBase);
+                continue;
+            }
+
+            size_t nCount = static_cast<size_t>(prim.nIndexCount);
+            size_t nOldBase = static_cast<size_t>(prim.nBaseVertex);
+
+            // 目标位置不会超过源位置，前移用 memmove 即可
+            if (nOldBase != currentBase)
+            {
+                if (bUseShadow)
+                    std::memmove(block->vShadow.data() + currentBase * 3,
+                        block->vShadow.data() + nOldBase * 3, nCount * 3 * sizeof(float));
+                else
+                    std::memmove(vGpuData.data() + currentBase * nStride,
+                        vGpuData.data() + nOldBase * nStride, nCount * nStride);
+            }
+
+            prim.nBaseVertex = static_cast<GLint>(currentBase);
+            currentBase += nCount;
+        }
+        ++m_nLayoutVersion;
+
+        if (block->bEvicted)
+        {
+            resizeShadow(block, currentBase * 3);
+            block->nVertexCount = currentBase;
+            block->nIndexCount = currentBase;
+            block->bCompact = false;
+            markDirty(block);
+            recordTime();
+            return;
+        }
+
+        const void* pUpload = nullptr;
+        std::vector<unsigned char> vEncoded;
+        if (bUseShadow)
+        {
+            resizeShadow(block, currentBase * 3);
+            if (block->eFormat == VertexFormat::Float3)
+            {
+                pUpload = block->vShadow.data();
+            }
+            else
+            {
+                vEncoded.resize(currentBase * nStride);
+                encodeVertices(block->eFormat, block->window, block->vShadow.data(), currentBase, vEncoded.data());
+                pUpload = vEncoded.data();
+            }
+        }
+        else
+        {
+            pUpload = vGpuData.data();
+        }
+
+        // 一次性上传新数据（orphaning 避免等待 GPU 使用旧数据）
+        m_gl->glBindBuffer(GL_ARRAY_BUFFER, block->vbo);
+        m_gl->glBufferData(GL_ARRAY_BUFFER,
+            static_cast<GLsizeiptr>(block->nVertexCapacity * nStride), nullptr, GL_DYNAMIC_DRAW);
+        if (currentBase > 0)
+        {
+            m_gl->glBufferSubData(GL_ARRAY_BUFFER, 0,
+                static_cast<GLsizeiptr>(currentBase * nStride), pUpload);
+            m_pGpuBudget->recordUpload(currentBase * nStride);
+        }
+
+        // 更新统计
+        block->nVertexCount = currentBase;
+        block->nIndexCount = currentBase;
+        block->bCompact = false;
+        markDirty(block);
+        trackBlock(block);
+        recordTime();
+    }
+
+    void PolylinesVboManager::rebuildDrawCmds(ColorVBOBlock* block)
+    {
+        FrameProfiler::ScopedStage stage(m_pProfiler, FrameProfiler::Stage::Rebuild);
+        block->vDrawCounts.clear();
+        block->vBaseVertices.clear();
+
+        for (const PrimitiveInfo& prim : block->vPrimitives)
+        {
+            if (prim.bValid && prim.nIndexCount > 0)
+            {
+                block->vDrawCounts.push_back(prim.nIndexCount);
+                block->vBaseVertices.push_back(prim.nBaseVertex);
+            }
+        }
+
+        block->bDirty = false;
+        block->bPickTreeDirty = true;
+    }
+
+    /**
+     * @brief 并行预处理绘制命令
+     *
+     * 共享锁下在线程池上为每个脏块生成后台缓冲（只读图元信息，可与其他线程的绘制并行），
+     * 再在独占锁下把仍然有效的后台缓冲与前台交换，渲染线程只负责绑定与绘制。
+     * 预处理期间块被再次编辑（版本号变化）、被驱逐或块布局改变时放弃对应结果，
+     * 块保持脏状态，由下一次预处理或绘制时的串行重建兜底。
+     * 绘制时的串行重建同样只持有共享锁，bDirty 的读写都在块锁 cmdMutex 下进行。
+     */
+    size_t PolylinesVboManager::prepareDrawCmds()
+    {
+        FrameProfiler::ScopedStage stage(m_pProfiler, FrameProfiler::Stage::Rebuild);
+        std::lock_guard<std::mutex> prepareLock(m_prepareMutex);
+
+        std::vector<ColorVBOBlock*> vDirty;
+        size_t nLayoutVersion = 0;
+        {
+            std::shared_lock<std::shared_mutex> lock(m_mutex);
+            for (const auto& pair : m_colorBlocksMap)
+            {
+                for (ColorVBOBlock* block : pair.second)
+                {
+                    std::lock_guard<std::mutex> cmdLock(block->cmdMutex);
+                    if (block->bDirty && !block->bEvicted)
+                        vDirty.push_back(block);
+                }
+            }
+            if (vDirty.empty())
+                return 0;
+
+            nLayoutVersion = m_nLayoutVersion;
+            ThreadPool::shared().parallelFor(vDirty.size(), 1, [&](size_t nBegin, size_t nEnd) {
+                for (size_t i = nBegin; i < nEnd; ++i)
+                    buildNextDrawCmds(vDirty[i]);
+            });
+        }
+
+        std::unique_lock<std::shared_mutex> lock(m_mutex);
+        if (m_nLayoutVersion != nLayoutVersion)
+            return 0;   // 期间有块被销毁，指针可能失效
+
+        size_t nPublished = 0;
+        for (ColorVBOBlock* block : vDirty)
+        {
+            if (!block->bDirty || block->bEvicted || block->nPreparedVersion != block->nEditVersion)
+                continue;
+
+            block->vDrawCounts.swap(block->vNextDrawCounts);
+            block->vBaseVertices.swap(block->vNextBaseVertices);
+            block->bDirty = false;
+            block->bPickTreeDirty = true;
+            ++nPublished;
+        }
+        return nPublished;
+    }
+
+    void PolylinesVboManager::buildNextDrawCmds(ColorVBOBlock* block)
+    {
+        block->vNextDrawCounts.clear();
+        block->vNextBaseVertices.clear();
+        block->vNextDrawCounts.reserve(block->vPrimitives.size());
+        block->vNextBaseVertices.reserve(block->vPrimitives.size());
+
+        for (const PrimitiveInfo& prim : block->vPrimitives)
+        {
+            if (prim.bValid && prim.nIndexCount > 0)
+            {
+                block->vNextDrawCounts.push_back(prim.nIndexCount);
+                block->vNextBaseVertices.push_back(prim.nBaseVertex);
+            }
+        }
+        block->nPreparedVersion = block->nEditVersion;
+    }
+
+    void PolylinesVboManager::compactPendingBlocks()
+    {
+        for (const auto& pair : m_colorBlocksMap)
+        {
+            for (ColorVBOBlock* block : pair.second)
+            {
+                if (block->bCompact && !block->bEvicted)
+                    compactBlock(block);
+            }
+        }
+    }
+
+    void PolylinesVboManager::writeShadow(ColorVBOBlock* block, size_t nBaseVertex,
+        const float* pVerts, size_t nVertCount)
+    {
+        if (!block->bShadowValid)
+            return;
+
+        size_t nEnd = (nBaseVertex + nVertCount) * 3;
+        if (block->vShadow.size() < nEnd)
+            resizeShadow(block, nEnd);
+        std::memcpy(block->vShadow.data() + nBaseVertex * 3, pVerts, nVertCount * 3 * sizeof(float));
+    }
+
+    void PolylinesVboManager::resizeShadow(ColorVBOBlock* block, size_t nFloatCount)
+    {
+        size_t nOldBytes = block->vShadow.capacity() * sizeof(float);
+        if (nFloatCount > block->vShadow.capacity())
+            block->vShadow.reserve(std::max(nFloatCount, block->nVertexCapacity * 3));
+        block->vShadow.resize(nFloatCount);
+        if (nFloatCount == 0)
+            block->vShadow.shrink_to_fit();
+
+        m_nShadowBytes = m_nShadowBytes - nOldBytes + block->vShadow.capacity() * sizeof(float);
+    }
+
+    void PolylinesVboManager::enforceShadowBudget()
+    {
+        if (m_nShadowBudgetBytes == 0 || m_nShadowBytes <= m_nShadowBudgetBytes)
+            return;
+
+        if (!m_bGpuReadBack)
+        {
+            if (!m_bShadowBudgetWarned)
+            {
+                qWarning() << "CPU shadow exceeds budget:" << m_nShadowBytes << "/" << m_nShadowBudgetBytes
+                    << "bytes, enable GPU read-back fallback to release shadows";
+                m_bShadowBudgetWarned = true;
+            }
+            return;
+        }
+
+        // 从最大的影子开始释放，之后该块的 compact 改为读回显存
+        std::vector<ColorVBOBlock*> vBlocks;
+        for (auto& pair : m_colorBlocksMap)
+        {
+            for (ColorVBOBlock* block : pair.second)
+            {
+                // 驱逐块的影子是唯一的数据副本，不能释放
+                if (block->bShadowValid && !block->bEvicted && !block->vShadow.empty())
+                    vBlocks.push_back(block);
+            }
+        }
+        std::sort(vBlocks.begin(), vBlocks.end(), [](const ColorVBOBlock* a, const ColorVBOBlock* b) {
+            return a->vShadow.capacity() > b->vShadow.capacity();
+        });
+
+        for (ColorVBOBlock* block : vBlocks)
+        {
+            if (m_nShadowBytes <= m_nShadowBudgetBytes)
+                break;
 
-                GLsizei nPrimCount = static_cast<GLsizei>(block->vDrawCounts.size());
+            m_nShadowBytes -= block->vShadow.capacity() * sizeof(float);
+            std::vector<float>().swap(block->vShadow);
+            block->bShadowValid = false;
+        }
+    }
 
-                static thread_local std::vector<const void*> g_nullPointers;
-                if (g_nullPointers.size() < 200000)
-                    g_nullPointers.assign(200000, nullptr);
+    void PolylinesVboManager::setShadowMemoryBudget(size_t nBytes)
+    {
+        std::unique_lock<std::shared_mutex> lock(m_mutex);
+        m_nShadowBudgetBytes = nBytes;
+        m_bShadowBudgetWarned = false;
+        enforceShadowBudget();
+    }
 
-                // 构造一个全是 nullptr 的指针数组
-                // 因为使用的是相对索引（0,1,2,...），所有 draw command 的 index offset 都是 0
-                const void** ptrs = g_nullPointers.data();
+    void PolylinesVboManager::setGpuReadBackFallback(bool bEnable)
+    {
+        std::unique_lock<std::shared_mutex> lock(m_mutex);
+        m_bGpuReadBack = bEnable;
+        enforceShadowBudget();
+    }
 
-                m_gl->glMultiDrawElementsBaseVertex(
-                    GL_LINE_STRIP,
-                    block->vDrawCounts.data(), // nCount[]
-                    GL_UNSIGNED_INT,
-                    ptrs,               // 必须是 [nullptr, nullptr, ...]，长度 = primCount
-                    nPrimCount,                 // draw command 数量
-                    block->vBaseVertices.data() // basevertex[]
-                );
+    size_t PolylinesVboManager::getShadowMemoryBytes() const
+    {
+        std::shared_lock<std::shared_mutex> lock(m_mutex);
+        return m_nShadowBytes;
+    }
 
-                unbindBlock();
-            }
-        }
+    void PolylinesVboManager::shrinkShadowToFit(ColorVBOBlock* block)
+    {
+        size_t nOldBytes = block->vShadow.capacity() * sizeof(float);
+        block->vShadow.shrink_to_fit();
+        m_nShadowBytes = m_nShadowBytes - nOldBytes + block->vShadow.capacity() * sizeof(float);
     }
 
     // ===================================================================
-    // 私有工具函数
+    // 显存预算
     // ===================================================================
 
-    /**
-     * @brief 查找或创建指定颜色的VBO块
-     *
-     * 根据颜色查找现有可容量足够的VBO块，如果不存在则创建新的。
-     * 这是实现颜色分组渲染优化的关键方法。
-     *
-     * @param color 要查找的颜色
-     * @return 指向ColorVBOBlock的指针，如果无法创建则返回nullptr
-     */
-    ColorVBOBlock* PolylinesVboManager::getColorBlock(const Color& color)
+    void PolylinesVboManager::setGpuMemoryBudget(std::shared_ptr<GpuMemoryBudget> pBudget)
     {
-        uint32_t nKey = color.toUInt32();
-        auto& vBlocks = m_colorBlocksMap[nKey];
+        if (!pBudget)
+            return;
 
-        for (ColorVBOBlock* b : vBlocks)
+        std::unique_lock<std::shared_mutex> lock(m_mutex);
+        for (auto& pair : m_colorBlocksMap)
         {
-            if (b->nVertexCount + 5000 < MAX_VERT_PER_BLOCK)
-                return b;
+            for (ColorVBOBlock* block : pair.second)
+                m_pGpuBudget->removeBlock(block);
         }
 
-        return createNewColorBlock(color);
+        m_pGpuBudget = std::move(pBudget);
+        for (auto& pair : m_colorBlocksMap)
+        {
+            for (ColorVBOBlock* block : pair.second)
+                trackBlock(block);
+        }
     }
 
-    /**
-     * @brief 创建新的颜色VBO块
-     *
-     * 分配并初始化一个新的ColorVBOBlock对象，包括：
-     * - 创建OpenGL缓冲区对象（VAO、VBO、EBO）
-     * - 设置初始容量
-     * - 配置顶点属性指针
-     * - 将新块添加到颜色映射中
-     *
-     * @param color 该块的颜色
-     * @return 指向新创建的ColorVBOBlock的指针
-     */
-    ColorVBOBlock* PolylinesVboManager::createNewColorBlock(const Color& color)
+    void PolylinesVboManager::setGpuMemoryLimit(size_t nBytes)
     {
-        ColorVBOBlock* block = new ColorVBOBlock();
-        block->color = color;
-
-        m_gl->glGenVertexArrays(1, &block->vao);
-        m_gl->glGenBuffers(1, &block->vbo);
-        m_gl->glGenBuffers(1, &block->ebo);
-
-        block->nVertexCapacity = INIT_CAPACITY;
-        block->nIndexCapacity = INIT_CAPACITY;
-
-        m_gl->glBindVertexArray(block->vao);
-
-        m_gl->glBindBuffer(GL_ARRAY_BUFFER, block->vbo);
-        m_gl->glBufferData(GL_ARRAY_BUFFER,
-            static_cast<GLsizeiptr>(INIT_CAPACITY * 3 * sizeof(float)),
-            nullptr, GL_DYNAMIC_DRAW);
-
-        m_gl->glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, block->ebo);
-        m_gl->glBufferData(GL_ELEMENT_ARRAY_BUFFER,
-            static_cast<GLsizeiptr>(INIT_CAPACITY * sizeof(unsigned int)),
-            nullptr, GL_DYNAMIC_DRAW);
+        m_pGpuBudget->setBudget(nBytes);
+    }
 
-        m_gl->glEnableVertexAttribArray(0);
-        m_gl->glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), nullptr);
+    GpuMemoryStats PolylinesVboManager::getGpuMemoryStats() const
+    {
+        return m_pGpuBudget->getStats();
+    }
 
-        m_gl->glBindVertexArray(0);
+    void PolylinesVboManager::trackBlock(const ColorVBOBlock* block)
+    {
+        if (block->bEvicted)
+        {
+            m_pGpuBudget->updateBlock(block, 0, 0, true);
+            return;
+        }
 
-        m_colorBlocksMap[color.toUInt32()].push_back(block);
-        return block;
+        const size_t nBytesPerVert = vertexStride(block->eFormat) + sizeof(unsigned int);
+        m_pGpuBudget->updateBlock(block,
+            block->nVertexCapacity * nBytesPerVert,
+            block->nVertexCount * nBytesPerVert);
     }
 
     /**
-     * @brief 确保VBO块有足够的容量
-     *
-     * 检查并在必要时扩容指定的VBO块，以容纳所需的顶点和索引数量。
-     * 如果块空间不足，将重新分配更大的缓冲区并复制现有数据。
+     * @brief 每帧绘制前更新块的显存驻留状态
      *
-     * @param block 要检查容量的VBO块
-     * @param nNeedV 需要的顶点数量
-     * @param nNeedI 需要的索引数量
+     * 先恢复重新出现可见图元的驱逐块（不受预算限制，保证可见内容总能绘制），
+     * 再在超出预算时依次回收，回到预算内即停止：
+     * 合并（小块并入有空余的块，整块释放）-> 收缩（释放空块、裁掉多余容量）-> 驱逐（整块隐藏的块）。
+     * 预算是全局的，但每个管理器只能回收自己的块。
      */
-    void PolylinesVboManager::checkBlockCapacity(ColorVBOBlock* block, size_t nNeedV, size_t nNeedI)
+    void PolylinesVboManager::updateGpuResidency()
     {
-        if (1)
+        for (auto& pair : m_colorBlocksMap)
         {
-            // Grok 优化版
-            if (nNeedV <= block->nVertexCapacity && nNeedI <= block->nIndexCapacity)
-                return;
-
-            size_t nNewCap = block->nVertexCapacity * 2;
-            if (nNewCap < nNeedV)
-                nNewCap = nNeedV + GROW_STEP;
-
-            block->nVertexCapacity = nNewCap;
-            block->nIndexCapacity = nNewCap;
+            for (ColorVBOBlock* block : pair.second)
+            {
+                if (!block->bEvicted || !block->bDirty)
+                    continue;
 
-            // Orphaning：只重新分配，不拷贝旧数据
-            m_gl->glBindBuffer(GL_ARRAY_BUFFER, block->vbo);
-            m_gl->glBufferData(GL_ARRAY_BUFFER,
-                nNewCap * 3 * sizeof(float), nullptr, GL_DYNAMIC_DRAW);
+                rebuildDrawCmds(block);
+                if (!block->vDrawCounts.empty())
+                    restoreBlock(block);
+            }
+        }
 
-            m_gl->glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, block->ebo);
-            m_gl->glBufferData(GL_ELEMENT_ARRAY_BUFFER,
-                nNewCap * sizeof(unsigned int), nullptr, GL_DYNAMIC_DRAW);
+        if (!m_pGpuBudget->isOverBudget())
+            return;
+        mergeSparseBlocks();
 
-            // 旧数据全丢！因为我们有 m_vVertexCache 缓存，下次 compact 时会重建
-            block->bCompact = true;  // 强制下次 compact 时重建
+        if (!m_pGpuBudget->isOverBudget())
+            return;
+        shrinkBlocks();
 
+        if (!m_pGpuBudget->isOverBudget())
             return;
-        }
-        else
-        {
-            // 没崩溃过
-            if (nNeedV <= block->nVertexCapacity && nNeedI <= block->nIndexCapacity)
-                return;
+        evictHiddenBlocks();
+    }
 
-            size_t nNewV = block->nVertexCapacity;
-            size_t nNewI = block->nIndexCapacity;
+    void PolylinesVboManager::shrinkBlocks()
+    {
+        std::vector<ColorVBOBlock*> vEmpty;
+        for (auto& pair : m_colorBlocksMap)
+        {
+            for (ColorVBOBlock* block : pair.second)
+            {
+                // 图元已全部删除的块直接释放
+                if (block->idToIndexMap.empty())
+                {
+                    vEmpty.push_back(block);
+                    continue;
+                }
 
-            while (nNewV < nNeedV)
-                nNewV += GROW_STEP;
-            while (nNewI < nNeedI)
-                nNewI += GROW_STEP;
+                if (block->bEvicted)
+                    continue;
 
-            // 保存旧容量信息，用于后续重新上传数据
-            size_t nOldVertexCount = block->nVertexCount;
-            size_t nOldIndexCount = block->nIndexCount;
+                compactBlock(block);
 
-            block->nVertexCapacity = nNewV;
-            block->nIndexCapacity = nNewI;
+                size_t nTarget = std::max(block->nVertexCount + block->nVertexCount / 4, MIN_BLOCK_CAPACITY);
+                if (block->nVertexCapacity > block->nVertexCount * SHRINK_RATIO && nTarget < block->nVertexCapacity)
+                {
+                    resizeBlockBuffers(block, nTarget);
+                    if (block->bShadowValid)
+                        shrinkShadowToFit(block);
+                    m_pGpuBudget->recordEvent(GpuMemoryBudget::Event::Shrink);
+                }
+            }
+        }
 
-            // Orphaning 重新分配 - 但这次我们需要重新上传数据
-            m_gl->glBindBuffer(GL_ARRAY_BUFFER, block->vbo);
-            m_gl->glBufferData(GL_ARRAY_BUFFER,
-                static_cast<GLsizeiptr>(nNewV * 3 * sizeof(float)), nullptr, GL_DYNAMIC_DRAW);
+        for (ColorVBOBlock* block : vEmpty)
+            destroyBlock(block);
+    }
 
-            m_gl->glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, block->ebo);
-            m_gl->glBufferData(GL_ELEMENT_ARRAY_BUFFER,
-                static_cast<GLsizeiptr>(nNewI * sizeof(unsigned int)), nullptr, GL_DYNAMIC_DRAW);
+    void PolylinesVboManager::mergeSparseBlocks()
+    {
+        // 格式、坐标窗口与 z 都相同时，两个块编码后的顶点字节可以直接互相拷贝
+        auto sameLayout = [](const ColorVBOBlock* a, const ColorVBOBlock* b) {
+            return a->eFormat == b->eFormat && a->fLayerZ == b->fLayerZ &&
+                a->window.fOriginX == b->window.fOriginX &&
+                a->window.fOriginY == b->window.fOriginY &&
+                a->window.fStep == b->window.fStep;
+        };
 
-            // 重新上传所有图元的数据
-            if (nOldVertexCount > 0)
+        for (auto& pair : m_colorBlocksMap)
+        {
+            std::vector<ColorVBOBlock*> vSparse;
+            for (ColorVBOBlock* block : pair.second)
             {
-                std::vector<float> allVertices;
-                std::vector<unsigned int> allIndices;
+                if (block->bEvicted)
+                    continue;
+
+                compactBlock(block);
+                if (block->nVertexCount < block->nVertexCapacity * SPARSE_THRESHOLD)
+                    vSparse.push_back(block);
+            }
+            if (vSparse.size() < 2)
+                continue;
 
-                allVertices.reserve(nOldVertexCount * 3);
-                allIndices.reserve(nOldIndexCount);
+            // 从小到大，小块并入能容纳它的最大稀疏块
+            std::sort(vSparse.begin(), vSparse.end(), [](const ColorVBOBlock* a, const ColorVBOBlock* b) {
+                return a->nVertexCount < b->nVertexCount;
+            });
 
-                // 从顶点缓存中收集所有有效图元的数据
-                // 每次扩容就重传整个 block（几百万顶点） !!!!
-                size_t currentBase = 0;
-                for (size_t i = 0; i < block->vPrimitives.size(); ++i)
+            for (size_t i = 0; i < vSparse.size(); ++i)
+            {
+                ColorVBOBlock* src = vSparse[i];
+                ColorVBOBlock* dst = nullptr;
+                for (size_t j = vSparse.size(); j-- > i + 1;)
                 {
-                    const PrimitiveInfo& prim = block->vPrimitives[i];
-                    if (prim.bValid)
+                    ColorVBOBlock* cand = vSparse[j];
+                    if (cand && sameLayout(src, cand) &&
+                        cand->nVertexCount + src->nVertexCount + 5000 < MAX_VERT_PER_BLOCK)
                     {
-                        auto it = m_vVertexCache.find(prim.id);
-                        if (it != m_vVertexCache.end())
-                        {
-                            const std::vector<float>& vertices = it->second;
-                            size_t vertexCount = vertices.size() / 3;
-
-                            // 添加顶点数据
-                            allVertices.insert(allVertices.end(), vertices.begin(), vertices.end());
-
-                            // 添加索引数据
-                            for (size_t j = 0; j < vertexCount; ++j)
-                            {
-                                allIndices.push_back(static_cast<unsigned int>(currentBase + j));
-                            }
-
-
-                            currentBase += vertexCount;
-                        }
+                        dst = cand;
+                        break;
                     }
                 }
+                if (!dst)
+                    continue;
 
-                // 上传重新收集的数据
-                m_gl->glBindBuffer(GL_ARRAY_BUFFER, block->vbo);
-                m_gl->glBufferSubData(GL_ARRAY_BUFFER, 0,
-                    static_cast<GLsizeiptr>(allVertices.size() * sizeof(float)), allVertices.data());
+                mergeBlockInto(src, dst);
+                vSparse[i] = nullptr;
 
-                m_gl->glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, block->ebo);
-                m_gl->glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0,
-                    static_cast<GLsizeiptr>(allIndices.size() * sizeof(unsigned int)), allIndices.data());
+                if (!m_pGpuBudget->isOverBudget())
+                    return;
             }
-            return;
         }
     }
 
     /**
-     * @brief 上传单个折线到VBO块
+     * @brief 合并两个块
      *
-     * 将折线数据（顶点和索引）上传到指定的VBO块中，包括：
-     * - 计算顶点和索引的偏移量
-     * - 使用glBufferSubData更新VBO和EBO
-     * - 计算相对索引值
-     * - 更新渲染相关状态
+     * 两个块先各自整理，src 的顶点在 GPU 端直接拷贝到 dst 尾部（格式与窗口相同，字节兼容），
+     * 索引按恒等序列补齐，图元基础顶点整体平移后追加到 dst，ID 映射同步改指向 dst。
+     * 隐藏的图元保持隐藏。dst 容量不足时只扩到恰好够用（再留 25% 余量），不按倍数增长。
      *
-     * @param block 目标VBO块
-     * @param nPrimIdx 要上传的折线在块中的索引
+     * @param src 被合并的块，合并后销毁
+     * @param dst 目标块
      */
-    void PolylinesVboManager::uploadSinglePrimitive(ColorVBOBlock* block, size_t nPrimIdx)
+    void PolylinesVboManager::mergeBlockInto(ColorVBOBlock* src, ColorVBOBlock* dst)
     {
-        const PrimitiveInfo& prim = block->vPrimitives[nPrimIdx];
-        if (!prim.bValid)
-            return;
-
-        auto it = m_vVertexCache.find(prim.id);
-        if (it == m_vVertexCache.end())
-            return;
-
-        const std::vector<float>& vVerts = it->second;
-        size_t nVertCount = vVerts.size() / 3;
-
-        GLsizeiptr nVertOffset = static_cast<GLsizeiptr>(prim.nBaseVertex) * 3 * sizeof(float);
-        GLsizeiptr nIdxOffset = static_cast<GLsizeiptr>(prim.nBaseVertex) * sizeof(unsigned int);
-
-        // 顶点
-        m_gl->glBindBuffer(GL_ARRAY_BUFFER, block->vbo);
-        m_gl->glBufferSubData(GL_ARRAY_BUFFER, nVertOffset,
-            static_cast<GLsizeiptr>(vVerts.size() * sizeof(float)), vVerts.data());
-
-        // 索引
-        std::vector<unsigned int> vIndices(nVertCount);
-        for (size_t i = 0; i < nVertCount; ++i)
-            vIndices[i] = static_cast<unsigned int>(prim.nBaseVertex + i);
+        compactBlock(src);
+        compactBlock(dst);
 
-        m_gl->glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, block->ebo);
-        m_gl->glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, nIdxOffset,
-            static_cast<GLsizeiptr>(vIndices.size() * sizeof(unsigned int)), vIndices.data());
-    }
+        const size_t nStride = vertexStride(dst->eFormat);
+        const size_t nOff = dst->nVertexCount;
+        const size_t nCount = src->nVertexCount;
+        const size_t nNeed = nOff + nCount;
+        if (nNeed > dst->nVertexCapacity)
+            resizeBlockBuffers(dst, nNeed + nNeed / 4);
 
-    /**
-     * @brief 压缩VBO块，整理内存碎片
-     *
-     * 当块中存在被删除的折线时，此方法负责：
-     * - 移除无效的折线数据
-     * - 重新组织顶点和索引数据以消除空洞
-     * - 更新所有受影响的折线的基础顶点偏移
-     * - 重置缓冲区大小为实际使用大小
-     * - 重新生成绘制命令
-     *
-     * @param block 要压缩的VBO块
-     */
-    void PolylinesVboManager::compactBlock(ColorVBOBlock* block)
-    {
-        if (!block->bCompact || block->nVertexCount == 0)
-            return;
+        if (nCount > 0)
+        {
+            m_gl->glBindBuffer(GL_COPY_READ_BUFFER, src->vbo);
+            m_gl->glBindBuffer(GL_COPY_WRITE_BUFFER, dst->vbo);
+            m_gl->glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0,
+                static_cast<GLintptr>(nOff * nStride), static_cast<GLsizeiptr>(nCount * nStride));
 
-        std::vector<float> newVerts;
-        std::vector<unsigned int> newIndices;
-        newVerts.reserve(block->nVertexCount * 3 * 3 / 4);  // 预估 75% 存活
-        newIndices.reserve(block->nVertexCount);
+            std::vector<unsigned int> vIndices(nCount);
+            for (size_t i = 0; i < nCount; ++i)
+                vIndices[i] = static_cast<unsigned int>(nOff + i);
+
+            m_gl->glBindBuffer(GL_COPY_WRITE_BUFFER, dst->ebo);
+            m_gl->glBufferSubData(GL_COPY_WRITE_BUFFER, static_cast<GLintptr>(nOff * sizeof(unsigned int)),
+                static_cast<GLsizeiptr>(nCount * sizeof(unsigned int)), vIndices.data());
+            m_gl->glBindBuffer(GL_COPY_READ_BUFFER, 0);
+            m_gl->glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+            m_pGpuBudget->recordUpload(nCount * (nStride + sizeof(unsigned int)));
+        }
 
-        size_t currentBase = 0;
+        // 影子：任何一方不完整，合并后的块都只能依赖显存读回
+        if (dst->bShadowValid)
+        {
+            if (src->bShadowValid)
+            {
+                writeShadow(dst, nOff, src->vShadow.data(), nCount);
+            }
+            else
+            {
+                m_nShadowBytes -= dst->vShadow.capacity() * sizeof(float);
+                std::vector<float>().swap(dst->vShadow);
+                dst->bShadowValid = false;
+            }
+        }
 
-        for (PrimitiveInfo& prim : block->vPrimitives)
+        for (const PrimitiveInfo& prim : src->vPrimitives)
         {
-            if (!prim.bValid || prim.nIndexCount <= 1)
+            if (prim.nIndexCount <= 0)
                 continue;
 
-            // Step 1: 先尝试从缓存拿（最快）
-            auto cacheIt = m_vVertexCache.find(prim.id);
-            const std::vector<float>* vertsPtr = nullptr;
-            std::vector<float> tempVerts;
+            PrimitiveInfo moved = prim;
+            moved.nBaseVertex += static_cast<GLint>(nOff);
 
-            if (cacheIt != m_vVertexCache.end())
+            size_t nPrimIdx = dst->vPrimitives.size();
+            dst->vPrimitives.push_back(moved);
+            dst->idToIndexMap[prim.id] = nPrimIdx;
+
+            auto itLoc = m_IDLocationMap.find(prim.id);
+            if (itLoc != m_IDLocationMap.end())
             {
-                vertsPtr = &cacheIt->second;
+                itLoc->second.block = dst;
+                itLoc->second.nPrimIdx = nPrimIdx;
             }
-            else
+        }
+        src->idToIndexMap.clear();
+
+        dst->nVertexCount += nCount;
+        dst->nIndexCount += nCount;
+        markDirty(dst);
+        trackBlock(dst);
+
+        destroyBlock(src);
+        m_pGpuBudget->recordEvent(GpuMemoryBudget::Event::Merge);
+    }
+
+    void PolylinesVboManager::evictHiddenBlocks()
+    {
+        std::vector<ColorVBOBlock*> vHidden;
+        for (auto& pair : m_colorBlocksMap)
+        {
+            for (ColorVBOBlock* block : pair.second)
             {
-                // Step 2: 缓存没了？从当前 VBO 里把旧数据读回来！（关键兜底！）
-                // 这才是真正的「数据永不丢失」
-                size_t oldOffset = static_cast<size_t>(prim.nBaseVertex);
-                size_t vertCount = static_cast<size_t>(prim.nIndexCount);
-
-                tempVerts.resize(vertCount * 3);
-                m_gl->glBindBuffer(GL_ARRAY_BUFFER, block->vbo);
-                m_gl->glGetBufferSubData(GL_ARRAY_BUFFER,
-                    oldOffset * 3 * sizeof(float),
-                    vertCount * 3 * sizeof(float),
-                    tempVerts.data());
-
-                vertsPtr = &tempVerts;
-
-                // 可选：重新放回缓存（防止下次又读）
-                // m_vVertexCache[prim.id] = std::move(tempVerts);
-                // touchCache(prim.id);
+                if (block->bEvicted || block->idToIndexMap.empty())
+                    continue;
+
+                if (block->bDirty)
+                    rebuildDrawCmds(block);
+                if (block->vDrawCounts.empty())
+                    vHidden.push_back(block);
             }
+        }
 
-            const auto& verts = *vertsPtr;
-            size_t nCount = verts.size() / 3;
+        std::sort(vHidden.begin(), vHidden.end(), [](const ColorVBOBlock* a, const ColorVBOBlock* b) {
+            return a->nVertexCapacity > b->nVertexCapacity;
+        });
 
-            // 写入新缓冲区
-            newVerts.insert(newVerts.end(), verts.begin(), verts.end());
-            for (size_t i = 0; i < nCount; ++i)
-                newIndices.push_back(static_cast<unsigned int>(currentBase + i));
+        for (ColorVBOBlock* block : vHidden)
+        {
+            if (!m_pGpuBudget->isOverBudget())
+                break;
+            evictBlock(block);
+        }
+    }
 
-            // 更新 base vertex
-            prim.nBaseVertex = static_cast<GLint>(currentBase);
-            currentBase += nCount;
+    /**
+     * @brief 驱逐块
+     *
+     * 先整理块，影子因内存预算被释放过时一次性读回显存并解码为 xyz，
+     * 然后删除 VAO / VBO / EBO。之后对该块的编辑只写影子，
+     * 有图元重新可见时由 updateGpuResidency 调用 restoreBlock 恢复。
+     *
+     * @param block 要驱逐的块
+     */
+    void PolylinesVboManager::evictBlock(ColorVBOBlock* block)
+    {
+        compactBlock(block);
+
+        const size_t nStride = vertexStride(block->eFormat);
+        std::vector<unsigned char> vRaw;
+        if (!block->bShadowValid && block->nVertexCount > 0)
+        {
+            vRaw.resize(block->nVertexCount * nStride);
+            m_gl->glBindBuffer(GL_COPY_READ_BUFFER, block->vbo);
+            m_gl->glGetBufferSubData(GL_COPY_READ_BUFFER, 0,
+                static_cast<GLsizeiptr>(vRaw.size()), vRaw.data());
+            m_gl->glBindBuffer(GL_COPY_READ_BUFFER, 0);
         }
 
-        // 一次性上传新数据
-        m_gl->glBindBuffer(GL_ARRAY_BUFFER, block->vbo);
-        m_gl->glBufferData(GL_ARRAY_BUFFER,
-            block->nVertexCapacity * 3 * sizeof(float), nullptr, GL_DYNAMIC_DRAW);
-        m_gl->glBufferSubData(GL_ARRAY_BUFFER, 0,
-            newVerts.size() * sizeof(float), newVerts.data());
+        m_gl->glDeleteVertexArrays(1, &block->vao);
+        m_gl->glDeleteBuffers(1, &block->vbo);
+        m_gl->glDeleteBuffers(1, &block->ebo);
+        block->vao = 0;
+        block->vbo = 0;
+        block->ebo = 0;
+        block->nVertexCapacity = 0;
+        block->nIndexCapacity = 0;
+        block->vDrawCounts.clear();
+        block->vBaseVertices.clear();
 
-        m_gl->glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, block->ebo);
-        m_gl->glBufferData(GL_ELEMENT_ARRAY_BUFFER,
-            block->nIndexCapacity * sizeof(unsigned int), nullptr, GL_DYNAMIC_DRAW);
-        m_gl->glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0,
-            newIndices.size() * sizeof(unsigned int), newIndices.data());
+        if (!block->bShadowValid)
+        {
+            block->bShadowValid = true;
+            resizeShadow(block, block->nVertexCount * 3);
+            decodeVertices(block->eFormat, block->window, block->fLayerZ,
+                vRaw.data(), block->nVertexCount, block->vShadow.data());
+        }
+        else
+        {
+            resizeShadow(block, block->nVertexCount * 3);
+        }
+        shrinkShadowToFit(block);
 
-        // 更新统计
-        block->nVertexCount = currentBase;
-        block->nIndexCount = currentBase;
-        block->bCompact = false;
-        block->bDirty = true;
+        block->bEvicted = true;
+        trackBlock(block);
+        m_pGpuBudget->recordEvent(GpuMemoryBudget::Event::Evict);
     }
 
-    void PolylinesVboManager::rebuildDrawCmds(ColorVBOBlock* block)
+    void PolylinesVboManager::restoreBlock(ColorVBOBlock* block)
     {
-        block->vDrawCounts.clear();
-        block->vBaseVertices.clear();
+        compactBlock(block);
 
-        for (const PrimitiveInfo& prim : block->vPrimitives)
+        const size_t nStride = vertexStride(block->eFormat);
+        const size_t nCount = block->nVertexCount;
+        const size_t nCap = std::max(nCount + nCount / 4, MIN_BLOCK_CAPACITY);
+
+        m_gl->glGenVertexArrays(1, &block->vao);
+        m_gl->glGenBuffers(1, &block->vbo);
+        m_gl->glGenBuffers(1, &block->ebo);
+
+        const void* pUpload = block->vShadow.data();
+        std::vector<unsigned char> vEncoded;
+        if (block->eFormat != VertexFormat::Float3)
         {
-            if (prim.bValid && prim.nIndexCount > 0)
-            {
-                block->vDrawCounts.push_back(prim.nIndexCount);
-                block->vBaseVertices.push_back(prim.nBaseVertex);
-            }
+            vEncoded.resize(nCount * nStride);
+            encodeVertices(block->eFormat, block->window, block->vShadow.data(), nCount, vEncoded.data());
+            pUpload = vEncoded.data();
         }
 
-        block->bDirty = false;
+        std::vector<unsigned int> vIndices(nCount);
+        for (size_t i = 0; i < nCount; ++i)
+            vIndices[i] = static_cast<unsigned int>(i);
+
+        m_gl->glBindBuffer(GL_COPY_WRITE_BUFFER, block->vbo);
+        m_gl->glBufferData(GL_COPY_WRITE_BUFFER,
+            static_cast<GLsizeiptr>(nCap * nStride), nullptr, GL_DYNAMIC_DRAW);
+        if (nCount > 0)
+            m_gl->glBufferSubData(GL_COPY_WRITE_BUFFER, 0, static_cast<GLsizeiptr>(nCount * nStride), pUpload);
+
+        m_gl->glBindBuffer(GL_COPY_WRITE_BUFFER, block->ebo);
+        m_gl->glBufferData(GL_COPY_WRITE_BUFFER,
+            static_cast<GLsizeiptr>(nCap * sizeof(unsigned int)), nullptr, GL_DYNAMIC_DRAW);
+        if (nCount > 0)
+            m_gl->glBufferSubData(GL_COPY_WRITE_BUFFER, 0,
+                static_cast<GLsizeiptr>(nCount * sizeof(unsigned int)), vIndices.data());
+        m_gl->glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        m_pGpuBudget->recordUpload(nCount * (nStride + sizeof(unsigned int)));
+
+        block->nVertexCapacity = nCap;
+        block->nIndexCapacity = nCap;
+        block->bEvicted = false;
+        markDirty(block);
+        setupBlockVao(block);
+
+        trackBlock(block);
+        m_pGpuBudget->recordEvent(GpuMemoryBudget::Event::Restore);
     }
 
-    void PolylinesVboManager::touchCache(long long id)
+    void PolylinesVboManager::destroyBlock(ColorVBOBlock* block)
     {
-        m_vertexCacheOrder.remove(id);
-        m_vertexCacheOrder.push_front(id);
-        if (m_vertexCacheOrder.size() > MAX_CACHE_SIZE)
+        auto& vBlocks = m_colorBlocksMap[block->color.toUInt32()];
+        vBlocks.erase(std::remove(vBlocks.begin(), vBlocks.end(), block), vBlocks.end());
+
+        if (m_gl)
         {
-            long long old = m_vertexCacheOrder.back();
-            m_vertexCacheOrder.pop_back();
-            m_vVertexCache.erase(old);
+            m_gl->glDeleteVertexArrays(1, &block->vao);
+            m_gl->glDeleteBuffers(1, &block->vbo);
+            m_gl->glDeleteBuffers(1, &block->ebo);
         }
+
+        m_nShadowBytes -= block->vShadow.capacity() * sizeof(float);
+        m_pGpuBudget->removeBlock(block);
+        delete block;
+        ++m_nLayoutVersion;
+        ++m_nBlockSetVersion;
     }
 
     void PolylinesVboManager::bindBlock(ColorVBOBlock* block) const
@@ -1040,6 +3130,9 @@ namespace GLRhi
 
     void PolylinesVboManager::startBackgroundDefrag()
     {
+        // 延迟模式下所有 GL 调用集中在渲染线程，待整理的块由每帧渲染时整理
+        if (isDeferredMode() || m_defragThread.joinable())
+            return;
 
         if (1)
         {
@@ -0,0 +1,177 @@
+#include "SegmentRTree.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace GLRhi
+{
+    /**
+     * @brief STR 排序：先按中心 x 切成 sqrt(P) 条，每条内再按中心 y 排序，
+     *        之后每 NODE_CAPACITY 个连续元素组成一个节点
+     */
+    template <typename T, typename CenterFn>
+    void SegmentRTree::strSort(std::vector<T>& vItems, CenterFn center)
+    {
+        const size_t nCount = vItems.size();
+        const size_t nPages = (nCount + NODE_CAPACITY - 1) / NODE_CAPACITY;
+        const size_t nSlices = static_cast<size_t>(std::ceil(std::sqrt(static_cast<double>(nPages))));
+        const size_t nSliceSize = nSlices * NODE_CAPACITY;
+
+        std::sort(vItems.begin(), vItems.end(),
+            [&](const T& a, const T& b) { return center(a).first < center(b).first; });
+
+        for (size_t i = 0; i < nCount; i += nSliceSize)
+        {
+            auto itEnd = vItems.begin() + static_cast<std::ptrdiff_t>(std::min(i + nSliceSize, nCount));
+            std::sort(vItems.begin() + static_cast<std::ptrdiff_t>(i), itEnd,
+                [&](const T& a, const T& b) { return center(a).second < center(b).second; });
+        }
+    }
+
+    void SegmentRTree::build(std::vector<SegmentEntry>&& vSegments)
+    {
+        clear();
+        m_vSegments = std::move(vSegments);
+        if (m_vSegments.empty())
+            return;
+
+        strSort(m_vSegments, [](const SegmentEntry& s) {
+            return std::make_pair(s.x1 + s.x2, s.y1 + s.y2);
+        });
+
+        // 叶节点
+        std::vector<Node> vLevel;
+        vLevel.reserve((m_vSegments.size() + NODE_CAPACITY - 1) / NODE_CAPACITY);
+        for (size_t i = 0; i < m_vSegments.size(); i += NODE_CAPACITY)
+        {
+            Node node;
+            node.nFirst = static_cast<uint32_t>(i);
+            node.nCount = static_cast<uint32_t>(std::min(NODE_CAPACITY, m_vSegments.size() - i));
+            node.box = segmentBox(m_vSegments[i]);
+            for (uint32_t k = 1; k < node.nCount; ++k)
+                expand(node.box, segmentBox(m_vSegments[i + k]));
+            vLevel.push_back(node);
+        }
+
+        // 逐层向上打包，子节点在 m_vNodes 中连续
+        while (vLevel.size() > 1)
+        {
+            strSort(vLevel, [](const Node& n) {
+                return std::make_pair(n.box.fMinX + n.box.fMaxX, n.box.fMinY + n.box.fMaxY);
+            });
+
+            const size_t nBase = m_vNodes.size();
+            m_vNodes.insert(m_vNodes.end(), vLevel.begin(), vLevel.end());
+
+            std::vector<Node> vParents;
+            vParents.reserve((vLevel.size() + NODE_CAPACITY - 1) / NODE_CAPACITY);
+            for (size_t i = 0; i < vLevel.size(); i += NODE_CAPACITY)
+            {
+                Node parent;
+                parent.bLeaf = false;
+                parent.nFirst = static_cast<uint32_t>(nBase + i);
+                parent.nCount = static_cast<uint32_t>(std::min(NODE_CAPACITY, vLevel.size() - i));
+                parent.box = vLevel[i].box;
+                for (uint32_t k = 1; k < parent.nCount; ++k)
+                    expand(parent.box, vLevel[i + k].box);
+                vParents.push_back(parent);
+            }
+            vLevel = std::move(vParents);
+        }
+
+        m_vNodes.push_back(vLevel.front());
+    }
+
+    void SegmentRTree::clear()
+    {
+        m_vSegments.clear();
+        m_vSegments.shrink_to_fit();
+        m_vNodes.clear();
+        m_vNodes.shrink_to_fit();
+    }
+
+    bool SegmentRTree::nearest(float x, float y, float fRadius, uint32_t& nPrim, float& fDist) const
+    {
+        if (m_vNodes.empty())
+            return false;
+
+        float fBestSq = fRadius * fRadius;
+        bool bFound = false;
+
+        std::vector<uint32_t> vStack;
+        vStack.reserve(64);
+        vStack.push_back(static_cast<uint32_t>(m_vNodes.size() - 1));
+
+        while (!vStack.empty())
+        {
+            const Node& node = m_vNodes[vStack.back()];
+            vStack.pop_back();
+
+            if (boxDistSq(node.box, x, y) > fBestSq)
+                continue;
+
+            if (!node.bLeaf)
+            {
+                for (uint32_t k = 0; k < node.nCount; ++k)
+                    vStack.push_back(node.nFirst + k);
+                continue;
+            }
+
+            for (uint32_t k = 0; k < node.nCount; ++k)
+            {
+                const SegmentEntry& seg = m_vSegments[node.nFirst + k];
+                float fDistSq = segmentDistSq(seg, x, y);
+                if (fDistSq <= fBestSq)
+                {
+                    fBestSq = fDistSq;
+                    nPrim = seg.nPrim;
+                    bFound = true;
+                }
+            }
+        }
+
+        if (bFound)
+            fDist = std::sqrt(fBestSq);
+        return bFound;
+    }
+
+    size_t SegmentRTree::memoryBytes() const
+    {
+        return m_vSegments.capacity() * sizeof(SegmentEntry) + m_vNodes.capacity() * sizeof(Node);
+    }
+
+    SegmentRTree::Box SegmentRTree::segmentBox(const SegmentEntry& seg)
+    {
+        return Box{ std::min(seg.x1, seg.x2), std::min(seg.y1, seg.y2),
+            std::max(seg.x1, seg.x2), std::max(seg.y1, seg.y2) };
+    }
+
+    void SegmentRTree::expand(Box& box, const Box& other)
+    {
+        box.fMinX = std::min(box.fMinX, other.fMinX);
+        box.fMinY = std::min(box.fMinY, other.fMinY);
+        box.fMaxX = std::max(box.fMaxX, other.fMaxX);
+        box.fMaxY = std::max(box.fMaxY, other.fMaxY);
+    }
+
+    float SegmentRTree::boxDistSq(const Box& box, float x, float y)
+    {
+        float dx = std::max({ box.fMinX - x, 0.0f, x - box.fMaxX });
+        float dy = std::max({ box.fMinY - y, 0.0f, y - box.fMaxY });
+        return dx * dx + dy * dy;
+    }
+
+    float SegmentRTree::segmentDistSq(const SegmentEntry& seg, float x, float y)
+    {
+        float dx = seg.x2 - seg.x1;
+        float dy = seg.y2 - seg.y1;
+        float fLenSq = dx * dx + dy * dy;
+        float t = 0.0f;
+        if (fLenSq > 0.0f)
+            t = std::clamp(((x - seg.x1) * dx + (y - seg.y1) * dy) / fLenSq, 0.0f, 1.0f);
+
+        float px = seg.x1 + t * dx - x;
+        float py = seg.y1 + t * dy - y;
+        return px * px + py * py;
+    }
+}
@@ -0,0 +1,70 @@
+#include "TexturesVboManager.h"
+
+namespace GLRhi
+{
+    void TextureTraits::writeVertices(const Data& data, float* pDst)
+    {
+        const float fDepth = data.brush.getDepth();
+        const float fLayer = static_cast<float>(data.textureLayer);
+        const float fAlpha = data.brush.getAlpha();
+
+        const float* pSrc = data.vVerts.data();
+        for (size_t i = 0, n = vertexCount(data); i < n; ++i, pSrc += 4, pDst += VERTEX_FLOATS)
+        {
+            pDst[0] = pSrc[0];
+            pDst[1] = pSrc[1];
+            pDst[2] = fDepth;
+            pDst[3] = pSrc[2];
+            pDst[4] = pSrc[3];
+            pDst[5] = fLayer;
+            pDst[6] = fAlpha;
+        }
+    }
+
+    void TextureTraits::writeIndices(const Data& data, std::vector<unsigned int>& vOut)
+    {
+        if (!data.indices.empty())
+        {
+            vOut.insert(vOut.end(), data.indices.begin(), data.indices.end());
+            return;
+        }
+
+        size_t nVerts = vertexCount(data);
+        if (nVerts == 4)
+        {
+            vOut.insert(vOut.end(), { 0u, 1u, 2u, 0u, 2u, 3u });
+            return;
+        }
+
+        nVerts = nVerts / 3 * 3;
+        for (size_t i = 0; i < nVerts; ++i)
+            vOut.push_back(static_cast<unsigned int>(i));
+    }
+
+    void TextureTraits::setupAttributes(QOpenGLFunctions_3_3_Core* gl)
+    {
+        const GLsizei nStride = VERTEX_FLOATS * sizeof(float);
+        gl->glEnableVertexAttribArray(0);
+        gl->glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, nStride, nullptr);
+        gl->glEnableVertexAttribArray(1);
+        gl->glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, nStride, reinterpret_cast<const void*>(3 * sizeof(float)));
+        gl->glEnableVertexAttribArray(2);
+        gl->glVertexAttribPointer(2, 1, GL_FLOAT, GL_FALSE, nStride, reinterpret_cast<const void*>(6 * sizeof(float)));
+    }
+
+    TextureTraits::Uniforms TextureTraits::getUniforms(QOpenGLFunctions_3_3_Core* gl, GLint nProg)
+    {
+        Uniforms uniforms;
+        uniforms.nSamplerLoc = gl->glGetUniformLocation(static_cast<GLuint>(nProg), "uTexArray");
+        if (uniforms.nSamplerLoc >= 0)
+            gl->glUniform1i(uniforms.nSamplerLoc, 0);
+        return uniforms;
+    }
+
+    void TextureTraits::bindBatch(QOpenGLFunctions_3_3_Core* gl, const Uniforms& uniforms, const BatchInfo& info)
+    {
+        (void)uniforms;
+        gl->glActiveTexture(GL_TEXTURE0);
+        gl->glBindTexture(GL_TEXTURE_2D_ARRAY, info.tex);
+    }
+}
@@ -0,0 +1,41 @@
+#include "TrianglesVboManager.h"
+
+namespace GLRhi
+{
+    void TriangleTraits::writeVertices(const Data& data, float* pDst)
+    {
+        std::memcpy(pDst, data.vVerts.data(), vertexCount(data) * VERTEX_FLOATS * sizeof(float));
+    }
+
+    void TriangleTraits::writeIndices(const Data& data, std::vector<unsigned int>& vOut)
+    {
+        if (!data.indices.empty())
+        {
+            vOut.insert(vOut.end(), data.indices.begin(), data.indices.end());
+            return;
+        }
+
+        size_t nVerts = vertexCount(data) / 3 * 3;
+        for (size_t i = 0; i < nVerts; ++i)
+            vOut.push_back(static_cast<unsigned int>(i));
+    }
+
+    void TriangleTraits::setupAttributes(QOpenGLFunctions_3_3_Core* gl)
+    {
+        gl->glEnableVertexAttribArray(0);
+        gl->glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), nullptr);
+    }
+
+    TriangleTraits::Uniforms TriangleTraits::getUniforms(QOpenGLFunctions_3_3_Core* gl, GLint nProg)
+    {
+        Uniforms uniforms;
+        uniforms.nColorLoc = gl->glGetUniformLocation(static_cast<GLuint>(nProg), "uColor");
+        return uniforms;
+    }
+
+    void TriangleTraits::bindBatch(QOpenGLFunctions_3_3_Core* gl, const Uniforms& uniforms, const BatchInfo& info)
+    {
+        if (uniforms.nColorLoc >= 0)
+            gl->glUniform4f(uniforms.nColorLoc, info.color.r(), info.color.g(), info.color.b(), info.color.a());
+    }
+}
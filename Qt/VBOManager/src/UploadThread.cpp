@@ -0,0 +1,118 @@
+#include "UploadThread.h"
+
+#include <QOpenGLContext>
+#include <QOffscreenSurface>
+#include <QThread>
+#include <QDebug>
+
+namespace GLRhi
+{
+    UploadThread::~UploadThread()
+    {
+        stop();
+    }
+
+    bool UploadThread::start(QOpenGLContext* pShareContext)
+    {
+        if (m_pThread || !pShareContext)
+            return m_pThread != nullptr;
+
+        m_pSurface = new QOffscreenSurface();
+        m_pSurface->setFormat(pShareContext->format());
+        m_pSurface->create();
+
+        m_pContext = new QOpenGLContext();
+        m_pContext->setFormat(pShareContext->format());
+        m_pContext->setShareContext(pShareContext);
+        if (!m_pSurface->isValid() || !m_pContext->create())
+        {
+            qWarning() << "UploadThread: failed to create shared OpenGL context";
+            delete m_pContext;
+            m_pContext = nullptr;
+            m_pSurface->destroy();
+            delete m_pSurface;
+            m_pSurface = nullptr;
+            return false;
+        }
+
+        m_bStop = false;
+        m_pOwnerThread = QThread::currentThread();
+        m_pThread = QThread::create([this]() { run(); });
+        m_pContext->moveToThread(m_pThread);
+        m_pThread->start();
+        return true;
+    }
+
+    void UploadThread::stop()
+    {
+        if (!m_pThread)
+            return;
+
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_bStop = true;
+            m_nPending -= m_tasks.size();
+            m_tasks.clear();
+        }
+        m_condition.notify_all();
+        m_pThread->wait();
+
+        delete m_pThread;
+        m_pThread = nullptr;
+        delete m_pContext;
+        m_pContext = nullptr;
+        m_pSurface->destroy();
+        delete m_pSurface;
+        m_pSurface = nullptr;
+    }
+
+    bool UploadThread::enqueue(Task task)
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            if (!m_pThread || m_bStop)
+                return false;
+            m_tasks.push_back(std::move(task));
+            ++m_nPending;
+        }
+        m_condition.notify_one();
+        return true;
+    }
+
+    GLsync UploadThread::insertFence(QOpenGLFunctions_3_3_Core* gl)
+    {
+        GLsync fence = gl->glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        // 不提交的话栅栏可能永远停在本上下文的命令队列里，其他上下文等不到
+        gl->glFlush();
+        return fence;
+    }
+
+    void UploadThread::run()
+    {
+        QOpenGLFunctions_3_3_Core* gl = nullptr;
+        if (m_pContext->makeCurrent(m_pSurface))
+            gl = m_pContext->versionFunctions<QOpenGLFunctions_3_3_Core>();
+        if (!gl)
+            qWarning() << "UploadThread: shared context has no OpenGL 3.3 core functions, tasks are dropped";
+
+        for (;;)
+        {
+            Task task;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_condition.wait(lock, [this] { return m_bStop || !m_tasks.empty(); });
+                if (m_bStop)
+                    break;
+
+                task = std::move(m_tasks.front());
+                m_tasks.pop_front();
+            }
+            if (gl)
+                task(gl);
+            --m_nPending;
+        }
+
+        m_pContext->doneCurrent();
+        m_pContext->moveToThread(m_pOwnerThread);
+    }
+}
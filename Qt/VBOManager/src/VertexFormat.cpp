@@ -0,0 +1,218 @@
+#include "VertexFormat.h"
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+
+namespace GLRhi
+{
+    size_t vertexStride(VertexFormat eFormat)
+    {
+        switch (eFormat)
+        {
+        case VertexFormat::Quantized16:
+            return 2 * sizeof(int16_t);
+        case VertexFormat::HalfFloat:
+            return 2 * sizeof(uint16_t);
+        case VertexFormat::Float3:
+        default:
+            return 3 * sizeof(float);
+        }
+    }
+
+    const char* vertexFormatName(VertexFormat eFormat)
+    {
+        switch (eFormat)
+        {
+        case VertexFormat::Quantized16:
+            return "Quantized16";
+        case VertexFormat::HalfFloat:
+            return "HalfFloat";
+        case VertexFormat::Float3:
+        default:
+            return "Float3";
+        }
+    }
+
+    uint16_t floatToHalf(float fValue)
+    {
+        uint32_t nBits = 0;
+        std::memcpy(&nBits, &fValue, sizeof(nBits));
+
+        uint32_t nSign = (nBits >> 16) & 0x8000u;
+        uint32_t nAbs = nBits & 0x7FFFFFFFu;
+
+        // NaN / Inf
+        if (nAbs >= 0x7F800000u)
+            return static_cast<uint16_t>(nSign | 0x7C00u | (nAbs > 0x7F800000u ? 0x200u : 0u));
+
+        // 超出半精度范围（>= 65520 舍入后溢出）
+        if (nAbs >= 0x477FF000u)
+            return static_cast<uint16_t>(nSign | 0x7C00u);
+
+        // 规格化数
+        if (nAbs >= 0x38800000u)
+        {
+            uint32_t nMant = nAbs & 0x007FFFFFu;
+            uint32_t nExp = (nAbs >> 23) - 112;
+            uint32_t nHalf = (nExp << 10) | (nMant >> 13);
+
+            // 就近舍入到偶数
+            uint32_t nRound = nMant & 0x1FFFu;
+            if (nRound > 0x1000u || (nRound == 0x1000u && (nHalf & 1u)))
+                ++nHalf;
+            return static_cast<uint16_t>(nSign | nHalf);
+        }
+
+        // 非规格化数
+        if (nAbs >= 0x33000000u)
+        {
+            uint32_t nExp = nAbs >> 23;
+            uint32_t nMant = (nAbs & 0x007FFFFFu) | 0x00800000u;
+            uint32_t nShift = 126 - nExp;
+            uint32_t nHalf = nMant >> nShift;
+
+            uint32_t nRem = nMant & ((1u << nShift) - 1u);
+            uint32_t nHalfWay = 1u << (nShift - 1);
+            if (nRem > nHalfWay || (nRem == nHalfWay && (nHalf & 1u)))
+                ++nHalf;
+            return static_cast<uint16_t>(nSign | nHalf);
+        }
+
+        return static_cast<uint16_t>(nSign);
+    }
+
+    float halfToFloat(uint16_t nHalf)
+    {
+        uint32_t nSign = (static_cast<uint32_t>(nHalf) & 0x8000u) << 16;
+        uint32_t nExp = (nHalf >> 10) & 0x1Fu;
+        uint32_t nMant = nHalf & 0x3FFu;
+        uint32_t nBits = 0;
+
+        if (nExp == 0)
+        {
+            if (nMant == 0)
+            {
+                nBits = nSign;
+            }
+            else
+            {
+                // 非规格化数：归一化尾数
+                nExp = 113;
+                while ((nMant & 0x400u) == 0)
+                {
+                    nMant <<= 1;
+                    --nExp;
+                }
+                nMant &= 0x3FFu;
+                nBits = nSign | (nExp << 23) | (nMant << 13);
+            }
+        }
+        else if (nExp == 0x1F)
+        {
+            nBits = nSign | 0x7F800000u | (nMant << 13);
+        }
+        else
+        {
+            nBits = nSign | ((nExp + 112) << 23) | (nMant << 13);
+        }
+
+        float fValue = 0.0f;
+        std::memcpy(&fValue, &nBits, sizeof(fValue));
+        return fValue;
+    }
+
+    bool fitsWindow(VertexFormat eFormat, const QuantizeWindow& window, float fLayerZ,
+        const float* pVerts, size_t nVertCount)
+    {
+        if (eFormat == VertexFormat::Float3)
+            return true;
+
+        const float fMaxOffset = (eFormat == VertexFormat::Quantized16)
+            ? QUANTIZE_HALF_RANGE * window.fStep
+            : HALF_EXACT_RANGE * window.fStep;
+
+        for (size_t i = 0; i < nVertCount; ++i)
+        {
+            const float* p = pVerts + i * 3;
+            if (p[2] != fLayerZ)
+                return false;
+
+            if (std::fabs(p[0] - window.fOriginX) > fMaxOffset ||
+                std::fabs(p[1] - window.fOriginY) > fMaxOffset)
+                return false;
+        }
+        return true;
+    }
+
+    void encodeVertices(VertexFormat eFormat, const QuantizeWindow& window,
+        const float* pVerts, size_t nVertCount, void* pDst)
+    {
+        switch (eFormat)
+        {
+        case VertexFormat::Quantized16:
+        {
+            int16_t* pOut = static_cast<int16_t*>(pDst);
+            const float fInvStep = 1.0f / window.fStep;
+            for (size_t i = 0; i < nVertCount; ++i)
+            {
+                const float* p = pVerts + i * 3;
+                long nX = std::lround((p[0] - window.fOriginX) * fInvStep);
+                long nY = std::lround((p[1] - window.fOriginY) * fInvStep);
+                pOut[i * 2] = static_cast<int16_t>(std::clamp<long>(nX, -QUANTIZE_HALF_RANGE, QUANTIZE_HALF_RANGE));
+                pOut[i * 2 + 1] = static_cast<int16_t>(std::clamp<long>(nY, -QUANTIZE_HALF_RANGE, QUANTIZE_HALF_RANGE));
+            }
+            break;
+        }
+        case VertexFormat::HalfFloat:
+        {
+            uint16_t* pOut = static_cast<uint16_t*>(pDst);
+            const float fInvStep = 1.0f / window.fStep;
+            for (size_t i = 0; i < nVertCount; ++i)
+            {
+                const float* p = pVerts + i * 3;
+                pOut[i * 2] = floatToHalf((p[0] - window.fOriginX) * fInvStep);
+                pOut[i * 2 + 1] = floatToHalf((p[1] - window.fOriginY) * fInvStep);
+            }
+            break;
+        }
+        case VertexFormat::Float3:
+        default:
+            std::memcpy(pDst, pVerts, nVertCount * 3 * sizeof(float));
+            break;
+        }
+    }
+
+    void decodeVertices(VertexFormat eFormat, const QuantizeWindow& window, float fLayerZ,
+        const void* pSrc, size_t nVertCount, float* pVerts)
+    {
+        switch (eFormat)
+        {
+        case VertexFormat::Quantized16:
+        {
+            const int16_t* pIn = static_cast<const int16_t*>(pSrc);
+            for (size_t i = 0; i < nVertCount; ++i)
+            {
+                pVerts[i * 3] = window.fOriginX + pIn[i * 2] * window.fStep;
+                pVerts[i * 3 + 1] = window.fOriginY + pIn[i * 2 + 1] * window.fStep;
+                pVerts[i * 3 + 2] = fLayerZ;
+            }
+            break;
+        }
+        case VertexFormat::HalfFloat:
+        {
+            const uint16_t* pIn = static_cast<const uint16_t*>(pSrc);
+            for (size_t i = 0; i < nVertCount; ++i)
+            {
+                pVerts[i * 3] = window.fOriginX + halfToFloat(pIn[i * 2]) * window.fStep;
+                pVerts[i * 3 + 1] = window.fOriginY + halfToFloat(pIn[i * 2 + 1]) * window.fStep;
+                pVerts[i * 3 + 2] = fLayerZ;
+            }
+            break;
+        }
+        case VertexFormat::Float3:
+        default:
+            std::memcpy(pVerts, pSrc, nVertCount * 3 * sizeof(float));
+            break;
+        }
+    }
+}